@@ -17,10 +17,10 @@ syn keyword modifiers       publiczny publiczna                             skip
 syn keyword modifiers       statyczny statyczna                             skipwhite
 syn keyword modifiers       końcowy końcowa                                 skipwhite
 syn keyword modifiers       ojczysty ojczysta                               skipwhite
-syn keyword modifiers       zmeinny zmeinna                                 skipwhite
+syn keyword modifiers       zmienny zmienna zmeinny zmeinna                 skipwhite
 syn keyword modifiers       zsynchronizowany zsynchronizowana               skipwhite
 syn keyword modifiers       abstrakcyjny abstrakcyjna                       skipwhite
-syn keyword modifiers       rzejściowy rzejściowa                           skipwhite
+syn keyword modifiers       przejściowy przejściowa                         skipwhite
 syn keyword modifiers       ścisłezp ścisłezp                               skipwhite
 syn keyword controlFlow     jeżeli albo dla wykonaj dopóki zwróć spróbuj    skipwhite
 syn keyword controlFlow     łap wreszcie kontyntynuj przełącz domyślna złam skipwhite
@@ -11,6 +11,7 @@
 #ifndef JAWA_ATTRIBUTE_HPP
 #define JAWA_ATTRIBUTE_HPP
 
+#include <optional>
 #include <vector>
 
 #include "byte_code.hpp"
@@ -33,6 +34,12 @@ namespace jasm {
           : attribute_name_index_(attribute_name_index)
         {}
 
+        inline u2
+        name_index() const
+        {
+            return attribute_name_index_;
+        }
+
         virtual void
         jasm(std::ostream &os, const ConstantPool *pool = nullptr) const = 0;
 
@@ -41,6 +48,19 @@ namespace jasm {
 
         virtual u4
         length() const = 0;
+
+        /**
+         * Visits the constant pool indices the attribute refers to, including its name.
+         *
+         * @param visitor function called with each index.
+         * @return false if the content of the attribute is not known to jasm, so its indices cannot be visited.
+         */
+        virtual bool
+        visit_constants(const ConstantVisitor &visitor)
+        {
+            visitor(attribute_name_index_);
+            return true;
+        }
     };
 
     class Attributable
@@ -88,6 +108,66 @@ namespace jasm {
         {
             attributes_.push_back(std::make_unique<T>(std::forward<T>(attr)));
         }
+
+        /**
+         * Visits the constant pool indices the attributes refer to.
+         *
+         * @param visitor function called with each index.
+         * @return false if any of the attributes is not known to jasm.
+         */
+        bool
+        visit_attribute_constants(const ConstantVisitor &visitor);
+    };
+
+    /**
+     * An attribute which is not interpreted by jasm. The attribute body is kept unchanged, so that a class file
+     * can be read and written back without losing information.
+     */
+    class RawAttribute : public Attribute
+    {
+    private:
+        std::vector<u1> bytes_;
+        // positions of the constant pool indices in the body, if the layout of the attribute is known
+        std::optional<std::vector<u4>> constant_positions_;
+
+    public:
+        RawAttribute(u2 attribute_name_index, std::vector<u1> bytes)
+          : Attribute(attribute_name_index)
+          , bytes_(std::move(bytes))
+        {}
+
+        inline const std::vector<u1> &
+        bytes() const
+        {
+            return bytes_;
+        }
+
+        /**
+         * Sets the positions of the constant pool indices in the body. The constants the attribute refers to can
+         * then be renumbered, although the rest of the body is not interpreted.
+         *
+         * @param positions positions of the big endian indices in the body.
+         */
+        inline void
+        set_constant_positions(std::vector<u4> positions)
+        {
+            constant_positions_ = std::move(positions);
+        }
+
+        void
+        jasm(std::ostream &os, const ConstantPool *pool = nullptr) const override;
+
+        void
+        emit_bytecode(std::ostream &os) const override;
+
+        inline u4
+        length() const override
+        {
+            return bytes_.size();
+        }
+
+        bool
+        visit_constants(const ConstantVisitor &visitor) override;
     };
 
     class ConstantValueAttribute : public Attribute
@@ -101,11 +181,26 @@ namespace jasm {
           , constant_value_index_(constant_value_index)
         {}
 
+        inline u2
+        constant_value_index() const
+        {
+            return constant_value_index_;
+        }
+
+        void
+        jasm(std::ostream &os, const ConstantPool *pool) const override;
+
+        void
+        emit_bytecode(std::ostream &os) const override;
+
         inline u4
         length() const override
         {
             return 2;
         }
+
+        bool
+        visit_constants(const ConstantVisitor &visitor) override;
     };
 
     class CodeAttribute
@@ -176,6 +271,12 @@ namespace jasm {
             return code_;
         }
 
+        inline std::vector<ExceptionTableEntry> &
+        exception_table()
+        {
+            return exception_table_;
+        }
+
         inline u2
         locals_limit() const
         {
@@ -208,11 +309,109 @@ namespace jasm {
 
         u4
         length() const override;
+
+        bool
+        visit_constants(const ConstantVisitor &visitor) override;
     };
 
+    /**
+     * Types of the local variables and of the operand stack at the jump targets, used by the type checking verifier.
+     * The attribute is required in the code containing jumps since class file version 50.
+     */
     class StackMapTableAttribute : public Attribute
     {
-        // TODO:
+    public:
+        struct VerificationType
+        {
+            enum Tag : u1
+            {
+                ITEM_TOP = 0,
+                ITEM_INTEGER = 1,
+                ITEM_FLOAT = 2,
+                ITEM_DOUBLE = 3,
+                ITEM_LONG = 4,
+                ITEM_NULL = 5,
+                ITEM_UNINITIALIZED_THIS = 6,
+                ITEM_OBJECT = 7,
+                ITEM_UNINITIALIZED = 8
+            };
+
+            Tag tag;
+            // constant pool index of the class of an object, position of the new instruction of an uninitialised one
+            u2 index;
+
+            VerificationType(Tag tag, u2 index = 0)
+              : tag(tag)
+              , index(index)
+            {}
+
+            inline bool
+            operator==(const VerificationType &other) const
+            {
+                return tag == other.tag && index == other.index;
+            }
+
+            inline bool
+            operator!=(const VerificationType &other) const
+            {
+                return !(*this == other);
+            }
+
+            inline u4
+            length() const
+            {
+                return tag == ITEM_OBJECT || tag == ITEM_UNINITIALIZED ? 3 : 1;
+            }
+        };
+
+        /**
+         * Frame at a position in the code. Long and double values take up a single entry.
+         */
+        struct Frame
+        {
+            u2 position;
+            std::vector<VerificationType> locals;
+            std::vector<VerificationType> stack;
+        };
+
+    private:
+        std::vector<Frame> frames_;
+
+        u1
+        frame_type(std::size_t i) const;
+
+    public:
+        explicit StackMapTableAttribute(u2 attribute_name_index)
+          : Attribute(attribute_name_index)
+        {}
+
+        /**
+         * Adds a frame, the frames have to be added in the order of their positions.
+         */
+        inline void
+        add_frame(Frame frame)
+        {
+            assert(frames_.empty() || frames_.back().position < frame.position);
+            frames_.push_back(std::move(frame));
+        }
+
+        inline const std::vector<Frame> &
+        frames() const
+        {
+            return frames_;
+        }
+
+        void
+        jasm(std::ostream &os, const ConstantPool *pool = nullptr) const override;
+
+        void
+        emit_bytecode(std::ostream &os) const override;
+
+        u4
+        length() const override;
+
+        bool
+        visit_constants(const ConstantVisitor &visitor) override;
     };
 
     class ExceptionAttribute : public Attribute
@@ -262,6 +461,9 @@ namespace jasm {
         {
             return 2;
         }
+
+        bool
+        visit_constants(const ConstantVisitor &visitor) override;
     };
 
     class SourceDebugExtensionAttribute : public Attribute
@@ -338,9 +540,60 @@ namespace jasm {
         // TODO:
     };
 
+    /**
+     * Bootstrap methods of the invokedynamic call sites of a class.
+     */
     class BootstrapMethodsAttribute : public Attribute
     {
-        // TODO:
+    public:
+        struct BootstrapMethod
+        {
+            u2 method_ref;
+            std::vector<u2> arguments;
+
+            inline bool
+            operator==(const BootstrapMethod &other) const
+            {
+                return method_ref == other.method_ref && arguments == other.arguments;
+            }
+        };
+
+    private:
+        std::vector<BootstrapMethod> bootstrap_methods_;
+
+    public:
+        explicit BootstrapMethodsAttribute(u2 attribute_name_index,
+                                           std::vector<BootstrapMethod> bootstrap_methods = {})
+          : Attribute(attribute_name_index)
+          , bootstrap_methods_(std::move(bootstrap_methods))
+        {}
+
+        /**
+         * Adds a bootstrap method unless the table already contains the same one.
+         *
+         * @param bootstrap_method method handle of the bootstrap method and its static arguments.
+         * @return index of the bootstrap method in the table.
+         */
+        u2
+        add_bootstrap_method(BootstrapMethod bootstrap_method);
+
+        inline const std::vector<BootstrapMethod> &
+        bootstrap_methods() const
+        {
+            return bootstrap_methods_;
+        }
+
+        void
+        jasm(std::ostream &os, const ConstantPool *pool = nullptr) const override;
+
+        void
+        emit_bytecode(std::ostream &os) const override;
+
+        u4
+        length() const override;
+
+        bool
+        visit_constants(const ConstantVisitor &visitor) override;
     };
 
 }
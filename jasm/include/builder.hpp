@@ -12,8 +12,11 @@
 #define JAWA_BUILDER_HPP
 
 #include <class.hpp>
+#include <deque>
 #include <map>
+#include <optional>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "class.hpp"
@@ -26,6 +29,10 @@ namespace jasm {
     {
     private:
         std::vector<std::unique_ptr<Instruction>> code_;
+        std::optional<StackMapTableAttribute::Frame> frame_;
+        // the frame is written only if a widened conditional jump skips to the block
+        bool frame_on_demand_ = false;
+        u4 position_ = 0;
 
         friend class ClassBuilder;
 
@@ -53,14 +60,36 @@ namespace jasm {
         using InsertionPoint = BasicBlock *;
 
     private:
-        std::vector<BasicBlock> basic_blocks_;
+        struct ExceptionHandler
+        {
+            Label start;
+            Label end;
+            Label handler;
+            u2 catch_type;
+        };
+
+        // blocks are laid out in the order of creation, the deque keeps the insertion points valid
+        std::deque<BasicBlock> basic_blocks_;
+        std::vector<const BasicBlock *> labels_;
+        std::vector<ExceptionHandler> exception_handlers_;
         InsertionPoint current_insertion_point_;
         CodeAttribute *current_code_;
         Method *current_method_;
+        BootstrapMethodsAttribute *bootstrap_methods_;
 
         std::map<utf8, u2> utf8_constants_;
         std::map<utf8, u2> string_constants_;
         std::map<utf8, u2> class_constants_;
+        std::map<u4, u2> integer_constants_;
+        std::map<u4, u2> float_constants_;
+        std::map<u8, u2> long_constants_;
+        std::map<u8, u2> double_constants_;
+        std::map<std::pair<u1, u2>, u2> method_handle_constants_;
+        std::map<std::pair<utf8, utf8>, u2> name_and_type_constants_;
+        std::map<std::tuple<utf8, utf8, utf8>, u2> method_constants_;
+        std::map<std::tuple<utf8, utf8, utf8>, u2> interface_method_constants_;
+        std::map<std::tuple<utf8, utf8, utf8>, u2> field_constants_;
+        std::map<std::pair<u2, u2>, u2> invoke_dynamic_constants_;
 
         utf8 class_name_;
         Class class_;
@@ -68,6 +97,15 @@ namespace jasm {
         void
         init();
 
+        /**
+         * Removes the instructions which cannot be reached from the start of the current method.
+         */
+        void
+        remove_unreachable_code();
+
+        void
+        layout_method();
+
     public:
         ClassBuilder(utf8 class_name);
 
@@ -82,18 +120,81 @@ namespace jasm {
         void
         leave_method();
 
-        void
+        Field &
         declare_field(const utf8 &field_name, const Type &type, u2 access_flags);
 
         void
         set_insertion_point(InsertionPoint insertion_point);
 
+        /**
+         * Creates a label in the current method. Jumps may refer to the label before it is bound.
+         *
+         * @return new label.
+         */
+        Label
+        create_label();
+
+        /**
+         * Binds a label to the end of the current method, the following instructions are emitted to a new basic
+         * block.
+         *
+         * @param label unbound label.
+         */
+        void
+        bind_label(Label label);
+
+        /**
+         * Sets the types of the local variables and of the operand stack at the start of the current basic block.
+         * The frames are written to the stack map table of the method, if several blocks start at the same position
+         * the frame of the last one is used.
+         *
+         * @param locals types of the local variables, long and double values take up a single entry.
+         * @param stack types of the operand stack entries from the bottom, the index of an uninitialised object is
+         *              the label of its new instruction.
+         */
+        void
+        set_frame(std::vector<StackMapTableAttribute::VerificationType> locals,
+                  std::vector<StackMapTableAttribute::VerificationType> stack);
+
+        /**
+         * Sets the types at the fall through of the conditional jump emitted last, the following instructions are
+         * emitted to a new basic block. The frame is written only if the jump is too long for a two byte offset,
+         * it is then inverted to skip a goto_w to its label and the skipped to instruction needs a frame.
+         *
+         * @param locals types of the local variables, long and double values take up a single entry.
+         * @param stack types of the operand stack entries without the operands of the jump.
+         */
+        void
+        set_fall_through_frame(std::vector<StackMapTableAttribute::VerificationType> locals,
+                               std::vector<StackMapTableAttribute::VerificationType> stack);
+
+        /**
+         * Adds an entry to the exception table of the current method. The entries are searched in the order in
+         * which they are added, so the inner handlers have to be added first.
+         *
+         * @param start label of the first protected instruction.
+         * @param end label following the last protected instruction.
+         * @param handler label of the handler, the operand stack holds just the exception at its start.
+         * @param catch_type index of the class constant of the caught exceptions, zero for any exception.
+         */
+        void
+        add_exception_handler(Label start, Label end, Label handler, u2 catch_type = 0);
+
         ClassBuilder &
         set_version(u2 major_version, u2 minor_version);
 
         ClassBuilder &
         set_access_flags(u2 access_flags);
 
+        /**
+         * Sets the direct superclass, java/lang/Object by default.
+         */
+        ClassBuilder &
+        set_super_class(const utf8 &class_name);
+
+        ClassBuilder &
+        add_interface(const utf8 &interface_name);
+
         u2
         add_utf8_constant(const utf8 &value);
 
@@ -106,18 +207,63 @@ namespace jasm {
         u2
         add_method_constant(const utf8 &class_name, const utf8 &method_name, const Type &type);
 
+        /**
+         * Adds a reference to a method of an interface, which is called by the invokeinterface instruction.
+         */
+        u2
+        add_interface_method_constant(const utf8 &interface_name, const utf8 &method_name, const Type &type);
+
         u2
         add_field_constant(const utf8 &class_name, const utf8 &field_name, const Type &type);
 
         u2
         add_string_constant(const utf8 &str);
 
+        u2
+        add_method_handle_constant(u1 reference_kind, u2 reference_index);
+
+        /**
+         * Adds a method to the bootstrap method table of the class, the table is created with the first method.
+         *
+         * @param method_handle index of the method handle constant of the bootstrap method.
+         * @param arguments indices of the constants passed to the bootstrap method.
+         * @return index of the bootstrap method in the table.
+         */
+        u2
+        add_bootstrap_method(u2 method_handle, std::vector<u2> arguments);
+
+        u2
+        add_invoke_dynamic_constant(u2 bootstrap_method, const utf8 &name, const Type &type);
+
+        u2
+        add_integer_constant(int32_t value);
+
+        u2
+        add_float_constant(float value);
+
+        u2
+        add_long_constant(int64_t value);
+
+        u2
+        add_double_constant(double value);
+
         inline Method *
         current_method()
         {
             return current_method_;
         }
 
+        /**
+         * Returns the code attribute of the current method.
+         *
+         * @return code attribute, nullptr if the method has no code.
+         */
+        inline CodeAttribute *
+        current_code()
+        {
+            return current_code_;
+        }
+
         template<typename T, typename... Args>
         inline void
         make_instruction(Args... args)
@@ -126,6 +272,19 @@ namespace jasm {
             current_insertion_point_->make_instruction<T>(args...);
         }
 
+        /**
+         * Emits a jump to a label, the offset is resolved when the method is left.
+         *
+         * @tparam T jump instruction, e.g. GoTo or IfEq.
+         * @param label target of the jump.
+         */
+        template<typename T>
+        inline void
+        make_jump(Label label)
+        {
+            make_instruction<JumpInstruction<T::Opcode>>(label);
+        }
+
         inline Class
         build()
         {
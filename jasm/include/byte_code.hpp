@@ -14,6 +14,7 @@
 #include <bit>
 #include <fstream>
 #include <iostream>
+#include <streambuf>
 
 #define U2_HIGH(X) ((jasm::u1)((X & 0xFF00u) >> 8u))
 #define U2_LOW(X) ((jasm::u1)(X & 0x00FFu))
@@ -98,6 +99,41 @@ namespace jasm::byte_code {
         os.write(reinterpret_cast<char *>(&val), sizeof(T));
     }
 
+    /**
+     * Read-only stream buffer over a block of memory, e.g. a memory mapped class file. The memory has to outlive
+     * the buffer.
+     */
+    class MemoryBuffer : public std::streambuf
+    {
+    public:
+        MemoryBuffer(const void *data, std::size_t size)
+        {
+            char *begin = const_cast<char *>(static_cast<const char *>(data));
+            setg(begin, begin, begin + size);
+        }
+
+    protected:
+        pos_type
+        seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+        {
+            if (!(which & std::ios_base::in))
+                return pos_type(off_type(-1));
+
+            char *base = dir == std::ios_base::beg ? eback() : dir == std::ios_base::cur ? gptr() : egptr();
+            if (base + off < eback() || base + off > egptr())
+                return pos_type(off_type(-1));
+
+            setg(eback(), base + off, egptr());
+            return pos_type(gptr() - eback());
+        }
+
+        pos_type
+        seekpos(pos_type pos, std::ios_base::openmode which) override
+        {
+            return seekoff(off_type(pos), std::ios_base::beg, which);
+        }
+    };
+
 }
 
 #endif // JAWA_BYTE_CODE_HPP
@@ -66,12 +66,24 @@ namespace jasm {
          *
          * @param is binary input stream.
          * @param code code attribute.
-         * @return instruction width.
+         * @param position position of the instruction in the code.
+         * @return instruction width, or 0 if the instruction is not implemented.
          */
         u4
-        read_instruction(std::istream &is, CodeAttribute *code);
+        read_instruction(std::istream &is, CodeAttribute *code, u4 position);
+
+        /**
+         * Visits the constant pool indices the class refers to outside of the constant pool.
+         *
+         * @param visitor function called with each index.
+         * @return false if any of the attributes is not known to jasm.
+         */
+        bool
+        visit_constants(const ConstantVisitor &visitor);
 
         friend class ClassBuilder;
+        friend class Optimizer;
+        friend class Disassembler;
 
     public:
         enum AccessFlag : u2
@@ -103,6 +115,15 @@ namespace jasm {
         void
         emit_bytecode(std::ostream &os) const;
 
+        /**
+         * Removes the constants the class does not refer to and renumbers the remaining ones. The class is left
+         * unchanged if it has an attribute which is not known to jasm, since its references cannot be updated.
+         *
+         * @return true if the constant pool has been compacted.
+         */
+        bool
+        remove_unused_constants();
+
         inline const ConstantPool &
         constant_pool() const
         {
@@ -159,12 +180,32 @@ namespace jasm {
             return dynamic_cast<ClassConstant *>(constant_pool_.get(this_class_));
         }
 
+        /**
+         * @return direct superclass, nullptr for java/lang/Object.
+         */
         inline ClassConstant *
         super_class()
         {
+            if (super_class_ == 0)
+                return nullptr;
             return dynamic_cast<ClassConstant *>(constant_pool_.get(super_class_));
         }
 
+        /**
+         * @return constant pool indices of the class constants of the direct superinterfaces.
+         */
+        inline const std::vector<u2> &
+        interfaces() const
+        {
+            return interfaces_;
+        }
+
+        inline u2
+        access_flags() const
+        {
+            return access_flags_;
+        }
+
         inline void
         set_version(u2 major_version, u2 minor_version)
         {
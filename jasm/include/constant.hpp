@@ -11,12 +11,19 @@
 #ifndef JAWA_CONSTANT_HPP
 #define JAWA_CONSTANT_HPP
 
+#include <functional>
+
 #include "byte_code.hpp"
 
 namespace jasm {
 
     using namespace byte_code;
 
+    /**
+     * Function called with the constant pool indices referred to by a class file item, it may rewrite the index.
+     */
+    using ConstantVisitor = std::function<void(u2 &index)>;
+
     class Constant
     {
     public:
@@ -42,6 +49,15 @@ namespace jasm {
 
         virtual u1
         tag() const = 0;
+
+        /**
+         * Visits the indices of the constants this constant refers to.
+         *
+         * @param visitor function called with each index.
+         */
+        virtual void
+        visit_references(const ConstantVisitor &visitor)
+        {}
     };
 
     class ClassConstant : public Constant
@@ -72,6 +88,12 @@ namespace jasm {
             return name_index_;
         }
 
+        void
+        visit_references(const ConstantVisitor &visitor) override
+        {
+            visitor(name_index_);
+        }
+
         u1
         tag() const override;
     };
@@ -102,6 +124,25 @@ namespace jasm {
             write_big_endian<u2>(os, name_and_type_index_);
         }
 
+        inline u2
+        class_index() const
+        {
+            return class_index_;
+        }
+
+        inline u2
+        name_and_type_index() const
+        {
+            return name_and_type_index_;
+        }
+
+        void
+        visit_references(const ConstantVisitor &visitor) override
+        {
+            visitor(class_index_);
+            visitor(name_and_type_index_);
+        }
+
         u1
         tag() const override;
     };
@@ -132,6 +173,25 @@ namespace jasm {
             write_big_endian<u2>(os, name_and_type_index_);
         }
 
+        inline u2
+        class_index() const
+        {
+            return class_index_;
+        }
+
+        inline u2
+        name_and_type_index() const
+        {
+            return name_and_type_index_;
+        }
+
+        void
+        visit_references(const ConstantVisitor &visitor) override
+        {
+            visitor(class_index_);
+            visitor(name_and_type_index_);
+        }
+
         u1
         tag() const override;
     };
@@ -162,6 +222,25 @@ namespace jasm {
             write_big_endian<u2>(os, name_and_type_index_);
         }
 
+        inline u2
+        class_index() const
+        {
+            return class_index_;
+        }
+
+        inline u2
+        name_and_type_index() const
+        {
+            return name_and_type_index_;
+        }
+
+        void
+        visit_references(const ConstantVisitor &visitor) override
+        {
+            visitor(class_index_);
+            visitor(name_and_type_index_);
+        }
+
         u1
         tag() const override;
     };
@@ -188,6 +267,18 @@ namespace jasm {
             write_big_endian<u2>(os, string_index_);
         }
 
+        inline u2
+        string_index() const
+        {
+            return string_index_;
+        }
+
+        void
+        visit_references(const ConstantVisitor &visitor) override
+        {
+            visitor(string_index_);
+        }
+
         u1
         tag() const override;
     };
@@ -214,6 +305,12 @@ namespace jasm {
             write_big_endian<u4>(os, bytes_);
         }
 
+        inline u4
+        bytes() const
+        {
+            return bytes_;
+        }
+
         u1
         tag() const override;
     };
@@ -240,6 +337,12 @@ namespace jasm {
             write_big_endian<u4>(os, bytes_);
         }
 
+        inline u4
+        bytes() const
+        {
+            return bytes_;
+        }
+
         u1
         tag() const override;
     };
@@ -269,6 +372,18 @@ namespace jasm {
             write_big_endian<u4>(os, low_bytes_);
         }
 
+        inline u4
+        high_bytes() const
+        {
+            return high_bytes_;
+        }
+
+        inline u4
+        low_bytes() const
+        {
+            return low_bytes_;
+        }
+
         u1
         tag() const override;
     };
@@ -298,6 +413,18 @@ namespace jasm {
             write_big_endian<u4>(os, low_bytes_);
         }
 
+        inline u4
+        high_bytes() const
+        {
+            return high_bytes_;
+        }
+
+        inline u4
+        low_bytes() const
+        {
+            return low_bytes_;
+        }
+
         u1
         tag() const override;
     };
@@ -328,6 +455,25 @@ namespace jasm {
             write_big_endian<u2>(os, descriptor_index_);
         }
 
+        inline u2
+        name_index() const
+        {
+            return name_index_;
+        }
+
+        inline u2
+        descriptor_index() const
+        {
+            return descriptor_index_;
+        }
+
+        void
+        visit_references(const ConstantVisitor &visitor) override
+        {
+            visitor(name_index_);
+            visitor(descriptor_index_);
+        }
+
         u1
         tag() const override;
     };
@@ -379,14 +525,39 @@ namespace jasm {
         u2 reference_index_;
 
     public:
+        enum ReferenceKind : u1
+        {
+            REF_GET_FIELD = 1,
+            REF_GET_STATIC = 2,
+            REF_PUT_FIELD = 3,
+            REF_PUT_STATIC = 4,
+            REF_INVOKE_VIRTUAL = 5,
+            REF_INVOKE_STATIC = 6,
+            REF_INVOKE_SPECIAL = 7,
+            REF_NEW_INVOKE_SPECIAL = 8,
+            REF_INVOKE_INTERFACE = 9
+        };
+
         MethodHandleConstant(u1 reference_kind, u2 reference_index)
           : reference_kind_(reference_kind)
           , reference_index_(reference_index){};
 
+        inline u1
+        reference_kind() const
+        {
+            return reference_kind_;
+        }
+
+        inline u2
+        reference_index() const
+        {
+            return reference_index_;
+        }
+
         void
         jasm(std::ostream &os) const override
         {
-            os << std::setw(20) << std::left << "MethodHandle" << '#' << reference_kind_ << ':' << '#'
+            os << std::setw(20) << std::left << "MethodHandle" << static_cast<int>(reference_kind_) << ':' << '#'
                << reference_index_ << std::endl;
         }
 
@@ -398,6 +569,12 @@ namespace jasm {
             write_big_endian<u2>(os, reference_index_);
         }
 
+        void
+        visit_references(const ConstantVisitor &visitor) override
+        {
+            visitor(reference_index_);
+        }
+
         u1
         tag() const override;
     };
@@ -424,6 +601,18 @@ namespace jasm {
             write_big_endian<u2>(os, descriptor_index_);
         }
 
+        inline u2
+        descriptor_index() const
+        {
+            return descriptor_index_;
+        }
+
+        void
+        visit_references(const ConstantVisitor &visitor) override
+        {
+            visitor(descriptor_index_);
+        }
+
         u1
         tag() const override;
     };
@@ -442,7 +631,7 @@ namespace jasm {
         void
         jasm(std::ostream &os) const override
         {
-            os << std::setw(20) << "InvokeDynamic" << '#' << bootstrap_method_attr_index_ << ':' << '#'
+            os << std::setw(20) << std::left << "InvokeDynamic" << '#' << bootstrap_method_attr_index_ << ':' << '#'
                << name_and_type_index_ << std::endl;
         }
 
@@ -454,6 +643,28 @@ namespace jasm {
             write_big_endian<u2>(os, name_and_type_index_);
         }
 
+        /**
+         * @return index of the bootstrap method in the BootstrapMethods attribute of the class.
+         */
+        inline u2
+        bootstrap_method_attr_index() const
+        {
+            return bootstrap_method_attr_index_;
+        }
+
+        inline u2
+        name_and_type_index() const
+        {
+            return name_and_type_index_;
+        }
+
+        void
+        visit_references(const ConstantVisitor &visitor) override
+        {
+            // the bootstrap method is an index to the BootstrapMethods attribute
+            visitor(name_and_type_index_);
+        }
+
         u1
         tag() const override;
     };
@@ -117,6 +117,23 @@ namespace jasm {
         {
             return pool_.size();
         }
+
+        /**
+         * Removes the constants which are not used, the remaining constants keep their order.
+         *
+         * @param used flags indexed by the constant pool indices, the flag at index 0 is ignored.
+         */
+        void
+        retain(const std::vector<bool> &used)
+        {
+            assert(used.size() == pool_.size() + 1);
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < pool_.size(); ++i) {
+                if (used[i + 1])
+                    pool_[kept++] = std::move(pool_[i]);
+            }
+            pool_.resize(kept);
+        }
     };
 
 }
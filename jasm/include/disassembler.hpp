@@ -0,0 +1,66 @@
+/**
+ * @file disassembler.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#ifndef JAWA_DISASSEMBLER_HPP
+#define JAWA_DISASSEMBLER_HPP
+
+#include <string>
+
+#include "class.hpp"
+
+namespace jasm {
+
+    /**
+     * Formats a class as jasm text. Unlike Class::jasm, the constants are resolved where they are used, so the text
+     * of a class does not depend on the order of its constant pool and the texts of two builds can be compared.
+     * The instructions are printed with their positions, absolute branch targets and decoded switch tables.
+     * The code is decoded from its bytecode, hence the methods with code kept raw by the class reader are printed
+     * as well. Attributes without a textual form are printed with their names and lengths.
+     */
+    class Disassembler
+    {
+    public:
+        struct Options
+        {
+            // prints the constant pool before the members of the class
+            bool constant_pool = false;
+        };
+
+    private:
+        Options options_;
+
+    public:
+        Disassembler() = default;
+
+        explicit Disassembler(Options options)
+          : options_(options)
+        {}
+
+        /**
+         * Appends the text of a class to a string. The disassembler may be used from several threads at once.
+         *
+         * @param clazz disassembled class.
+         * @param text string the text is appended to.
+         */
+        void
+        disassemble(const Class &clazz, std::string &text) const;
+
+        inline std::string
+        disassemble(const Class &clazz) const
+        {
+            std::string text;
+            disassemble(clazz, text);
+            return text;
+        }
+    };
+
+}
+
+#endif // JAWA_DISASSEMBLER_HPP
@@ -68,6 +68,15 @@ namespace jasm {
 
         void
         emit_bytecode(std::ostream &os) const;
+
+        /**
+         * Visits the constant pool indices the field refers to, including the ones in its attributes.
+         *
+         * @param visitor function called with each index.
+         * @return false if any of the attributes is not known to jasm.
+         */
+        bool
+        visit_constants(const ConstantVisitor &visitor);
     };
 
 }
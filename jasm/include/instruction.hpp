@@ -14,6 +14,8 @@
 #include <array>
 #include <initializer_list>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 #include "byte_code.hpp"
 #include "constant_pool.hpp"
@@ -201,8 +203,8 @@ namespace jasm {
         { 2, 0, 0 }, // 0xa7 goto
         { 2, 0, 1 }, // 0xa8 jsr
         { 1, 0, 0 }, // 0xa9 ret
-        { 0, 0, 0 }, // 0xaa tableswitch
-        { 0, 0, 0 }, // axab lookupswitch
+        { 0, 1, 0 }, // 0xaa tableswitch
+        { 0, 1, 0 }, // 0xab lookupswitch
         { 0, 1, 0 }, // 0xac ireturn
         { 0, 1, 0 }, // 0xad lreturn
         { 0, 1, 0 }, // 0xae freturn
@@ -236,6 +238,25 @@ namespace jasm {
         { 0, 0, 0 }, // 0xca breakpoint
     };
 
+    /**
+     * Checks whether the operand of an instruction is an index to the constant pool.
+     */
+    constexpr bool
+    refers_to_constant(u1 opcode)
+    {
+        return (opcode >= 0x12 && opcode <= 0x14) || (opcode >= 0xb2 && opcode <= 0xbb) || opcode == 0xbd ||
+               opcode == 0xc0 || opcode == 0xc1 || opcode == 0xc5;
+    }
+
+    /**
+     * Checks whether the execution may continue with the following instruction.
+     */
+    constexpr bool
+    falls_through(u1 opcode)
+    {
+        return !((opcode >= 0xa7 && opcode <= 0xb1) && opcode != 0xa8) && opcode != 0xbf && opcode != 0xc8;
+    }
+
     class Instruction
     {
     public:
@@ -276,6 +297,15 @@ namespace jasm {
 
         virtual void
         emit_bytecode(std::ostream &os) const = 0;
+
+        /**
+         * Visits the constant pool index in the operands of the instruction, if there is one.
+         *
+         * @param visitor function called with the index.
+         */
+        virtual void
+        visit_constants(const ConstantVisitor &visitor)
+        {}
     };
 
     template<u1 opcode_>
@@ -284,6 +314,8 @@ namespace jasm {
         std::array<u1, InstructionInfo[opcode_][0]> operands_;
 
     public:
+        static constexpr u1 Opcode = opcode_;
+
         template<typename... Args>
         explicit SimpleInstruction(Args... args)
           : operands_{ args... }
@@ -357,6 +389,23 @@ namespace jasm {
             for (auto operand : operands_)
                 write_big_endian<u1>(os, operand);
         }
+
+        void
+        visit_constants(const ConstantVisitor &visitor) override
+        {
+            if constexpr (opcode_ == 0x12) {
+                // ldc has a single byte index
+                u2 index = operands_[0];
+                visitor(index);
+                assert(index <= 0xFF);
+                operands_[0] = U2_LOW(index);
+            } else if constexpr (refers_to_constant(opcode_)) {
+                u2 index = (operands_[0] << 8u) | operands_[1];
+                visitor(index);
+                operands_[0] = U2_HIGH(index);
+                operands_[1] = U2_LOW(index);
+            }
+        }
     };
 
     using RefArrayLoad = SimpleInstruction<0x32>;
@@ -559,11 +608,322 @@ namespace jasm {
     using ShortPush = SimpleInstruction<0x11>;
     using Swap = SimpleInstruction<0x5f>;
 
-    // TODO: following instructions cannot be implemented using the same simple
-    //       instruction format as the instructions above:
-    //         - lookup switch instruction
-    //         - table switch instruction
-    //         - wide instruction
+    /**
+     * Position in the code of a method, which can be referred to before it is known.
+     *
+     * @see ClassBuilder::create_label
+     */
+    using Label = u4;
+
+    /**
+     * Instruction jumping to labels. The jump offsets are relative to the position of the instruction, so they are
+     * resolved once the layout of the whole method is known.
+     */
+    class BranchInstruction : public Instruction
+    {
+    protected:
+        u4 position_ = 0;
+
+    public:
+        inline void
+        set_position(u4 position)
+        {
+            position_ = position;
+        }
+
+        /**
+         * Resolves the jump offsets.
+         *
+         * @param label_positions positions of the labels in the code.
+         */
+        virtual void
+        resolve(const std::vector<u4> &label_positions) = 0;
+
+        /**
+         * Switches to a longer form of the instruction if its offsets cannot reach the labels.
+         *
+         * @param label_positions positions of the labels in the code.
+         * @return true if the size of the instruction has changed.
+         */
+        virtual bool
+        widen(const std::vector<u4> &label_positions)
+        {
+            return false;
+        }
+
+        /**
+         * @return labels of the targets of the branch.
+         */
+        virtual std::vector<Label>
+        labels() const = 0;
+    };
+
+    /**
+     * Conditional or unconditional jump with a two byte offset. A jump to a label out of the range of the offset is
+     * widened, goto and jsr become goto_w and jsr_w, a conditional jump is inverted to skip a goto_w to the label.
+     */
+    template<u1 opcode_>
+    class JumpInstruction : public BranchInstruction
+    {
+        static constexpr bool Unconditional = opcode_ == 0xa7 || opcode_ == 0xa8;
+        // goto_w and jsr_w follow goto and jsr at the same distance
+        static constexpr u1 WideOpcode = opcode_ + 0x21;
+        // the conditions come in negated pairs, ifeq and ifne, iflt and ifge, ..., ifnull and ifnonnull
+        static constexpr u1 InvertedOpcode = opcode_ >= 0xc6 ? opcode_ ^ 1u : ((opcode_ + 1u) ^ 1u) - 1u;
+
+        Label label_;
+        // relative to the position of the instruction, also if the offset belongs to the goto_w of a wide jump
+        int32_t jump_offset_;
+        bool wide_;
+
+    public:
+        explicit JumpInstruction(Label label)
+          : label_(label)
+          , jump_offset_(0)
+          , wide_(false)
+        {
+            static_assert(InstructionInfo[opcode_][0] == 2);
+        }
+
+        inline u1
+        opcode() const override
+        {
+            return wide_ && Unconditional ? WideOpcode : opcode_;
+        }
+
+        inline const char *
+        mnemonic() const override
+        {
+            return InstructionMnemonics[opcode()];
+        }
+
+        inline u2
+        operand_count() const override
+        {
+            return size() - 1;
+        }
+
+        inline u2
+        input_stack_operand_count() const override
+        {
+            return InstructionInfo[opcode_][1];
+        }
+
+        inline u2
+        output_stack_operand_count() const override
+        {
+            return InstructionInfo[opcode_][2];
+        }
+
+        inline u4
+        size() const override
+        {
+            if (!wide_)
+                return 3;
+            return Unconditional ? 5 : 8;
+        }
+
+        bool
+        widen(const std::vector<u4> &label_positions) override
+        {
+            int64_t offset = static_cast<int64_t>(label_positions[label_]) - position_;
+            if (wide_ || (offset >= INT16_MIN && offset <= INT16_MAX))
+                return false;
+            wide_ = true;
+            return true;
+        }
+
+        void
+        resolve(const std::vector<u4> &label_positions) override
+        {
+            int64_t offset = static_cast<int64_t>(label_positions[label_]) - position_;
+            assert(wide_ || (offset >= INT16_MIN && offset <= INT16_MAX));
+            jump_offset_ = static_cast<int32_t>(offset);
+        }
+
+        inline std::vector<Label>
+        labels() const override
+        {
+            return { label_ };
+        }
+
+        void
+        jasm(std::ostream &os, const ConstantPool *pool) const override
+        {
+            if (wide_ && !Unconditional) {
+                os << std::setw(19) << InstructionMnemonics[InvertedOpcode] << " @" << position_ + size() << std::endl;
+                os << std::setw(19) << InstructionMnemonics[0xc8] << " @" << position_ + jump_offset_ << std::endl;
+                return;
+            }
+            os << std::setw(19) << mnemonic() << " @" << position_ + jump_offset_ << std::endl;
+        }
+
+        void
+        emit_bytecode(std::ostream &os) const override
+        {
+            if (!wide_) {
+                write_big_endian<u1>(os, opcode_);
+                write_big_endian<u2>(os, static_cast<u2>(jump_offset_));
+                return;
+            }
+            if (!Unconditional) {
+                write_big_endian<u1>(os, InvertedOpcode);
+                write_big_endian<u2>(os, static_cast<u2>(size()));
+                write_big_endian<u1>(os, 0xc8);
+                // the goto_w follows the inverted jump
+                write_big_endian<u4>(os, static_cast<u4>(jump_offset_ - 3));
+                return;
+            }
+            write_big_endian<u1>(os, WideOpcode);
+            write_big_endian<u4>(os, static_cast<u4>(jump_offset_));
+        }
+    };
+
+    /**
+     * Common part of tableswitch and lookupswitch. The operands are aligned to four bytes from the start of the code,
+     * hence the size of the instruction depends on its position.
+     */
+    class SwitchInstruction : public BranchInstruction
+    {
+    protected:
+        Label default_label_;
+        int32_t default_offset_;
+
+        explicit SwitchInstruction(Label default_label)
+          : default_label_(default_label)
+          , default_offset_(0)
+        {}
+
+        inline u4
+        padding() const
+        {
+            return 3 - position_ % 4;
+        }
+
+        int32_t
+        offset_of(Label label, const std::vector<u4> &label_positions) const;
+
+    public:
+        inline u2
+        operand_count() const override
+        {
+            return size() - 1;
+        }
+
+        inline u2
+        input_stack_operand_count() const override
+        {
+            return 1;
+        }
+
+        inline u2
+        output_stack_operand_count() const override
+        {
+            return 0;
+        }
+    };
+
+    /**
+     * Jump through a table indexed by the key, used for dense ranges of keys.
+     */
+    class TableSwitch : public SwitchInstruction
+    {
+        int32_t low_;
+        std::vector<Label> labels_;
+        std::vector<int32_t> offsets_;
+
+    public:
+        /**
+         * @param low key of the first label.
+         * @param default_label target of the keys outside of the table.
+         * @param labels targets of the keys low, low + 1, ...
+         */
+        TableSwitch(int32_t low, Label default_label, std::vector<Label> labels);
+
+        TableSwitch(std::istream *is, u4 position);
+
+        inline u1
+        opcode() const override
+        {
+            return 0xaa;
+        }
+
+        inline const char *
+        mnemonic() const override
+        {
+            return InstructionMnemonics[0xaa];
+        }
+
+        inline u4
+        size() const override
+        {
+            return 1 + padding() + 12 + 4 * offsets_.size();
+        }
+
+        void
+        resolve(const std::vector<u4> &label_positions) override;
+
+        std::vector<Label>
+        labels() const override;
+
+        void
+        jasm(std::ostream &os, const ConstantPool *pool) const override;
+
+        void
+        emit_bytecode(std::ostream &os) const override;
+    };
+
+    /**
+     * Jump through a sorted table of key and offset pairs, used for sparse keys.
+     */
+    class LookupSwitch : public SwitchInstruction
+    {
+        std::vector<int32_t> keys_;
+        std::vector<Label> labels_;
+        std::vector<int32_t> offsets_;
+
+    public:
+        /**
+         * @param default_label target of the keys not in the table.
+         * @param cases distinct keys and their targets in any order.
+         */
+        LookupSwitch(Label default_label, std::vector<std::pair<int32_t, Label>> cases);
+
+        LookupSwitch(std::istream *is, u4 position);
+
+        inline u1
+        opcode() const override
+        {
+            return 0xab;
+        }
+
+        inline const char *
+        mnemonic() const override
+        {
+            return InstructionMnemonics[0xab];
+        }
+
+        inline u4
+        size() const override
+        {
+            return 1 + padding() + 8 + 8 * offsets_.size();
+        }
+
+        void
+        resolve(const std::vector<u4> &label_positions) override;
+
+        std::vector<Label>
+        labels() const override;
+
+        void
+        jasm(std::ostream &os, const ConstantPool *pool) const override;
+
+        void
+        emit_bytecode(std::ostream &os) const override;
+    };
+
+    // TODO: the wide instruction cannot be implemented using the same simple
+    //       instruction format as the instructions above
 
     JASM_SPECIALISATION(InvokeVirtual)
 
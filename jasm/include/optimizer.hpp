@@ -0,0 +1,102 @@
+/**
+ * @file optimizer.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#ifndef JAWA_OPTIMIZER_HPP
+#define JAWA_OPTIMIZER_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "class.hpp"
+
+namespace jasm {
+
+    class ClassConstants;
+
+    /**
+     * Optimises the classes read from class files. The code of each method is decoded, the unreachable instructions
+     * are removed, the peephole rules are applied and the code is laid out again together with its exception table,
+     * stack map frames, line numbers and local variable tables. The limits of the operand stack and of the local
+     * variables are recomputed and the constants the class no longer refers to are removed.
+     * A method whose code or attributes are not understood by jasm is left unchanged, and so is the constant pool of
+     * a class with such an attribute.
+     */
+    class Optimizer
+    {
+    public:
+        struct Options
+        {
+            bool remove_dead_code = true;
+            bool peephole = true;
+            bool compact_constants = true;
+            bool recompute_limits = true;
+        };
+
+        struct Statistics
+        {
+            // methods whose code has been rewritten
+            std::size_t methods = 0;
+            // methods with code which could not be decoded
+            std::size_t skipped_methods = 0;
+            std::size_t removed_instructions = 0;
+            std::size_t removed_constants = 0;
+
+            Statistics &
+            operator+=(const Statistics &other);
+        };
+
+    private:
+        Options options_;
+
+        /**
+         * Optimises the code of every method of a class.
+         *
+         * @return flags of the methods whose code has been rewritten.
+         */
+        std::vector<bool>
+        optimize_methods(Class &clazz, Statistics &statistics) const;
+
+        /**
+         * Optimises the code of a method, the code is rewritten only if it changes.
+         *
+         * @return true if the code has been rewritten.
+         */
+        bool
+        optimize_method(Class &clazz, Method &method, ClassConstants &constants, Statistics &statistics) const;
+
+    public:
+        Optimizer() = default;
+
+        explicit Optimizer(Options options)
+          : options_(options)
+        {}
+
+        /**
+         * Optimises a class in place.
+         *
+         * @param clazz class read from a class file.
+         * @return statistics of the changes.
+         */
+        Statistics
+        optimize(Class &clazz) const;
+
+        /**
+         * Records the positions of the constant pool indices in the attributes read as raw attributes whose layout
+         * is known, so that the indices can be visited and renumbered when the constant pool is compacted.
+         *
+         * @param clazz class read from a class file.
+         */
+        static void
+        index_attributes(Class &clazz);
+    };
+
+}
+
+#endif // JAWA_OPTIMIZER_HPP
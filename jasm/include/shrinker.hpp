@@ -0,0 +1,121 @@
+/**
+ * @file shrinker.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#ifndef JAWA_SHRINKER_HPP
+#define JAWA_SHRINKER_HPP
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "class.hpp"
+
+namespace jasm {
+
+    /**
+     * Removes the classes, methods and fields of a program which cannot be reached from its entry points.
+     *
+     * The reachable members are found by following the constants referred to by the code of the reachable methods:
+     * class constants keep the classes, field references the resolved fields and method references the resolved
+     * methods. The classes named in the descriptors are kept as well. A reachable class keeps its superclasses,
+     * superinterfaces and static initializer. Since the receiver of a virtual call is not known, every method with
+     * the name and the descriptor of a reachable method reference is kept in every reachable class.
+     * The classes which are not part of the program, such as the classes of the Java class library, may call any
+     * method overriding their own, therefore a class with a supertype outside of the program keeps all of its methods
+     * and fields, and every class keeps the methods overriding java/lang/Object.
+     * Classes used only through reflection or from native code have to be kept explicitly.
+     * A class which jasm cannot read is kept unchanged as an opaque class. Its code cannot be followed, hence every
+     * class it refers to is kept with all of its members.
+     */
+    class Shrinker
+    {
+    public:
+        struct Statistics
+        {
+            std::size_t classes = 0;
+            std::size_t removed_classes = 0;
+            std::size_t removed_methods = 0;
+            std::size_t removed_fields = 0;
+            std::size_t opaque_classes = 0;
+        };
+
+    private:
+        std::map<std::string, Class> classes_;
+        // names of the opaque classes and of the classes they refer to
+        std::map<std::string, std::vector<std::string>> opaque_classes_;
+        std::vector<std::string> kept_classes_;
+        // class name, method name and descriptor
+        std::vector<std::array<std::string, 3>> kept_methods_;
+
+    public:
+        Shrinker() = default;
+
+        /**
+         * Adds a class of the program, a class with the same name as a previously added class is ignored.
+         *
+         * @param clazz class read from a class file.
+         * @return true if the class has been added.
+         */
+        bool
+        add_class(Class &&clazz);
+
+        /**
+         * Adds a class which cannot be read by jasm, a class with the same name as a previously added class is
+         * ignored. The class is always kept.
+         *
+         * @param name name of the class in the internal form.
+         * @param references names of the classes the constant pool of the class refers to.
+         * @return true if the class has been added.
+         */
+        bool
+        add_opaque_class(const std::string &name, std::vector<std::string> references);
+
+        /**
+         * Keeps a class with all of its members, an opaque class is kept anyway.
+         *
+         * @return false if the class is not part of the program.
+         */
+        bool
+        keep_class(const std::string &name);
+
+        /**
+         * Keeps a method, typically the main method of the program. The methods of an opaque class are not known,
+         * the class is kept as a whole.
+         *
+         * @param class_name name of the class in the internal form.
+         * @param name name of the method.
+         * @param descriptor descriptor of the method.
+         * @return false if the method is not part of the program and the class is not opaque.
+         */
+        bool
+        keep_method(const std::string &class_name, const std::string &name, const std::string &descriptor);
+
+        /**
+         * Removes the unreachable classes and members. The constant pools of the kept classes still contain
+         * the constants of the removed members, see Optimizer for their removal.
+         */
+        Statistics
+        shrink();
+
+        /**
+         * @return classes of the program ordered by their names, without the opaque classes.
+         */
+        inline std::map<std::string, Class> &
+        classes()
+        {
+            return classes_;
+        }
+    };
+
+}
+
+#endif // JAWA_SHRINKER_HPP
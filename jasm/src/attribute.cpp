@@ -8,9 +8,82 @@
  * Copyright (c) 2021 Peter Grajcar
  */
 #include "attribute.hpp"
+#include <algorithm>
 
 namespace jasm {
 
+    bool
+    Attributable::visit_attribute_constants(const ConstantVisitor &visitor)
+    {
+        bool known = true;
+        for (auto &attribute : attributes_)
+            known &= attribute->visit_constants(visitor);
+        return known;
+    }
+
+    void
+    RawAttribute::jasm(std::ostream &os, const ConstantPool *pool) const
+    {
+        if (pool) {
+            auto name_const = dynamic_cast<const Utf8Constant *>(pool->get(attribute_name_index_));
+            os << name_const->value();
+        } else {
+            os << "Attribute #" << attribute_name_index_;
+        }
+        os << ": " << bytes_.size() << " bytes" << std::endl;
+    }
+
+    void
+    RawAttribute::emit_bytecode(std::ostream &os) const
+    {
+        write_big_endian<u2>(os, attribute_name_index_);
+        write_big_endian<u4>(os, bytes_.size());
+        os.write(reinterpret_cast<const char *>(bytes_.data()), bytes_.size());
+    }
+
+    bool
+    RawAttribute::visit_constants(const ConstantVisitor &visitor)
+    {
+        visitor(attribute_name_index_);
+        // the bytes may contain indices, they are not known without parsing the attribute
+        if (!constant_positions_)
+            return false;
+        for (u4 position : *constant_positions_) {
+            u2 index = (bytes_[position] << 8u) | bytes_[position + 1];
+            visitor(index);
+            bytes_[position] = U2_HIGH(index);
+            bytes_[position + 1] = U2_LOW(index);
+        }
+        return true;
+    }
+
+    void
+    ConstantValueAttribute::jasm(std::ostream &os, const ConstantPool *pool) const
+    {
+        if (pool) {
+            os << "ConstantValue: ";
+            pool->get(constant_value_index_)->jasm(os);
+        } else {
+            os << "ConstantValue: #" << constant_value_index_ << std::endl;
+        }
+    }
+
+    void
+    ConstantValueAttribute::emit_bytecode(std::ostream &os) const
+    {
+        write_big_endian<u2>(os, attribute_name_index_);
+        write_big_endian<u4>(os, 2);
+        write_big_endian<u2>(os, constant_value_index_);
+    }
+
+    bool
+    ConstantValueAttribute::visit_constants(const ConstantVisitor &visitor)
+    {
+        visitor(attribute_name_index_);
+        visitor(constant_value_index_);
+        return true;
+    }
+
     void
     SourceFileAttribute::jasm(std::ostream &os, const ConstantPool *pool) const
     {
@@ -30,6 +103,14 @@ namespace jasm {
         write_big_endian<u2>(os, source_file_index_);
     }
 
+    bool
+    SourceFileAttribute::visit_constants(const ConstantVisitor &visitor)
+    {
+        visitor(attribute_name_index_);
+        visitor(source_file_index_);
+        return true;
+    }
+
     void
     CodeAttribute::jasm(std::ostream &os, const ConstantPool *pool) const
     {
@@ -67,8 +148,9 @@ namespace jasm {
     CodeAttribute::attributes_length() const
     {
         u4 attributes_length = 0;
+        // every attribute has a 6 byte header (name index and length)
         for (auto &attr : attributes_)
-            attributes_length += attr->length();
+            attributes_length += 6 + attr->length();
         return attributes_length;
     }
 
@@ -96,4 +178,247 @@ namespace jasm {
         for (auto &attr : attributes_)
             attr->emit_bytecode(os);
     }
+
+    bool
+    CodeAttribute::visit_constants(const ConstantVisitor &visitor)
+    {
+        visitor(attribute_name_index_);
+        for (auto &inst : code_)
+            inst->visit_constants(visitor);
+        for (auto &entry : exception_table_) {
+            // zero catch type stands for any exception
+            if (entry.catch_type != 0)
+                visitor(entry.catch_type);
+        }
+        return visit_attribute_constants(visitor);
+    }
+
+    /**
+     * Returns the type of the frame of the most compact form: frames equal to the previous one apart from the position,
+     * frames with a single stack entry and frames differing in up to three last locals are written without
+     * repeating the locals.
+     */
+    u1
+    StackMapTableAttribute::frame_type(std::size_t i) const
+    {
+        constexpr u1 SameLocals1StackItemExtended = 247;
+        constexpr u1 SameExtended = 251;
+        constexpr u1 Full = 255;
+
+        // the first frame is compared with the frame given by the method descriptor, which is not known here
+        if (i == 0)
+            return Full;
+
+        const Frame &frame = frames_[i];
+        const Frame &previous = frames_[i - 1];
+        u4 delta = frame.position - previous.position - 1;
+
+        if (frame.locals == previous.locals) {
+            if (frame.stack.empty())
+                return delta < 64 ? delta : SameExtended;
+            if (frame.stack.size() == 1)
+                return delta < 64 ? 64 + delta : SameLocals1StackItemExtended;
+            return Full;
+        }
+        if (!frame.stack.empty())
+            return Full;
+
+        std::size_t common = std::min(frame.locals.size(), previous.locals.size());
+        if (!std::equal(frame.locals.begin(), frame.locals.begin() + common, previous.locals.begin()))
+            return Full;
+        if (frame.locals.size() < previous.locals.size() && previous.locals.size() - common <= 3)
+            return SameExtended - (previous.locals.size() - common); // chop frame
+        if (frame.locals.size() > previous.locals.size() && frame.locals.size() - common <= 3)
+            return SameExtended + (frame.locals.size() - common); // append frame
+        return Full;
+    }
+
+    static void
+    emit_verification_types(std::ostream &os,
+                            std::vector<StackMapTableAttribute::VerificationType>::const_iterator begin,
+                            std::vector<StackMapTableAttribute::VerificationType>::const_iterator end)
+    {
+        for (auto it = begin; it != end; ++it) {
+            write_big_endian<u1>(os, it->tag);
+            if (it->length() == 3)
+                write_big_endian<u2>(os, it->index);
+        }
+    }
+
+    static u4
+    verification_types_length(const std::vector<StackMapTableAttribute::VerificationType> &types, std::size_t from = 0)
+    {
+        u4 length = 0;
+        for (std::size_t i = from; i < types.size(); ++i)
+            length += types[i].length();
+        return length;
+    }
+
+    u4
+    StackMapTableAttribute::length() const
+    {
+        u4 length = 2;
+        for (std::size_t i = 0; i < frames_.size(); ++i) {
+            const Frame &frame = frames_[i];
+            u1 type = frame_type(i);
+            if (type < 64)
+                length += 1;
+            else if (type < 128)
+                length += 1 + verification_types_length(frame.stack);
+            else if (type == 247)
+                length += 3 + verification_types_length(frame.stack);
+            else if (type <= 251)
+                length += 3;
+            else if (type < 255)
+                length += 3 + verification_types_length(frame.locals, frames_[i - 1].locals.size());
+            else
+                length += 7 + verification_types_length(frame.locals) + verification_types_length(frame.stack);
+        }
+        return length;
+    }
+
+    void
+    StackMapTableAttribute::emit_bytecode(std::ostream &os) const
+    {
+        write_big_endian<u2>(os, attribute_name_index_);
+        write_big_endian<u4>(os, length());
+        write_big_endian<u2>(os, frames_.size());
+
+        for (std::size_t i = 0; i < frames_.size(); ++i) {
+            const Frame &frame = frames_[i];
+            u2 delta = i == 0 ? frame.position : frame.position - frames_[i - 1].position - 1;
+            u1 type = frame_type(i);
+            write_big_endian<u1>(os, type);
+            if (type < 64)
+                continue;
+            if (type < 128) {
+                emit_verification_types(os, frame.stack.begin(), frame.stack.end());
+                continue;
+            }
+
+            write_big_endian<u2>(os, delta);
+            if (type == 247) {
+                emit_verification_types(os, frame.stack.begin(), frame.stack.end());
+            } else if (type > 251 && type < 255) {
+                emit_verification_types(os, frame.locals.begin() + frames_[i - 1].locals.size(), frame.locals.end());
+            } else if (type == 255) {
+                write_big_endian<u2>(os, frame.locals.size());
+                emit_verification_types(os, frame.locals.begin(), frame.locals.end());
+                write_big_endian<u2>(os, frame.stack.size());
+                emit_verification_types(os, frame.stack.begin(), frame.stack.end());
+            }
+        }
+    }
+
+    static void
+    jasm_verification_types(std::ostream &os, const std::vector<StackMapTableAttribute::VerificationType> &types,
+                            const ConstantPool *pool)
+    {
+        static constexpr const char *names[] = {
+            "top", "int", "float", "double", "long", "null", "uninitializedThis", "object", "uninitialized",
+        };
+        os << '[';
+        for (std::size_t i = 0; i < types.size(); ++i) {
+            if (i > 0)
+                os << ", ";
+            const auto &type = types[i];
+            if (type.tag == StackMapTableAttribute::VerificationType::ITEM_OBJECT && pool) {
+                auto class_const = dynamic_cast<const ClassConstant *>(pool->get(type.index));
+                auto name_const = dynamic_cast<const Utf8Constant *>(pool->get(class_const->name_index()));
+                os << name_const->value();
+            } else {
+                os << names[type.tag];
+                if (type.length() == 3)
+                    os << " #" << type.index;
+            }
+        }
+        os << ']';
+    }
+
+    void
+    StackMapTableAttribute::jasm(std::ostream &os, const ConstantPool *pool) const
+    {
+        os << "StackMapTable: " << frames_.size() << " frames" << std::endl;
+        for (auto &frame : frames_) {
+            os << "  @" << frame.position << " locals ";
+            jasm_verification_types(os, frame.locals, pool);
+            os << " stack ";
+            jasm_verification_types(os, frame.stack, pool);
+            os << std::endl;
+        }
+    }
+
+    bool
+    StackMapTableAttribute::visit_constants(const ConstantVisitor &visitor)
+    {
+        visitor(attribute_name_index_);
+        for (auto &frame : frames_) {
+            for (auto *types : { &frame.locals, &frame.stack }) {
+                for (auto &type : *types) {
+                    if (type.tag == VerificationType::ITEM_OBJECT)
+                        visitor(type.index);
+                }
+            }
+        }
+        return true;
+    }
+
+
+    u2
+    BootstrapMethodsAttribute::add_bootstrap_method(BootstrapMethod bootstrap_method)
+    {
+        auto search = std::find(bootstrap_methods_.begin(), bootstrap_methods_.end(), bootstrap_method);
+        if (search != bootstrap_methods_.end())
+            return search - bootstrap_methods_.begin();
+        bootstrap_methods_.push_back(std::move(bootstrap_method));
+        return bootstrap_methods_.size() - 1;
+    }
+
+    void
+    BootstrapMethodsAttribute::jasm(std::ostream &os, const ConstantPool *pool) const
+    {
+        os << "BootstrapMethods: " << bootstrap_methods_.size() << " methods" << std::endl;
+        for (std::size_t i = 0; i < bootstrap_methods_.size(); ++i) {
+            os << "  " << i << ": #" << bootstrap_methods_[i].method_ref;
+            for (u2 argument : bootstrap_methods_[i].arguments)
+                os << " #" << argument;
+            os << std::endl;
+        }
+    }
+
+    void
+    BootstrapMethodsAttribute::emit_bytecode(std::ostream &os) const
+    {
+        write_big_endian<u2>(os, attribute_name_index_);
+        write_big_endian<u4>(os, length());
+        write_big_endian<u2>(os, bootstrap_methods_.size());
+        for (auto &bootstrap_method : bootstrap_methods_) {
+            write_big_endian<u2>(os, bootstrap_method.method_ref);
+            write_big_endian<u2>(os, bootstrap_method.arguments.size());
+            for (u2 argument : bootstrap_method.arguments)
+                write_big_endian<u2>(os, argument);
+        }
+    }
+
+    u4
+    BootstrapMethodsAttribute::length() const
+    {
+        u4 length = 2;
+        for (auto &bootstrap_method : bootstrap_methods_)
+            length += 4 + 2 * bootstrap_method.arguments.size();
+        return length;
+    }
+
+    bool
+    BootstrapMethodsAttribute::visit_constants(const ConstantVisitor &visitor)
+    {
+        visitor(attribute_name_index_);
+        for (auto &bootstrap_method : bootstrap_methods_) {
+            visitor(bootstrap_method.method_ref);
+            for (u2 &argument : bootstrap_method.arguments)
+                visitor(argument);
+        }
+        return true;
+    }
+
 }
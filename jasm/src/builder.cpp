@@ -8,7 +8,10 @@
  * Copyright (c) 2021 Peter Grajcar
  */
 
+#include <algorithm>
 #include <builder.hpp>
+#include <cstring>
+#include <set>
 #include <utility>
 
 namespace jasm {
@@ -26,6 +29,7 @@ namespace jasm {
       : current_insertion_point_()
       , current_code_()
       , current_method_()
+      , bootstrap_methods_()
       , class_name_(std::move(class_name))
     {
         init();
@@ -35,6 +39,7 @@ namespace jasm {
       : current_insertion_point_()
       , current_code_()
       , current_method_()
+      , bootstrap_methods_()
       , class_name_(class_name)
     {
         init();
@@ -76,12 +81,68 @@ namespace jasm {
         return *this;
     }
 
+    ClassBuilder &
+    ClassBuilder::set_super_class(const utf8 &class_name)
+    {
+        class_.super_class_ = add_class_constant(class_name);
+        return *this;
+    }
+
+    ClassBuilder &
+    ClassBuilder::add_interface(const utf8 &interface_name)
+    {
+        class_.interfaces_.push_back(add_class_constant(interface_name));
+        return *this;
+    }
+
     void
     ClassBuilder::set_insertion_point(ClassBuilder::InsertionPoint insertion_point)
     {
         current_insertion_point_ = insertion_point;
     }
 
+    Label
+    ClassBuilder::create_label()
+    {
+        labels_.push_back(nullptr);
+        return labels_.size() - 1;
+    }
+
+    void
+    ClassBuilder::bind_label(Label label)
+    {
+        assert(labels_[label] == nullptr);
+        // an empty block at the end can be labelled directly
+        if (current_insertion_point_ != &basic_blocks_.back() || !current_insertion_point_->code_.empty())
+            current_insertion_point_ = create_basic_block();
+        labels_[label] = current_insertion_point_;
+    }
+
+    void
+    ClassBuilder::set_frame(std::vector<StackMapTableAttribute::VerificationType> locals,
+                            std::vector<StackMapTableAttribute::VerificationType> stack)
+    {
+        assert(current_insertion_point_);
+        current_insertion_point_->frame_ = StackMapTableAttribute::Frame{ 0, std::move(locals), std::move(stack) };
+        current_insertion_point_->frame_on_demand_ = false;
+    }
+
+    void
+    ClassBuilder::set_fall_through_frame(std::vector<StackMapTableAttribute::VerificationType> locals,
+                                         std::vector<StackMapTableAttribute::VerificationType> stack)
+    {
+        assert(current_insertion_point_ && !current_insertion_point_->code_.empty());
+        current_insertion_point_ = create_basic_block();
+        set_frame(std::move(locals), std::move(stack));
+        current_insertion_point_->frame_on_demand_ = true;
+    }
+
+    void
+    ClassBuilder::add_exception_handler(Label start, Label end, Label handler, u2 catch_type)
+    {
+        exception_handlers_.push_back(ExceptionHandler{ start, end, handler, catch_type });
+    }
+
     u2
     ClassBuilder::add_utf8_constant(const utf8 &value)
     {
@@ -100,32 +161,65 @@ namespace jasm {
         if (search != class_constants_.end())
             return search->second;
         u2 name_index = add_utf8_constant(class_name);
-        return class_.constant_pool_.make_constant<ClassConstant>(name_index);
+        u2 index = class_.constant_pool_.make_constant<ClassConstant>(name_index);
+        class_constants_.insert({ class_name, index });
+        return index;
     }
 
     u2
     ClassBuilder::add_name_and_type_constant(const utf8 &name, const Type &type)
     {
-        u2 name_index = add_utf8_constant(name);
         utf8 type_descriptor = type.descriptor();
+        auto search = name_and_type_constants_.find({ name, type_descriptor });
+        if (search != name_and_type_constants_.end())
+            return search->second;
+        u2 name_index = add_utf8_constant(name);
         u2 type_index = add_utf8_constant(type_descriptor);
-        return class_.constant_pool_.make_constant<NameAndTypeConstant>(name_index, type_index);
+        u2 index = class_.constant_pool_.make_constant<NameAndTypeConstant>(name_index, type_index);
+        name_and_type_constants_.insert({ { name, type_descriptor }, index });
+        return index;
     }
 
     u2
     ClassBuilder::add_method_constant(const utf8 &class_name, const utf8 &method_name, const Type &type)
     {
+        auto key = std::make_tuple(class_name, method_name, type.descriptor());
+        auto search = method_constants_.find(key);
+        if (search != method_constants_.end())
+            return search->second;
         u2 name_and_type_index = add_name_and_type_constant(method_name, type);
         u2 class_index = add_class_constant(class_name);
-        return class_.constant_pool_.make_constant<MethodRefConstant>(class_index, name_and_type_index);
+        u2 index = class_.constant_pool_.make_constant<MethodRefConstant>(class_index, name_and_type_index);
+        method_constants_.insert({ key, index });
+        return index;
+    }
+
+    u2
+    ClassBuilder::add_interface_method_constant(const utf8 &interface_name, const utf8 &method_name, const Type &type)
+    {
+        auto key = std::make_tuple(interface_name, method_name, type.descriptor());
+        auto search = interface_method_constants_.find(key);
+        if (search != interface_method_constants_.end())
+            return search->second;
+        u2 name_and_type_index = add_name_and_type_constant(method_name, type);
+        u2 class_index = add_class_constant(interface_name);
+        u2 index = class_.constant_pool_.make_constant<InterfaceMethodRefConstant>(class_index, name_and_type_index);
+        interface_method_constants_.insert({ key, index });
+        return index;
     }
 
     u2
     ClassBuilder::add_field_constant(const utf8 &class_name, const utf8 &field_name, const Type &type)
     {
+        auto key = std::make_tuple(class_name, field_name, type.descriptor());
+        auto search = field_constants_.find(key);
+        if (search != field_constants_.end())
+            return search->second;
         u2 name_and_type_index = add_name_and_type_constant(field_name, type);
         u2 class_index = add_class_constant(class_name);
-        return class_.constant_pool_.make_constant<FieldRefConstant>(class_index, name_and_type_index);
+        u2 index = class_.constant_pool_.make_constant<FieldRefConstant>(class_index, name_and_type_index);
+        field_constants_.insert({ key, index });
+        return index;
     }
 
     u2
@@ -134,12 +228,99 @@ namespace jasm {
         auto search = string_constants_.find(str);
         if (search != string_constants_.end())
             return search->second;
-        u2 utf8_index = class_.constant_pool_.make_constant<Utf8Constant>(str);
+        u2 utf8_index = add_utf8_constant(str);
         u2 index = class_.constant_pool_.make_constant<StringConstant>(utf8_index);
         string_constants_.insert({ str, index });
         return index;
     }
 
+    u2
+    ClassBuilder::add_method_handle_constant(u1 reference_kind, u2 reference_index)
+    {
+        auto search = method_handle_constants_.find({ reference_kind, reference_index });
+        if (search != method_handle_constants_.end())
+            return search->second;
+        u2 index = class_.constant_pool_.make_constant<MethodHandleConstant>(reference_kind, reference_index);
+        method_handle_constants_.insert({ { reference_kind, reference_index }, index });
+        return index;
+    }
+
+    u2
+    ClassBuilder::add_bootstrap_method(u2 method_handle, std::vector<u2> arguments)
+    {
+        if (bootstrap_methods_ == nullptr) {
+            class_.make_attribute<BootstrapMethodsAttribute>(add_utf8_constant("BootstrapMethods"));
+            bootstrap_methods_ = dynamic_cast<BootstrapMethodsAttribute *>(class_.attributes().back().get());
+        }
+        return bootstrap_methods_->add_bootstrap_method({ method_handle, std::move(arguments) });
+    }
+
+    u2
+    ClassBuilder::add_invoke_dynamic_constant(u2 bootstrap_method, const utf8 &name, const Type &type)
+    {
+        u2 name_and_type_index = add_name_and_type_constant(name, type);
+        auto search = invoke_dynamic_constants_.find({ bootstrap_method, name_and_type_index });
+        if (search != invoke_dynamic_constants_.end())
+            return search->second;
+        u2 index = class_.constant_pool_.make_constant<InvokeDynamicConstant>(bootstrap_method, name_and_type_index);
+        invoke_dynamic_constants_.insert({ { bootstrap_method, name_and_type_index }, index });
+        return index;
+    }
+
+    u2
+    ClassBuilder::add_integer_constant(int32_t value)
+    {
+        u4 bytes = static_cast<u4>(value);
+        auto search = integer_constants_.find(bytes);
+        if (search != integer_constants_.end())
+            return search->second;
+        u2 index = class_.constant_pool_.make_constant<IntegerConstant>(bytes);
+        integer_constants_.insert({ bytes, index });
+        return index;
+    }
+
+    u2
+    ClassBuilder::add_float_constant(float value)
+    {
+        // constants are distinguished by their bit patterns, so that 0.0f and -0.0f are kept apart
+        u4 bytes;
+        std::memcpy(&bytes, &value, sizeof(bytes));
+        auto search = float_constants_.find(bytes);
+        if (search != float_constants_.end())
+            return search->second;
+        u2 index = class_.constant_pool_.make_constant<FloatConstant>(bytes);
+        float_constants_.insert({ bytes, index });
+        return index;
+    }
+
+    u2
+    ClassBuilder::add_long_constant(int64_t value)
+    {
+        u8 bytes = static_cast<u8>(value);
+        auto search = long_constants_.find(bytes);
+        if (search != long_constants_.end())
+            return search->second;
+        u2 index = class_.constant_pool_.make_constant<LongConstant>(bytes >> 32u, bytes & 0xFFFFFFFFu);
+        // long and double constants take up two entries
+        class_.constant_pool_.make_constant<EmptyConstant>();
+        long_constants_.insert({ bytes, index });
+        return index;
+    }
+
+    u2
+    ClassBuilder::add_double_constant(double value)
+    {
+        u8 bytes;
+        std::memcpy(&bytes, &value, sizeof(bytes));
+        auto search = double_constants_.find(bytes);
+        if (search != double_constants_.end())
+            return search->second;
+        u2 index = class_.constant_pool_.make_constant<DoubleConstant>(bytes >> 32u, bytes & 0xFFFFFFFFu);
+        class_.constant_pool_.make_constant<EmptyConstant>();
+        double_constants_.insert({ bytes, index });
+        return index;
+    }
+
     ClassBuilder::InsertionPoint
     ClassBuilder::enter_method(const utf8 &method_name, const MethodType &type, u2 access_flags)
     {
@@ -161,6 +342,148 @@ namespace jasm {
         return insertion_point;
     }
 
+    void
+    ClassBuilder::remove_unreachable_code()
+    {
+        std::map<const BasicBlock *, std::size_t> block_indices;
+        for (std::size_t i = 0; i < basic_blocks_.size(); ++i)
+            block_indices[&basic_blocks_[i]] = i;
+
+        std::vector<bool> reachable(basic_blocks_.size(), false);
+        std::vector<std::size_t> worklist{ 0 };
+        reachable[0] = true;
+        auto reach = [&](std::size_t i) {
+            if (i < basic_blocks_.size() && !reachable[i]) {
+                reachable[i] = true;
+                worklist.push_back(i);
+            }
+        };
+
+        do {
+            while (!worklist.empty()) {
+                BasicBlock &basic_block = basic_blocks_[worklist.back()];
+                std::size_t next = worklist.back() + 1;
+                worklist.pop_back();
+
+                // the instructions following an unconditional jump, return or throw are dead
+                auto end = std::find_if(basic_block.code_.begin(), basic_block.code_.end(),
+                                        [](auto &inst) { return !falls_through(inst->opcode()); });
+                if (end != basic_block.code_.end())
+                    basic_block.code_.erase(end + 1, basic_block.code_.end());
+
+                for (auto &inst : basic_block.code_) {
+                    if (auto *branch = dynamic_cast<BranchInstruction *>(inst.get())) {
+                        for (Label label : branch->labels())
+                            reach(block_indices[labels_[label]]);
+                    }
+                }
+                if (end == basic_block.code_.end())
+                    reach(next);
+            }
+
+            // a handler is reachable if any of the blocks it protects is
+            for (auto &handler : exception_handlers_) {
+                auto first = reachable.begin() + block_indices[labels_[handler.start]];
+                auto last = reachable.begin() + block_indices[labels_[handler.end]];
+                if (first < last && std::find(first, last, true) != last)
+                    reach(block_indices[labels_[handler.handler]]);
+            }
+        } while (!worklist.empty());
+
+        // the blocks are kept, so that the labels bound to them stay valid
+        for (std::size_t i = 0; i < basic_blocks_.size(); ++i) {
+            if (!reachable[i]) {
+                basic_blocks_[i].code_.clear();
+                basic_blocks_[i].frame_.reset();
+            }
+        }
+    }
+
+    /**
+     * Computes the positions of the basic blocks, resolves the jumps and creates the stack map table.
+     */
+    void
+    ClassBuilder::layout_method()
+    {
+        remove_unreachable_code();
+
+        // the jumps are laid out with two byte offsets first, the ones out of range are widened until all of them
+        // reach their labels, the size of the switch instructions depends on their position
+        u4 code_length;
+        std::vector<u4> label_positions(labels_.size());
+        bool widened;
+        do {
+            u4 position = 0;
+            for (auto &basic_block : basic_blocks_) {
+                basic_block.position_ = position;
+                for (auto &inst : basic_block.code_) {
+                    if (auto *branch = dynamic_cast<BranchInstruction *>(inst.get()))
+                        branch->set_position(position);
+                    position += inst->size();
+                }
+            }
+            code_length = position;
+
+            for (std::size_t i = 0; i < labels_.size(); ++i) {
+                assert(labels_[i] != nullptr);
+                label_positions[i] = labels_[i]->position_;
+            }
+
+            widened = false;
+            for (std::size_t i = 0; i < basic_blocks_.size(); ++i) {
+                auto &code = basic_blocks_[i].code_;
+                for (auto &inst : code) {
+                    auto *branch = dynamic_cast<BranchInstruction *>(inst.get());
+                    if (branch == nullptr || !branch->widen(label_positions))
+                        continue;
+                    widened = true;
+                    if (inst->opcode() == GoToW::Opcode || inst->opcode() == JmpSubroutineW::Opcode)
+                        continue;
+                    // the inverted conditional jump skips to the following block, which needs its frame then
+                    assert(&inst == &code.back() && i + 1 < basic_blocks_.size() && basic_blocks_[i + 1].frame_);
+                    basic_blocks_[i + 1].frame_on_demand_ = false;
+                }
+            }
+        } while (widened);
+
+        std::vector<StackMapTableAttribute::Frame> frames;
+        for (auto &basic_block : basic_blocks_) {
+            for (auto &inst : basic_block.code_) {
+                if (auto *branch = dynamic_cast<BranchInstruction *>(inst.get()))
+                    branch->resolve(label_positions);
+            }
+
+            // no frame is needed at the end of the code, nothing can jump there
+            if (!basic_block.frame_ || basic_block.frame_on_demand_ || basic_block.position_ >= code_length)
+                continue;
+            basic_block.frame_->position = basic_block.position_;
+            for (auto &type : basic_block.frame_->stack) {
+                if (type.tag == StackMapTableAttribute::VerificationType::ITEM_UNINITIALIZED)
+                    type.index = label_positions[type.index];
+            }
+            if (!frames.empty() && frames.back().position == basic_block.position_)
+                frames.back() = std::move(*basic_block.frame_);
+            else
+                frames.push_back(std::move(*basic_block.frame_));
+        }
+
+        for (auto &handler : exception_handlers_) {
+            u4 start = label_positions[handler.start];
+            u4 end = label_positions[handler.end];
+            // the protected code may have been removed as unreachable
+            if (start < end)
+                current_code_->make_exception_table_entry(start, end, label_positions[handler.handler],
+                                                          handler.catch_type);
+        }
+
+        if (!frames.empty()) {
+            StackMapTableAttribute attribute(add_utf8_constant("StackMapTable"));
+            for (auto &frame : frames)
+                attribute.add_frame(std::move(frame));
+            current_code_->add_attribute(std::move(attribute));
+        }
+    }
+
     void
     ClassBuilder::leave_method()
     {
@@ -168,10 +491,24 @@ namespace jasm {
             current_method_->attributes().erase(std::remove_if(
               current_method_->attributes().begin(), current_method_->attributes().end(),
               [](std::unique_ptr<Attribute> &attr) { return dynamic_cast<CodeAttribute *>(attr.get()) != nullptr; }));
+            current_code_ = nullptr;
+            basic_blocks_.clear();
+            labels_.clear();
+            exception_handlers_.clear();
+            return;
         }
+        layout_method();
+        std::set<const BasicBlock *> handler_blocks;
+        for (auto &handler : exception_handlers_)
+            handler_blocks.insert(labels_[handler.handler]);
         u2 stack_size = 0;
         u2 max_stack_size = 0;
         for (auto &basic_block : basic_blocks_) {
+            // a handler is entered with just the exception on the operand stack
+            if (handler_blocks.count(&basic_block)) {
+                stack_size = 1;
+                max_stack_size = std::max(max_stack_size, stack_size);
+            }
             for (auto &inst : basic_block.code_) {
                 stack_size -= inst->input_stack_operand_count();
                 stack_size += inst->output_stack_operand_count();
@@ -184,15 +521,18 @@ namespace jasm {
         }
         current_code_->set_stack_limit(max_stack_size);
         basic_blocks_.clear();
+        labels_.clear();
+        exception_handlers_.clear();
     }
 
-    void
+    Field &
     ClassBuilder::declare_field(const utf8 &field_name, const Type &type, u2 access_flags)
     {
         u2 name_index = add_utf8_constant(field_name);
         u2 descriptor_index = add_utf8_constant(type.descriptor());
         Field field(access_flags, name_index, descriptor_index);
         class_.add_field(std::move(field));
+        return class_.fields_.back();
     }
 
 }
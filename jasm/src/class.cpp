@@ -190,38 +190,61 @@ namespace jasm {
         if (attribute_name == "SourceFile") {
             u2 source_file_index = read_big_endian<u2>(is);
             attr->make_attribute<SourceFileAttribute>(attribute_name_index, source_file_index);
+        } else if (attribute_name == "ConstantValue") {
+            u2 constant_value_index = read_big_endian<u2>(is);
+            attr->make_attribute<ConstantValueAttribute>(attribute_name_index, constant_value_index);
+        } else if (attribute_name == "BootstrapMethods") {
+            // the table is read as it is, the call sites refer to the methods by their indices
+            std::vector<BootstrapMethodsAttribute::BootstrapMethod> bootstrap_methods(read_big_endian<u2>(is));
+            for (auto &bootstrap_method : bootstrap_methods) {
+                bootstrap_method.method_ref = read_big_endian<u2>(is);
+                bootstrap_method.arguments.resize(read_big_endian<u2>(is));
+                for (u2 &argument : bootstrap_method.arguments)
+                    argument = read_big_endian<u2>(is);
+            }
+            attr->make_attribute<BootstrapMethodsAttribute>(attribute_name_index, std::move(bootstrap_methods));
         } else if (attribute_name == "Code") {
-            u2 max_stack = read_big_endian<u2>(is);
-            u2 max_locals = read_big_endian<u2>(is);
+            // the body is buffered, so that code containing instructions not implemented by jasm can be kept raw
+            std::vector<u1> bytes(attribute_length);
+            is.read(reinterpret_cast<char *>(bytes.data()), attribute_length);
+            MemoryBuffer buffer(bytes.data(), bytes.size());
+            std::istream code_is(&buffer);
+
+            u2 max_stack = read_big_endian<u2>(code_is);
+            u2 max_locals = read_big_endian<u2>(code_is);
             CodeAttribute code(attribute_name_index, max_stack, max_locals);
 
-            u4 code_length = read_big_endian<u4>(is);
+            u4 code_length = read_big_endian<u4>(code_is);
             for (u4 i = 0; i < code_length;) {
-                i += read_instruction(is, &code);
+                u4 width = read_instruction(code_is, &code, i);
+                if (width == 0) {
+                    attr->add_attribute(RawAttribute(attribute_name_index, std::move(bytes)));
+                    return;
+                }
+                i += width;
                 assert(i <= code_length);
             }
 
-            u2 exception_table_length = read_big_endian<u2>(is);
+            u2 exception_table_length = read_big_endian<u2>(code_is);
             for (u2 i = 0; i < exception_table_length; ++i) {
-                u2 start_pc = read_big_endian<u2>(is);
-                u2 end_pc = read_big_endian<u2>(is);
-                u2 handler_pc = read_big_endian<u2>(is);
-                u2 catch_type = read_big_endian<u2>(is);
+                u2 start_pc = read_big_endian<u2>(code_is);
+                u2 end_pc = read_big_endian<u2>(code_is);
+                u2 handler_pc = read_big_endian<u2>(code_is);
+                u2 catch_type = read_big_endian<u2>(code_is);
                 code.make_exception_table_entry(start_pc, end_pc, handler_pc, catch_type);
             }
 
-            u2 attributes_count = read_big_endian<u2>(is);
+            u2 attributes_count = read_big_endian<u2>(code_is);
             for (u2 i = 0; i < attributes_count; ++i) {
-                read_attribute(is, &code);
+                read_attribute(code_is, &code);
             }
 
             attr->add_attribute(std::move(code));
         } else {
-            // skip unknown
-            std::cerr << "Warning: attribute " << attribute_name << " is not implemented." << std::endl;
-            for (u4 i = 0; i < attribute_length; ++i) {
-                read_big_endian<u1>(is);
-            }
+            // attributes not implemented by jasm are preserved as they are
+            std::vector<u1> bytes(attribute_length);
+            is.read(reinterpret_cast<char *>(bytes.data()), attribute_length);
+            attr->add_attribute(RawAttribute(attribute_name_index, std::move(bytes)));
         }
     }
 
@@ -231,7 +254,7 @@ namespace jasm {
         return 1 + InstructionInfo[opcode][0];
 
     u4
-    Class::read_instruction(std::istream &is, CodeAttribute *code)
+    Class::read_instruction(std::istream &is, CodeAttribute *code, u4 position)
     {
         u1 opcode = read_big_endian<u1>(is);
         switch (opcode) {
@@ -434,15 +457,16 @@ namespace jasm {
             CASE_SIMPLE_INST(0xc7)
             CASE_SIMPLE_INST(0xc8)
             CASE_SIMPLE_INST(0xc9)
-        case 0xc4:
         case 0xaa:
+            code->make_instruction<TableSwitch>(&is, position);
+            return code->code().back()->size();
         case 0xab:
+            code->make_instruction<LookupSwitch>(&is, position);
+            return code->code().back()->size();
+        case 0xc4:
         default:
-            // skip unimplemented instruction
-            std::cerr << "Warning: instruction 0x" << std::hex << std::setw(2) << std::setfill('0') << (int) opcode
-                      << " (" << (opcode <= 0xca ? InstructionMnemonics[opcode] : "") << ") is not implemented."
-                      << std::endl;
-            return 1;
+            // not implemented, the caller keeps the code raw
+            return 0;
         }
     }
 
@@ -452,27 +476,27 @@ namespace jasm {
         // dump the constant pool
         size_t i = 1;
         for (auto &c : constant_pool_) {
-            std::cout << '#' << std::setw(4) << std::left << i++ << " = ";
-            c->jasm(std::cout);
+            os << '#' << std::setw(4) << std::left << i++ << " = ";
+            c->jasm(os);
         }
-        std::cout << std::endl;
+        os << std::endl;
 
         // dump attributes
         for (auto &attr : attributes_) {
-            attr->jasm(std::cout, &constant_pool_);
+            attr->jasm(os, &constant_pool_);
         }
-        std::cout << std::endl;
+        os << std::endl;
 
         // dump fields
         for (auto &field : fields_) {
-            field.jasm(std::cout, &constant_pool_);
-            std::cout << std::endl;
+            field.jasm(os, &constant_pool_);
+            os << std::endl;
         }
 
         // dump methods
         for (auto &method : methods_) {
-            method.jasm(std::cout, &constant_pool_);
-            std::cout << std::endl;
+            method.jasm(os, &constant_pool_);
+            os << std::endl;
         }
     }
 
@@ -508,4 +532,67 @@ namespace jasm {
             attr->emit_bytecode(os);
     }
 
-}
\ No newline at end of file
+
+    bool
+    Class::visit_constants(const ConstantVisitor &visitor)
+    {
+        visitor(this_class_);
+        // java/lang/Object has no super class
+        if (super_class_ != 0)
+            visitor(super_class_);
+        for (auto &interface : interfaces_)
+            visitor(interface);
+
+        bool known = true;
+        for (auto &field : fields_)
+            known &= field.visit_constants(visitor);
+        for (auto &method : methods_)
+            known &= method.visit_constants(visitor);
+        return visit_attribute_constants(visitor) && known;
+    }
+
+    bool
+    Class::remove_unused_constants()
+    {
+        std::vector<bool> used(constant_pool_.count() + 1, false);
+        std::vector<u2> worklist;
+        auto mark = [&](u2 &index) {
+            assert(index > 0 && index < used.size());
+            if (!used[index]) {
+                used[index] = true;
+                worklist.push_back(index);
+            }
+        };
+
+        if (!visit_constants(mark))
+            return false;
+        while (!worklist.empty()) {
+            u2 index = worklist.back();
+            worklist.pop_back();
+            auto constant = constant_pool_.get(index);
+            constant->visit_references(mark);
+            // long and double constants take up two entries
+            if (constant->tag() == ConstantPool::CONSTANT_LONG || constant->tag() == ConstantPool::CONSTANT_DOUBLE)
+                used[index + 1] = true;
+        }
+
+        std::vector<u2> new_index(used.size(), 0);
+        u2 count = 0;
+        for (std::size_t i = 1; i < used.size(); ++i) {
+            if (used[i])
+                new_index[i] = ++count;
+        }
+        if (count == constant_pool_.count())
+            return true;
+
+        auto renumber = [&](u2 &index) { index = new_index[index]; };
+        visit_constants(renumber);
+        for (std::size_t i = 1; i < used.size(); ++i) {
+            if (used[i])
+                constant_pool_.get(i)->visit_references(renumber);
+        }
+        constant_pool_.retain(used);
+        return true;
+    }
+
+}
@@ -0,0 +1,828 @@
+/**
+ * @file disassembler.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include "disassembler.hpp"
+#include "mnemonics.hpp"
+
+namespace jasm {
+
+    struct FlagName
+    {
+        u2 flag;
+        const char *name;
+    };
+
+    static constexpr FlagName ClassFlags[] = {
+        { 0x0001, "public" },   { 0x0010, "final" },     { 0x0020, "super" },      { 0x0200, "interface" },
+        { 0x0400, "abstract" }, { 0x1000, "synthetic" }, { 0x2000, "annotation" }, { 0x4000, "enum" },
+        { 0x8000, "module" },
+    };
+
+    static constexpr FlagName FieldFlags[] = {
+        { 0x0002, "private" }, { 0x0004, "protected" }, { 0x0001, "public" },   { 0x0008, "static" },
+        { 0x0010, "final" },   { 0x0080, "transient" }, { 0x0040, "volatile" }, { 0x1000, "synthetic" },
+        { 0x4000, "enum" },
+    };
+
+    static constexpr FlagName MethodFlags[] = {
+        { 0x0002, "private" },  { 0x0004, "protected" }, { 0x0001, "public" }, { 0x0008, "static" },
+        { 0x0010, "final" },    { 0x0400, "abstract" },  { 0x0100, "native" }, { 0x0020, "synchronized" },
+        { 0x0800, "strictfp" }, { 0x0040, "bridge" },    { 0x0080, "varargs" }, { 0x1000, "synthetic" },
+    };
+
+    static constexpr const char *ReferenceKinds[] = {
+        "",
+        "REF_getField",
+        "REF_getStatic",
+        "REF_putField",
+        "REF_putStatic",
+        "REF_invokeVirtual",
+        "REF_invokeStatic",
+        "REF_invokeSpecial",
+        "REF_newInvokeSpecial",
+        "REF_invokeInterface",
+    };
+
+    // element types of newarray indexed by the operand
+    static constexpr const char *ArrayTypes[] = {
+        "", "", "", "", "boolean", "char", "float", "double", "byte", "short", "int", "long",
+    };
+
+    static constexpr u1 LastOpcode = 0xc9;
+
+    /**
+     * Stream buffer appending to a string, the bytecode of the attributes is emitted into it without the copies of
+     * std::ostringstream.
+     */
+    class StringBuffer : public std::streambuf
+    {
+    private:
+        std::string &bytes_;
+
+    public:
+        explicit StringBuffer(std::string &bytes)
+          : bytes_(bytes)
+        {}
+
+    protected:
+        int_type
+        overflow(int_type ch) override
+        {
+            if (ch != traits_type::eof())
+                bytes_.push_back(static_cast<char>(ch));
+            return traits_type::not_eof(ch);
+        }
+
+        std::streamsize
+        xsputn(const char *s, std::streamsize count) override
+        {
+            bytes_.append(s, count);
+            return count;
+        }
+    };
+
+    /**
+     * Bounds checked big endian reader of the bytes of an attribute. Reading past the end marks the reader invalid
+     * and returns zeros.
+     */
+    class ByteReader
+    {
+    private:
+        const u1 *data_;
+        std::size_t size_;
+        std::size_t position_ = 0;
+        bool valid_ = true;
+
+    public:
+        ByteReader(const u1 *data, std::size_t size)
+          : data_(data)
+          , size_(size)
+        {}
+
+        inline bool
+        available(std::size_t count)
+        {
+            if (count > size_ - position_)
+                valid_ = false;
+            return valid_;
+        }
+
+        inline u1
+        get_u1()
+        {
+            return available(1) ? data_[position_++] : 0;
+        }
+
+        inline u2
+        get_u2()
+        {
+            u2 high = get_u1();
+            return (high << 8u) | get_u1();
+        }
+
+        inline u4
+        get_u4()
+        {
+            u4 high = get_u2();
+            return (high << 16u) | get_u2();
+        }
+
+        inline void
+        skip(std::size_t count)
+        {
+            if (available(count))
+                position_ += count;
+        }
+
+        inline const u1 *
+        current() const
+        {
+            return data_ + position_;
+        }
+
+        inline std::size_t
+        position() const
+        {
+            return position_;
+        }
+
+        inline bool
+        at_end() const
+        {
+            return position_ >= size_;
+        }
+
+        inline bool
+        valid() const
+        {
+            return valid_;
+        }
+    };
+
+    /**
+     * Appends the pieces of the text to a string, numbers are formatted with std::to_chars.
+     */
+    class TextWriter
+    {
+    private:
+        std::string &text_;
+
+    public:
+        explicit TextWriter(std::string &text)
+          : text_(text)
+        {}
+
+        inline TextWriter &
+        put(char ch)
+        {
+            text_.push_back(ch);
+            return *this;
+        }
+
+        inline TextWriter &
+        put(std::string_view str)
+        {
+            text_.append(str);
+            return *this;
+        }
+
+        inline TextWriter &
+        put_number(int64_t value)
+        {
+            char buffer[24];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            text_.append(buffer, result.ptr);
+            return *this;
+        }
+
+        /**
+         * Appends a number aligned to the right.
+         */
+        inline TextWriter &
+        put_padded(int64_t value, std::size_t width)
+        {
+            char buffer[24];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            auto length = static_cast<std::size_t>(result.ptr - buffer);
+            if (length < width)
+                text_.append(width - length, ' ');
+            text_.append(buffer, result.ptr);
+            return *this;
+        }
+
+        /**
+         * Appends a floating point number with the fewest digits which still read back as the same number.
+         */
+        template<typename T>
+        inline TextWriter &
+        put_floating(T value, char suffix)
+        {
+            if (std::isnan(value)) {
+                text_.append("NaN");
+            } else if (std::isinf(value)) {
+                text_.append(value < 0 ? "-Infinity" : "Infinity");
+            } else {
+                char buffer[32];
+                int max_precision = sizeof(T) == sizeof(float) ? 9 : 17;
+                for (int precision = 1; precision <= max_precision; ++precision) {
+                    snprintf(buffer, sizeof(buffer), "%.*g", precision, static_cast<double>(value));
+                    if (static_cast<T>(strtod(buffer, nullptr)) == value)
+                        break;
+                }
+                text_.append(buffer);
+                // keeps the number distinguishable from an integer
+                if (strpbrk(buffer, ".e") == nullptr)
+                    text_.append(".0");
+            }
+            text_.push_back(suffix);
+            return *this;
+        }
+
+        /**
+         * Appends a string constant in double quotes with the quotes and the control characters escaped.
+         */
+        TextWriter &
+        put_quoted(std::string_view str)
+        {
+            static constexpr char Hex[] = "0123456789abcdef";
+            text_.push_back('"');
+            for (char ch : str) {
+                switch (ch) {
+                case '"':
+                    text_.append("\\\"");
+                    break;
+                case '\\':
+                    text_.append("\\\\");
+                    break;
+                case '\n':
+                    text_.append("\\n");
+                    break;
+                case '\r':
+                    text_.append("\\r");
+                    break;
+                case '\t':
+                    text_.append("\\t");
+                    break;
+                default:
+                    if (static_cast<u1>(ch) < 0x20 || ch == 0x7f) {
+                        text_.append("\\u00");
+                        text_.push_back(Hex[static_cast<u1>(ch) >> 4u]);
+                        text_.push_back(Hex[static_cast<u1>(ch) & 0xfu]);
+                    } else {
+                        text_.push_back(ch);
+                    }
+                }
+            }
+            text_.push_back('"');
+            return *this;
+        }
+
+        template<std::size_t N>
+        TextWriter &
+        put_flags(u2 flags, const FlagName (&names)[N])
+        {
+            for (auto &name : names) {
+                if (flags & name.flag)
+                    put(name.name).put(' ');
+            }
+            return *this;
+        }
+    };
+
+    /**
+     * Formats a single class, the constants are resolved with its constant pool.
+     */
+    class ClassPrinter
+    {
+    private:
+        const ConstantPool &pool_;
+        TextWriter out_;
+
+        const Constant *
+        constant(u2 index) const
+        {
+            if (index == 0 || index > pool_.count())
+                return nullptr;
+            return pool_.get(index);
+        }
+
+        const std::string *
+        utf8(u2 index) const
+        {
+            auto utf8 = dynamic_cast<const Utf8Constant *>(constant(index));
+            return utf8 != nullptr ? &utf8->value() : nullptr;
+        }
+
+        void
+        put_invalid(u2 index)
+        {
+            out_.put('#').put_number(index);
+        }
+
+        void
+        put_class_name(u2 index)
+        {
+            auto clazz = dynamic_cast<const ClassConstant *>(constant(index));
+            if (clazz != nullptr)
+                put_utf8(clazz->name_index());
+            else
+                put_invalid(index);
+        }
+
+        void
+        put_name_and_type(u2 index, char separator)
+        {
+            auto name_and_type = dynamic_cast<const NameAndTypeConstant *>(constant(index));
+            if (name_and_type == nullptr) {
+                put_invalid(index);
+                return;
+            }
+            put_utf8(name_and_type->name_index());
+            out_.put(separator);
+            put_utf8(name_and_type->descriptor_index());
+        }
+
+        void
+        put_member(u2 class_index, u2 name_and_type_index)
+        {
+            put_class_name(class_index);
+            out_.put('.');
+            put_name_and_type(name_and_type_index, ':');
+        }
+
+    public:
+        ClassPrinter(const ConstantPool &pool, std::string &text)
+          : pool_(pool)
+          , out_(text)
+        {}
+
+        inline TextWriter &
+        out()
+        {
+            return out_;
+        }
+
+        /**
+         * Appends a name or a descriptor without quotes.
+         */
+        void
+        put_utf8(u2 index)
+        {
+            if (auto value = utf8(index))
+                out_.put(*value);
+            else
+                put_invalid(index);
+        }
+
+        /**
+         * Appends the value of a constant: strings are quoted, numbers carry the suffixes of Java literals and
+         * member references are written as the owner, the name and the descriptor.
+         */
+        void
+        put_constant(u2 index)
+        {
+            const Constant *value = constant(index);
+            if (value == nullptr) {
+                put_invalid(index);
+                return;
+            }
+            switch (value->tag()) {
+            case ConstantPool::CONSTANT_UTF_8:
+                out_.put_quoted(static_cast<const Utf8Constant *>(value)->value());
+                break;
+            case ConstantPool::CONSTANT_INTEGER:
+                out_.put_number(static_cast<int32_t>(static_cast<const IntegerConstant *>(value)->bytes()));
+                break;
+            case ConstantPool::CONSTANT_FLOAT: {
+                u4 bytes = static_cast<const FloatConstant *>(value)->bytes();
+                float number;
+                memcpy(&number, &bytes, sizeof(number));
+                out_.put_floating(number, 'f');
+                break;
+            }
+            case ConstantPool::CONSTANT_LONG: {
+                auto constant = static_cast<const LongConstant *>(value);
+                u8 bytes = (static_cast<u8>(constant->high_bytes()) << 32u) | constant->low_bytes();
+                out_.put_number(static_cast<int64_t>(bytes)).put('L');
+                break;
+            }
+            case ConstantPool::CONSTANT_DOUBLE: {
+                auto constant = static_cast<const DoubleConstant *>(value);
+                u8 bytes = (static_cast<u8>(constant->high_bytes()) << 32u) | constant->low_bytes();
+                double number;
+                memcpy(&number, &bytes, sizeof(number));
+                out_.put_floating(number, 'd');
+                break;
+            }
+            case ConstantPool::CONSTANT_CLASS:
+                put_utf8(static_cast<const ClassConstant *>(value)->name_index());
+                break;
+            case ConstantPool::CONSTANT_STRING: {
+                u2 string_index = static_cast<const StringConstant *>(value)->string_index();
+                if (auto str = utf8(string_index))
+                    out_.put_quoted(*str);
+                else
+                    put_invalid(string_index);
+                break;
+            }
+            case ConstantPool::CONSTANT_FIELD_REF: {
+                auto ref = static_cast<const FieldRefConstant *>(value);
+                put_member(ref->class_index(), ref->name_and_type_index());
+                break;
+            }
+            case ConstantPool::CONSTANT_METHOD_REF: {
+                auto ref = static_cast<const MethodRefConstant *>(value);
+                put_member(ref->class_index(), ref->name_and_type_index());
+                break;
+            }
+            case ConstantPool::CONSTANT_INTERFACE_METHOD_REF: {
+                auto ref = static_cast<const InterfaceMethodRefConstant *>(value);
+                put_member(ref->class_index(), ref->name_and_type_index());
+                break;
+            }
+            case ConstantPool::CONSTANT_NAME_AND_TYPE:
+                put_name_and_type(index, ':');
+                break;
+            case ConstantPool::CONSTANT_METHOD_HANDLE: {
+                auto handle = static_cast<const MethodHandleConstant *>(value);
+                u1 kind = handle->reference_kind();
+                out_.put("MethodHandle ");
+                if (kind >= 1 && kind <= MethodHandleConstant::REF_INVOKE_INTERFACE)
+                    out_.put(ReferenceKinds[kind]);
+                else
+                    out_.put_number(kind);
+                out_.put(' ');
+                put_constant(handle->reference_index());
+                break;
+            }
+            case ConstantPool::CONSTANT_METHOD_TYPE:
+                out_.put("MethodType ");
+                put_utf8(static_cast<const MethodTypeConstant *>(value)->descriptor_index());
+                break;
+            case ConstantPool::CONSTANT_INVOKE_DYNAMIC: {
+                auto call_site = static_cast<const InvokeDynamicConstant *>(value);
+                out_.put_number(call_site->bootstrap_method_attr_index()).put(' ');
+                put_name_and_type(call_site->name_and_type_index(), ':');
+                break;
+            }
+            default:
+                put_invalid(index);
+            }
+        }
+
+        void
+        put_constant_pool()
+        {
+            // the values of method handles and method types are written with their kinds
+            static constexpr const char *TagNames[] = {
+                "", "Utf8", "", "Integer", "Float", "Long", "Double", "Class", "String", "Fieldref", "Methodref",
+                "InterfaceMethodref", "NameAndType", "", "", "", "", "", "InvokeDynamic",
+            };
+            for (u2 index = 1; index <= pool_.count(); ++index) {
+                u1 tag = pool_.get(index)->tag();
+                // the second slot of a long or a double
+                if (tag == 0)
+                    continue;
+                out_.put(".const #").put_number(index).put(" = ");
+                if (tag < sizeof(TagNames) / sizeof(TagNames[0]) && TagNames[tag][0] != '\0')
+                    out_.put(TagNames[tag]).put(' ');
+                put_constant(index);
+                out_.put('\n');
+            }
+            out_.put('\n');
+        }
+
+        /**
+         * Appends the lines of an attribute of a class, a field or a method.
+         *
+         * @param attribute attribute and its header as written in a class file.
+         * @param indent indentation of the lines.
+         */
+        void
+        put_attribute(const std::string &attribute, std::string_view indent)
+        {
+            ByteReader reader(reinterpret_cast<const u1 *>(attribute.data()), attribute.size());
+            u2 name_index = reader.get_u2();
+            u4 length = reader.get_u4();
+            const std::string *name = utf8(name_index);
+            out_.put(indent);
+
+            if (name != nullptr && length == 2 && *name == "SourceFile") {
+                u2 index = reader.get_u2();
+                out_.put(".source ");
+                if (auto source = utf8(index))
+                    out_.put_quoted(*source);
+                else
+                    put_invalid(index);
+            } else if (name != nullptr && length == 2 && *name == "Signature") {
+                out_.put(".signature ");
+                put_utf8(reader.get_u2());
+            } else if (name != nullptr && *name == "Exceptions") {
+                u2 count = reader.get_u2();
+                out_.put(".throws");
+                for (u2 i = 0; i < count && reader.valid(); ++i) {
+                    out_.put(' ');
+                    put_class_name(reader.get_u2());
+                }
+            } else if (name != nullptr && *name == "BootstrapMethods") {
+                u2 count = reader.get_u2();
+                for (u2 i = 0; i < count && reader.valid(); ++i) {
+                    if (i > 0)
+                        out_.put('\n').put(indent);
+                    out_.put(".bootstrap ").put_number(i).put(' ');
+                    put_constant(reader.get_u2());
+                    u2 arguments = reader.get_u2();
+                    for (u2 j = 0; j < arguments && reader.valid(); ++j) {
+                        out_.put(j == 0 ? " " : ", ");
+                        put_constant(reader.get_u2());
+                    }
+                }
+            } else {
+                out_.put(".attribute ");
+                put_utf8(name_index);
+                out_.put(' ').put_number(length);
+            }
+            out_.put('\n');
+        }
+
+        /**
+         * Appends the limits, the instructions, the exception table and the attributes of a Code attribute.
+         */
+        void
+        put_code(const std::string &attribute)
+        {
+            ByteReader reader(reinterpret_cast<const u1 *>(attribute.data()), attribute.size());
+            reader.skip(6);
+            u2 max_stack = reader.get_u2();
+            u2 max_locals = reader.get_u2();
+            u4 code_length = reader.get_u4();
+            out_.put("    .limit stack ").put_number(max_stack).put('\n');
+            out_.put("    .limit locals ").put_number(max_locals).put('\n');
+            if (!reader.available(code_length)) {
+                out_.put("    ; malformed code\n");
+                return;
+            }
+            put_instructions(ByteReader(reader.current(), code_length));
+            reader.skip(code_length);
+
+            u2 exception_table_length = reader.get_u2();
+            for (u2 i = 0; i < exception_table_length && reader.valid(); ++i) {
+                u2 start_pc = reader.get_u2();
+                u2 end_pc = reader.get_u2();
+                u2 handler_pc = reader.get_u2();
+                u2 catch_type = reader.get_u2();
+                out_.put("    .catch ");
+                if (catch_type == 0)
+                    out_.put("all");
+                else
+                    put_class_name(catch_type);
+                out_.put(' ').put_number(start_pc).put(' ').put_number(end_pc).put(' ').put_number(handler_pc);
+                out_.put('\n');
+            }
+
+            u2 attributes_count = reader.get_u2();
+            for (u2 i = 0; i < attributes_count && reader.valid(); ++i) {
+                u2 name_index = reader.get_u2();
+                u4 length = reader.get_u4();
+                reader.skip(length);
+                out_.put("    .attribute ");
+                put_utf8(name_index);
+                out_.put(' ').put_number(length).put('\n');
+            }
+        }
+
+    private:
+        void
+        put_jump(ByteReader &code, u4 pc, bool wide)
+        {
+            int32_t offset = wide ? static_cast<int32_t>(code.get_u4()) : static_cast<int16_t>(code.get_u2());
+            out_.put(' ').put_number(static_cast<int64_t>(pc) + offset);
+        }
+
+        void
+        put_case(int64_t key, u4 pc, int32_t offset)
+        {
+            out_.put("            ").put_number(key).put(": ").put_number(static_cast<int64_t>(pc) + offset);
+            out_.put('\n');
+        }
+
+        void
+        put_switch(ByteReader &code, u4 pc, bool table)
+        {
+            // the operands are aligned to four bytes from the start of the code
+            code.skip((4 - code.position() % 4) % 4);
+            auto default_offset = static_cast<int32_t>(code.get_u4());
+            if (table) {
+                auto low = static_cast<int32_t>(code.get_u4());
+                auto high = static_cast<int32_t>(code.get_u4());
+                out_.put(' ').put_number(low).put(' ').put_number(high).put('\n');
+                for (int64_t key = low; key <= high && code.valid(); ++key)
+                    put_case(key, pc, static_cast<int32_t>(code.get_u4()));
+            } else {
+                u4 pairs = code.get_u4();
+                out_.put(' ').put_number(pairs).put('\n');
+                for (u4 i = 0; i < pairs && code.valid(); ++i) {
+                    auto key = static_cast<int32_t>(code.get_u4());
+                    put_case(key, pc, static_cast<int32_t>(code.get_u4()));
+                }
+            }
+            out_.put("            default: ").put_number(static_cast<int64_t>(pc) + default_offset);
+        }
+
+        void
+        put_instructions(ByteReader code)
+        {
+            while (!code.at_end()) {
+                auto pc = static_cast<u4>(code.position());
+                u1 opcode = code.get_u1();
+                out_.put("    ").put_padded(pc, 5).put(": ");
+                if (opcode > LastOpcode) {
+                    out_.put("; invalid opcode ").put_number(opcode).put('\n');
+                    return;
+                }
+                out_.put(InstructionMnemonics[opcode]);
+                switch (opcode) {
+                case 0x10: // bipush
+                    out_.put(' ').put_number(static_cast<int8_t>(code.get_u1()));
+                    break;
+                case 0x11: // sipush
+                    out_.put(' ').put_number(static_cast<int16_t>(code.get_u2()));
+                    break;
+                case 0x12: // ldc
+                    out_.put(' ');
+                    put_constant(code.get_u1());
+                    break;
+                case 0x84: { // iinc
+                    u1 local = code.get_u1();
+                    out_.put(' ').put_number(local).put(' ').put_number(static_cast<int8_t>(code.get_u1()));
+                    break;
+                }
+                case 0xaa: // tableswitch
+                case 0xab: // lookupswitch
+                    put_switch(code, pc, opcode == 0xaa);
+                    break;
+                case 0xb9: // invokeinterface
+                    out_.put(' ');
+                    put_constant(code.get_u2());
+                    out_.put(' ').put_number(code.get_u1());
+                    code.skip(1);
+                    break;
+                case 0xba: // invokedynamic
+                    out_.put(' ');
+                    put_constant(code.get_u2());
+                    code.skip(2);
+                    break;
+                case 0xbc: { // newarray
+                    u1 type = code.get_u1();
+                    out_.put(' ');
+                    if (type < sizeof(ArrayTypes) / sizeof(ArrayTypes[0]) && ArrayTypes[type][0] != '\0')
+                        out_.put(ArrayTypes[type]);
+                    else
+                        out_.put_number(type);
+                    break;
+                }
+                case 0xc4: { // wide
+                    u1 modified = code.get_u1();
+                    out_.put(' ').put(modified <= LastOpcode ? InstructionMnemonics[modified] : "?");
+                    out_.put(' ').put_number(code.get_u2());
+                    if (modified == 0x84)
+                        out_.put(' ').put_number(static_cast<int16_t>(code.get_u2()));
+                    break;
+                }
+                case 0xc5: // multianewarray
+                    out_.put(' ');
+                    put_constant(code.get_u2());
+                    out_.put(' ').put_number(code.get_u1());
+                    break;
+                case 0xc8: // goto_w
+                case 0xc9: // jsr_w
+                    put_jump(code, pc, true);
+                    break;
+                default:
+                    if ((opcode >= 0x99 && opcode <= 0xa8) || opcode == 0xc6 || opcode == 0xc7) {
+                        put_jump(code, pc, false);
+                    } else if (refers_to_constant(opcode)) {
+                        out_.put(' ');
+                        put_constant(code.get_u2());
+                    } else {
+                        // local variable indices and the instructions without operands
+                        for (u2 i = 0; i < InstructionInfo[opcode][0]; ++i)
+                            out_.put(' ').put_number(code.get_u1());
+                    }
+                }
+                if (!code.valid()) {
+                    out_.put(" ; truncated\n");
+                    return;
+                }
+                out_.put('\n');
+            }
+        }
+    };
+
+    /**
+     * @return bytecode of an attribute including its name and length.
+     */
+    static std::string
+    attribute_bytes(const Attribute &attribute)
+    {
+        std::string bytes;
+        bytes.reserve(attribute.length() + 6);
+        StringBuffer buffer(bytes);
+        std::ostream os(&buffer);
+        attribute.emit_bytecode(os);
+        return bytes;
+    }
+
+    static bool
+    is_attribute(const ConstantPool &pool, const std::string &bytes, const char *name)
+    {
+        u2 name_index = (static_cast<u1>(bytes[0]) << 8u) | static_cast<u1>(bytes[1]);
+        if (name_index == 0 || name_index > pool.count())
+            return false;
+        auto utf8 = dynamic_cast<const Utf8Constant *>(pool.get(name_index));
+        return utf8 != nullptr && utf8->value() == name;
+    }
+
+    void
+    Disassembler::disassemble(const Class &clazz, std::string &text) const
+    {
+        const ConstantPool &pool = clazz.constant_pool_;
+        ClassPrinter printer(pool, text);
+        TextWriter &out = printer.out();
+
+        out.put(".class ").put_flags(clazz.access_flags_, ClassFlags);
+        printer.put_constant(clazz.this_class_);
+        out.put("\n.version ").put_number(clazz.major_version_).put(' ').put_number(clazz.minor_version_).put('\n');
+        if (clazz.super_class_ != 0) {
+            out.put(".super ");
+            printer.put_constant(clazz.super_class_);
+            out.put('\n');
+        }
+        for (u2 interface : clazz.interfaces_) {
+            out.put(".implements ");
+            printer.put_constant(interface);
+            out.put('\n');
+        }
+        for (auto &attribute : clazz.attributes())
+            printer.put_attribute(attribute_bytes(*attribute), "");
+        out.put('\n');
+
+        if (options_.constant_pool)
+            printer.put_constant_pool();
+
+        for (auto &field : clazz.fields_) {
+            out.put(".field ").put_flags(field.access_flags(), FieldFlags);
+            printer.put_utf8(field.name_index());
+            out.put(' ');
+            printer.put_utf8(field.descriptor_index());
+
+            std::vector<std::string> attributes;
+            for (auto &attribute : field.attributes()) {
+                std::string bytes = attribute_bytes(*attribute);
+                if (bytes.size() == 8 && is_attribute(pool, bytes, "ConstantValue")) {
+                    out.put(" = ");
+                    printer.put_constant((static_cast<u1>(bytes[6]) << 8u) | static_cast<u1>(bytes[7]));
+                } else {
+                    attributes.push_back(std::move(bytes));
+                }
+            }
+            out.put('\n');
+            for (auto &bytes : attributes)
+                printer.put_attribute(bytes, "    ");
+        }
+        if (!clazz.fields_.empty())
+            out.put('\n');
+
+        for (auto &method : clazz.methods_) {
+            out.put(".method ").put_flags(method.access_flags(), MethodFlags);
+            printer.put_utf8(method.name_index());
+            printer.put_utf8(method.descriptor_index());
+            out.put('\n');
+            for (auto &attribute : method.attributes()) {
+                std::string bytes = attribute_bytes(*attribute);
+                if (is_attribute(pool, bytes, "Code"))
+                    printer.put_code(bytes);
+                else
+                    printer.put_attribute(bytes, "    ");
+            }
+            out.put(".end method\n\n");
+        }
+    }
+
+}
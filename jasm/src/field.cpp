@@ -42,4 +42,12 @@ namespace jasm {
             attr->emit_bytecode(os);
     }
 
+    bool
+    Field::visit_constants(const ConstantVisitor &visitor)
+    {
+        visitor(name_index_);
+        visitor(descriptor_index_);
+        return visit_attribute_constants(visitor);
+    }
+
 }
@@ -8,9 +8,148 @@
  * Copyright (c) 2021 Peter Grajcar
  */
 #include "instruction.hpp"
+#include <algorithm>
 
 namespace jasm {
 
+    int32_t
+    SwitchInstruction::offset_of(Label label, const std::vector<u4> &label_positions) const
+    {
+        return static_cast<int32_t>(static_cast<int64_t>(label_positions[label]) - position_);
+    }
+
+    TableSwitch::TableSwitch(int32_t low, Label default_label, std::vector<Label> labels)
+      : SwitchInstruction(default_label)
+      , low_(low)
+      , labels_(std::move(labels))
+      , offsets_(labels_.size())
+    {
+        assert(!labels_.empty());
+    }
+
+    TableSwitch::TableSwitch(std::istream *is, u4 position)
+      : SwitchInstruction(0)
+    {
+        position_ = position;
+        for (u4 i = 0; i < padding(); ++i)
+            read_big_endian<u1>(*is);
+        default_offset_ = static_cast<int32_t>(read_big_endian<u4>(*is));
+        low_ = static_cast<int32_t>(read_big_endian<u4>(*is));
+        auto high = static_cast<int32_t>(read_big_endian<u4>(*is));
+        assert(low_ <= high);
+        offsets_.resize(static_cast<int64_t>(high) - low_ + 1);
+        for (auto &offset : offsets_)
+            offset = static_cast<int32_t>(read_big_endian<u4>(*is));
+    }
+
+    void
+    TableSwitch::resolve(const std::vector<u4> &label_positions)
+    {
+        default_offset_ = offset_of(default_label_, label_positions);
+        for (std::size_t i = 0; i < labels_.size(); ++i)
+            offsets_[i] = offset_of(labels_[i], label_positions);
+    }
+
+    std::vector<Label>
+    TableSwitch::labels() const
+    {
+        std::vector<Label> labels{ default_label_ };
+        labels.insert(labels.end(), labels_.begin(), labels_.end());
+        return labels;
+    }
+
+    void
+    TableSwitch::jasm(std::ostream &os, const ConstantPool *pool) const
+    {
+        os << std::setw(19) << mnemonic() << ' ' << low_ << " to " << low_ + static_cast<int64_t>(offsets_.size()) - 1
+           << std::endl;
+        for (std::size_t i = 0; i < offsets_.size(); ++i)
+            os << std::setw(24) << "" << low_ + static_cast<int64_t>(i) << ": @" << position_ + offsets_[i]
+               << std::endl;
+        os << std::setw(24) << "" << "default: @" << position_ + default_offset_ << std::endl;
+    }
+
+    void
+    TableSwitch::emit_bytecode(std::ostream &os) const
+    {
+        write_big_endian<u1>(os, opcode());
+        for (u4 i = 0; i < padding(); ++i)
+            write_big_endian<u1>(os, 0);
+        write_big_endian<u4>(os, static_cast<u4>(default_offset_));
+        write_big_endian<u4>(os, static_cast<u4>(low_));
+        write_big_endian<u4>(os, static_cast<u4>(low_ + static_cast<int32_t>(offsets_.size()) - 1));
+        for (int32_t offset : offsets_)
+            write_big_endian<u4>(os, static_cast<u4>(offset));
+    }
+
+    LookupSwitch::LookupSwitch(Label default_label, std::vector<std::pair<int32_t, Label>> cases)
+      : SwitchInstruction(default_label)
+      , offsets_(cases.size())
+    {
+        // the keys have to be sorted, so that the virtual machine can use a binary search
+        std::sort(cases.begin(), cases.end());
+        for (auto &[key, label] : cases) {
+            assert(keys_.empty() || keys_.back() != key);
+            keys_.push_back(key);
+            labels_.push_back(label);
+        }
+    }
+
+    LookupSwitch::LookupSwitch(std::istream *is, u4 position)
+      : SwitchInstruction(0)
+    {
+        position_ = position;
+        for (u4 i = 0; i < padding(); ++i)
+            read_big_endian<u1>(*is);
+        default_offset_ = static_cast<int32_t>(read_big_endian<u4>(*is));
+        u4 pair_count = read_big_endian<u4>(*is);
+        keys_.resize(pair_count);
+        offsets_.resize(pair_count);
+        for (u4 i = 0; i < pair_count; ++i) {
+            keys_[i] = static_cast<int32_t>(read_big_endian<u4>(*is));
+            offsets_[i] = static_cast<int32_t>(read_big_endian<u4>(*is));
+        }
+    }
+
+    void
+    LookupSwitch::resolve(const std::vector<u4> &label_positions)
+    {
+        default_offset_ = offset_of(default_label_, label_positions);
+        for (std::size_t i = 0; i < labels_.size(); ++i)
+            offsets_[i] = offset_of(labels_[i], label_positions);
+    }
+
+    std::vector<Label>
+    LookupSwitch::labels() const
+    {
+        std::vector<Label> labels{ default_label_ };
+        labels.insert(labels.end(), labels_.begin(), labels_.end());
+        return labels;
+    }
+
+    void
+    LookupSwitch::jasm(std::ostream &os, const ConstantPool *pool) const
+    {
+        os << std::setw(19) << mnemonic() << ' ' << keys_.size() << std::endl;
+        for (std::size_t i = 0; i < keys_.size(); ++i)
+            os << std::setw(24) << "" << keys_[i] << ": @" << position_ + offsets_[i] << std::endl;
+        os << std::setw(24) << "" << "default: @" << position_ + default_offset_ << std::endl;
+    }
+
+    void
+    LookupSwitch::emit_bytecode(std::ostream &os) const
+    {
+        write_big_endian<u1>(os, opcode());
+        for (u4 i = 0; i < padding(); ++i)
+            write_big_endian<u1>(os, 0);
+        write_big_endian<u4>(os, static_cast<u4>(default_offset_));
+        write_big_endian<u4>(os, keys_.size());
+        for (std::size_t i = 0; i < keys_.size(); ++i) {
+            write_big_endian<u4>(os, static_cast<u4>(keys_[i]));
+            write_big_endian<u4>(os, static_cast<u4>(offsets_[i]));
+        }
+    }
+
     template<>
     void
     GetStatic::jasm(std::ostream &os, const ConstantPool *pool) const
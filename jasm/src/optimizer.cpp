@@ -0,0 +1,1858 @@
+/**
+ * @file optimizer.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "optimizer.hpp"
+
+namespace jasm {
+
+    using VerificationType = StackMapTableAttribute::VerificationType;
+
+    static constexpr u1 Goto = 0xa7;
+    static constexpr u1 GotoW = 0xc8;
+    static constexpr u1 TableSwitchOpcode = 0xaa;
+    static constexpr u1 LookupSwitchOpcode = 0xab;
+
+    /**
+     * operand stack slots popped, pushed; the instructions referring to fields and methods are computed from the
+     * descriptors
+     */
+    static constexpr u1 StackSlots[][2] = {
+        { 0, 0 }, // 0x00 nop
+        { 0, 1 }, // 0x01 aconst_null
+        { 0, 1 }, // 0x02 iconst_m1
+        { 0, 1 }, // 0x03 iconst_0
+        { 0, 1 }, // 0x04 iconst_1
+        { 0, 1 }, // 0x05 iconst_2
+        { 0, 1 }, // 0x06 iconst_3
+        { 0, 1 }, // 0x07 iconst_4
+        { 0, 1 }, // 0x08 iconst_5
+        { 0, 2 }, // 0x09 lconst_0
+        { 0, 2 }, // 0x0a lconst_1
+        { 0, 1 }, // 0x0b fconst_0
+        { 0, 1 }, // 0x0c fconst_1
+        { 0, 1 }, // 0x0d fconst_2
+        { 0, 2 }, // 0x0e dconst_0
+        { 0, 2 }, // 0x0f dconst_1
+        { 0, 1 }, // 0x10 bipush
+        { 0, 1 }, // 0x11 sipush
+        { 0, 1 }, // 0x12 ldc
+        { 0, 1 }, // 0x13 ldc_w
+        { 0, 2 }, // 0x14 ldc2_w
+        { 0, 1 }, // 0x15 iload
+        { 0, 2 }, // 0x16 lload
+        { 0, 1 }, // 0x17 fload
+        { 0, 2 }, // 0x18 dload
+        { 0, 1 }, // 0x19 aload
+        { 0, 1 }, // 0x1a iload_0
+        { 0, 1 }, // 0x1b iload_1
+        { 0, 1 }, // 0x1c iload_2
+        { 0, 1 }, // 0x1d iload_3
+        { 0, 2 }, // 0x1e lload_0
+        { 0, 2 }, // 0x1f lload_1
+        { 0, 2 }, // 0x20 lload_2
+        { 0, 2 }, // 0x21 lload_3
+        { 0, 1 }, // 0x22 fload_0
+        { 0, 1 }, // 0x23 fload_1
+        { 0, 1 }, // 0x24 fload_2
+        { 0, 1 }, // 0x25 fload_3
+        { 0, 2 }, // 0x26 dload_0
+        { 0, 2 }, // 0x27 dload_1
+        { 0, 2 }, // 0x28 dload_2
+        { 0, 2 }, // 0x29 dload_3
+        { 0, 1 }, // 0x2a aload_0
+        { 0, 1 }, // 0x2b aload_1
+        { 0, 1 }, // 0x2c aload_2
+        { 0, 1 }, // 0x2d aload_3
+        { 2, 1 }, // 0x2e iaload
+        { 2, 2 }, // 0x2f laload
+        { 2, 1 }, // 0x30 faload
+        { 2, 2 }, // 0x31 daload
+        { 2, 1 }, // 0x32 aaload
+        { 2, 1 }, // 0x33 baload
+        { 2, 1 }, // 0x34 caload
+        { 2, 1 }, // 0x35 saload
+        { 1, 0 }, // 0x36 istore
+        { 2, 0 }, // 0x37 lstore
+        { 1, 0 }, // 0x38 fstore
+        { 2, 0 }, // 0x39 dstore
+        { 1, 0 }, // 0x3a astore
+        { 1, 0 }, // 0x3b istore_0
+        { 1, 0 }, // 0x3c istore_1
+        { 1, 0 }, // 0x3d istore_2
+        { 1, 0 }, // 0x3e istore_3
+        { 2, 0 }, // 0x3f lstore_0
+        { 2, 0 }, // 0x40 lstore_1
+        { 2, 0 }, // 0x41 lstore_2
+        { 2, 0 }, // 0x42 lstore_3
+        { 1, 0 }, // 0x43 fstore_0
+        { 1, 0 }, // 0x44 fstore_1
+        { 1, 0 }, // 0x45 fstore_2
+        { 1, 0 }, // 0x46 fstore_3
+        { 2, 0 }, // 0x47 dstore_0
+        { 2, 0 }, // 0x48 dstore_1
+        { 2, 0 }, // 0x49 dstore_2
+        { 2, 0 }, // 0x4a dstore_3
+        { 1, 0 }, // 0x4b astore_0
+        { 1, 0 }, // 0x4c astore_1
+        { 1, 0 }, // 0x4d astore_2
+        { 1, 0 }, // 0x4e astore_3
+        { 3, 0 }, // 0x4f iastore
+        { 4, 0 }, // 0x50 lastore
+        { 3, 0 }, // 0x51 fastore
+        { 4, 0 }, // 0x52 dastore
+        { 3, 0 }, // 0x53 aastore
+        { 3, 0 }, // 0x54 bastore
+        { 3, 0 }, // 0x55 castore
+        { 3, 0 }, // 0x56 sastore
+        { 1, 0 }, // 0x57 pop
+        { 2, 0 }, // 0x58 pop2
+        { 1, 2 }, // 0x59 dup
+        { 2, 3 }, // 0x5a dup_x1
+        { 3, 4 }, // 0x5b dup_x2
+        { 2, 4 }, // 0x5c dup2
+        { 3, 5 }, // 0x5d dup2_x1
+        { 4, 6 }, // 0x5e dup2_x2
+        { 2, 2 }, // 0x5f swap
+        { 2, 1 }, // 0x60 iadd
+        { 4, 2 }, // 0x61 ladd
+        { 2, 1 }, // 0x62 fadd
+        { 4, 2 }, // 0x63 dadd
+        { 2, 1 }, // 0x64 isub
+        { 4, 2 }, // 0x65 lsub
+        { 2, 1 }, // 0x66 fsub
+        { 4, 2 }, // 0x67 dsub
+        { 2, 1 }, // 0x68 imul
+        { 4, 2 }, // 0x69 lmul
+        { 2, 1 }, // 0x6a fmul
+        { 4, 2 }, // 0x6b dmul
+        { 2, 1 }, // 0x6c idiv
+        { 4, 2 }, // 0x6d ldiv
+        { 2, 1 }, // 0x6e fdiv
+        { 4, 2 }, // 0x6f ddiv
+        { 2, 1 }, // 0x70 irem
+        { 4, 2 }, // 0x71 lrem
+        { 2, 1 }, // 0x72 frem
+        { 4, 2 }, // 0x73 drem
+        { 1, 1 }, // 0x74 ineg
+        { 2, 2 }, // 0x75 lneg
+        { 1, 1 }, // 0x76 fneg
+        { 2, 2 }, // 0x77 dneg
+        { 2, 1 }, // 0x78 ishl
+        { 3, 2 }, // 0x79 lshl
+        { 2, 1 }, // 0x7a ishr
+        { 3, 2 }, // 0x7b lshr
+        { 2, 1 }, // 0x7c iushr
+        { 3, 2 }, // 0x7d lushr
+        { 2, 1 }, // 0x7e iand
+        { 4, 2 }, // 0x7f land
+        { 2, 1 }, // 0x80 ior
+        { 4, 2 }, // 0x81 lor
+        { 2, 1 }, // 0x82 ixor
+        { 4, 2 }, // 0x83 lxor
+        { 0, 0 }, // 0x84 iinc
+        { 1, 2 }, // 0x85 i2l
+        { 1, 1 }, // 0x86 i2f
+        { 1, 2 }, // 0x87 i2d
+        { 2, 1 }, // 0x88 l2i
+        { 2, 1 }, // 0x89 l2f
+        { 2, 2 }, // 0x8a l2d
+        { 1, 1 }, // 0x8b f2i
+        { 1, 2 }, // 0x8c f2l
+        { 1, 2 }, // 0x8d f2d
+        { 2, 1 }, // 0x8e d2i
+        { 2, 2 }, // 0x8f d2l
+        { 2, 1 }, // 0x90 d2f
+        { 1, 1 }, // 0x91 i2b
+        { 1, 1 }, // 0x92 i2c
+        { 1, 1 }, // 0x93 i2s
+        { 4, 1 }, // 0x94 lcmp
+        { 2, 1 }, // 0x95 fcmpl
+        { 2, 1 }, // 0x96 fcmpg
+        { 4, 1 }, // 0x97 dcmpl
+        { 4, 1 }, // 0x98 dcmpg
+        { 1, 0 }, // 0x99 ifeq
+        { 1, 0 }, // 0x9a ifne
+        { 1, 0 }, // 0x9b iflt
+        { 1, 0 }, // 0x9c ifge
+        { 1, 0 }, // 0x9d ifgt
+        { 1, 0 }, // 0x9e ifle
+        { 2, 0 }, // 0x9f if_icmpeq
+        { 2, 0 }, // 0xa0 if_icmpne
+        { 2, 0 }, // 0xa1 if_icmplt
+        { 2, 0 }, // 0xa2 if_icmpge
+        { 2, 0 }, // 0xa3 if_icmpgt
+        { 2, 0 }, // 0xa4 if_icmple
+        { 2, 0 }, // 0xa5 if_acmpeq
+        { 2, 0 }, // 0xa6 if_acmpne
+        { 0, 0 }, // 0xa7 goto
+        { 0, 1 }, // 0xa8 jsr
+        { 0, 0 }, // 0xa9 ret
+        { 1, 0 }, // 0xaa tableswitch
+        { 1, 0 }, // 0xab lookupswitch
+        { 1, 0 }, // 0xac ireturn
+        { 2, 0 }, // 0xad lreturn
+        { 1, 0 }, // 0xae freturn
+        { 2, 0 }, // 0xaf dreturn
+        { 1, 0 }, // 0xb0 areturn
+        { 0, 0 }, // 0xb1 return
+        { 0, 0 }, // 0xb2 getstatic
+        { 0, 0 }, // 0xb3 putstatic
+        { 0, 0 }, // 0xb4 getfield
+        { 0, 0 }, // 0xb5 putfield
+        { 0, 0 }, // 0xb6 invokevirtual
+        { 0, 0 }, // 0xb7 invokespecial
+        { 0, 0 }, // 0xb8 invokestatic
+        { 0, 0 }, // 0xb9 invokeinterface
+        { 0, 0 }, // 0xba invokedynamic
+        { 0, 1 }, // 0xbb new
+        { 1, 1 }, // 0xbc newarray
+        { 1, 1 }, // 0xbd anewarray
+        { 1, 1 }, // 0xbe arraylength
+        { 1, 0 }, // 0xbf athrow
+        { 1, 1 }, // 0xc0 checkcast
+        { 1, 1 }, // 0xc1 instanceof
+        { 1, 0 }, // 0xc2 monitorenter
+        { 1, 0 }, // 0xc3 monitorexit
+        { 0, 0 }, // 0xc4 wide
+        { 0, 1 }, // 0xc5 multianewarray
+        { 1, 0 }, // 0xc6 ifnull
+        { 1, 0 }, // 0xc7 ifnonnull
+        { 0, 0 }, // 0xc8 goto_w
+        { 0, 1 }, // 0xc9 jsr_w
+    };
+
+    static u2
+    get_u2(const std::vector<u1> &bytes, std::size_t at)
+    {
+        return (bytes[at] << 8u) | bytes[at + 1];
+    }
+
+    static u4
+    get_u4(const std::vector<u1> &bytes, std::size_t at)
+    {
+        return (get_u2(bytes, at) << 16u) | get_u2(bytes, at + 2);
+    }
+
+    static void
+    put_u2(std::vector<u1> &bytes, u2 value)
+    {
+        bytes.push_back(U2_HIGH(value));
+        bytes.push_back(U2_LOW(value));
+    }
+
+    static void
+    put_u4(std::vector<u1> &bytes, u4 value)
+    {
+        put_u2(bytes, value >> 16u);
+        put_u2(bytes, value & 0xFFFFu);
+    }
+
+    static const Utf8Constant *
+    utf8_constant(const ConstantPool &pool, u2 index)
+    {
+        if (index == 0 || index > pool.count())
+            return nullptr;
+        return dynamic_cast<const Utf8Constant *>(pool.get(index));
+    }
+
+    /**
+     * Number of the slots taken by a value of a type given by the first character of its descriptor.
+     */
+    static u2
+    type_slots(char prefix)
+    {
+        switch (prefix) {
+        case LongTypePrefix:
+        case DoubleTypePrefix:
+            return 2;
+        case VoidTypePrefix:
+            return 0;
+        default:
+            return 1;
+        }
+    }
+
+    /**
+     * Splits a method descriptor into the descriptors of its parameter types.
+     *
+     * @param descriptor method descriptor.
+     * @param parameters receives the parameter descriptors.
+     * @param return_prefix receives the first character of the return type descriptor.
+     * @return false if the descriptor is malformed.
+     */
+    static bool
+    parameter_types(const std::string &descriptor, std::vector<std::string> &parameters, char &return_prefix)
+    {
+        if (descriptor.empty() || descriptor[0] != '(')
+            return false;
+        std::size_t i = 1;
+        while (i < descriptor.size() && descriptor[i] != ')') {
+            std::size_t begin = i;
+            while (i < descriptor.size() && descriptor[i] == ArrayTypePrefix)
+                ++i;
+            if (i < descriptor.size() && descriptor[i] == ClassTypePrefix)
+                i = descriptor.find(';', i);
+            if (i >= descriptor.size())
+                return false;
+            ++i;
+            parameters.push_back(descriptor.substr(begin, i - begin));
+        }
+        if (i + 1 >= descriptor.size())
+            return false;
+        return_prefix = descriptor[i + 1];
+        return true;
+    }
+
+    static u4
+    parameter_slots(const std::vector<std::string> &parameters)
+    {
+        u4 slots = 0;
+        for (auto &parameter : parameters)
+            slots += type_slots(parameter[0]);
+        return slots;
+    }
+
+    /**
+     * Descriptor of the member referred to by a field, method or call site constant.
+     */
+    static const std::string *
+    member_descriptor(const ConstantPool &pool, u2 index)
+    {
+        if (index == 0 || index > pool.count())
+            return nullptr;
+        const Constant *constant = pool.get(index);
+        u2 name_and_type_index;
+        if (auto field = dynamic_cast<const FieldRefConstant *>(constant))
+            name_and_type_index = field->name_and_type_index();
+        else if (auto method = dynamic_cast<const MethodRefConstant *>(constant))
+            name_and_type_index = method->name_and_type_index();
+        else if (auto interface_method = dynamic_cast<const InterfaceMethodRefConstant *>(constant))
+            name_and_type_index = interface_method->name_and_type_index();
+        else if (auto call_site = dynamic_cast<const InvokeDynamicConstant *>(constant))
+            name_and_type_index = call_site->name_and_type_index();
+        else
+            return nullptr;
+
+        if (name_and_type_index == 0 || name_and_type_index > pool.count())
+            return nullptr;
+        auto name_and_type = dynamic_cast<const NameAndTypeConstant *>(pool.get(name_and_type_index));
+        if (name_and_type == nullptr)
+            return nullptr;
+        auto descriptor = utf8_constant(pool, name_and_type->descriptor_index());
+        return descriptor != nullptr ? &descriptor->value() : nullptr;
+    }
+
+    /**
+     * Bounds checked reader of the body of an attribute, which records the positions of the constant pool indices.
+     */
+    class AttributeScanner
+    {
+    private:
+        const std::vector<u1> &bytes_;
+        std::size_t position_ = 0;
+        bool valid_ = true;
+
+    public:
+        std::vector<u4> constants;
+
+        explicit AttributeScanner(const std::vector<u1> &bytes)
+          : bytes_(bytes)
+        {}
+
+        inline bool
+        available(std::size_t count)
+        {
+            if (position_ + count > bytes_.size())
+                valid_ = false;
+            return valid_;
+        }
+
+        inline bool
+        valid() const
+        {
+            return valid_;
+        }
+
+        /**
+         * @return true if the whole body has been read.
+         */
+        inline bool
+        complete() const
+        {
+            return valid_ && position_ == bytes_.size();
+        }
+
+        inline void
+        fail()
+        {
+            valid_ = false;
+        }
+
+        inline void
+        skip(std::size_t count)
+        {
+            if (available(count))
+                position_ += count;
+        }
+
+        inline u1
+        read_u1()
+        {
+            return available(1) ? bytes_[position_++] : 0;
+        }
+
+        inline u2
+        read_u2()
+        {
+            if (!available(2))
+                return 0;
+            position_ += 2;
+            return get_u2(bytes_, position_ - 2);
+        }
+
+        /**
+         * Reads a constant pool index.
+         *
+         * @param optional whether the index may be zero, which stands for no constant.
+         */
+        inline void
+        constant(bool optional = false)
+        {
+            u4 position = position_;
+            u2 index = read_u2();
+            if (index != 0)
+                constants.push_back(position);
+            else if (!optional)
+                valid_ = false;
+        }
+    };
+
+    static void
+    scan_element_value(AttributeScanner &scanner);
+
+    static void
+    scan_annotation(AttributeScanner &scanner)
+    {
+        scanner.constant();
+        for (u2 pairs = scanner.read_u2(); pairs > 0 && scanner.valid(); --pairs) {
+            scanner.constant();
+            scan_element_value(scanner);
+        }
+    }
+
+    static void
+    scan_annotations(AttributeScanner &scanner)
+    {
+        for (u2 count = scanner.read_u2(); count > 0 && scanner.valid(); --count)
+            scan_annotation(scanner);
+    }
+
+    static void
+    scan_element_value(AttributeScanner &scanner)
+    {
+        switch (scanner.read_u1()) {
+        case 'B':
+        case 'C':
+        case 'D':
+        case 'F':
+        case 'I':
+        case 'J':
+        case 'S':
+        case 'Z':
+        case 's':
+        case 'c':
+            scanner.constant();
+            break;
+        case 'e':
+            scanner.constant();
+            scanner.constant();
+            break;
+        case '@':
+            scan_annotation(scanner);
+            break;
+        case '[':
+            for (u2 count = scanner.read_u2(); count > 0 && scanner.valid(); --count)
+                scan_element_value(scanner);
+            break;
+        default:
+            scanner.fail();
+        }
+    }
+
+    static void
+    scan_verification_types(AttributeScanner &scanner, std::size_t count)
+    {
+        for (; count > 0 && scanner.valid(); --count) {
+            u1 tag = scanner.read_u1();
+            if (tag == VerificationType::ITEM_OBJECT)
+                scanner.constant();
+            else if (tag == VerificationType::ITEM_UNINITIALIZED)
+                scanner.skip(2);
+            else if (tag > VerificationType::ITEM_UNINITIALIZED)
+                scanner.fail();
+        }
+    }
+
+    static void
+    scan_stack_map_table(AttributeScanner &scanner)
+    {
+        for (u2 count = scanner.read_u2(); count > 0 && scanner.valid(); --count) {
+            u1 type = scanner.read_u1();
+            if (type < 64)
+                continue;
+            if (type < 128) {
+                scan_verification_types(scanner, 1);
+                continue;
+            }
+            if (type < 247) {
+                scanner.fail();
+                continue;
+            }
+            scanner.skip(2);
+            if (type == 247) {
+                scan_verification_types(scanner, 1);
+            } else if (type > 251 && type < 255) {
+                scan_verification_types(scanner, type - 251);
+            } else if (type == 255) {
+                scan_verification_types(scanner, scanner.read_u2());
+                scan_verification_types(scanner, scanner.read_u2());
+            }
+        }
+    }
+
+    /**
+     * Finds the constant pool indices in the body of an attribute.
+     *
+     * @return false if the layout of the attribute is not known or the body is malformed.
+     */
+    static bool
+    scan_attribute(const std::string &name, AttributeScanner &scanner)
+    {
+        if (name == "Deprecated" || name == "Synthetic") {
+            // no body
+        } else if (name == "LineNumberTable") {
+            scanner.skip(4 * scanner.read_u2());
+        } else if (name == "Signature" || name == "NestHost") {
+            scanner.constant();
+        } else if (name == "Exceptions" || name == "NestMembers" || name == "PermittedSubclasses") {
+            for (u2 count = scanner.read_u2(); count > 0 && scanner.valid(); --count)
+                scanner.constant();
+        } else if (name == "LocalVariableTable" || name == "LocalVariableTypeTable") {
+            for (u2 count = scanner.read_u2(); count > 0 && scanner.valid(); --count) {
+                scanner.skip(4);
+                scanner.constant();
+                scanner.constant();
+                scanner.skip(2);
+            }
+        } else if (name == "InnerClasses") {
+            // the outer class and the name are missing for local and anonymous classes
+            for (u2 count = scanner.read_u2(); count > 0 && scanner.valid(); --count) {
+                scanner.constant();
+                scanner.constant(true);
+                scanner.constant(true);
+                scanner.skip(2);
+            }
+        } else if (name == "EnclosingMethod") {
+            scanner.constant();
+            scanner.constant(true);
+        } else if (name == "MethodParameters") {
+            for (u1 count = scanner.read_u1(); count > 0 && scanner.valid(); --count) {
+                scanner.constant(true);
+                scanner.skip(2);
+            }
+        } else if (name == "RuntimeVisibleAnnotations" || name == "RuntimeInvisibleAnnotations") {
+            scan_annotations(scanner);
+        } else if (name == "RuntimeVisibleParameterAnnotations" || name == "RuntimeInvisibleParameterAnnotations") {
+            for (u1 count = scanner.read_u1(); count > 0 && scanner.valid(); --count)
+                scan_annotations(scanner);
+        } else if (name == "AnnotationDefault") {
+            scan_element_value(scanner);
+        } else if (name == "StackMapTable") {
+            scan_stack_map_table(scanner);
+        } else {
+            return false;
+        }
+        return scanner.complete();
+    }
+
+    /**
+     * Verification type of a decoded stack map frame. The types of the parameters in the implicit frame of the method
+     * entry are identified by the names of their classes, because the class constants may be missing.
+     */
+    struct FrameType
+    {
+        VerificationType::Tag tag;
+        // class constant of an object, position of the new instruction of an uninitialised object
+        u2 index = 0;
+        // name of the class of an object without a class constant
+        std::string name;
+
+        FrameType(VerificationType::Tag tag, u2 index = 0, std::string name = {})
+          : tag(tag)
+          , index(index)
+          , name(std::move(name))
+        {}
+
+        inline bool
+        operator==(const FrameType &other) const
+        {
+            return tag == other.tag && index == other.index && name == other.name;
+        }
+
+        inline bool
+        operator!=(const FrameType &other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    /**
+     * Stack map frame. Long and double values take up a single entry.
+     */
+    struct DecodedFrame
+    {
+        u4 position;
+        std::vector<FrameType> locals;
+        std::vector<FrameType> stack;
+
+        explicit DecodedFrame(u4 position = 0)
+          : position(position)
+        {}
+    };
+
+    /**
+     * Class constants of a class by the names of the classes, the missing constants are added when a frame needs
+     * them.
+     */
+    class ClassConstants
+    {
+    private:
+        ConstantPool &pool_;
+        std::map<std::string, u2> utf8_;
+        std::map<std::string, u2> classes_;
+
+    public:
+        explicit ClassConstants(ConstantPool &pool)
+          : pool_(pool)
+        {
+            for (std::size_t i = 1; i <= pool.count(); ++i) {
+                if (auto utf8 = dynamic_cast<const Utf8Constant *>(pool.get(i)))
+                    utf8_.try_emplace(utf8->value(), i);
+            }
+            for (std::size_t i = 1; i <= pool.count(); ++i) {
+                auto class_constant = dynamic_cast<const ClassConstant *>(pool.get(i));
+                if (class_constant == nullptr)
+                    continue;
+                if (auto name = utf8_constant(pool, class_constant->name_index()))
+                    classes_.try_emplace(name->value(), i);
+            }
+        }
+
+        /**
+         * @return index of the class constant, 0 if there is none.
+         */
+        inline u2
+        find(const std::string &name) const
+        {
+            auto search = classes_.find(name);
+            return search != classes_.end() ? search->second : 0;
+        }
+
+        /**
+         * @return index of the class constant, which is added if it is missing, or 0 if the constant pool is full.
+         */
+        u2
+        get(const std::string &name)
+        {
+            if (u2 index = find(name))
+                return index;
+            if (pool_.count() + 2 >= 0xFFFF)
+                return 0;
+            auto utf8 = utf8_.find(name);
+            if (utf8 == utf8_.end())
+                utf8 = utf8_.emplace(name, pool_.make_constant<Utf8Constant>(name.c_str())).first;
+            u2 index = pool_.make_constant<ClassConstant>(utf8->second);
+            classes_.emplace(name, index);
+            return index;
+        }
+    };
+
+    /**
+     * Verification type of a parameter, given by its descriptor.
+     */
+    static FrameType
+    parameter_frame_type(const std::string &descriptor, const ClassConstants &constants)
+    {
+        switch (descriptor[0]) {
+        case FloatTypePrefix:
+            return { VerificationType::ITEM_FLOAT };
+        case LongTypePrefix:
+            return { VerificationType::ITEM_LONG };
+        case DoubleTypePrefix:
+            return { VerificationType::ITEM_DOUBLE };
+        case ClassTypePrefix:
+        case ArrayTypePrefix: {
+            // a class is named without the prefix and suffix, an array by its descriptor
+            std::string name = descriptor[0] == ClassTypePrefix ? descriptor.substr(1, descriptor.size() - 2) : descriptor;
+            if (u2 index = constants.find(name))
+                return { VerificationType::ITEM_OBJECT, index };
+            return { VerificationType::ITEM_OBJECT, 0, std::move(name) };
+        }
+        default:
+            return { VerificationType::ITEM_INTEGER };
+        }
+    }
+
+    static bool
+    read_frame_types(AttributeScanner &scanner, std::size_t count, std::vector<FrameType> &types)
+    {
+        for (; count > 0 && scanner.valid(); --count) {
+            u1 tag = scanner.read_u1();
+            if (tag > VerificationType::ITEM_UNINITIALIZED)
+                return false;
+            FrameType type(static_cast<VerificationType::Tag>(tag));
+            if (tag == VerificationType::ITEM_OBJECT || tag == VerificationType::ITEM_UNINITIALIZED)
+                type.index = scanner.read_u2();
+            types.push_back(std::move(type));
+        }
+        return scanner.valid();
+    }
+
+    /**
+     * Decodes the body of a StackMapTable attribute into full frames.
+     *
+     * @param bytes body of the attribute.
+     * @param initial locals of the implicit frame of the method entry.
+     * @param frames receives the frames.
+     * @return false if the body is malformed.
+     */
+    static bool
+    decode_frames(const std::vector<u1> &bytes, const std::vector<FrameType> &initial,
+                  std::vector<DecodedFrame> &frames)
+    {
+        AttributeScanner scanner(bytes);
+        u2 count = scanner.read_u2();
+        int64_t position = -1;
+        for (u2 i = 0; i < count && scanner.valid(); ++i) {
+            const std::vector<FrameType> &previous = frames.empty() ? initial : frames.back().locals;
+            DecodedFrame frame;
+            u2 delta;
+            u1 type = scanner.read_u1();
+            if (type < 128) {
+                delta = type < 64 ? type : type - 64;
+                frame.locals = previous;
+                if (type >= 64 && !read_frame_types(scanner, 1, frame.stack))
+                    return false;
+            } else if (type < 247) {
+                return false;
+            } else {
+                delta = scanner.read_u2();
+                if (type == 247) {
+                    frame.locals = previous;
+                    if (!read_frame_types(scanner, 1, frame.stack))
+                        return false;
+                } else if (type < 251) {
+                    std::size_t chopped = 251 - type;
+                    if (chopped > previous.size())
+                        return false;
+                    frame.locals.assign(previous.begin(), previous.end() - chopped);
+                } else if (type == 251) {
+                    frame.locals = previous;
+                } else if (type < 255) {
+                    frame.locals = previous;
+                    if (!read_frame_types(scanner, type - 251, frame.locals))
+                        return false;
+                } else if (!read_frame_types(scanner, scanner.read_u2(), frame.locals) ||
+                           !read_frame_types(scanner, scanner.read_u2(), frame.stack)) {
+                    return false;
+                }
+            }
+            position += delta + 1;
+            frame.position = position;
+            frames.push_back(std::move(frame));
+        }
+        return scanner.complete();
+    }
+
+    static bool
+    encode_frame_types(std::vector<FrameType>::const_iterator begin, std::vector<FrameType>::const_iterator end,
+                       ClassConstants &constants, std::vector<u1> &bytes, std::vector<u4> &constant_positions)
+    {
+        for (auto it = begin; it != end; ++it) {
+            bytes.push_back(it->tag);
+            if (it->tag == VerificationType::ITEM_OBJECT) {
+                u2 index = it->index != 0 ? it->index : constants.get(it->name);
+                if (index == 0)
+                    return false;
+                constant_positions.push_back(bytes.size());
+                put_u2(bytes, index);
+            } else if (it->tag == VerificationType::ITEM_UNINITIALIZED) {
+                put_u2(bytes, it->index);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Encodes frames into the body of a StackMapTable attribute. Each frame is encoded relative to the previous one,
+     * the first one relative to the implicit frame of the method entry, in the shortest form.
+     *
+     * @return false if a class constant needed by a frame could not be added.
+     */
+    static bool
+    encode_frames(const std::vector<DecodedFrame> &frames, const std::vector<FrameType> &initial,
+                  ClassConstants &constants, std::vector<u1> &bytes, std::vector<u4> &constant_positions)
+    {
+        constexpr u1 SameLocals1StackItemExtended = 247;
+        constexpr u1 SameExtended = 251;
+        constexpr u1 Full = 255;
+
+        put_u2(bytes, frames.size());
+        for (std::size_t i = 0; i < frames.size(); ++i) {
+            const DecodedFrame &frame = frames[i];
+            const std::vector<FrameType> &previous = i == 0 ? initial : frames[i - 1].locals;
+            u2 delta = i == 0 ? frame.position : frame.position - frames[i - 1].position - 1;
+            std::size_t common =
+              std::mismatch(frame.locals.begin(), frame.locals.end(), previous.begin(), previous.end()).first -
+              frame.locals.begin();
+
+            if (frame.locals == previous && frame.stack.size() <= 1) {
+                if (frame.stack.empty() && delta < 64) {
+                    bytes.push_back(delta);
+                } else if (frame.stack.empty()) {
+                    bytes.push_back(SameExtended);
+                    put_u2(bytes, delta);
+                } else if (delta < 64) {
+                    bytes.push_back(64 + delta);
+                } else {
+                    bytes.push_back(SameLocals1StackItemExtended);
+                    put_u2(bytes, delta);
+                }
+                if (!encode_frame_types(frame.stack.begin(), frame.stack.end(), constants, bytes, constant_positions))
+                    return false;
+            } else if (frame.stack.empty() && common == frame.locals.size() && previous.size() - common <= 3) {
+                // chop frame
+                bytes.push_back(SameExtended - (previous.size() - common));
+                put_u2(bytes, delta);
+            } else if (frame.stack.empty() && common == previous.size() && frame.locals.size() - common <= 3) {
+                // append frame
+                bytes.push_back(SameExtended + (frame.locals.size() - common));
+                put_u2(bytes, delta);
+                if (!encode_frame_types(frame.locals.begin() + common, frame.locals.end(), constants, bytes,
+                                        constant_positions))
+                    return false;
+            } else {
+                bytes.push_back(Full);
+                put_u2(bytes, delta);
+                put_u2(bytes, frame.locals.size());
+                if (!encode_frame_types(frame.locals.begin(), frame.locals.end(), constants, bytes,
+                                        constant_positions))
+                    return false;
+                put_u2(bytes, frame.stack.size());
+                if (!encode_frame_types(frame.stack.begin(), frame.stack.end(), constants, bytes, constant_positions))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Instruction decoded from the code of a method. The jump targets are positions in the original code until the
+     * code is laid out again.
+     */
+    struct DecodedInstruction
+    {
+        u4 position;
+        u1 opcode;
+        // operands of the instructions other than jumps and switches
+        std::vector<u1> operands;
+        // jump targets, the default target of a switch comes first
+        std::vector<u4> targets;
+        // match values of the switch targets other than the default one
+        std::vector<int32_t> keys;
+        bool kept = true;
+
+        DecodedInstruction(u4 position, u1 opcode)
+          : position(position)
+          , opcode(opcode)
+        {}
+    };
+
+    /**
+     * Decoded code of a method. An instruction is removed by clearing its flag, a position referring to it then
+     * refers to the following kept instruction.
+     */
+    struct MethodCode
+    {
+        std::vector<DecodedInstruction> instructions;
+        // index of the instruction at each position of the original code, -1 inside of an instruction
+        std::vector<int64_t> index_at;
+        std::vector<CodeAttribute::ExceptionTableEntry> exception_table;
+
+        inline bool
+        is_instruction(u4 position) const
+        {
+            return position < index_at.size() && index_at[position] >= 0;
+        }
+
+        /**
+         * @return index of the first kept instruction at or after the given one, the number of instructions if there
+         * is none.
+         */
+        inline std::size_t
+        resolve(std::size_t index) const
+        {
+            while (index < instructions.size() && !instructions[index].kept)
+                ++index;
+            return index;
+        }
+
+        inline std::size_t
+        resolve_position(u4 position) const
+        {
+            return resolve(index_at[position]);
+        }
+    };
+
+    static inline bool
+    is_jump(u1 opcode)
+    {
+        return (opcode >= 0x99 && opcode <= Goto) || opcode == 0xc6 || opcode == 0xc7 || opcode == GotoW;
+    }
+
+    /**
+     * Decodes the code of a method.
+     *
+     * @return false if the code is malformed or it contains a subroutine or a wide instruction, which the optimizer
+     * does not handle.
+     */
+    static bool
+    decode_code(const std::vector<u1> &bytes, MethodCode &code)
+    {
+        std::size_t length = bytes.size();
+        code.index_at.assign(length + 1, -1);
+        for (std::size_t at = 0; at < length;) {
+            DecodedInstruction inst(at, bytes[at]);
+            u1 opcode = inst.opcode;
+            // jsr, ret, wide and jsr_w
+            if (opcode == 0xa8 || opcode == 0xa9 || opcode == 0xc4 || opcode > GotoW)
+                return false;
+
+            std::vector<int64_t> offsets;
+            std::size_t width;
+            if (opcode == TableSwitchOpcode || opcode == LookupSwitchOpcode) {
+                // the operands are aligned to a multiple of four bytes
+                std::size_t operands = (at & ~std::size_t(3)) + 4;
+                if (operands + 12 > length)
+                    return false;
+                offsets.push_back(static_cast<int32_t>(get_u4(bytes, operands)));
+                if (opcode == TableSwitchOpcode) {
+                    auto low = static_cast<int32_t>(get_u4(bytes, operands + 4));
+                    auto high = static_cast<int32_t>(get_u4(bytes, operands + 8));
+                    int64_t count = int64_t(high) - low + 1;
+                    if (count <= 0 || operands + 12 + 4 * count > length)
+                        return false;
+                    for (int64_t i = 0; i < count; ++i) {
+                        inst.keys.push_back(low + i);
+                        offsets.push_back(static_cast<int32_t>(get_u4(bytes, operands + 12 + 4 * i)));
+                    }
+                    width = operands + 12 + 4 * count - at;
+                } else {
+                    u4 count = get_u4(bytes, operands + 4);
+                    if (operands + 8 + 8 * uint64_t(count) > length)
+                        return false;
+                    for (u4 i = 0; i < count; ++i) {
+                        inst.keys.push_back(static_cast<int32_t>(get_u4(bytes, operands + 8 + 8 * i)));
+                        offsets.push_back(static_cast<int32_t>(get_u4(bytes, operands + 12 + 8 * i)));
+                    }
+                    width = operands + 8 + 8 * count - at;
+                }
+            } else if (is_jump(opcode)) {
+                width = opcode == GotoW ? 5 : 3;
+                if (at + width > length)
+                    return false;
+                offsets.push_back(opcode == GotoW ? static_cast<int32_t>(get_u4(bytes, at + 1))
+                                                  : static_cast<int16_t>(get_u2(bytes, at + 1)));
+            } else {
+                width = 1 + InstructionInfo[opcode][0];
+                if (at + width > length)
+                    return false;
+                inst.operands.assign(bytes.begin() + at + 1, bytes.begin() + at + width);
+            }
+
+            for (int64_t offset : offsets) {
+                int64_t target = int64_t(at) + offset;
+                if (target < 0 || target >= int64_t(length))
+                    return false;
+                inst.targets.push_back(target);
+            }
+            code.index_at[at] = code.instructions.size();
+            code.instructions.push_back(std::move(inst));
+            at += width;
+        }
+        code.index_at[length] = code.instructions.size();
+
+        for (auto &inst : code.instructions) {
+            for (u4 target : inst.targets) {
+                if (!code.is_instruction(target))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Removes the kept instructions which cannot be reached from the method entry. A handler is reached if any of
+     * the instructions it protects is reached.
+     *
+     * @return number of the removed instructions.
+     */
+    static std::size_t
+    remove_unreachable_code(MethodCode &code)
+    {
+        std::size_t count = code.instructions.size();
+        std::vector<bool> reached(count, false);
+        std::vector<std::size_t> worklist{ code.resolve(0) };
+        bool changed;
+        do {
+            while (!worklist.empty()) {
+                std::size_t i = worklist.back();
+                worklist.pop_back();
+                if (i >= count || reached[i])
+                    continue;
+                reached[i] = true;
+                const DecodedInstruction &inst = code.instructions[i];
+                if (falls_through(inst.opcode))
+                    worklist.push_back(code.resolve(i + 1));
+                for (u4 target : inst.targets)
+                    worklist.push_back(code.resolve_position(target));
+            }
+
+            changed = false;
+            for (auto &entry : code.exception_table) {
+                std::size_t handler = code.resolve_position(entry.handler_pc);
+                if (handler >= count || reached[handler])
+                    continue;
+                for (auto i = code.index_at[entry.start_pc]; i < code.index_at[entry.end_pc]; ++i) {
+                    if (reached[i]) {
+                        worklist.push_back(handler);
+                        changed = true;
+                        break;
+                    }
+                }
+            }
+        } while (changed);
+
+        std::size_t removed = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (code.instructions[i].kept && !reached[i]) {
+                code.instructions[i].kept = false;
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    static std::size_t
+    remove_nops(MethodCode &code)
+    {
+        std::size_t removed = 0;
+        for (auto &inst : code.instructions) {
+            if (inst.kept && inst.opcode == 0x00) {
+                inst.kept = false;
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    static inline bool
+    is_goto(u1 opcode)
+    {
+        return opcode == Goto || opcode == GotoW;
+    }
+
+    /**
+     * Redirects the jumps to an unconditional jump to its target.
+     *
+     * @return number of the redirected jump targets.
+     */
+    static std::size_t
+    thread_jumps(MethodCode &code)
+    {
+        // the chains are followed for a few jumps, which also stops at the cycles
+        constexpr int MaxChain = 8;
+
+        std::size_t threaded = 0;
+        for (auto &inst : code.instructions) {
+            if (!inst.kept)
+                continue;
+            for (u4 &target : inst.targets) {
+                for (int i = 0; i < MaxChain; ++i) {
+                    std::size_t index = code.resolve_position(target);
+                    if (index >= code.instructions.size() || !is_goto(code.instructions[index].opcode))
+                        break;
+                    u4 next = code.instructions[index].targets[0];
+                    if (code.resolve_position(next) == index)
+                        break;
+                    target = next;
+                    ++threaded;
+                }
+            }
+        }
+        return threaded;
+    }
+
+    /**
+     * Removes the unconditional jumps to the following instruction. The code is walked backwards, so that a jump
+     * over the removed jumps is removed too.
+     *
+     * @return number of the removed instructions.
+     */
+    static std::size_t
+    remove_jumps_to_next(MethodCode &code)
+    {
+        std::size_t removed = 0;
+        for (std::size_t i = code.instructions.size(); i-- > 0;) {
+            DecodedInstruction &inst = code.instructions[i];
+            if (inst.kept && is_goto(inst.opcode) && code.resolve_position(inst.targets[0]) == code.resolve(i + 1)) {
+                inst.kept = false;
+                ++removed;
+            }
+        }
+        return removed;
+    }
+
+    /**
+     * Replaces the instructions by their shorter forms: the loads and stores of the first four local variables,
+     * small integer constants and the constants loaded by ldc_w with an index fitting ldc.
+     *
+     * @return number of the replaced instructions.
+     */
+    static std::size_t
+    shorten_instructions(MethodCode &code)
+    {
+        std::size_t shortened = 0;
+        for (auto &inst : code.instructions) {
+            if (!inst.kept)
+                continue;
+            u1 opcode = inst.opcode;
+            if ((opcode >= 0x15 && opcode <= 0x19) || (opcode >= 0x36 && opcode <= 0x3a)) {
+                // xload and xstore
+                if (inst.operands[0] > 3)
+                    continue;
+                u1 first = opcode <= 0x19 ? 0x1a + 4 * (opcode - 0x15) : 0x3b + 4 * (opcode - 0x36);
+                inst.opcode = first + inst.operands[0];
+                inst.operands.clear();
+            } else if (opcode == 0x10 || opcode == 0x11) {
+                // bipush and sipush
+                int value = opcode == 0x10 ? int(static_cast<int8_t>(inst.operands[0]))
+                                           : int(static_cast<int16_t>((inst.operands[0] << 8u) | inst.operands[1]));
+                if (value >= -1 && value <= 5) {
+                    inst.opcode = 0x03 + value;
+                    inst.operands.clear();
+                } else if (opcode == 0x11 && value >= -128 && value <= 127) {
+                    inst.opcode = 0x10;
+                    inst.operands = { static_cast<u1>(value) };
+                } else {
+                    continue;
+                }
+            } else if (opcode == 0x13 && inst.operands[0] == 0) {
+                // ldc_w
+                inst.opcode = 0x12;
+                inst.operands.erase(inst.operands.begin());
+            } else {
+                continue;
+            }
+            ++shortened;
+        }
+        return shortened;
+    }
+
+    static u4
+    instruction_width(const DecodedInstruction &inst, u4 position)
+    {
+        if (inst.opcode == TableSwitchOpcode)
+            return 1 + (3 - position % 4) + 12 + 4 * inst.keys.size();
+        if (inst.opcode == LookupSwitchOpcode)
+            return 1 + (3 - position % 4) + 8 + 8 * inst.keys.size();
+        if (is_jump(inst.opcode))
+            return inst.opcode == GotoW ? 5 : 3;
+        return 1 + inst.operands.size();
+    }
+
+    /**
+     * Lays out and encodes the kept instructions.
+     *
+     * @param code decoded code.
+     * @param new_position receives the position of each instruction in the new code, a removed instruction gets the
+     * position of the following kept instruction. The last element is the length of the code.
+     * @param bytes receives the code.
+     * @return false if the code is too long or a jump offset does not fit its instruction.
+     */
+    static bool
+    lay_out(const MethodCode &code, std::vector<u4> &new_position, std::vector<u1> &bytes)
+    {
+        std::size_t count = code.instructions.size();
+        new_position.assign(count + 1, 0);
+        u4 position = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (code.instructions[i].kept) {
+                new_position[i] = position;
+                position += instruction_width(code.instructions[i], position);
+            }
+        }
+        if (position > 0xFFFF)
+            return false;
+        new_position[count] = position;
+        for (std::size_t i = count; i-- > 0;) {
+            if (!code.instructions[i].kept)
+                new_position[i] = new_position[i + 1];
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const DecodedInstruction &inst = code.instructions[i];
+            if (!inst.kept)
+                continue;
+            u4 at = new_position[i];
+            std::vector<int64_t> offsets;
+            for (u4 target : inst.targets)
+                offsets.push_back(int64_t(new_position[code.index_at[target]]) - at);
+
+            bytes.push_back(inst.opcode);
+            if (inst.opcode == TableSwitchOpcode || inst.opcode == LookupSwitchOpcode) {
+                while (bytes.size() % 4 != 0)
+                    bytes.push_back(0);
+                put_u4(bytes, offsets[0]);
+                if (inst.opcode == TableSwitchOpcode) {
+                    put_u4(bytes, inst.keys.front());
+                    put_u4(bytes, inst.keys.back());
+                    for (std::size_t j = 1; j < offsets.size(); ++j)
+                        put_u4(bytes, offsets[j]);
+                } else {
+                    put_u4(bytes, inst.keys.size());
+                    for (std::size_t j = 0; j < inst.keys.size(); ++j) {
+                        put_u4(bytes, inst.keys[j]);
+                        put_u4(bytes, offsets[j + 1]);
+                    }
+                }
+            } else if (inst.opcode == GotoW) {
+                put_u4(bytes, offsets[0]);
+            } else if (is_jump(inst.opcode)) {
+                if (offsets[0] < INT16_MIN || offsets[0] > INT16_MAX)
+                    return false;
+                put_u2(bytes, offsets[0]);
+            } else {
+                bytes.insert(bytes.end(), inst.operands.begin(), inst.operands.end());
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Moves the frames to the new positions of their instructions. The frame of a removed instruction is moved to
+     * the following kept instruction, unless it has a frame. The closest removed frame is taken, since the removed
+     * instructions in between are jumps to the following instruction, no-ops or unreachable.
+     *
+     * @return false if a frame is not at an instruction or it refers to a removed new instruction.
+     */
+    static bool
+    remap_frames(const MethodCode &code, const std::vector<u4> &new_position, std::vector<DecodedFrame> &frames)
+    {
+        std::size_t count = code.instructions.size();
+        std::vector<bool> framed(count, false);
+        for (auto &frame : frames) {
+            if (!code.is_instruction(frame.position) || code.index_at[frame.position] >= int64_t(count))
+                return false;
+            if (code.instructions[code.index_at[frame.position]].kept)
+                framed[code.index_at[frame.position]] = true;
+        }
+
+        std::vector<DecodedFrame> remapped;
+        for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+            std::size_t index = code.index_at[it->position];
+            if (!code.instructions[index].kept) {
+                index = code.resolve(index);
+                if (index >= count || framed[index])
+                    continue;
+                framed[index] = true;
+            }
+            DecodedFrame frame = std::move(*it);
+            frame.position = new_position[index];
+            for (auto *types : { &frame.locals, &frame.stack }) {
+                for (auto &type : *types) {
+                    if (type.tag != VerificationType::ITEM_UNINITIALIZED)
+                        continue;
+                    if (!code.is_instruction(type.index))
+                        return false;
+                    const DecodedInstruction &created = code.instructions[code.index_at[type.index]];
+                    if (!created.kept || created.opcode != 0xbb)
+                        return false;
+                    type.index = new_position[code.index_at[type.index]];
+                }
+            }
+            remapped.push_back(std::move(frame));
+        }
+        std::reverse(remapped.begin(), remapped.end());
+        std::stable_sort(remapped.begin(), remapped.end(),
+                         [](const DecodedFrame &lhs, const DecodedFrame &rhs) { return lhs.position < rhs.position; });
+        frames = std::move(remapped);
+        return true;
+    }
+
+    /**
+     * Moves the line numbers to the new positions. The line of a removed instruction is kept only if no kept
+     * instruction starts the same line at its new position.
+     */
+    static bool
+    remap_line_numbers(const MethodCode &code, const std::vector<u4> &new_position, const std::vector<u1> &body,
+                       std::vector<u1> &bytes)
+    {
+        AttributeScanner scanner(body);
+        // the entry with the greatest original position wins, it belongs to the instruction at the new position
+        std::map<u4, std::pair<u2, u2>> lines;
+        for (u2 count = scanner.read_u2(); count > 0 && scanner.valid(); --count) {
+            u2 start_pc = scanner.read_u2();
+            u2 line = scanner.read_u2();
+            if (!code.is_instruction(start_pc))
+                return false;
+            u4 position = new_position[code.index_at[start_pc]];
+            if (position == new_position.back())
+                continue;
+            auto &entry = lines[position];
+            if (entry.second == 0 || entry.first <= start_pc)
+                entry = { start_pc, line };
+        }
+        if (!scanner.complete())
+            return false;
+
+        put_u2(bytes, lines.size());
+        for (auto &[position, entry] : lines) {
+            put_u2(bytes, position);
+            put_u2(bytes, entry.second);
+        }
+        return true;
+    }
+
+    /**
+     * Moves the ranges of the local variables to the new positions, the variables whose ranges become empty are
+     * removed.
+     */
+    static bool
+    remap_local_variables(const MethodCode &code, const std::vector<u4> &new_position, const std::vector<u1> &body,
+                          std::vector<u1> &bytes, std::vector<u4> &constant_positions)
+    {
+        AttributeScanner scanner(body);
+        u2 count = scanner.read_u2();
+        std::vector<std::array<u2, 5>> variables;
+        for (; count > 0 && scanner.valid(); --count) {
+            std::array<u2, 5> variable{};
+            for (u2 &field : variable)
+                field = scanner.read_u2();
+            u4 start = variable[0];
+            u4 end = start + variable[1];
+            if (!code.is_instruction(start) || !code.is_instruction(end))
+                return false;
+            start = new_position[code.index_at[start]];
+            end = new_position[code.index_at[end]];
+            if (start >= end)
+                continue;
+            variable[0] = start;
+            variable[1] = end - start;
+            variables.push_back(variable);
+        }
+        if (!scanner.complete())
+            return false;
+
+        put_u2(bytes, variables.size());
+        for (auto &variable : variables) {
+            for (std::size_t i = 0; i < variable.size(); ++i) {
+                // the name and the descriptor or signature
+                if (i == 2 || i == 3)
+                    constant_positions.push_back(bytes.size());
+                put_u2(bytes, variable[i]);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Number of the operand stack slots an instruction pops and pushes.
+     *
+     * @return false if the constant the instruction refers to is missing.
+     */
+    static bool
+    stack_effect(const DecodedInstruction &inst, const ConstantPool &pool, int &popped, int &pushed)
+    {
+        u1 opcode = inst.opcode;
+        popped = StackSlots[opcode][0];
+        pushed = StackSlots[opcode][1];
+        if (opcode == 0xc5) {
+            // multianewarray pops the dimensions
+            popped = inst.operands[2];
+            return true;
+        }
+        if (opcode < 0xb2 || opcode > 0xba)
+            return true;
+
+        const std::string *descriptor = member_descriptor(pool, (inst.operands[0] << 8u) | inst.operands[1]);
+        if (descriptor == nullptr || descriptor->empty())
+            return false;
+        if (opcode <= 0xb5) {
+            int slots = type_slots((*descriptor)[0]);
+            // getstatic, putstatic, getfield, putfield
+            popped = (opcode == 0xb3 ? slots : 0) + (opcode >= 0xb4 ? 1 : 0) + (opcode == 0xb5 ? slots : 0);
+            pushed = opcode == 0xb2 || opcode == 0xb4 ? slots : 0;
+            return true;
+        }
+
+        std::vector<std::string> parameters;
+        char return_prefix;
+        if (!parameter_types(*descriptor, parameters, return_prefix))
+            return false;
+        // invokestatic and invokedynamic have no receiver
+        popped = parameter_slots(parameters) + (opcode == 0xb8 || opcode == 0xba ? 0 : 1);
+        pushed = type_slots(return_prefix);
+        return true;
+    }
+
+    /**
+     * Computes the maximum depth of the operand stack of the kept instructions.
+     *
+     * @param limit receives the limit, it is not lowered below the current one if some instructions are not reached.
+     * @return false if the depths cannot be determined, because they do not agree where the control flow joins.
+     */
+    static bool
+    compute_stack_limit(const MethodCode &code, const ConstantPool &pool, u2 &limit)
+    {
+        std::size_t count = code.instructions.size();
+        std::vector<int> depth(count, -1);
+        std::vector<std::size_t> worklist;
+        auto reach = [&](std::size_t index, int value) {
+            if (index >= count)
+                return true;
+            if (depth[index] < 0) {
+                depth[index] = value;
+                worklist.push_back(index);
+            }
+            return depth[index] == value;
+        };
+
+        int max = 0;
+        if (!reach(code.resolve(0), 0))
+            return false;
+        for (auto &entry : code.exception_table) {
+            if (code.resolve_position(entry.start_pc) >= std::size_t(code.index_at[entry.end_pc]))
+                continue;
+            // the handler starts with the exception on the stack
+            max = 1;
+            if (!reach(code.resolve_position(entry.handler_pc), 1))
+                return false;
+        }
+
+        while (!worklist.empty()) {
+            std::size_t i = worklist.back();
+            worklist.pop_back();
+            const DecodedInstruction &inst = code.instructions[i];
+            int popped, pushed;
+            if (!stack_effect(inst, pool, popped, pushed) || depth[i] < popped)
+                return false;
+            int out = depth[i] - popped + pushed;
+            max = std::max(max, out);
+            if (falls_through(inst.opcode) && !reach(code.resolve(i + 1), out))
+                return false;
+            for (u4 target : inst.targets) {
+                if (!reach(code.resolve_position(target), out))
+                    return false;
+            }
+        }
+        if (max > 0xFFFF)
+            return false;
+
+        bool complete = true;
+        for (std::size_t i = 0; i < count; ++i)
+            complete &= !code.instructions[i].kept || depth[i] >= 0;
+        // the verifier checks the unreachable code too, its depth is not known
+        limit = complete ? max : std::max<int>(limit, max);
+        return true;
+    }
+
+    static u4
+    frame_slots(const std::vector<FrameType> &types)
+    {
+        u4 slots = 0;
+        for (auto &type : types)
+            slots += type.tag == VerificationType::ITEM_LONG || type.tag == VerificationType::ITEM_DOUBLE ? 2 : 1;
+        return slots;
+    }
+
+    /**
+     * Computes the number of the local variable slots used by the parameters, the kept instructions and the
+     * frames.
+     */
+    static u4
+    compute_locals_limit(const MethodCode &code, u4 parameters, const std::vector<DecodedFrame> &frames)
+    {
+        u4 limit = parameters;
+        for (auto &inst : code.instructions) {
+            if (!inst.kept)
+                continue;
+            u1 opcode = inst.opcode;
+            u4 index, slots;
+            if ((opcode >= 0x15 && opcode <= 0x19) || (opcode >= 0x36 && opcode <= 0x3a)) {
+                index = inst.operands[0];
+                u1 kind = opcode <= 0x19 ? opcode - 0x15 : opcode - 0x36;
+                // long and double
+                slots = kind == 1 || kind == 3 ? 2 : 1;
+            } else if ((opcode >= 0x1a && opcode <= 0x2d) || (opcode >= 0x3b && opcode <= 0x4e)) {
+                u1 short_form = opcode <= 0x2d ? opcode - 0x1a : opcode - 0x3b;
+                index = short_form % 4;
+                slots = short_form / 4 == 1 || short_form / 4 == 3 ? 2 : 1;
+            } else if (opcode == 0x84) {
+                index = inst.operands[0];
+                slots = 1;
+            } else {
+                continue;
+            }
+            limit = std::max(limit, index + slots);
+        }
+        for (auto &frame : frames)
+            limit = std::max(limit, frame_slots(frame.locals));
+        return limit;
+    }
+
+    /**
+     * Number of the local variable slots needed by the variables of a LocalVariableTable or LocalVariableTypeTable
+     * attribute, whose body has been checked.
+     */
+    static u4
+    local_variable_slots(const ConstantPool &pool, const std::vector<u1> &body)
+    {
+        u4 slots = 0;
+        for (std::size_t at = 2; at + 10 <= body.size(); at += 10) {
+            // a signature of a long or double variable is the same as its descriptor
+            auto descriptor = utf8_constant(pool, get_u2(body, at + 6));
+            u4 size = descriptor != nullptr && !descriptor->value().empty() ? type_slots(descriptor->value()[0]) : 2;
+            slots = std::max<u4>(slots, get_u2(body, at + 8) + size);
+        }
+        return slots;
+    }
+
+    /**
+     * Sets the positions of the constant pool indices of the raw attributes whose layout is known, so that the
+     * constant pool can be compacted.
+     */
+    static void
+    index_raw_attributes(const ConstantPool &pool, Attributable &attributable)
+    {
+        for (auto &attribute : attributable.attributes()) {
+            auto raw = dynamic_cast<RawAttribute *>(attribute.get());
+            auto name = raw != nullptr ? utf8_constant(pool, raw->name_index()) : nullptr;
+            if (name == nullptr)
+                continue;
+            AttributeScanner scanner(raw->bytes());
+            if (scan_attribute(name->value(), scanner))
+                raw->set_constant_positions(std::move(scanner.constants));
+        }
+    }
+
+    Optimizer::Statistics &
+    Optimizer::Statistics::operator+=(const Statistics &other)
+    {
+        methods += other.methods;
+        skipped_methods += other.skipped_methods;
+        removed_instructions += other.removed_instructions;
+        removed_constants += other.removed_constants;
+        return *this;
+    }
+
+    bool
+    Optimizer::optimize_method(Class &clazz, Method &method, ClassConstants &constants, Statistics &statistics) const
+    {
+        ConstantPool &pool = clazz.constant_pool();
+        CodeAttribute *code_attribute = nullptr;
+        bool raw_code = false;
+        for (auto &attribute : method.attributes()) {
+            if (auto code = dynamic_cast<CodeAttribute *>(attribute.get())) {
+                code_attribute = code;
+            } else if (auto raw = dynamic_cast<RawAttribute *>(attribute.get())) {
+                auto name = utf8_constant(pool, raw->name_index());
+                raw_code |= name != nullptr && name->value() == "Code";
+            }
+        }
+        if (code_attribute == nullptr) {
+            // the code is kept raw if it contains instructions not implemented by jasm
+            statistics.skipped_methods += raw_code;
+            return false;
+        }
+
+        std::vector<u1> bytes;
+        {
+            std::ostringstream os;
+            for (auto &inst : code_attribute->code())
+                inst->emit_bytecode(os);
+            std::string emitted = std::move(os).str();
+            bytes.assign(emitted.begin(), emitted.end());
+        }
+
+        auto name = utf8_constant(pool, method.name_index());
+        auto descriptor = utf8_constant(pool, method.descriptor_index());
+        std::vector<std::string> parameters;
+        char return_prefix;
+        MethodCode code;
+        if (name == nullptr || descriptor == nullptr || !parameter_types(descriptor->value(), parameters, return_prefix) ||
+            !decode_code(bytes, code)) {
+            ++statistics.skipped_methods;
+            return false;
+        }
+        code.exception_table = code_attribute->exception_table();
+        for (auto &entry : code.exception_table) {
+            if (entry.start_pc >= entry.end_pc || entry.handler_pc >= bytes.size() ||
+                !code.is_instruction(entry.start_pc) || !code.is_instruction(entry.end_pc) ||
+                !code.is_instruction(entry.handler_pc)) {
+                ++statistics.skipped_methods;
+                return false;
+            }
+        }
+
+        bool is_static = method.access_flags() & Method::ACC_STATIC;
+        std::vector<FrameType> initial;
+        if (!is_static) {
+            // a constructor starts with an uninitialised this, except the one of java/lang/Object
+            ClassConstant *this_class = clazz.this_class();
+            auto this_name = this_class != nullptr ? utf8_constant(pool, this_class->name_index()) : nullptr;
+            if (name->value() == "<init>" && (this_name == nullptr || this_name->value() != "java/lang/Object"))
+                initial.push_back({ VerificationType::ITEM_UNINITIALIZED_THIS });
+            else
+                initial.push_back({ VerificationType::ITEM_OBJECT, clazz.this_class_ });
+        }
+        for (auto &parameter : parameters)
+            initial.push_back(parameter_frame_type(parameter, constants));
+
+        // the attributes of the code referring to its positions
+        auto &attributes = code_attribute->attributes();
+        std::optional<std::size_t> frames_attribute;
+        std::optional<std::size_t> lines_attribute;
+        std::vector<std::size_t> variables_attributes;
+        std::vector<DecodedFrame> frames;
+        // the limits are computed from the frames and the local variable tables
+        bool decoded = true;
+        // the code is rewritten only if all the attributes referring to its positions are known
+        bool rewritable = true;
+        for (std::size_t i = 0; i < attributes.size(); ++i) {
+            if (auto stack_map = dynamic_cast<StackMapTableAttribute *>(attributes[i].get())) {
+                // the frames of a class made by the class builder
+                frames_attribute = i;
+                for (auto &frame : stack_map->frames()) {
+                    DecodedFrame &decoded_frame = frames.emplace_back(frame.position);
+                    for (auto &type : frame.locals)
+                        decoded_frame.locals.push_back({ type.tag, type.index });
+                    for (auto &type : frame.stack)
+                        decoded_frame.stack.push_back({ type.tag, type.index });
+                }
+                continue;
+            }
+
+            auto raw = dynamic_cast<RawAttribute *>(attributes[i].get());
+            auto attribute_name = raw != nullptr ? utf8_constant(pool, raw->name_index()) : nullptr;
+            if (attribute_name == nullptr) {
+                rewritable = false;
+                continue;
+            }
+            const std::string &value = attribute_name->value();
+            AttributeScanner scanner(raw->bytes());
+            if (value == "StackMapTable") {
+                frames_attribute = i;
+                if (!decode_frames(raw->bytes(), initial, frames))
+                    decoded = rewritable = false;
+            } else if (value == "LineNumberTable") {
+                lines_attribute = i;
+            } else if (value == "LocalVariableTable" || value == "LocalVariableTypeTable") {
+                variables_attributes.push_back(i);
+                if (!scan_attribute(value, scanner))
+                    decoded = rewritable = false;
+            } else {
+                rewritable = false;
+            }
+        }
+
+        std::size_t removed = 0;
+        std::size_t replaced = 0;
+        MethodCode original;
+        if (rewritable) {
+            original = code;
+            if (options_.remove_dead_code)
+                removed += remove_unreachable_code(code);
+            if (options_.peephole) {
+                removed += remove_nops(code);
+                replaced += thread_jumps(code);
+                if (options_.remove_dead_code)
+                    removed += remove_unreachable_code(code);
+                removed += remove_jumps_to_next(code);
+                replaced += shorten_instructions(code);
+            }
+        }
+
+        std::vector<u4> new_position;
+        std::vector<u1> new_code;
+        std::vector<CodeAttribute::ExceptionTableEntry> new_exception_table;
+        std::vector<DecodedFrame> new_frames = frames;
+        // the replaced attributes by their indices, an attribute which is no longer needed is replaced by nullptr
+        std::map<std::size_t, std::unique_ptr<Attribute>> new_attributes;
+        auto rewrite = [&]() {
+            if (!lay_out(code, new_position, new_code))
+                return false;
+            for (auto &entry : code.exception_table) {
+                u2 start_pc = new_position[code.index_at[entry.start_pc]];
+                u2 end_pc = new_position[code.index_at[entry.end_pc]];
+                // the handlers of the removed code are dropped
+                if (start_pc < end_pc)
+                    new_exception_table.emplace_back(start_pc, end_pc, new_position[code.index_at[entry.handler_pc]],
+                                                     entry.catch_type);
+            }
+
+            if (frames_attribute) {
+                std::vector<u1> body;
+                std::vector<u4> constant_positions;
+                if (!remap_frames(code, new_position, new_frames) ||
+                    !encode_frames(new_frames, initial, constants, body, constant_positions))
+                    return false;
+                if (!new_frames.empty()) {
+                    auto attribute = std::make_unique<RawAttribute>(attributes[*frames_attribute]->name_index(),
+                                                                    std::move(body));
+                    attribute->set_constant_positions(std::move(constant_positions));
+                    new_attributes[*frames_attribute] = std::move(attribute);
+                } else {
+                    new_attributes[*frames_attribute] = nullptr;
+                }
+            }
+            if (lines_attribute) {
+                auto raw = static_cast<RawAttribute *>(attributes[*lines_attribute].get());
+                std::vector<u1> body;
+                if (!remap_line_numbers(code, new_position, raw->bytes(), body))
+                    return false;
+                auto attribute = std::make_unique<RawAttribute>(raw->name_index(), std::move(body));
+                attribute->set_constant_positions({});
+                new_attributes[*lines_attribute] = std::move(attribute);
+            }
+            for (std::size_t i : variables_attributes) {
+                auto raw = static_cast<RawAttribute *>(attributes[i].get());
+                std::vector<u1> body;
+                std::vector<u4> constant_positions;
+                if (!remap_local_variables(code, new_position, raw->bytes(), body, constant_positions))
+                    return false;
+                auto attribute = std::make_unique<RawAttribute>(raw->name_index(), std::move(body));
+                attribute->set_constant_positions(std::move(constant_positions));
+                new_attributes[i] = std::move(attribute);
+            }
+            return true;
+        };
+
+        bool changed = removed + replaced > 0 && rewrite();
+        if (!changed && rewritable) {
+            code = std::move(original);
+            new_frames = frames;
+        }
+
+        if (options_.recompute_limits && decoded) {
+            u2 stack_limit = code_attribute->stack_limit();
+            u4 locals_limit = compute_locals_limit(code, parameter_slots(parameters) + !is_static, new_frames);
+            for (std::size_t i : variables_attributes) {
+                auto raw = static_cast<RawAttribute *>(changed ? new_attributes[i].get() : attributes[i].get());
+                locals_limit = std::max(locals_limit, local_variable_slots(pool, raw->bytes()));
+            }
+            if (compute_stack_limit(code, pool, stack_limit) && locals_limit <= 0xFFFF) {
+                code_attribute->set_stack_limit(stack_limit);
+                code_attribute->set_locals_limit(locals_limit);
+            }
+        }
+
+        if (!changed)
+            return false;
+
+        auto &instructions = code_attribute->code();
+        instructions.clear();
+        MemoryBuffer buffer(new_code.data(), new_code.size());
+        std::istream is(&buffer);
+        for (u4 position = 0; position < new_code.size();) {
+            u4 width = clazz.read_instruction(is, code_attribute, position);
+            assert(width > 0);
+            position += width;
+        }
+        code_attribute->exception_table() = std::move(new_exception_table);
+        for (auto &[i, attribute] : new_attributes)
+            attributes[i] = std::move(attribute);
+        attributes.erase(std::remove(attributes.begin(), attributes.end(), nullptr), attributes.end());
+        statistics.removed_instructions += removed;
+        return true;
+    }
+
+    std::vector<bool>
+    Optimizer::optimize_methods(Class &clazz, Statistics &statistics) const
+    {
+        ClassConstants constants(clazz.constant_pool());
+        std::vector<bool> rewritten;
+        for (auto &method : clazz.methods()) {
+            bool changed = optimize_method(clazz, method, constants, statistics);
+            statistics.methods += changed;
+            rewritten.push_back(changed);
+        }
+        return rewritten;
+    }
+
+    void
+    Optimizer::index_attributes(Class &clazz)
+    {
+        const ConstantPool &pool = clazz.constant_pool();
+        index_raw_attributes(pool, clazz);
+        for (auto &field : clazz.fields())
+            index_raw_attributes(pool, field);
+        for (auto &method : clazz.methods()) {
+            index_raw_attributes(pool, method);
+            for (auto &attribute : method.attributes()) {
+                if (auto code = dynamic_cast<CodeAttribute *>(attribute.get()))
+                    index_raw_attributes(pool, *code);
+            }
+        }
+    }
+
+    Optimizer::Statistics
+    Optimizer::optimize(Class &clazz) const
+    {
+        Statistics statistics;
+        std::vector<bool> rewritten = optimize_methods(clazz, statistics);
+        if (!options_.compact_constants)
+            return statistics;
+
+        index_attributes(clazz);
+        const ConstantPool &pool = clazz.constant_pool();
+        u2 count = pool.count();
+        if (!clazz.remove_unused_constants() || pool.count() == count)
+            return statistics;
+        statistics.removed_constants = count - pool.count();
+
+        if (options_.peephole) {
+            // the constants loaded by ldc_w may have got indices fitting ldc
+            Statistics again;
+            std::vector<bool> shortened = optimize_methods(clazz, again);
+            for (std::size_t i = 0; i < shortened.size(); ++i)
+                statistics.methods += shortened[i] && !rewritten[i];
+            statistics.removed_instructions += again.removed_instructions;
+        }
+        return statistics;
+    }
+
+}
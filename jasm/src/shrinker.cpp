@@ -0,0 +1,693 @@
+/**
+ * @file shrinker.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <algorithm>
+#include <deque>
+#include <set>
+#include <unordered_map>
+
+#include "optimizer.hpp"
+#include "shrinker.hpp"
+
+namespace jasm {
+
+    // the methods of java/lang/Object the class library calls on objects of any class
+    static const char *const ObjectMethods[] = {
+        "toString:()Ljava/lang/String;", "equals:(Ljava/lang/Object;)Z", "hashCode:()I", "finalize:()V",
+        "clone:()Ljava/lang/Object;",
+    };
+
+    static const std::string StaticInitializer = "<clinit>:()V";
+    static const std::string Constructor = "<init>:";
+
+    static std::string
+    utf8_value(const ConstantPool &pool, u2 index)
+    {
+        if (index == 0 || index > pool.count())
+            return std::string();
+        auto utf8 = dynamic_cast<const Utf8Constant *>(pool.get(index));
+        return utf8 != nullptr ? utf8->value() : std::string();
+    }
+
+    static std::string
+    class_name(const ConstantPool &pool, u2 index)
+    {
+        if (index == 0 || index > pool.count())
+            return std::string();
+        auto class_constant = dynamic_cast<const ClassConstant *>(pool.get(index));
+        return class_constant != nullptr ? utf8_value(pool, class_constant->name_index()) : std::string();
+    }
+
+    /**
+     * @return name and descriptor of a member separated by a colon.
+     */
+    static std::string
+    member_key(const ConstantPool &pool, u2 name_index, u2 descriptor_index)
+    {
+        return utf8_value(pool, name_index) + ':' + utf8_value(pool, descriptor_index);
+    }
+
+    static std::string
+    name_and_type_key(const ConstantPool &pool, u2 index)
+    {
+        if (index == 0 || index > pool.count())
+            return std::string();
+        auto name_and_type = dynamic_cast<const NameAndTypeConstant *>(pool.get(index));
+        if (name_and_type == nullptr)
+            return std::string();
+        return member_key(pool, name_and_type->name_index(), name_and_type->descriptor_index());
+    }
+
+    static bool
+    is_constructor(const std::string &key)
+    {
+        return key.compare(0, Constructor.size(), Constructor) == 0;
+    }
+
+    /**
+     * Finds the reachable classes and members of a program.
+     */
+    class Reachability
+    {
+    public:
+        struct ClassInfo
+        {
+            std::string name;
+            Class *clazz;
+            std::string super_class;
+            std::vector<std::string> interfaces;
+            std::vector<std::string> methods;
+            std::vector<std::string> fields;
+            std::vector<bool> reached_methods;
+            std::vector<bool> reached_fields;
+            std::vector<bool> followed_constants;
+            const BootstrapMethodsAttribute *bootstrap_methods = nullptr;
+            bool reachable = false;
+            bool keep_members = false;
+            // -1 until computed
+            int external_supertype = -1;
+
+            ClassInfo(std::string name, Class &clazz);
+        };
+
+    private:
+        /**
+         * A reached method or field, or the attributes of a reached class.
+         */
+        struct Member
+        {
+            enum Kind
+            {
+                MethodMember,
+                FieldMember,
+                ClassAttributes
+            };
+
+            ClassInfo *info;
+            Kind kind;
+            std::size_t index;
+        };
+
+        std::unordered_map<std::string, ClassInfo> classes_;
+        // classes declaring a method of the given name and descriptor
+        std::unordered_map<std::string, std::vector<std::pair<ClassInfo *, std::size_t>>> declarations_;
+        std::set<std::string> virtual_methods_;
+        std::deque<Member> work_list_;
+
+        ClassInfo *
+        find(const std::string &name);
+
+        bool
+        has_external_supertype(ClassInfo &info);
+
+        void
+        reach_descriptor(const std::string &descriptor);
+
+        std::size_t
+        reach_type_signature(const std::string &signature, std::size_t position);
+
+        void
+        reach_signature(const std::string &signature);
+
+        void
+        reach_signatures(ClassInfo &info, const Attributable &attributable);
+
+        void
+        reach_method(ClassInfo &info, std::size_t index);
+
+        void
+        reach_field(ClassInfo &info, std::size_t index);
+
+        bool
+        resolve_method(ClassInfo &info, const std::string &key);
+
+        bool
+        resolve_field(ClassInfo &info, const std::string &key);
+
+        void
+        follow_constant(ClassInfo &info, u2 index);
+
+        void
+        follow_all_constants(ClassInfo &info);
+
+        void
+        follow_class_attributes(ClassInfo &info);
+
+        void
+        follow_member(const Member &member);
+
+    public:
+        explicit Reachability(std::map<std::string, Class> &classes);
+
+        void
+        reach_class(const std::string &name, bool keep_members = false);
+
+        void
+        reach_method(const std::string &class_name, const std::string &key, bool is_virtual);
+
+        void
+        reach_field(const std::string &class_name, const std::string &key);
+
+        /**
+         * Follows the constants of the reached members until no new member is reached.
+         */
+        void
+        run();
+
+        inline ClassInfo &
+        info(const std::string &name)
+        {
+            return classes_.at(name);
+        }
+    };
+
+    Reachability::ClassInfo::ClassInfo(std::string name, Class &clazz)
+      : name(std::move(name))
+      , clazz(&clazz)
+      , reached_methods(clazz.methods().size())
+      , reached_fields(clazz.fields().size())
+      , followed_constants(clazz.constant_pool().count() + 1)
+    {
+        ConstantPool &pool = clazz.constant_pool();
+        if (auto super = clazz.super_class())
+            super_class = utf8_value(pool, super->name_index());
+        for (u2 index : clazz.interfaces())
+            interfaces.push_back(class_name(pool, index));
+        for (auto &method : clazz.methods())
+            methods.push_back(member_key(pool, method.name_index(), method.descriptor_index()));
+        for (auto &field : clazz.fields())
+            fields.push_back(member_key(pool, field.name_index(), field.descriptor_index()));
+        for (auto &attribute : clazz.attributes()) {
+            if (auto bootstrap = dynamic_cast<const BootstrapMethodsAttribute *>(attribute.get()))
+                bootstrap_methods = bootstrap;
+        }
+    }
+
+    Reachability::Reachability(std::map<std::string, Class> &classes)
+    {
+        for (auto &[name, clazz] : classes)
+            classes_.try_emplace(name, name, clazz);
+        for (auto &[name, info] : classes_) {
+            for (std::size_t i = 0; i < info.methods.size(); ++i)
+                declarations_[info.methods[i]].emplace_back(&info, i);
+        }
+        for (const char *method : ObjectMethods)
+            virtual_methods_.insert(method);
+    }
+
+    Reachability::ClassInfo *
+    Reachability::find(const std::string &name)
+    {
+        auto it = classes_.find(name);
+        return it != classes_.end() ? &it->second : nullptr;
+    }
+
+    bool
+    Reachability::has_external_supertype(ClassInfo &info)
+    {
+        if (info.external_supertype >= 0)
+            return info.external_supertype;
+        info.external_supertype = 0;
+        std::vector<const std::string *> supertypes{ &info.super_class };
+        for (auto &interface : info.interfaces)
+            supertypes.push_back(&interface);
+        for (auto *supertype : supertypes) {
+            if (supertype->empty() || *supertype == "java/lang/Object")
+                continue;
+            auto super = find(*supertype);
+            if (super == nullptr || has_external_supertype(*super)) {
+                info.external_supertype = 1;
+                break;
+            }
+        }
+        return info.external_supertype;
+    }
+
+    void
+    Reachability::reach_class(const std::string &name, bool keep_members)
+    {
+        if (!name.empty() && name[0] == '[') {
+            reach_descriptor(name);
+            return;
+        }
+        auto info = find(name);
+        if (info == nullptr || (info->reachable && (info->keep_members || !keep_members)))
+            return;
+        if (!info->reachable)
+            work_list_.push_back({ info, Member::ClassAttributes, 0 });
+        info->reachable = true;
+        info->keep_members |= keep_members;
+
+        reach_class(info->super_class);
+        for (auto &interface : info->interfaces)
+            reach_class(interface);
+
+        // the class library may call any method overriding its own and may access the fields by reflection
+        bool overrides = has_external_supertype(*info);
+        for (std::size_t i = 0; i < info->methods.size(); ++i) {
+            const std::string &method = info->methods[i];
+            if (info->keep_members || (overrides && !is_constructor(method)) || method == StaticInitializer ||
+                virtual_methods_.count(method) > 0)
+                reach_method(*info, i);
+        }
+        if (info->keep_members || overrides) {
+            for (std::size_t i = 0; i < info->fields.size(); ++i)
+                reach_field(*info, i);
+        }
+    }
+
+    void
+    Reachability::reach_descriptor(const std::string &descriptor)
+    {
+        for (std::size_t i = 0; i < descriptor.size(); ++i) {
+            if (descriptor[i] != 'L')
+                continue;
+            std::size_t end = descriptor.find(';', i);
+            if (end == std::string::npos)
+                return;
+            reach_class(descriptor.substr(i + 1, end - i - 1));
+            i = end;
+        }
+    }
+
+    /**
+     * Reaches the classes of a type in a generic signature.
+     *
+     * @return position after the type.
+     */
+    std::size_t
+    Reachability::reach_type_signature(const std::string &signature, std::size_t position)
+    {
+        if (position >= signature.size())
+            return signature.size();
+        switch (signature[position]) {
+        case '[':
+            return reach_type_signature(signature, position + 1);
+        case 'T': {
+            // type variable
+            std::size_t end = signature.find(';', position);
+            return end != std::string::npos ? end + 1 : signature.size();
+        }
+        case 'L':
+            break;
+        default:
+            // primitive type or void
+            return position + 1;
+        }
+
+        // the class name is followed by the type arguments and the names of the inner classes, e.g. La<TT;>.B;
+        std::size_t end = signature.find_first_of("<.;", position);
+        if (end == std::string::npos)
+            return signature.size();
+        reach_class(signature.substr(position + 1, end - position - 1));
+        position = end;
+        while (position < signature.size() && signature[position] != ';') {
+            if (signature[position] == '<') {
+                ++position;
+                while (position < signature.size() && signature[position] != '>') {
+                    if (signature[position] == '*')
+                        ++position;
+                    else if (signature[position] == '+' || signature[position] == '-')
+                        position = reach_type_signature(signature, position + 1);
+                    else
+                        position = reach_type_signature(signature, position);
+                }
+                ++position;
+            } else if (signature[position] == '.') {
+                position = std::min(signature.find_first_of("<.;", position + 1), signature.size());
+            } else {
+                return signature.size();
+            }
+        }
+        return std::min(position + 1, signature.size());
+    }
+
+    /**
+     * Reaches the classes named in a generic signature of a class, a method or a field.
+     */
+    void
+    Reachability::reach_signature(const std::string &signature)
+    {
+        std::size_t position = 0;
+        std::size_t size = signature.size();
+        // formal type parameters and their bounds, e.g. <T:Ljava/lang/Object;U::La;>
+        if (position < size && signature[position] == '<') {
+            ++position;
+            while (position < size && signature[position] != '>') {
+                position = signature.find(':', position);
+                if (position == std::string::npos)
+                    return;
+                while (position < size && signature[position] == ':') {
+                    ++position;
+                    if (position < size && signature[position] != ':')
+                        position = reach_type_signature(signature, position);
+                }
+            }
+            ++position;
+        }
+        // method signature, the thrown exceptions follow the return type
+        if (position < size && signature[position] == '(') {
+            ++position;
+            while (position < size && signature[position] != ')')
+                position = reach_type_signature(signature, position);
+            ++position;
+        }
+        while (position < size) {
+            if (signature[position] == '^')
+                ++position;
+            position = reach_type_signature(signature, position);
+        }
+    }
+
+    void
+    Reachability::reach_signatures(ClassInfo &info, const Attributable &attributable)
+    {
+        const ConstantPool &pool = info.clazz->constant_pool();
+        for (auto &attribute : attributable.attributes()) {
+            auto raw = dynamic_cast<const RawAttribute *>(attribute.get());
+            if (raw == nullptr || raw->bytes().size() != 2 || utf8_value(pool, raw->name_index()) != "Signature")
+                continue;
+            reach_signature(utf8_value(pool, (raw->bytes()[0] << 8u) | raw->bytes()[1]));
+        }
+    }
+
+    void
+    Reachability::reach_method(ClassInfo &info, std::size_t index)
+    {
+        if (info.reached_methods[index])
+            return;
+        info.reached_methods[index] = true;
+        work_list_.push_back({ &info, Member::MethodMember, index });
+    }
+
+    void
+    Reachability::reach_field(ClassInfo &info, std::size_t index)
+    {
+        if (info.reached_fields[index])
+            return;
+        info.reached_fields[index] = true;
+        work_list_.push_back({ &info, Member::FieldMember, index });
+    }
+
+    bool
+    Reachability::resolve_method(ClassInfo &info, const std::string &key)
+    {
+        auto it = std::find(info.methods.begin(), info.methods.end(), key);
+        if (it != info.methods.end()) {
+            reach_method(info, it - info.methods.begin());
+            return true;
+        }
+        auto super = find(info.super_class);
+        if (super != nullptr && resolve_method(*super, key))
+            return true;
+        // an interface method may be declared by several superinterfaces
+        bool found = false;
+        for (auto &interface : info.interfaces) {
+            if (auto super_interface = find(interface))
+                found |= resolve_method(*super_interface, key);
+        }
+        return found;
+    }
+
+    bool
+    Reachability::resolve_field(ClassInfo &info, const std::string &key)
+    {
+        auto it = std::find(info.fields.begin(), info.fields.end(), key);
+        if (it != info.fields.end()) {
+            reach_field(info, it - info.fields.begin());
+            return true;
+        }
+        for (auto &interface : info.interfaces) {
+            auto super_interface = find(interface);
+            if (super_interface != nullptr && resolve_field(*super_interface, key))
+                return true;
+        }
+        auto super = find(info.super_class);
+        return super != nullptr && resolve_field(*super, key);
+    }
+
+    void
+    Reachability::reach_method(const std::string &class_name, const std::string &key, bool is_virtual)
+    {
+        reach_class(class_name);
+        if (is_virtual && virtual_methods_.insert(key).second) {
+            auto it = declarations_.find(key);
+            if (it != declarations_.end()) {
+                for (auto &[info, index] : it->second) {
+                    if (info->reachable)
+                        reach_method(*info, index);
+                }
+            }
+        }
+        if (auto info = find(class_name))
+            resolve_method(*info, key);
+    }
+
+    void
+    Reachability::reach_field(const std::string &class_name, const std::string &key)
+    {
+        reach_class(class_name);
+        if (auto info = find(class_name))
+            resolve_field(*info, key);
+    }
+
+    void
+    Reachability::follow_constant(ClassInfo &info, u2 index)
+    {
+        ConstantPool &pool = info.clazz->constant_pool();
+        if (index == 0 || index > pool.count() || info.followed_constants[index])
+            return;
+        info.followed_constants[index] = true;
+
+        Constant *constant = pool.get(index);
+        if (auto class_constant = dynamic_cast<ClassConstant *>(constant)) {
+            reach_class(utf8_value(pool, class_constant->name_index()));
+        } else if (auto field_ref = dynamic_cast<FieldRefConstant *>(constant)) {
+            reach_field(class_name(pool, field_ref->class_index()),
+                        name_and_type_key(pool, field_ref->name_and_type_index()));
+        } else if (auto method_ref = dynamic_cast<MethodRefConstant *>(constant)) {
+            std::string key = name_and_type_key(pool, method_ref->name_and_type_index());
+            reach_method(class_name(pool, method_ref->class_index()), key, !is_constructor(key));
+        } else if (auto interface_method_ref = dynamic_cast<InterfaceMethodRefConstant *>(constant)) {
+            std::string key = name_and_type_key(pool, interface_method_ref->name_and_type_index());
+            reach_method(class_name(pool, interface_method_ref->class_index()), key, true);
+        } else if (auto name_and_type = dynamic_cast<NameAndTypeConstant *>(constant)) {
+            reach_descriptor(utf8_value(pool, name_and_type->descriptor_index()));
+        } else if (auto method_type = dynamic_cast<MethodTypeConstant *>(constant)) {
+            reach_descriptor(utf8_value(pool, method_type->descriptor_index()));
+        } else if (auto invoke_dynamic = dynamic_cast<InvokeDynamicConstant *>(constant)) {
+            // the bootstrap method and its arguments, such as the implementation of a lambda
+            u2 bootstrap = invoke_dynamic->bootstrap_method_attr_index();
+            if (info.bootstrap_methods == nullptr || bootstrap >= info.bootstrap_methods->bootstrap_methods().size()) {
+                follow_all_constants(info);
+            } else {
+                auto &bootstrap_method = info.bootstrap_methods->bootstrap_methods()[bootstrap];
+                follow_constant(info, bootstrap_method.method_ref);
+                for (u2 argument : bootstrap_method.arguments)
+                    follow_constant(info, argument);
+            }
+        }
+        constant->visit_references([this, &info](u2 &reference) { follow_constant(info, reference); });
+    }
+
+    void
+    Reachability::follow_all_constants(ClassInfo &info)
+    {
+        u2 count = info.clazz->constant_pool().count();
+        for (u2 index = 1; index <= count; ++index)
+            follow_constant(info, index);
+    }
+
+    /**
+     * Follows the classes named by the attributes of a class, such as its nest mates, its enclosing class and
+     * the classes of its generic signature. The bootstrap methods are followed from their call sites instead.
+     */
+    void
+    Reachability::follow_class_attributes(ClassInfo &info)
+    {
+        auto visitor = [this, &info](u2 &index) { follow_constant(info, index); };
+        bool known = true;
+        for (auto &attribute : info.clazz->attributes()) {
+            if (dynamic_cast<const BootstrapMethodsAttribute *>(attribute.get()) == nullptr)
+                known &= attribute->visit_constants(visitor);
+        }
+        reach_signatures(info, *info.clazz);
+        if (!known)
+            follow_all_constants(info);
+    }
+
+    void
+    Reachability::follow_member(const Member &member)
+    {
+        ClassInfo &info = *member.info;
+        if (member.kind == Member::ClassAttributes) {
+            follow_class_attributes(info);
+            return;
+        }
+
+        const ConstantPool &pool = info.clazz->constant_pool();
+        auto visitor = [this, &info](u2 &index) { follow_constant(info, index); };
+        bool known;
+        if (member.kind == Member::FieldMember) {
+            Field &field = info.clazz->fields()[member.index];
+            reach_descriptor(utf8_value(pool, field.descriptor_index()));
+            reach_signatures(info, field);
+            known = field.visit_constants(visitor);
+        } else {
+            Method &method = info.clazz->methods()[member.index];
+            reach_descriptor(utf8_value(pool, method.descriptor_index()));
+            reach_signatures(info, method);
+            known = method.visit_constants(visitor);
+        }
+        // the references of an attribute not known to jasm, such as code with wide instructions, cannot be followed
+        if (!known)
+            follow_all_constants(info);
+    }
+
+    void
+    Reachability::run()
+    {
+        while (!work_list_.empty()) {
+            Member member = work_list_.front();
+            work_list_.pop_front();
+            follow_member(member);
+        }
+    }
+
+    /**
+     * Removes the elements which are not flagged.
+     *
+     * @return number of the removed elements.
+     */
+    template<typename T>
+    static std::size_t
+    retain(std::vector<T> &elements, const std::vector<bool> &flags)
+    {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < elements.size(); ++i) {
+            if (!flags[i])
+                continue;
+            if (kept != i)
+                elements[kept] = std::move(elements[i]);
+            ++kept;
+        }
+        std::size_t removed = elements.size() - kept;
+        elements.erase(elements.begin() + kept, elements.end());
+        return removed;
+    }
+
+    bool
+    Shrinker::add_class(Class &&clazz)
+    {
+        ClassConstant *this_class = clazz.this_class();
+        if (this_class == nullptr)
+            return false;
+        std::string name = utf8_value(clazz.constant_pool(), this_class->name_index());
+        if (name.empty() || classes_.count(name) > 0 || opaque_classes_.count(name) > 0)
+            return false;
+        // the constants of the raw attributes can be visited only once their positions are known
+        Optimizer::index_attributes(clazz);
+        classes_.emplace(std::move(name), std::move(clazz));
+        return true;
+    }
+
+    bool
+    Shrinker::add_opaque_class(const std::string &name, std::vector<std::string> references)
+    {
+        if (name.empty() || classes_.count(name) > 0)
+            return false;
+        return opaque_classes_.try_emplace(name, std::move(references)).second;
+    }
+
+    bool
+    Shrinker::keep_class(const std::string &name)
+    {
+        if (opaque_classes_.count(name) > 0)
+            return true;
+        if (classes_.count(name) == 0)
+            return false;
+        kept_classes_.push_back(name);
+        return true;
+    }
+
+    bool
+    Shrinker::keep_method(const std::string &class_name, const std::string &name, const std::string &descriptor)
+    {
+        if (opaque_classes_.count(class_name) > 0)
+            return true;
+        auto it = classes_.find(class_name);
+        if (it == classes_.end())
+            return false;
+        ConstantPool &pool = it->second.constant_pool();
+        for (auto &method : it->second.methods()) {
+            if (utf8_value(pool, method.name_index()) == name &&
+                utf8_value(pool, method.descriptor_index()) == descriptor) {
+                kept_methods_.push_back({ class_name, name, descriptor });
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Shrinker::Statistics
+    Shrinker::shrink()
+    {
+        Statistics statistics;
+        Reachability reachability(classes_);
+        for (auto &name : kept_classes_)
+            reachability.reach_class(name, true);
+        for (auto &[class_name, name, descriptor] : kept_methods_)
+            reachability.reach_method(class_name, name + ':' + descriptor, false);
+        // the code of an opaque class may use any member of the classes it refers to
+        for (auto &[name, references] : opaque_classes_) {
+            for (auto &reference : references)
+                reachability.reach_class(reference, true);
+        }
+        statistics.opaque_classes = opaque_classes_.size();
+        reachability.run();
+
+        for (auto it = classes_.begin(); it != classes_.end();) {
+            auto &info = reachability.info(it->first);
+            if (!info.reachable) {
+                ++statistics.removed_classes;
+                it = classes_.erase(it);
+                continue;
+            }
+
+            Class &clazz = it->second;
+            statistics.removed_methods += retain(clazz.methods(), info.reached_methods);
+            statistics.removed_fields += retain(clazz.fields(), info.reached_fields);
+            ++statistics.classes;
+            ++it;
+        }
+        return statistics;
+    }
+
+}
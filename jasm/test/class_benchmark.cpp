@@ -0,0 +1,515 @@
+/**
+ * @file class_benchmark.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef JASM_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "class.hpp"
+
+using namespace jasm;
+
+/*
+ * Allocation counting. Every allocation made by the process goes through the replaced global operator new.
+ */
+
+static std::size_t allocations = 0;
+static std::size_t allocated_bytes = 0;
+
+void *
+operator new(std::size_t size)
+{
+    ++allocations;
+    allocated_bytes += size;
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *
+operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void
+operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void
+operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void
+operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void
+operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+/**
+ * Read-only memory mapping of a whole file.
+ */
+class MappedFile
+{
+private:
+    const u1 *data_;
+    std::size_t size_;
+
+public:
+    explicit MappedFile(const std::string &path)
+      : data_(nullptr)
+      , size_(0)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st
+        {};
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                data_ = static_cast<const u1 *>(data);
+                size_ = st.st_size;
+            }
+        }
+        close(fd);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &
+    operator=(const MappedFile &) = delete;
+
+    ~MappedFile()
+    {
+        if (data_)
+            munmap(const_cast<u1 *>(data_), size_);
+    }
+
+    inline const u1 *
+    data() const
+    {
+        return data_;
+    }
+
+    inline std::size_t
+    size() const
+    {
+        return size_;
+    }
+};
+
+/**
+ * A class file of the benchmarked corpus, either a standalone file or an archive entry.
+ */
+struct entry_t
+{
+    std::string name;
+    std::size_t offset;
+    std::size_t compressed_size;
+    std::size_t size;
+    bool deflated;
+};
+
+/**
+ * Class files of a directory, a JAR or a JMOD file.
+ */
+struct corpus_t
+{
+    std::string archive;
+    std::vector<entry_t> entries;
+    std::size_t bytes = 0;
+};
+
+static u2
+read_le16(const u1 *ptr)
+{
+    return ptr[0] | (ptr[1] << 8);
+}
+
+static u4
+read_le32(const u1 *ptr)
+{
+    return read_le16(ptr) | (read_le16(ptr + 2) << 16);
+}
+
+static bool
+is_class_file(const std::string &name)
+{
+    // module descriptors use constants not supported by jasm
+    const std::string suffix = ".class";
+    return name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0 &&
+           name.find("module-info.class") == std::string::npos;
+}
+
+/**
+ * Reads the central directory of a ZIP archive. Archives with a prefix (JMOD files start with a 4 byte header)
+ * are supported, because the offsets are computed relative to the actual end of central directory record.
+ */
+static bool
+read_archive(const std::string &path, corpus_t &corpus)
+{
+    MappedFile file(path);
+    const u1 *data = file.data();
+    std::size_t size = file.size();
+    if (!data || size < 22)
+        return false;
+
+    // the end of central directory record is followed by a comment of at most 65535 bytes
+    std::size_t eocd = size - 22;
+    while (read_le32(data + eocd) != 0x06054b50) {
+        if (eocd == 0 || size - eocd > 22 + 0xFFFF)
+            return false;
+        --eocd;
+    }
+
+    u2 entries = read_le16(data + eocd + 10);
+    u4 cd_size = read_le32(data + eocd + 12);
+    u4 cd_offset = read_le32(data + eocd + 16);
+    std::size_t base = eocd - cd_size - cd_offset;
+
+    corpus.archive = path;
+    const u1 *ptr = data + base + cd_offset;
+    for (u2 i = 0; i < entries; ++i) {
+        if (read_le32(ptr) != 0x02014b50)
+            return false;
+        u2 method = read_le16(ptr + 10);
+        u4 compressed_size = read_le32(ptr + 20);
+        u4 entry_size = read_le32(ptr + 24);
+        u2 name_length = read_le16(ptr + 28);
+        u2 extra_length = read_le16(ptr + 30);
+        u2 comment_length = read_le16(ptr + 32);
+        u4 local_header = read_le32(ptr + 42);
+        std::string name(reinterpret_cast<const char *>(ptr + 46), name_length);
+        ptr += 46 + name_length + extra_length + comment_length;
+
+        if (!is_class_file(name))
+            continue;
+
+#ifndef JASM_HAVE_ZLIB
+        if (method == 8) {
+            std::cerr << "skipping compressed entry " << name << " (built without zlib)" << std::endl;
+            continue;
+        }
+#endif
+        if (method != 0 && method != 8) {
+            std::cerr << "skipping entry " << name << " (unsupported compression method " << method << ")"
+                      << std::endl;
+            continue;
+        }
+
+        const u1 *local = data + base + local_header;
+        std::size_t offset = base + local_header + 30 + read_le16(local + 26) + read_le16(local + 28);
+        corpus.entries.push_back({ name, offset, compressed_size, entry_size, method == 8 });
+        corpus.bytes += entry_size;
+    }
+    return true;
+}
+
+static void
+read_directory(const std::string &path, corpus_t &corpus)
+{
+    for (auto &file : std::filesystem::recursive_directory_iterator(path)) {
+        if (!file.is_regular_file() || !is_class_file(file.path().string()))
+            continue;
+        std::size_t size = file.file_size();
+        corpus.entries.push_back({ file.path().string(), 0, size, size, false });
+        corpus.bytes += size;
+    }
+    std::sort(corpus.entries.begin(), corpus.entries.end(),
+              [](const entry_t &lhs, const entry_t &rhs) { return lhs.name < rhs.name; });
+}
+
+/**
+ * Decompresses an entry into the buffer.
+ */
+static void
+inflate_entry(const entry_t &entry, const u1 *compressed, std::vector<u1> &buffer)
+{
+    buffer.resize(entry.size);
+#ifdef JASM_HAVE_ZLIB
+    z_stream stream{};
+    stream.next_in = const_cast<u1 *>(compressed);
+    stream.avail_in = entry.compressed_size;
+    stream.next_out = buffer.data();
+    stream.avail_out = buffer.size();
+    // negative window bits select raw deflate data without the zlib header
+    inflateInit2(&stream, -MAX_WBITS);
+    int result = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+    if (result != Z_STREAM_END)
+        std::cerr << "could not inflate " << entry.name << std::endl;
+#endif
+}
+
+enum class Input
+{
+    STREAM,
+    MMAP
+};
+
+enum class Work
+{
+    READ,
+    ROUND_TRIP
+};
+
+struct result_t
+{
+    std::size_t classes = 0;
+    std::size_t bytes = 0;
+    std::size_t emitted_bytes = 0;
+};
+
+static void
+process(std::istream &is, Work work, result_t &result)
+{
+    Class clazz(is);
+    ++result.classes;
+    if (work == Work::ROUND_TRIP) {
+        std::ostringstream os;
+        clazz.emit_bytecode(os);
+        result.emitted_bytes += os.tellp();
+    }
+}
+
+/**
+ * Reads every class of the corpus through the given input path.
+ */
+static result_t
+run(const corpus_t &corpus, Input input, Work work)
+{
+    result_t result;
+    std::vector<u1> buffer;
+
+    if (input == Input::MMAP) {
+        std::unique_ptr<MappedFile> archive;
+        if (!corpus.archive.empty())
+            archive = std::make_unique<MappedFile>(corpus.archive);
+
+        for (auto &entry : corpus.entries) {
+            std::unique_ptr<MappedFile> file;
+            const u1 *data;
+            if (archive) {
+                data = archive->data() + entry.offset;
+            } else {
+                file = std::make_unique<MappedFile>(entry.name);
+                data = file->data();
+            }
+            if (entry.deflated) {
+                inflate_entry(entry, data, buffer);
+                data = buffer.data();
+            }
+
+            MemoryBuffer memory(data, entry.size);
+            std::istream is(&memory);
+            process(is, work, result);
+            result.bytes += entry.size;
+        }
+    } else if (corpus.archive.empty()) {
+        for (auto &entry : corpus.entries) {
+            std::ifstream is(entry.name, std::ios::in | std::ios::binary);
+            process(is, work, result);
+            result.bytes += entry.size;
+        }
+    } else {
+        std::ifstream is(corpus.archive, std::ios::in | std::ios::binary);
+        std::vector<u1> compressed;
+        for (auto &entry : corpus.entries) {
+            is.seekg(entry.offset);
+            if (entry.deflated) {
+                compressed.resize(entry.compressed_size);
+                is.read(reinterpret_cast<char *>(compressed.data()), compressed.size());
+                inflate_entry(entry, compressed.data(), buffer);
+                MemoryBuffer memory(buffer.data(), buffer.size());
+                std::istream entry_is(&memory);
+                process(entry_is, work, result);
+            } else {
+                // stored entries are read directly from the archive stream
+                process(is, work, result);
+            }
+            result.bytes += entry.size;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Round-trips every class and compares the emitted bytecode with the original class file.
+ *
+ * @return number of classes whose bytecode differs.
+ */
+static std::size_t
+verify(const corpus_t &corpus)
+{
+    std::size_t mismatches = 0;
+    std::unique_ptr<MappedFile> archive;
+    if (!corpus.archive.empty())
+        archive = std::make_unique<MappedFile>(corpus.archive);
+
+    std::vector<u1> buffer;
+    for (auto &entry : corpus.entries) {
+        std::unique_ptr<MappedFile> file;
+        const u1 *data;
+        if (archive) {
+            data = archive->data() + entry.offset;
+        } else {
+            file = std::make_unique<MappedFile>(entry.name);
+            data = file->data();
+        }
+        if (entry.deflated) {
+            inflate_entry(entry, data, buffer);
+            data = buffer.data();
+        }
+
+        MemoryBuffer memory(data, entry.size);
+        std::istream is(&memory);
+        Class clazz(is);
+        std::ostringstream os;
+        clazz.emit_bytecode(os);
+        std::string emitted = std::move(os).str();
+
+        if (emitted.size() != entry.size || std::memcmp(emitted.data(), data, entry.size) != 0) {
+            if (mismatches < 10)
+                std::cerr << "round trip differs: " << entry.name << std::endl;
+            ++mismatches;
+        }
+    }
+    return mismatches;
+}
+
+static long
+peak_rss_kb()
+{
+    struct rusage usage
+    {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static void
+show_usage(const char *name)
+{
+    std::cerr << "usage: " << name << " [--iterations N] [--mode stream|mmap|all] [--verify] <DIRECTORY|JAR|JMOD>"
+              << std::endl;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int iterations = 3;
+    std::string mode = "all";
+    bool verify_round_trip = false;
+    const char *path = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            mode = argv[++i];
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            verify_round_trip = true;
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            show_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!path || (mode != "stream" && mode != "mmap" && mode != "all")) {
+        show_usage(argv[0]);
+        return 1;
+    }
+
+    corpus_t corpus;
+    if (std::filesystem::is_directory(path)) {
+        read_directory(path, corpus);
+    } else if (!read_archive(path, corpus)) {
+        std::cerr << "could not read archive " << path << std::endl;
+        return 1;
+    }
+
+    std::cout << corpus.entries.size() << " classes, " << corpus.bytes << " bytes" << std::endl;
+    if (corpus.entries.empty())
+        return 0;
+
+    std::vector<std::pair<Input, const char *>> inputs;
+    if (mode != "mmap")
+        inputs.emplace_back(Input::STREAM, "stream");
+    if (mode != "stream")
+        inputs.emplace_back(Input::MMAP, "mmap");
+
+    std::cout << std::left << std::setw(8) << "input" << std::setw(12) << "work" << std::right << std::setw(12)
+              << "classes/s" << std::setw(10) << "MB/s" << std::setw(14) << "allocs/class" << std::setw(14)
+              << "KB alloc/cls" << std::setw(14) << "peak RSS KB" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    for (auto &[input, input_name] : inputs) {
+        for (Work work : { Work::READ, Work::ROUND_TRIP }) {
+            // warm up the page cache, so the first measured mode is not penalised
+            run(corpus, input, work);
+
+            std::size_t allocations_start = allocations;
+            std::size_t allocated_bytes_start = allocated_bytes;
+            auto start = std::chrono::steady_clock::now();
+            result_t result;
+            for (int i = 0; i < iterations; ++i)
+                result = run(corpus, input, work);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            double classes = double(result.classes) * iterations;
+            std::cout << std::left << std::setw(8) << input_name << std::setw(12)
+                      << (work == Work::READ ? "read" : "round-trip") << std::right << std::setw(12)
+                      << classes / seconds << std::setw(10) << double(result.bytes) * iterations / seconds / 1e6
+                      << std::setw(14) << double(allocations - allocations_start) / classes << std::setw(14)
+                      << double(allocated_bytes - allocated_bytes_start) / classes / 1024 << std::setw(14)
+                      << peak_rss_kb() << std::endl;
+        }
+    }
+
+    if (verify_round_trip) {
+        std::size_t mismatches = verify(corpus);
+        std::cout << corpus.entries.size() - mismatches << '/' << corpus.entries.size()
+                  << " classes round-trip byte for byte" << std::endl;
+        return mismatches == 0 ? 0 : 1;
+    }
+
+    return 0;
+}
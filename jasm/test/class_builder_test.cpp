@@ -10,9 +10,11 @@
 
 #include <ios>
 #include <iostream>
+#include <sstream>
 
 #include "builder.hpp"
 #include "class.hpp"
+#include "disassembler.hpp"
 
 using namespace jasm;
 
@@ -20,7 +22,7 @@ int
 main()
 {
     ClassBuilder builder("HelloWorld");
-    builder.set_version(59, 0).set_access_flags(Class::ACC_PUBLIC);
+    builder.set_version(59, 0).set_access_flags(Class::ACC_PUBLIC).add_interface("java/io/Serializable");
 
     ClassType str_type("java/lang/String");
     ClassType print_stream("java/io/PrintStream");
@@ -49,12 +51,162 @@ main()
     builder.make_instruction<Return>();
     builder.leave_method();
 
+    // static int weekday(int day) returns 1 on working days, 0 on weekends and -1 on invalid days
+    IntType int_type;
+    MethodType weekday_signature(&int_type, &int_type);
+    using VerificationType = StackMapTableAttribute::VerificationType;
+    std::vector<VerificationType> int_local{ VerificationType::ITEM_INTEGER };
+
+    builder.enter_method("weekday", weekday_signature, Method::ACC_PUBLIC | Method::ACC_STATIC);
+    Label working = builder.create_label();
+    Label weekend = builder.create_label();
+    Label invalid = builder.create_label();
+    builder.make_instruction<IntLoad0>();
+    builder.make_instruction<TableSwitch>(1, invalid, std::vector<Label>{ working, working, working, working, working,
+                                                                          weekend, weekend });
+    builder.bind_label(working);
+    builder.set_frame(int_local, {});
+    builder.make_instruction<IntConst1>();
+    builder.make_instruction<IntReturn>();
+    builder.bind_label(weekend);
+    builder.set_frame(int_local, {});
+    builder.make_instruction<IntConst0>();
+    builder.make_instruction<IntReturn>();
+    builder.bind_label(invalid);
+    builder.set_frame(int_local, {});
+    builder.make_instruction<IntConstNeg1>();
+    builder.make_instruction<IntReturn>();
+    builder.leave_method();
+
+    // static int is_prime(int n) for n < 10, sparse keys are looked up
+    builder.enter_method("is_prime", weekday_signature, Method::ACC_PUBLIC | Method::ACC_STATIC);
+    Label prime = builder.create_label();
+    Label composite = builder.create_label();
+    builder.make_instruction<IntLoad0>();
+    builder.make_instruction<LookupSwitch>(composite, std::vector<std::pair<int32_t, Label>>{
+                                                        { 7, prime }, { 2, prime }, { 5, prime }, { 3, prime } });
+    builder.bind_label(prime);
+    builder.set_frame(int_local, {});
+    builder.make_instruction<IntConst1>();
+    builder.make_instruction<IntReturn>();
+    builder.bind_label(composite);
+    builder.set_frame(int_local, {});
+    builder.make_instruction<IntConst0>();
+    builder.make_instruction<IntReturn>();
+    builder.leave_method();
+
+    // static String greet(String name) concatenates the strings by invokedynamic
+    ClassType lookup_type("java/lang/invoke/MethodHandles$Lookup");
+    ClassType method_type("java/lang/invoke/MethodType");
+    ClassType call_site_type("java/lang/invoke/CallSite");
+    ClassType object_type("java/lang/Object");
+    ArrayType object_arr(&object_type, 1);
+    MethodType bootstrap_signature(&call_site_type, &lookup_type, &str_type, &method_type, &str_type, &object_arr);
+    MethodType greet_signature(&str_type, &str_type);
+
+    u2 concat_factory = builder.add_method_constant("java/lang/invoke/StringConcatFactory", "makeConcatWithConstants",
+                                                    bootstrap_signature);
+    u2 concat_handle = builder.add_method_handle_constant(MethodHandleConstant::REF_INVOKE_STATIC, concat_factory);
+    u2 bootstrap_method = builder.add_bootstrap_method(concat_handle, { builder.add_string_constant("Hello, \1!") });
+    u2 concat_call = builder.add_invoke_dynamic_constant(bootstrap_method, "makeConcatWithConstants", greet_signature);
+
+    builder.enter_method("greet", greet_signature, Method::ACC_PUBLIC | Method::ACC_STATIC);
+    builder.make_instruction<RefLoad0>();
+    builder.make_instruction<InvokeDynamic>(U2_SPLIT(concat_call), u1(0), u1(0));
+    builder.make_instruction<RefReturn>();
+    builder.leave_method();
+
+    // static String unreachable() has dead code after the return, its string constant is removed from the pool
+    MethodType unreachable_signature(&str_type);
+    u2 dead_message = builder.add_string_constant("Unreachable");
+
+    builder.enter_method("unreachable", unreachable_signature, Method::ACC_PUBLIC | Method::ACC_STATIC);
+    Label dead = builder.create_label();
+    builder.make_instruction<LoadConst>(U2_LOW(message));
+    builder.make_instruction<RefReturn>();
+    builder.make_instruction<RefConstNull>();
+    builder.bind_label(dead);
+    builder.make_instruction<LoadConst>(U2_LOW(dead_message));
+    builder.make_jump<GoTo>(dead);
+    builder.leave_method();
+
+    // static int size(List list) calls a method of an interface
+    ClassType list_type("java/util/List");
+    MethodType size_signature(&int_type, &list_type);
+    MethodType list_size_signature(&int_type);
+    u2 list_size = builder.add_interface_method_constant("java/util/List", "size", list_size_signature);
+
+    builder.enter_method("size", size_signature, Method::ACC_PUBLIC | Method::ACC_STATIC);
+    builder.make_instruction<RefLoad0>();
+    builder.make_instruction<InvokeInterface>(U2_SPLIT(list_size), u1(1), u1(0));
+    builder.make_instruction<IntReturn>();
+    builder.leave_method();
+
+    // static int locked_size(List list) holds the monitor of the list, a handler releases it on an exception
+    builder.enter_method("locked_size", size_signature, Method::ACC_PUBLIC | Method::ACC_STATIC);
+    Label locked = builder.create_label();
+    Label handler = builder.create_label();
+    builder.make_instruction<RefLoad0>();
+    builder.make_instruction<Duplicate>();
+    builder.make_instruction<RefStore1>();
+    builder.make_instruction<MonitorEnter>();
+    builder.bind_label(locked);
+    builder.make_instruction<RefLoad0>();
+    builder.make_instruction<InvokeInterface>(U2_SPLIT(list_size), u1(1), u1(0));
+    builder.make_instruction<RefLoad1>();
+    builder.make_instruction<MonitorExit>();
+    builder.make_instruction<IntReturn>();
+    builder.bind_label(handler);
+    VerificationType list_local(VerificationType::ITEM_OBJECT, builder.add_class_constant("java/util/List"));
+    builder.set_frame({ list_local, list_local },
+                      { VerificationType(VerificationType::ITEM_OBJECT, builder.add_class_constant("java/lang/Throwable")) });
+    builder.make_instruction<RefLoad1>();
+    builder.make_instruction<MonitorExit>();
+    builder.make_instruction<RefThrow>();
+    builder.add_exception_handler(locked, handler, handler);
+    builder.leave_method();
+
     Class clazz = builder.build();
+    clazz.remove_unused_constants();
     std::cout << clazz;
 
     std::ofstream os("jasm/test/classes/HelloWorld.class");
     clazz.emit_bytecode(os);
     os.close();
 
+    // static int far(int x) counts x up to a positive number, the loop body is longer than a two byte jump offset
+    // reaches, so the backward goto becomes goto_w and the conditional exit skips a goto_w
+    ClassBuilder far_builder("FarJumps");
+    far_builder.set_version(59, 0);
+    far_builder.enter_method("far", weekday_signature, Method::ACC_PUBLIC | Method::ACC_STATIC);
+    Label head = far_builder.create_label();
+    Label exit = far_builder.create_label();
+    far_builder.make_instruction<Nop>();
+    far_builder.bind_label(head);
+    far_builder.set_frame(int_local, {});
+    far_builder.make_instruction<IntLoad0>();
+    far_builder.make_jump<IfGt>(exit);
+    far_builder.set_fall_through_frame(int_local, {});
+    far_builder.make_instruction<IntInc>(u1(0), u1(1));
+    for (int i = 0; i < 40000; ++i)
+        far_builder.make_instruction<Nop>();
+    far_builder.make_jump<GoTo>(head);
+    far_builder.bind_label(exit);
+    far_builder.set_frame(int_local, {});
+    far_builder.make_instruction<IntLoad0>();
+    far_builder.make_instruction<IntReturn>();
+    far_builder.leave_method();
+
+    std::ostringstream far_os;
+    far_builder.build().emit_bytecode(far_os);
+    std::string far_bytes = std::move(far_os).str();
+    MemoryBuffer far_memory(far_bytes.data(), far_bytes.size());
+    std::istream far_is(&far_memory);
+    std::istringstream far_text(Disassembler().disassemble(Class(far_is)));
+    for (std::string line; std::getline(far_text, line);) {
+        if (line.find(" nop") == std::string::npos)
+            std::cout << line << std::endl;
+    }
+
     return 0;
 }
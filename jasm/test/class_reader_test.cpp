@@ -14,14 +14,22 @@
 #include "class.hpp"
 
 int
-main()
+main(int argc, char *argv[])
 {
-    // std::ifstream is("jasm/test/classes/HelloWorld.class",
-    std::ifstream is("/Users/petergrajcar/Desktop/java/io/PrintStream.class", std::ios::in | std::ios::binary);
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <CLASS_FILE>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream is(argv[1], std::ios::in | std::ios::binary);
+    if (!is) {
+        std::cerr << "could not open file " << argv[1] << std::endl;
+        return 1;
+    }
     jasm::Class clazz(is);
     is.close();
 
     std::cout << clazz;
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,68 @@
+/**
+ * @file disassembler_test.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <iostream>
+#include <sstream>
+
+#include "builder.hpp"
+#include "class.hpp"
+#include "disassembler.hpp"
+
+using namespace jasm;
+
+int
+main()
+{
+    ClassBuilder builder("Greeter");
+    builder.set_version(59, 0).set_access_flags(Class::ACC_PUBLIC);
+
+    ClassType str_type("java/lang/String");
+    ClassType print_stream_type("java/io/PrintStream");
+    PrimitiveType void_type = VoidType();
+    IntType int_type;
+    MethodType greet_signature(&void_type, &int_type);
+    MethodType println_signature(&void_type, &str_type);
+    // the constant is not referred to, removing it renumbers the other constants
+    builder.add_string_constant("Unused");
+    u2 out = builder.add_field_constant("java/lang/System", "out", print_stream_type);
+    u2 println = builder.add_method_constant("java/io/PrintStream", "println", println_signature);
+    u2 greeting = builder.add_string_constant("Hello,\t\"World\"");
+    builder.declare_field("count", int_type, Field::ACC_PRIVATE | Field::ACC_STATIC);
+
+    // static void greet(int times) prints the greeting if times is positive
+    builder.enter_method("greet", greet_signature, Method::ACC_PUBLIC | Method::ACC_STATIC);
+    Label done = builder.create_label();
+    builder.make_instruction<IntLoad>(u1(0));
+    builder.make_jump<IfLe>(done);
+    builder.make_instruction<GetStatic>(U2_SPLIT(out));
+    builder.make_instruction<LoadConst>(U2_LOW(greeting));
+    builder.make_instruction<InvokeVirtual>(U2_SPLIT(println));
+    builder.bind_label(done);
+    builder.set_frame({ StackMapTableAttribute::VerificationType::ITEM_INTEGER }, {});
+    builder.make_instruction<Return>();
+    builder.leave_method();
+
+    std::ostringstream os;
+    builder.build().emit_bytecode(os);
+    std::string bytes = std::move(os).str();
+    MemoryBuffer memory(bytes.data(), bytes.size());
+    std::istream is(&memory);
+    Class clazz(is);
+
+    Disassembler disassembler;
+    std::string text = disassembler.disassemble(clazz);
+    std::cout << text;
+
+    // the constants are resolved in the text, so it does not change with the order of the constant pool
+    clazz.remove_unused_constants();
+    std::cout << (disassembler.disassemble(clazz) == text ? "same text after compaction" : "text changed") << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file optimizer_test.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <iostream>
+#include <sstream>
+
+#include "builder.hpp"
+#include "class.hpp"
+#include "optimizer.hpp"
+
+using namespace jasm;
+
+int
+main()
+{
+    ClassBuilder builder("Clamp");
+    builder.set_version(59, 0).set_access_flags(Class::ACC_PUBLIC);
+
+    IntType int_type;
+    MethodType clamp_signature(&int_type, &int_type);
+    using VerificationType = StackMapTableAttribute::VerificationType;
+    std::vector<VerificationType> int_local{ VerificationType::ITEM_INTEGER };
+    // the constant is not referred to and is removed from the pool
+    builder.add_string_constant("Unused");
+    u2 limit = builder.add_integer_constant(100);
+
+    // static int clamp(int x) returns min(x, 100) written with nops, long forms of instructions and a jump chain
+    builder.enter_method("clamp", clamp_signature, Method::ACC_PUBLIC | Method::ACC_STATIC);
+    Label small = builder.create_label();
+    Label load = builder.create_label();
+    Label done = builder.create_label();
+    builder.make_instruction<Nop>();
+    builder.make_instruction<IntLoad>(u1(0));
+    builder.make_instruction<LoadConstW>(U2_SPLIT(limit));
+    builder.make_jump<IfIntCmpLe>(small);
+    builder.make_instruction<ShortPush>(u1(0), u1(100));
+    builder.make_jump<GoTo>(done);
+    // the block is unreachable once the conditional jump is threaded to its target
+    builder.bind_label(small);
+    builder.set_frame(int_local, {});
+    builder.make_jump<GoTo>(load);
+    builder.bind_label(load);
+    builder.set_frame(int_local, {});
+    builder.make_instruction<IntLoad>(u1(0));
+    builder.make_instruction<IntStore>(u1(1));
+    builder.make_instruction<IntLoad>(u1(1));
+    builder.make_jump<GoTo>(done);
+    builder.bind_label(done);
+    builder.set_frame(int_local, int_local);
+    builder.make_instruction<IntReturn>();
+    builder.leave_method();
+
+    Class clazz = builder.build();
+    std::ostringstream os;
+    clazz.emit_bytecode(os);
+    std::string bytes = std::move(os).str();
+
+    // the optimiser works on classes read from class files
+    MemoryBuffer memory(bytes.data(), bytes.size());
+    std::istream is(&memory);
+    Class read(is);
+    Optimizer::Statistics statistics = Optimizer().optimize(read);
+    std::cout << statistics.methods << " methods rewritten, " << statistics.removed_instructions
+              << " instructions removed, " << statistics.removed_constants << " constants removed" << std::endl;
+
+    std::ostringstream optimized_os;
+    read.emit_bytecode(optimized_os);
+    std::string optimized = std::move(optimized_os).str();
+    std::cout << bytes.size() << " -> " << optimized.size() << " bytes" << std::endl;
+
+    MemoryBuffer optimized_memory(optimized.data(), optimized.size());
+    std::istream optimized_is(&optimized_memory);
+    Class reread(optimized_is);
+    std::cout << reread;
+
+    return 0;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file shrinker_test.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <iostream>
+#include <sstream>
+
+#include "builder.hpp"
+#include "class.hpp"
+#include "class_file.hpp"
+#include "shrinker.hpp"
+
+using namespace jasm;
+
+/**
+ * Emits a built class and reads it back, as the shrinker works on classes read from class files.
+ */
+static Class
+reread(const Class &clazz)
+{
+    std::ostringstream os;
+    clazz.emit_bytecode(os);
+    std::string bytes = std::move(os).str();
+    MemoryBuffer memory(bytes.data(), bytes.size());
+    std::istream is(&memory);
+    return Class(is);
+}
+
+static Class
+reread(ClassBuilder &builder)
+{
+    return reread(builder.build());
+}
+
+static void
+add_empty_class(Shrinker &shrinker, const char *name)
+{
+    ClassBuilder builder(name);
+    builder.set_version(59, 0).set_access_flags(Class::ACC_PUBLIC);
+    shrinker.add_class(reread(builder));
+}
+
+static void
+put_utf8(std::vector<u1> &bytes, const std::string &value)
+{
+    bytes.insert(bytes.end(), { ConstantPool::CONSTANT_UTF_8, U2_SPLIT(value.size()) });
+    bytes.insert(bytes.end(), value.begin(), value.end());
+}
+
+/**
+ * @return class file of a class Plugin which loads a CONSTANT_Dynamic of the type Helper. The reader of jasm does not
+ * support the constant, therefore the class is kept as an opaque class.
+ */
+static std::vector<u1>
+plugin_class_file()
+{
+    std::vector<u1> bytes{ 0xCA, 0xFE, 0xBA, 0xBE, 0, 0, 0, 59, 0, 9 };
+    put_utf8(bytes, "Plugin");
+    bytes.insert(bytes.end(), { ConstantPool::CONSTANT_CLASS, 0, 1 });
+    put_utf8(bytes, "java/lang/Object");
+    bytes.insert(bytes.end(), { ConstantPool::CONSTANT_CLASS, 0, 3 });
+    put_utf8(bytes, "helper");
+    put_utf8(bytes, "LHelper;");
+    bytes.insert(bytes.end(), { ConstantPool::CONSTANT_NAME_AND_TYPE, 0, 5, 0, 6 });
+    // CONSTANT_Dynamic with the bootstrap method 0
+    bytes.insert(bytes.end(), { 17, 0, 0, 0, 7 });
+    // public class Plugin extends java/lang/Object without interfaces, fields, methods and attributes
+    bytes.insert(bytes.end(), { 0, Class::ACC_PUBLIC, 0, 2, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0 });
+    return bytes;
+}
+
+static void
+add_constructor(ClassBuilder &builder, const MethodType &constructor_signature)
+{
+    u2 object_constructor = builder.add_method_constant("java/lang/Object", "<init>", constructor_signature);
+    builder.enter_method("<init>", constructor_signature, Method::ACC_PUBLIC);
+    builder.make_instruction<RefLoad0>();
+    builder.make_instruction<InvokeSpecial>(U2_SPLIT(object_constructor));
+    builder.make_instruction<Return>();
+    builder.leave_method();
+}
+
+int
+main()
+{
+    ClassType str_type("java/lang/String");
+    ArrayType str_arr(&str_type, 1);
+    PrimitiveType void_type = VoidType();
+    IntType int_type;
+    MethodType main_signature(&void_type, &str_arr);
+    MethodType void_signature(&void_type);
+    MethodType to_string_signature(&str_type);
+    Shrinker shrinker;
+
+    // Main.main creates Used and calls its run method, Main.helper is never called
+    ClassBuilder main_builder("Main");
+    main_builder.set_version(59, 0).set_access_flags(Class::ACC_PUBLIC);
+    u2 used_class = main_builder.add_class_constant("Used");
+    u2 used_constructor = main_builder.add_method_constant("Used", "<init>", void_signature);
+    u2 run_method = main_builder.add_method_constant("Used", "run", void_signature);
+    main_builder.enter_method("main", main_signature, Method::ACC_PUBLIC | Method::ACC_STATIC);
+    main_builder.make_instruction<New>(U2_SPLIT(used_class));
+    main_builder.make_instruction<Duplicate>();
+    main_builder.make_instruction<InvokeSpecial>(U2_SPLIT(used_constructor));
+    main_builder.make_instruction<InvokeVirtual>(U2_SPLIT(run_method));
+    main_builder.make_instruction<Return>();
+    main_builder.leave_method();
+    u2 go_method = main_builder.add_method_constant("Unused", "go", void_signature);
+    main_builder.enter_method("helper", void_signature, Method::ACC_PUBLIC | Method::ACC_STATIC);
+    main_builder.make_instruction<InvokeStatic>(U2_SPLIT(go_method));
+    main_builder.make_instruction<Return>();
+    main_builder.leave_method();
+    shrinker.add_class(reread(main_builder));
+
+    // Used.run increments the counter, the spare field and the unused method are removed, toString is kept
+    ClassBuilder used_builder("Used");
+    used_builder.set_version(59, 0).set_access_flags(Class::ACC_PUBLIC);
+    add_constructor(used_builder, void_signature);
+    used_builder.declare_field("counter", int_type, Field::ACC_PRIVATE | Field::ACC_STATIC);
+    used_builder.declare_field("spare", int_type, Field::ACC_PRIVATE);
+    u2 counter = used_builder.add_field_constant("Used", "counter", int_type);
+    used_builder.enter_method("run", void_signature, Method::ACC_PUBLIC);
+    used_builder.make_instruction<GetStatic>(U2_SPLIT(counter));
+    used_builder.make_instruction<IntConst1>();
+    used_builder.make_instruction<IntAdd>();
+    used_builder.make_instruction<PutStatic>(U2_SPLIT(counter));
+    used_builder.make_instruction<Return>();
+    used_builder.leave_method();
+    used_builder.enter_method("unused", void_signature, Method::ACC_PUBLIC);
+    used_builder.make_instruction<Return>();
+    used_builder.leave_method();
+    u2 name = used_builder.add_string_constant("Used");
+    used_builder.enter_method("toString", to_string_signature, Method::ACC_PUBLIC);
+    used_builder.make_instruction<LoadConst>(U2_LOW(name));
+    used_builder.make_instruction<RefReturn>();
+    used_builder.leave_method();
+    // Used$Inner is named only by the NestMembers attribute and Box only by the generic signature of Used
+    Class used = used_builder.build();
+    u2 inner_name = used.constant_pool().make_constant<Utf8Constant>("Used$Inner");
+    u2 inner_class = used.constant_pool().make_constant<ClassConstant>(inner_name);
+    u2 nest_members = used.constant_pool().make_constant<Utf8Constant>("NestMembers");
+    used.make_attribute<RawAttribute>(nest_members, std::vector<u1>{ 0, 1, U2_SPLIT(inner_class) });
+    u2 signature = used.constant_pool().make_constant<Utf8Constant>("Ljava/lang/Object;Ljava/lang/Comparable<LBox;>;");
+    u2 signature_name = used.constant_pool().make_constant<Utf8Constant>("Signature");
+    used.make_attribute<RawAttribute>(signature_name, std::vector<u1>{ U2_SPLIT(signature) });
+    shrinker.add_class(reread(used));
+    add_empty_class(shrinker, "Used$Inner");
+    add_empty_class(shrinker, "Box");
+
+    // Unused is referred to only by the unreachable Main.helper
+    ClassBuilder unused_builder("Unused");
+    unused_builder.set_version(59, 0).set_access_flags(Class::ACC_PUBLIC);
+    unused_builder.enter_method("go", void_signature, Method::ACC_PUBLIC | Method::ACC_STATIC);
+    unused_builder.make_instruction<Return>();
+    unused_builder.leave_method();
+    shrinker.add_class(reread(unused_builder));
+
+    // Helper is referred to only by Plugin, which cannot be read by jasm, so it is kept with its unused method
+    ClassBuilder helper_builder("Helper");
+    helper_builder.set_version(59, 0).set_access_flags(Class::ACC_PUBLIC);
+    helper_builder.enter_method("assist", void_signature, Method::ACC_PUBLIC | Method::ACC_STATIC);
+    helper_builder.make_instruction<Return>();
+    helper_builder.leave_method();
+    shrinker.add_class(reread(helper_builder));
+
+    std::vector<u1> plugin = plugin_class_file();
+    std::string plugin_name;
+    std::vector<std::string> plugin_references;
+    if (tools::is_supported_class(plugin) || !tools::scan_class_references(plugin, plugin_name, plugin_references) ||
+        !shrinker.add_opaque_class(plugin_name, plugin_references)) {
+        std::cerr << "opaque class not added" << std::endl;
+        return 1;
+    }
+
+    if (!shrinker.keep_method("Main", "main", "([Ljava/lang/String;)V")) {
+        std::cerr << "main method not found" << std::endl;
+        return 1;
+    }
+    Shrinker::Statistics statistics = shrinker.shrink();
+    std::cout << statistics.classes << " classes kept, " << statistics.removed_classes << " classes, "
+              << statistics.removed_methods << " methods and " << statistics.removed_fields << " fields removed, "
+              << statistics.opaque_classes << " opaque classes kept" << std::endl;
+
+    for (auto &[class_name, clazz] : shrinker.classes()) {
+        clazz.remove_unused_constants();
+        std::cout << clazz;
+    }
+
+    return 0;
+}
@@ -0,0 +1,303 @@
+/**
+ * @file archive.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <array>
+#include <fstream>
+#include <iterator>
+
+#ifdef JASM_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "archive.hpp"
+
+namespace jasm::tools {
+
+    static constexpr u4 LocalHeaderSignature = 0x04034b50;
+    static constexpr u4 CentralHeaderSignature = 0x02014b50;
+    static constexpr u4 EndOfCentralDirectorySignature = 0x06054b50;
+    static constexpr std::size_t LocalHeaderSize = 30;
+    static constexpr std::size_t CentralHeaderSize = 46;
+    static constexpr std::size_t EndOfCentralDirectorySize = 22;
+    // the sizes and the checksum follow the data instead of being stored in the local header
+    static constexpr u2 DataDescriptorFlag = 0x0008;
+
+    static u2
+    read_le16(const u1 *ptr)
+    {
+        return ptr[0] | (ptr[1] << 8);
+    }
+
+    static u4
+    read_le32(const u1 *ptr)
+    {
+        return read_le16(ptr) | (read_le16(ptr + 2) << 16);
+    }
+
+    static void
+    write_le16(std::ostream &os, u2 value)
+    {
+        os.put(static_cast<char>(value & 0xFF));
+        os.put(static_cast<char>(value >> 8));
+    }
+
+    static void
+    write_le32(std::ostream &os, u4 value)
+    {
+        write_le16(os, value & 0xFFFF);
+        write_le16(os, value >> 16);
+    }
+
+    u4
+    crc32(const u1 *data, std::size_t size)
+    {
+        static const std::array<u4, 256> table = []() {
+            std::array<u4, 256> result{};
+            for (u4 i = 0; i < 256; ++i) {
+                u4 value = i;
+                for (int bit = 0; bit < 8; ++bit)
+                    value = value & 1 ? 0xEDB88320 ^ (value >> 1) : value >> 1;
+                result[i] = value;
+            }
+            return result;
+        }();
+
+        u4 crc = 0xFFFFFFFF;
+        for (std::size_t i = 0; i < size; ++i)
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return crc ^ 0xFFFFFFFF;
+    }
+
+    bool
+    Archive::open(const std::string &path)
+    {
+        data_.clear();
+        entries_.clear();
+        comment_.clear();
+        base_ = 0;
+
+        std::ifstream is(path, std::ios::in | std::ios::binary);
+        if (!is)
+            return false;
+        data_.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+        const u1 *data = data_.data();
+        std::size_t size = data_.size();
+        if (size < EndOfCentralDirectorySize)
+            return false;
+
+        // the end of central directory record is followed by a comment of at most 65535 bytes
+        std::size_t eocd = size - EndOfCentralDirectorySize;
+        while (read_le32(data + eocd) != EndOfCentralDirectorySignature) {
+            if (eocd == 0 || size - eocd >= EndOfCentralDirectorySize + 0xFFFF)
+                return false;
+            --eocd;
+        }
+
+        u2 entries = read_le16(data + eocd + 10);
+        u4 cd_size = read_le32(data + eocd + 12);
+        u4 cd_offset = read_le32(data + eocd + 16);
+        u2 comment_length = read_le16(data + eocd + 20);
+        // the values of a ZIP64 archive are stored in another record
+        if (entries == 0xFFFF || cd_size == 0xFFFFFFFF || cd_offset == 0xFFFFFFFF)
+            return false;
+        if (std::size_t(cd_size) + cd_offset > eocd ||
+            eocd + EndOfCentralDirectorySize + comment_length > size)
+            return false;
+        // the offsets are relative to the start of the archive, which may be preceded by a header
+        base_ = eocd - cd_size - cd_offset;
+        comment_.assign(reinterpret_cast<const char *>(data + eocd + EndOfCentralDirectorySize), comment_length);
+
+        std::size_t ptr = base_ + cd_offset;
+        std::size_t cd_end = ptr + cd_size;
+        for (u2 i = 0; i < entries; ++i) {
+            if (ptr + CentralHeaderSize > cd_end || read_le32(data + ptr) != CentralHeaderSignature)
+                return false;
+            const u1 *header = data + ptr;
+            Entry entry;
+            entry.version_made_by = read_le16(header + 4);
+            entry.version_needed = read_le16(header + 6);
+            entry.flags = read_le16(header + 8);
+            entry.method = read_le16(header + 10);
+            entry.time = read_le16(header + 12);
+            entry.date = read_le16(header + 14);
+            entry.crc = read_le32(header + 16);
+            entry.compressed_size = read_le32(header + 20);
+            entry.size = read_le32(header + 24);
+            u2 name_length = read_le16(header + 28);
+            u2 extra_length = read_le16(header + 30);
+            u2 entry_comment_length = read_le16(header + 32);
+            entry.internal_attributes = read_le16(header + 36);
+            entry.external_attributes = read_le32(header + 38);
+            u4 local_header = read_le32(header + 42);
+
+            std::size_t variable = ptr + CentralHeaderSize;
+            ptr = variable + name_length + extra_length + entry_comment_length;
+            if (ptr > cd_end)
+                return false;
+            const char *chars = reinterpret_cast<const char *>(data + variable);
+            entry.name.assign(chars, name_length);
+            entry.extra.assign(chars + name_length, extra_length);
+            entry.comment.assign(chars + name_length + extra_length, entry_comment_length);
+
+            std::size_t local = base_ + local_header;
+            if (local + LocalHeaderSize > size || read_le32(data + local) != LocalHeaderSignature)
+                return false;
+            entry.data_offset = local + LocalHeaderSize + read_le16(data + local + 26) + read_le16(data + local + 28);
+            if (entry.data_offset + entry.compressed_size > size)
+                return false;
+            entries_.push_back(std::move(entry));
+        }
+        return true;
+    }
+
+    bool
+    Archive::read(const Entry &entry, std::vector<u1> &bytes) const
+    {
+        const u1 *compressed = raw_data(entry);
+        if (entry.method == Stored) {
+            if (entry.compressed_size != entry.size)
+                return false;
+            bytes.assign(compressed, compressed + entry.size);
+        } else if (entry.method == Deflated) {
+#ifdef JASM_HAVE_ZLIB
+            bytes.resize(entry.size);
+            z_stream stream{};
+            stream.next_in = const_cast<u1 *>(compressed);
+            stream.avail_in = entry.compressed_size;
+            stream.next_out = bytes.data();
+            stream.avail_out = bytes.size();
+            // negative window bits select raw deflate data without the zlib header
+            if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+                return false;
+            int result = inflate(&stream, Z_FINISH);
+            inflateEnd(&stream);
+            if (result != Z_STREAM_END || stream.total_out != entry.size)
+                return false;
+#else
+            return false;
+#endif
+        } else {
+            return false;
+        }
+        return crc32(bytes.data(), bytes.size()) == entry.crc;
+    }
+
+    ArchiveWriter::ArchiveWriter(std::ostream &os, const std::string &prefix)
+      : os_(os)
+    {
+        os_.write(prefix.data(), prefix.size());
+    }
+
+    void
+    ArchiveWriter::write_entry(Archive::Entry entry, const u1 *data)
+    {
+        entry.flags &= ~DataDescriptorFlag;
+        local_headers_.push_back(offset_);
+
+        write_le32(os_, LocalHeaderSignature);
+        write_le16(os_, entry.version_needed);
+        write_le16(os_, entry.flags);
+        write_le16(os_, entry.method);
+        write_le16(os_, entry.time);
+        write_le16(os_, entry.date);
+        write_le32(os_, entry.crc);
+        write_le32(os_, entry.compressed_size);
+        write_le32(os_, entry.size);
+        write_le16(os_, entry.name.size());
+        write_le16(os_, entry.extra.size());
+        os_ << entry.name << entry.extra;
+        os_.write(reinterpret_cast<const char *>(data), entry.compressed_size);
+
+        offset_ += LocalHeaderSize + entry.name.size() + entry.extra.size() + entry.compressed_size;
+        entries_.push_back(std::move(entry));
+    }
+
+    void
+    ArchiveWriter::copy(const Archive::Entry &entry, const u1 *compressed)
+    {
+        write_entry(entry, compressed);
+    }
+
+    void
+    ArchiveWriter::add(const Archive::Entry &entry, const std::vector<u1> &content)
+    {
+        Archive::Entry added = entry;
+        added.size = content.size();
+        added.crc = crc32(content.data(), content.size());
+#ifdef JASM_HAVE_ZLIB
+        if (entry.method == Archive::Deflated) {
+            z_stream stream{};
+            if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK) {
+                std::vector<u1> compressed(deflateBound(&stream, content.size()));
+                stream.next_in = const_cast<u1 *>(content.data());
+                stream.avail_in = content.size();
+                stream.next_out = compressed.data();
+                stream.avail_out = compressed.size();
+                int result = deflate(&stream, Z_FINISH);
+                deflateEnd(&stream);
+                if (result == Z_STREAM_END) {
+                    added.compressed_size = stream.total_out;
+                    write_entry(std::move(added), compressed.data());
+                    return;
+                }
+            }
+        }
+#endif
+        added.method = Archive::Stored;
+        added.compressed_size = content.size();
+        write_entry(std::move(added), content.data());
+    }
+
+    bool
+    ArchiveWriter::finish(const std::string &comment)
+    {
+        if (entries_.size() >= 0xFFFF || offset_ >= 0xFFFFFFFF || comment.size() > 0xFFFF)
+            return false;
+
+        std::size_t cd_size = 0;
+        for (std::size_t i = 0; i < entries_.size(); ++i) {
+            const Archive::Entry &entry = entries_[i];
+            write_le32(os_, CentralHeaderSignature);
+            write_le16(os_, entry.version_made_by);
+            write_le16(os_, entry.version_needed);
+            write_le16(os_, entry.flags);
+            write_le16(os_, entry.method);
+            write_le16(os_, entry.time);
+            write_le16(os_, entry.date);
+            write_le32(os_, entry.crc);
+            write_le32(os_, entry.compressed_size);
+            write_le32(os_, entry.size);
+            write_le16(os_, entry.name.size());
+            write_le16(os_, entry.extra.size());
+            write_le16(os_, entry.comment.size());
+            // disk number
+            write_le16(os_, 0);
+            write_le16(os_, entry.internal_attributes);
+            write_le32(os_, entry.external_attributes);
+            write_le32(os_, local_headers_[i]);
+            os_ << entry.name << entry.extra << entry.comment;
+            cd_size += CentralHeaderSize + entry.name.size() + entry.extra.size() + entry.comment.size();
+        }
+
+        write_le32(os_, EndOfCentralDirectorySignature);
+        // number of this disk and of the disk with the central directory
+        write_le16(os_, 0);
+        write_le16(os_, 0);
+        write_le16(os_, entries_.size());
+        write_le16(os_, entries_.size());
+        write_le32(os_, cd_size);
+        write_le32(os_, offset_);
+        write_le16(os_, comment.size());
+        os_ << comment;
+        os_.flush();
+        return os_.good();
+    }
+
+}
@@ -0,0 +1,175 @@
+/**
+ * @file archive.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#ifndef JAWA_ARCHIVE_HPP
+#define JAWA_ARCHIVE_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "byte_code.hpp"
+
+namespace jasm::tools {
+
+    using namespace jasm::byte_code;
+
+    /**
+     * ZIP archive (a JAR or a JMOD file) read into memory. Only the stored and deflated entries can be read,
+     * the deflated ones only if jasm is built with zlib. ZIP64 archives are not supported.
+     */
+    class Archive
+    {
+    public:
+        static constexpr u2 Stored = 0;
+        static constexpr u2 Deflated = 8;
+
+        /**
+         * Entry of the central directory.
+         */
+        struct Entry
+        {
+            std::string name;
+            u2 version_made_by = 0;
+            u2 version_needed = 0;
+            u2 flags = 0;
+            u2 method = Stored;
+            u2 time = 0;
+            u2 date = 0;
+            u4 crc = 0;
+            u4 compressed_size = 0;
+            u4 size = 0;
+            std::string extra;
+            std::string comment;
+            u2 internal_attributes = 0;
+            u4 external_attributes = 0;
+            // offset of the compressed data in the archive
+            std::size_t data_offset = 0;
+        };
+
+    private:
+        std::vector<u1> data_;
+        // bytes preceding the archive, JMOD files start with a 4 byte header
+        std::size_t base_ = 0;
+        std::vector<Entry> entries_;
+        std::string comment_;
+
+    public:
+        Archive() = default;
+
+        /**
+         * Reads the archive, the content of the previously read archive is discarded.
+         *
+         * @param path path of the archive.
+         * @return true if the archive could be read.
+         */
+        bool
+        open(const std::string &path);
+
+        inline const std::vector<Entry> &
+        entries() const
+        {
+            return entries_;
+        }
+
+        inline std::size_t
+        size() const
+        {
+            return data_.size();
+        }
+
+        /**
+         * @return bytes preceding the archive.
+         */
+        inline std::string
+        prefix() const
+        {
+            return std::string(data_.begin(), data_.begin() + base_);
+        }
+
+        inline const std::string &
+        comment() const
+        {
+            return comment_;
+        }
+
+        /**
+         * @return compressed data of the entry.
+         */
+        inline const u1 *
+        raw_data(const Entry &entry) const
+        {
+            return data_.data() + entry.data_offset;
+        }
+
+        /**
+         * Decompresses the entry.
+         *
+         * @return true if the entry could be decompressed and its checksum matches.
+         */
+        bool
+        read(const Entry &entry, std::vector<u1> &bytes) const;
+    };
+
+    /**
+     * Writes a ZIP archive. The entries can be either copied from another archive with their compressed data or
+     * added with new content, which is then compressed by the method of the entry if jasm is built with zlib and
+     * stored otherwise.
+     */
+    class ArchiveWriter
+    {
+    private:
+        std::ostream &os_;
+        std::vector<Archive::Entry> entries_;
+        std::size_t offset_ = 0;
+        std::vector<u4> local_headers_;
+
+        void
+        write_entry(Archive::Entry entry, const u1 *data);
+
+    public:
+        /**
+         * @param os output stream.
+         * @param prefix bytes preceding the archive.
+         */
+        explicit ArchiveWriter(std::ostream &os, const std::string &prefix = "");
+
+        /**
+         * Copies an entry and its compressed data.
+         */
+        void
+        copy(const Archive::Entry &entry, const u1 *compressed);
+
+        /**
+         * Adds an entry with new content. The size, the checksum and the compressed size of the entry are
+         * computed from the content.
+         */
+        void
+        add(const Archive::Entry &entry, const std::vector<u1> &content);
+
+        /**
+         * Writes the central directory.
+         *
+         * @param comment comment of the archive.
+         * @return true if the whole archive has been written.
+         */
+        bool
+        finish(const std::string &comment = "");
+    };
+
+    /**
+     * @return CRC-32 checksum of the data as used in ZIP archives.
+     */
+    u4
+    crc32(const u1 *data, std::size_t size);
+
+}
+
+#endif // JAWA_ARCHIVE_HPP
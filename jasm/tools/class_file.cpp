@@ -0,0 +1,232 @@
+/**
+ * @file class_file.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "class_file.hpp"
+#include "constant_pool.hpp"
+
+namespace jasm::tools {
+
+    bool
+    is_class_file(const std::string &name)
+    {
+        const std::string suffix = ".class";
+        const std::string module_info = "module-info.class";
+        if (name.size() <= suffix.size() || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+            return false;
+        return name.size() < module_info.size() ||
+               name.compare(name.size() - module_info.size(), module_info.size(), module_info) != 0;
+    }
+
+    // constants of the class file format which the reader of jasm does not support
+    static constexpr u1 ConstantDynamic = 17;
+    static constexpr u1 ConstantModule = 19;
+    static constexpr u1 ConstantPackage = 20;
+
+    static u2
+    u2_at(const std::vector<u1> &bytes, std::size_t offset)
+    {
+        return u2((bytes[offset] << 8) | bytes[offset + 1]);
+    }
+
+    /**
+     * Finds the constants of a class file, including the ones not supported by jasm.
+     *
+     * @param offsets offsets of the constants indexed by their constant pool indices, 0 for the unused indices.
+     * @param end offset of the first byte after the constant pool.
+     * @return false if the file is not a class file or its constant pool is truncated.
+     */
+    static bool
+    find_constants(const std::vector<u1> &bytes, std::vector<std::size_t> &offsets, std::size_t &end)
+    {
+        if (bytes.size() < 10 || bytes[0] != 0xCA || bytes[1] != 0xFE || bytes[2] != 0xBA || bytes[3] != 0xBE)
+            return false;
+
+        u2 count = u2_at(bytes, 8);
+        offsets.assign(std::max<u2>(count, 1), 0);
+        std::size_t offset = 10;
+        for (u2 i = 1; i < count; ++i) {
+            if (offset >= bytes.size())
+                return false;
+            offsets[i] = offset;
+            std::size_t size;
+            switch (bytes[offset]) {
+            case ConstantPool::CONSTANT_UTF_8:
+                if (offset + 3 > bytes.size())
+                    return false;
+                size = 3 + u2_at(bytes, offset + 1);
+                break;
+            case ConstantPool::CONSTANT_CLASS:
+            case ConstantPool::CONSTANT_STRING:
+            case ConstantPool::CONSTANT_METHOD_TYPE:
+            case ConstantModule:
+            case ConstantPackage:
+                size = 3;
+                break;
+            case ConstantPool::CONSTANT_METHOD_HANDLE:
+                size = 4;
+                break;
+            case ConstantPool::CONSTANT_INTEGER:
+            case ConstantPool::CONSTANT_FLOAT:
+            case ConstantPool::CONSTANT_FIELD_REF:
+            case ConstantPool::CONSTANT_METHOD_REF:
+            case ConstantPool::CONSTANT_INTERFACE_METHOD_REF:
+            case ConstantPool::CONSTANT_NAME_AND_TYPE:
+            case ConstantPool::CONSTANT_INVOKE_DYNAMIC:
+            case ConstantDynamic:
+                size = 5;
+                break;
+            case ConstantPool::CONSTANT_LONG:
+            case ConstantPool::CONSTANT_DOUBLE:
+                // the constant takes two entries of the pool
+                size = 9;
+                ++i;
+                break;
+            default:
+                return false;
+            }
+            offset += size;
+        }
+        end = offset;
+        return offset <= bytes.size();
+    }
+
+    bool
+    is_supported_class(const std::vector<u1> &bytes)
+    {
+        std::vector<std::size_t> offsets;
+        std::size_t end;
+        if (!find_constants(bytes, offsets, end))
+            return false;
+        for (std::size_t offset : offsets) {
+            if (offset != 0 && (bytes[offset] == ConstantDynamic || bytes[offset] == ConstantModule ||
+                                bytes[offset] == ConstantPackage))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Adds the classes named in a field or a method descriptor.
+     */
+    static void
+    add_descriptor_classes(const std::string &descriptor, std::vector<std::string> &classes)
+    {
+        for (std::size_t i = 0; i < descriptor.size(); ++i) {
+            if (descriptor[i] != 'L')
+                continue;
+            std::size_t end = descriptor.find(';', i);
+            if (end == std::string::npos)
+                return;
+            classes.push_back(descriptor.substr(i + 1, end - i - 1));
+            i = end;
+        }
+    }
+
+    bool
+    scan_class_references(const std::vector<u1> &bytes, std::string &name, std::vector<std::string> &references)
+    {
+        std::vector<std::size_t> offsets;
+        std::size_t end;
+        if (!find_constants(bytes, offsets, end) || end + 4 > bytes.size())
+            return false;
+
+        auto utf8 = [&bytes, &offsets](u2 index) {
+            if (index >= offsets.size() || offsets[index] == 0 || bytes[offsets[index]] != ConstantPool::CONSTANT_UTF_8)
+                return std::string();
+            std::size_t offset = offsets[index];
+            return std::string(reinterpret_cast<const char *>(&bytes[offset + 3]), u2_at(bytes, offset + 1));
+        };
+        auto class_name = [&](u2 index) {
+            if (index >= offsets.size() || offsets[index] == 0 || bytes[offsets[index]] != ConstantPool::CONSTANT_CLASS)
+                return std::string();
+            return utf8(u2_at(bytes, offsets[index] + 1));
+        };
+
+        name = class_name(u2_at(bytes, end + 2));
+        if (name.empty())
+            return false;
+        for (std::size_t offset : offsets) {
+            if (offset == 0)
+                continue;
+            switch (bytes[offset]) {
+            case ConstantPool::CONSTANT_CLASS: {
+                std::string referenced = utf8(u2_at(bytes, offset + 1));
+                // array classes are named by their descriptors
+                if (!referenced.empty() && referenced[0] == '[')
+                    add_descriptor_classes(referenced, references);
+                else if (!referenced.empty() && referenced != name)
+                    references.push_back(std::move(referenced));
+                break;
+            }
+            case ConstantPool::CONSTANT_NAME_AND_TYPE:
+                add_descriptor_classes(utf8(u2_at(bytes, offset + 3)), references);
+                break;
+            case ConstantPool::CONSTANT_METHOD_TYPE:
+                add_descriptor_classes(utf8(u2_at(bytes, offset + 1)), references);
+                break;
+            default:
+                break;
+            }
+        }
+        return true;
+    }
+
+    std::vector<std::string>
+    list_class_files(const std::string &directory)
+    {
+        std::vector<std::string> files;
+        for (auto &file : std::filesystem::recursive_directory_iterator(directory)) {
+            if (file.is_regular_file() && is_class_file(file.path().filename().string()))
+                files.push_back(file.path().string());
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    bool
+    read_file(const std::string &path, std::vector<u1> &bytes)
+    {
+        std::ifstream is(path, std::ios::in | std::ios::binary);
+        if (!is)
+            return false;
+        bytes.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+        return !is.bad();
+    }
+
+    bool
+    write_file(const std::string &path, const std::string &bytes)
+    {
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream os(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!os)
+                return false;
+            os.write(bytes.data(), bytes.size());
+            if (!os.flush()) {
+                std::remove(temporary.c_str());
+                return false;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+        if (error) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+        return true;
+    }
+
+}
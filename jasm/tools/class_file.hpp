@@ -0,0 +1,70 @@
+/**
+ * @file class_file.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#ifndef JAWA_CLASS_FILE_HPP
+#define JAWA_CLASS_FILE_HPP
+
+#include <string>
+#include <vector>
+
+#include "byte_code.hpp"
+
+namespace jasm::tools {
+
+    using namespace jasm::byte_code;
+
+    /**
+     * @return true if the file name or the archive entry name is a name of a class file. Module descriptors are
+     * not considered class files, because their constants are not supported by jasm.
+     */
+    bool
+    is_class_file(const std::string &name);
+
+    /**
+     * Checks the header and the constant pool of a class file. The reader of jasm expects a well-formed class
+     * file, the check rejects the files it would fail on because of an unsupported constant or a truncated
+     * constant pool.
+     *
+     * @return true if the class file can be read by jasm.
+     */
+    bool
+    is_supported_class(const std::vector<u1> &bytes);
+
+    /**
+     * Reads the name of a class and the names of the classes it refers to from its constant pool, without reading
+     * the rest of the class file. Unlike the reader of jasm, the scan accepts every constant of the class file
+     * format, so it is used for the classes jasm cannot read.
+     *
+     * @param name name of the class in the internal form.
+     * @param references names of the classes named by the class constants and by the descriptors.
+     * @return false if the file is not a class file or its constant pool is truncated.
+     */
+    bool
+    scan_class_references(const std::vector<u1> &bytes, std::string &name, std::vector<std::string> &references);
+
+    /**
+     * @return paths of the class files in a directory and its subdirectories in lexicographic order.
+     */
+    std::vector<std::string>
+    list_class_files(const std::string &directory);
+
+    bool
+    read_file(const std::string &path, std::vector<u1> &bytes);
+
+    /**
+     * Writes a file through a temporary file in the same directory, so the file is either replaced as a whole
+     * or left unchanged.
+     */
+    bool
+    write_file(const std::string &path, const std::string &bytes);
+
+}
+
+#endif // JAWA_CLASS_FILE_HPP
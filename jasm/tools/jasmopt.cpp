@@ -0,0 +1,289 @@
+/**
+ * @file jasmopt.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "archive.hpp"
+#include "class.hpp"
+#include "class_file.hpp"
+#include "optimizer.hpp"
+#include "parallel.hpp"
+
+using namespace jasm;
+using namespace jasm::tools;
+
+/**
+ * Result of optimising a class file, an archive or all of the inputs.
+ */
+struct Result
+{
+    Optimizer::Statistics statistics;
+    std::size_t classes = 0;
+    // class files jasm cannot read
+    std::size_t skipped_classes = 0;
+    std::size_t bytes = 0;
+    std::size_t optimized_bytes = 0;
+    bool failed = false;
+    std::string message;
+
+    Result &
+    operator+=(const Result &other)
+    {
+        statistics += other.statistics;
+        classes += other.classes;
+        skipped_classes += other.skipped_classes;
+        bytes += other.bytes;
+        optimized_bytes += other.optimized_bytes;
+        failed |= other.failed;
+        return *this;
+    }
+};
+
+struct Settings
+{
+    Optimizer::Options optimizer;
+    unsigned threads = hardware_threads();
+    std::string output;
+    bool verbose = false;
+    std::vector<std::string> inputs;
+};
+
+static std::string
+size_change(std::size_t before, std::size_t after)
+{
+    std::ostringstream os;
+    os << before << " -> " << after << " bytes";
+    if (before > 0)
+        os << " (" << std::fixed << std::setprecision(1) << 100.0 * (double(after) - double(before)) / before << " %)";
+    return std::move(os).str();
+}
+
+/**
+ * Optimises a class file.
+ *
+ * @param optimized optimised class file.
+ * @return true if the class file could be read.
+ */
+static bool
+optimize_class(const Optimizer &optimizer, const std::vector<u1> &bytes, std::string &optimized, Result &result)
+{
+    if (!is_supported_class(bytes)) {
+        ++result.skipped_classes;
+        return false;
+    }
+
+    MemoryBuffer memory(bytes.data(), bytes.size());
+    std::istream is(&memory);
+    Class clazz(is);
+    result.statistics += optimizer.optimize(clazz);
+
+    std::ostringstream os;
+    clazz.emit_bytecode(os);
+    optimized = std::move(os).str();
+    ++result.classes;
+    result.bytes += bytes.size();
+    result.optimized_bytes += optimized.size();
+    return true;
+}
+
+static bool
+is_unchanged(const std::vector<u1> &bytes, const std::string &optimized)
+{
+    return bytes.size() == optimized.size() && std::memcmp(bytes.data(), optimized.data(), bytes.size()) == 0;
+}
+
+/**
+ * Optimises the class files in parallel, each of them is written to the output path at the same index.
+ */
+static Result
+optimize_files(const Settings &settings, const std::vector<std::string> &inputs,
+               const std::vector<std::string> &outputs)
+{
+    Optimizer optimizer(settings.optimizer);
+    std::vector<Result> results(inputs.size());
+    parallel_for(inputs.size(), settings.threads, [&](std::size_t i) {
+        Result &result = results[i];
+        std::vector<u1> bytes;
+        std::string optimized;
+        if (!read_file(inputs[i], bytes)) {
+            result.failed = true;
+            result.message = "could not read " + inputs[i];
+            return;
+        }
+        if (!optimize_class(optimizer, bytes, optimized, result)) {
+            result.message = "skipping " + inputs[i] + " (not supported by jasm)";
+            return;
+        }
+        if (outputs[i] == inputs[i] && is_unchanged(bytes, optimized))
+            return;
+
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(outputs[i]).parent_path(), error);
+        if (!write_file(outputs[i], optimized)) {
+            result.failed = true;
+            result.message = "could not write " + outputs[i];
+        } else if (settings.verbose) {
+            result.message = inputs[i] + ": " + size_change(bytes.size(), optimized.size());
+        }
+    });
+
+    Result total;
+    for (auto &result : results) {
+        if (!result.message.empty())
+            (result.failed ? std::cerr : std::cout) << result.message << std::endl;
+        total += result;
+    }
+    return total;
+}
+
+/**
+ * Optimises the class files of an archive in parallel and writes the archive. The other entries and the classes
+ * which have not changed are copied with their compressed data.
+ */
+static Result
+optimize_archive(const Settings &settings, const std::string &input, const std::string &output)
+{
+    Result total;
+    Archive archive;
+    if (!archive.open(input)) {
+        std::cerr << "could not read " << input << " (not a class file or a ZIP archive)" << std::endl;
+        total.failed = true;
+        return total;
+    }
+
+    Optimizer optimizer(settings.optimizer);
+    auto &entries = archive.entries();
+    std::vector<Result> results(entries.size());
+    std::vector<std::string> optimized(entries.size());
+    // not a vector of bools, whose elements share bytes written by different threads
+    std::vector<char> changed(entries.size());
+    parallel_for(entries.size(), settings.threads, [&](std::size_t i) {
+        if (!is_class_file(entries[i].name))
+            return;
+        Result &result = results[i];
+        std::vector<u1> bytes;
+        if (!archive.read(entries[i], bytes)) {
+            ++result.skipped_classes;
+            result.message = "skipping " + input + "!" + entries[i].name + " (unsupported compression)";
+        } else if (!optimize_class(optimizer, bytes, optimized[i], result)) {
+            result.message = "skipping " + input + "!" + entries[i].name + " (not supported by jasm)";
+        } else {
+            changed[i] = !is_unchanged(bytes, optimized[i]);
+            if (settings.verbose)
+                result.message = input + "!" + entries[i].name + ": " + size_change(bytes.size(), optimized[i].size());
+        }
+    });
+
+    for (auto &result : results) {
+        if (!result.message.empty())
+            std::cout << result.message << std::endl;
+        total += result;
+    }
+    if (output == input && std::find(changed.begin(), changed.end(), true) == changed.end())
+        return total;
+
+    std::ostringstream os;
+    ArchiveWriter writer(os, archive.prefix());
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (changed[i])
+            writer.add(entries[i], std::vector<u1>(optimized[i].begin(), optimized[i].end()));
+        else
+            writer.copy(entries[i], archive.raw_data(entries[i]));
+    }
+
+    bool written = writer.finish(archive.comment());
+    std::string bytes = std::move(os).str();
+    if (!written || !write_file(output, bytes)) {
+        std::cerr << "could not write " << output << std::endl;
+        total.failed = true;
+    } else {
+        std::cout << input << ": " << size_change(archive.size(), bytes.size()) << std::endl;
+    }
+    return total;
+}
+
+static void
+show_usage(const char *name)
+{
+    std::cerr << "usage: " << name
+              << " [-j THREADS] [-o OUTPUT] [--no-dead-code] [--no-peephole] [--no-compact] [--no-limits] [-v]"
+                 " <CLASS|JAR|DIRECTORY>..."
+              << std::endl;
+}
+
+int
+main(int argc, char *argv[])
+{
+    Settings settings;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            settings.threads = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            settings.output = argv[++i];
+        } else if (strcmp(argv[i], "--no-dead-code") == 0) {
+            settings.optimizer.remove_dead_code = false;
+        } else if (strcmp(argv[i], "--no-peephole") == 0) {
+            settings.optimizer.peephole = false;
+        } else if (strcmp(argv[i], "--no-compact") == 0) {
+            settings.optimizer.compact_constants = false;
+        } else if (strcmp(argv[i], "--no-limits") == 0) {
+            settings.optimizer.recompute_limits = false;
+        } else if (strcmp(argv[i], "-v") == 0) {
+            settings.verbose = true;
+        } else if (argv[i][0] == '-') {
+            show_usage(argv[0]);
+            return 1;
+        } else {
+            settings.inputs.emplace_back(argv[i]);
+        }
+    }
+
+    // the inputs are optimised in place unless a single input has an output
+    if (settings.inputs.empty() || (!settings.output.empty() && settings.inputs.size() > 1)) {
+        show_usage(argv[0]);
+        return 1;
+    }
+
+    Result total;
+    std::vector<std::string> files;
+    std::vector<std::string> outputs;
+    for (auto &input : settings.inputs) {
+        std::string output = settings.output.empty() ? input : settings.output;
+        if (std::filesystem::is_directory(input)) {
+            for (auto &file : list_class_files(input)) {
+                files.push_back(file);
+                auto relative = std::filesystem::path(file).lexically_relative(input);
+                outputs.push_back((std::filesystem::path(output) / relative).string());
+            }
+        } else if (is_class_file(input)) {
+            files.push_back(input);
+            outputs.push_back(output);
+        } else {
+            total += optimize_archive(settings, input, output);
+        }
+    }
+    total += optimize_files(settings, files, outputs);
+
+    const auto &statistics = total.statistics;
+    std::cout << total.classes << " classes optimised, " << total.skipped_classes << " skipped" << std::endl;
+    std::cout << statistics.methods << " methods rewritten, " << statistics.skipped_methods << " methods skipped, "
+              << statistics.removed_instructions << " instructions and " << statistics.removed_constants
+              << " constants removed" << std::endl;
+    std::cout << "classes: " << size_change(total.bytes, total.optimized_bytes) << std::endl;
+    return total.failed ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file jasmp.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "archive.hpp"
+#include "class.hpp"
+#include "class_file.hpp"
+#include "disassembler.hpp"
+#include "parallel.hpp"
+
+using namespace jasm;
+using namespace jasm::tools;
+
+// classes disassembled before their text is written, bounds the memory used for large archives
+static constexpr std::size_t BatchSize = 1024;
+
+/**
+ * A class file to disassemble, either a standalone file or an archive entry.
+ */
+struct Source
+{
+    // path shown in the messages
+    std::string path;
+    // path of the text relative to the output directory without the extension
+    std::string name;
+    const Archive *archive;
+    const Archive::Entry *entry;
+};
+
+struct Settings
+{
+    unsigned threads = hardware_threads();
+    Disassembler::Options disassembler;
+    std::string output;
+};
+
+static std::string
+without_extension(const std::string &name)
+{
+    return name.substr(0, name.size() - std::strlen(".class"));
+}
+
+/**
+ * Collects the class files of the inputs, an input is a class file, a directory or a JAR.
+ */
+static bool
+collect_sources(const std::vector<std::string> &inputs, std::vector<std::unique_ptr<Archive>> &archives,
+                std::vector<Source> &sources)
+{
+    for (auto &input : inputs) {
+        if (std::filesystem::is_directory(input)) {
+            for (auto &file : list_class_files(input)) {
+                std::string name = std::filesystem::path(file).lexically_relative(input).generic_string();
+                sources.push_back({ file, without_extension(name), nullptr, nullptr });
+            }
+        } else if (is_class_file(input)) {
+            std::string name = std::filesystem::path(input).filename().string();
+            sources.push_back({ input, without_extension(name), nullptr, nullptr });
+        } else {
+            auto archive = std::make_unique<Archive>();
+            if (!archive->open(input)) {
+                std::cerr << "could not read " << input << " (not a class file, a directory or a ZIP archive)"
+                          << std::endl;
+                return false;
+            }
+            for (auto &entry : archive->entries()) {
+                if (!is_class_file(entry.name))
+                    continue;
+                sources.push_back({ input + "!" + entry.name, without_extension(entry.name), archive.get(), &entry });
+            }
+            archives.push_back(std::move(archive));
+        }
+    }
+    return true;
+}
+
+enum class Outcome : char
+{
+    Disassembled,
+    // the class file is not supported by jasm, it is skipped
+    Skipped,
+    Failed
+};
+
+/**
+ * Disassembles a class file.
+ *
+ * @param text string the text is appended to.
+ * @param message message explaining why the class file has not been disassembled.
+ */
+static Outcome
+disassemble_class(const Settings &settings, const Source &source, std::string &text, std::string &message)
+{
+    std::vector<u1> bytes;
+    bool read = source.archive != nullptr ? source.archive->read(*source.entry, bytes) : read_file(source.path, bytes);
+    if (!read) {
+        message = "could not read " + source.path;
+        return Outcome::Failed;
+    }
+    if (!is_supported_class(bytes)) {
+        message = "skipping " + source.path + " (not supported by jasm)";
+        return Outcome::Skipped;
+    }
+    MemoryBuffer memory(bytes.data(), bytes.size());
+    std::istream is(&memory);
+    Class clazz(is);
+    Disassembler(settings.disassembler).disassemble(clazz, text);
+    return Outcome::Disassembled;
+}
+
+static void
+show_usage(const char *name)
+{
+    std::cerr << "usage: " << name << " [-j THREADS] [-c] [-o DIRECTORY] <CLASS|JAR|DIRECTORY>..." << std::endl;
+}
+
+int
+main(int argc, char *argv[])
+{
+    Settings settings;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            settings.threads = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "-c") == 0) {
+            settings.disassembler.constant_pool = true;
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            settings.output = argv[++i];
+        } else if (argv[i][0] == '-') {
+            show_usage(argv[0]);
+            return 1;
+        } else {
+            inputs.emplace_back(argv[i]);
+        }
+    }
+    if (inputs.empty()) {
+        show_usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<Archive>> archives;
+    std::vector<Source> sources;
+    if (!collect_sources(inputs, archives, sources))
+        return 1;
+
+    // the texts are written in the order of the inputs, whichever thread finishes first
+    std::ios_base::sync_with_stdio(false);
+    bool failed = false;
+    for (std::size_t first = 0; first < sources.size(); first += BatchSize) {
+        std::size_t count = std::min(BatchSize, sources.size() - first);
+        std::vector<std::string> texts(count);
+        std::vector<std::string> messages(count);
+        std::vector<Outcome> outcomes(count);
+        parallel_for(count, settings.threads, [&](std::size_t i) {
+            const Source &source = sources[first + i];
+            outcomes[i] = disassemble_class(settings, source, texts[i], messages[i]);
+            if (outcomes[i] != Outcome::Disassembled || settings.output.empty())
+                return;
+            auto path = std::filesystem::path(settings.output) / (source.name + ".jasm");
+            std::error_code error;
+            std::filesystem::create_directories(path.parent_path(), error);
+            if (!write_file(path.string(), texts[i])) {
+                outcomes[i] = Outcome::Failed;
+                messages[i] = "could not write " + path.string();
+            }
+        });
+
+        for (std::size_t i = 0; i < count; ++i) {
+            if (outcomes[i] != Outcome::Disassembled)
+                std::cerr << messages[i] << std::endl;
+            failed |= outcomes[i] == Outcome::Failed;
+            if (settings.output.empty())
+                std::cout.write(texts[i].data(), texts[i].size());
+        }
+    }
+    std::cout.flush();
+
+    return failed ? 1 : 0;
+}
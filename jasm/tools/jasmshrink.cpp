@@ -0,0 +1,327 @@
+/**
+ * @file jasmshrink.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "archive.hpp"
+#include "class.hpp"
+#include "class_file.hpp"
+#include "optimizer.hpp"
+#include "parallel.hpp"
+#include "shrinker.hpp"
+
+using namespace jasm;
+using namespace jasm::tools;
+
+// 1 January 1980, the earliest date of a ZIP entry, keeps the archive reproducible
+static constexpr u2 EntryDate = (1 << 5) | 1;
+static constexpr u2 ZipVersion = 20;
+
+/**
+ * A class file of the class path, either a standalone file or an archive entry.
+ */
+struct Source
+{
+    std::string path;
+    const Archive *archive;
+    const Archive::Entry *entry;
+};
+
+/**
+ * A class file read from the class path. A class jasm cannot read is kept as an opaque class, its bytes are
+ * written to the output unchanged.
+ */
+struct ClassFile
+{
+    std::unique_ptr<Class> clazz;
+    std::vector<u1> bytes;
+    std::string name;
+    std::vector<std::string> references;
+    bool valid = false;
+};
+
+struct Settings
+{
+    unsigned threads = hardware_threads();
+    std::vector<std::string> kept_classes;
+    bool optimize = false;
+    bool verbose = false;
+    std::string output;
+    std::string main_class;
+    std::string class_path;
+};
+
+static bool
+ends_with(const std::string &str, const std::string &suffix)
+{
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+ * @return true if an archive entry describes or signs the archive it is read from, the entry is not valid in
+ * the shrunk archive.
+ */
+static bool
+is_archive_metadata(const std::string &name)
+{
+    if (name.compare(0, 9, "META-INF/") != 0)
+        return false;
+    return ends_with(name, ".SF") || ends_with(name, ".RSA") || ends_with(name, ".DSA") || ends_with(name, ".EC") ||
+           name == "META-INF/INDEX.LIST";
+}
+
+static std::string
+internal_name(std::string name)
+{
+    std::replace(name.begin(), name.end(), '.', '/');
+    return name;
+}
+
+/**
+ * Collects the class files of the class path. The entries of the class path are separated by colons, an entry is
+ * either a directory or a JAR.
+ */
+static bool
+collect_sources(const std::string &class_path, std::vector<std::unique_ptr<Archive>> &archives,
+                std::vector<Source> &sources)
+{
+    std::size_t start = 0;
+    while (start <= class_path.size()) {
+        std::size_t end = std::min(class_path.find(':', start), class_path.size());
+        std::string path = class_path.substr(start, end - start);
+        start = end + 1;
+        if (path.empty())
+            continue;
+
+        if (std::filesystem::is_directory(path)) {
+            for (auto &file : list_class_files(path))
+                sources.push_back({ file, nullptr, nullptr });
+            continue;
+        }
+        auto archive = std::make_unique<Archive>();
+        if (!archive->open(path)) {
+            std::cerr << "could not read " << path << " (not a directory or a ZIP archive)" << std::endl;
+            return false;
+        }
+        for (auto &entry : archive->entries()) {
+            // the versioned classes of multi-release archives are not supported
+            if (is_class_file(entry.name) && entry.name.compare(0, 9, "META-INF/") != 0)
+                sources.push_back({ path + "!" + entry.name, archive.get(), &entry });
+        }
+        archives.push_back(std::move(archive));
+    }
+    return true;
+}
+
+/**
+ * Reads the class files in parallel. The classes jasm cannot read keep their bytes and the classes they refer to.
+ */
+static std::vector<ClassFile>
+read_classes(const Settings &settings, const std::vector<Source> &sources)
+{
+    std::vector<ClassFile> classes(sources.size());
+    parallel_for(sources.size(), settings.threads, [&](std::size_t i) {
+        const Source &source = sources[i];
+        ClassFile &class_file = classes[i];
+        bool read = source.archive != nullptr ? source.archive->read(*source.entry, class_file.bytes)
+                                              : read_file(source.path, class_file.bytes);
+        if (!read)
+            return;
+        if (!is_supported_class(class_file.bytes)) {
+            class_file.valid = scan_class_references(class_file.bytes, class_file.name, class_file.references);
+            return;
+        }
+        MemoryBuffer memory(class_file.bytes.data(), class_file.bytes.size());
+        std::istream is(&memory);
+        class_file.clazz = std::make_unique<Class>(is);
+        class_file.bytes.clear();
+        class_file.valid = true;
+    });
+    return classes;
+}
+
+/**
+ * Writes the classes to a directory or a JAR, the JAR also receives the other entries of the archives of
+ * the class path.
+ */
+static bool
+write_output(const Settings &settings, std::vector<std::string> names, std::vector<std::string> bytes,
+             const std::vector<std::unique_ptr<Archive>> &archives, const std::vector<const ClassFile *> &opaque)
+{
+    for (auto *class_file : opaque) {
+        names.push_back(class_file->name);
+        bytes.emplace_back(class_file->bytes.begin(), class_file->bytes.end());
+    }
+
+    if (!ends_with(settings.output, ".jar")) {
+        bool written = true;
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            auto path = std::filesystem::path(settings.output) / (names[i] + ".class");
+            std::error_code error;
+            std::filesystem::create_directories(path.parent_path(), error);
+            if (!write_file(path.string(), bytes[i])) {
+                std::cerr << "could not write " << path.string() << std::endl;
+                written = false;
+            }
+        }
+        return written;
+    }
+
+    std::ostringstream os;
+    ArchiveWriter writer(os);
+    std::set<std::string> written;
+    for (auto &archive : archives) {
+        for (auto &entry : archive->entries()) {
+            if (is_class_file(entry.name) || is_archive_metadata(entry.name) || !written.insert(entry.name).second)
+                continue;
+            writer.copy(entry, archive->raw_data(entry));
+        }
+    }
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        Archive::Entry entry;
+        entry.name = names[i] + ".class";
+        entry.version_made_by = ZipVersion;
+        entry.version_needed = ZipVersion;
+        entry.method = Archive::Deflated;
+        entry.date = EntryDate;
+        writer.add(entry, std::vector<u1>(bytes[i].begin(), bytes[i].end()));
+    }
+    if (!writer.finish() || !write_file(settings.output, std::move(os).str())) {
+        std::cerr << "could not write " << settings.output << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static void
+show_usage(const char *name)
+{
+    std::cerr << "usage: " << name << " [-j THREADS] [-k CLASS]... [-O] [-v] -o OUTPUT <MAIN_CLASS> <CLASSPATH>"
+              << std::endl;
+}
+
+int
+main(int argc, char *argv[])
+{
+    Settings settings;
+    std::vector<std::string> arguments;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            settings.threads = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            settings.kept_classes.push_back(internal_name(argv[++i]));
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            settings.output = argv[++i];
+        } else if (strcmp(argv[i], "-O") == 0) {
+            settings.optimize = true;
+        } else if (strcmp(argv[i], "-v") == 0) {
+            settings.verbose = true;
+        } else if (argv[i][0] == '-') {
+            show_usage(argv[0]);
+            return 1;
+        } else {
+            arguments.emplace_back(argv[i]);
+        }
+    }
+    if (arguments.size() != 2 || settings.output.empty()) {
+        show_usage(argv[0]);
+        return 1;
+    }
+    settings.main_class = internal_name(arguments[0]);
+    settings.class_path = arguments[1];
+
+    std::vector<std::unique_ptr<Archive>> archives;
+    std::vector<Source> sources;
+    if (!collect_sources(settings.class_path, archives, sources))
+        return 1;
+    std::vector<ClassFile> classes = read_classes(settings, sources);
+
+    // the first class of a name on the class path hides the others
+    Shrinker shrinker;
+    std::vector<const ClassFile *> opaque;
+    for (std::size_t i = 0; i < classes.size(); ++i) {
+        ClassFile &class_file = classes[i];
+        if (!class_file.valid) {
+            std::cerr << "could not read " << sources[i].path << std::endl;
+            return 1;
+        }
+        if (class_file.clazz) {
+            shrinker.add_class(std::move(*class_file.clazz));
+            class_file.clazz.reset();
+        } else if (shrinker.add_opaque_class(class_file.name, class_file.references)) {
+            std::cerr << "keeping " << sources[i].path << " unchanged (not supported by jasm)" << std::endl;
+            opaque.push_back(&class_file);
+        }
+    }
+
+    if (!shrinker.keep_method(settings.main_class, "main", "([Ljava/lang/String;)V")) {
+        std::cerr << "class " << settings.main_class << " has no main method" << std::endl;
+        return 1;
+    }
+    for (auto &name : settings.kept_classes) {
+        if (!shrinker.keep_class(name))
+            std::cerr << "class " << name << " is not on the class path" << std::endl;
+    }
+
+    std::set<std::string> all_classes;
+    for (auto &[name, clazz] : shrinker.classes())
+        all_classes.insert(name);
+    Shrinker::Statistics statistics = shrinker.shrink();
+    if (settings.verbose) {
+        for (auto &name : all_classes) {
+            if (shrinker.classes().count(name) == 0)
+                std::cout << "removed " << name << std::endl;
+        }
+    }
+
+    // the constants of the removed members are removed with the other optimisations
+    Optimizer::Options options;
+    if (!settings.optimize) {
+        options.remove_dead_code = false;
+        options.peephole = false;
+        options.recompute_limits = false;
+    }
+    Optimizer optimizer(options);
+    std::vector<std::string> names;
+    std::vector<Class *> kept;
+    for (auto &[name, clazz] : shrinker.classes()) {
+        names.push_back(name);
+        kept.push_back(&clazz);
+    }
+    std::vector<std::string> bytes(kept.size());
+    std::vector<Optimizer::Statistics> optimized(kept.size());
+    parallel_for(kept.size(), settings.threads, [&](std::size_t i) {
+        optimized[i] = optimizer.optimize(*kept[i]);
+        std::ostringstream os;
+        kept[i]->emit_bytecode(os);
+        bytes[i] = std::move(os).str();
+    });
+    std::size_t removed_constants = 0;
+    for (auto &class_statistics : optimized)
+        removed_constants += class_statistics.removed_constants;
+
+    std::cout << statistics.classes << " classes kept, " << statistics.removed_classes << " classes, "
+              << statistics.removed_methods << " methods, " << statistics.removed_fields << " fields and "
+              << removed_constants << " constants removed";
+    if (statistics.opaque_classes > 0)
+        std::cout << ", " << statistics.opaque_classes << " classes kept unchanged";
+    std::cout << std::endl;
+
+    return write_output(settings, std::move(names), std::move(bytes), archives, opaque) ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file parallel.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#ifndef JAWA_PARALLEL_HPP
+#define JAWA_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace jasm::tools {
+
+    /**
+     * @return number of threads the hardware runs concurrently, at least 1.
+     */
+    inline unsigned
+    hardware_threads()
+    {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    /**
+     * Calls the function for every index in [0, count) on the given number of threads. The indices are taken one
+     * by one from a shared counter, so a thread which finishes a small item continues with the next one instead of
+     * waiting for a precomputed share of the work. The function must not throw.
+     *
+     * @param count number of the items.
+     * @param threads maximal number of threads including the calling thread.
+     * @param function function called with the index of an item.
+     */
+    template<typename Function>
+    void
+    parallel_for(std::size_t count, unsigned threads, Function function)
+    {
+        std::size_t workers = std::min<std::size_t>(std::max(1u, threads), count);
+        if (workers <= 1) {
+            for (std::size_t i = 0; i < count; ++i)
+                function(i);
+            return;
+        }
+
+        std::atomic<std::size_t> next(0);
+        auto work = [&next, &function, count]() {
+            for (std::size_t i = next++; i < count; i = next++)
+                function(i);
+        };
+        std::vector<std::thread> pool;
+        pool.reserve(workers - 1);
+        for (std::size_t i = 1; i < workers; ++i)
+            pool.emplace_back(work);
+        work();
+        for (auto &thread : pool)
+            thread.join();
+    }
+
+}
+
+#endif // JAWA_PARALLEL_HPP
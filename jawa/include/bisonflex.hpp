@@ -15,7 +15,7 @@
 #include "context.hpp"
 #include "unicode.hpp"
 
-#define YY_DECL jawa::parser::symbol_type yylex(yyscan_t yyscanner, jawa::Context *ctx)
+#define YY_DECL jawa::parser::symbol_type scan_token(yyscan_t yyscanner, jawa::Context *ctx)
 
 #define YY_USER_ACTION ctx->inc_column(jawa::unicode::utf8_length(yytext));
 
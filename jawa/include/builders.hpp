@@ -0,0 +1,37 @@
+/**
+ * @file builders.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#ifndef JAWA_BUILDERS_HPP
+#define JAWA_BUILDERS_HPP
+
+#include "ir.hpp"
+#include "tables.hpp"
+
+namespace jawa {
+
+    /**
+     * Replaces the repeated concatenation to a string variable in a loop by a string builder. A variable qualifies
+     * if the loop only appends to it, that is all its occurrences in the loop are statements of the form s = s + x
+     * or s += x. The builder is created from the value of the variable before the loop, the statements append to it
+     * and the variable is assigned the content of the builder after the loop if any of the statements has run, so a
+     * loop that does not append leaves the variable as it is. Each iteration then costs time proportional to the
+     * appended text rather than to the whole string.
+     * The pass has to run after the invariants are hoisted and before the local variable slots are allocated.
+     *
+     * @param arena arena of the IR nodes.
+     * @param type_table type table.
+     * @param method IR of the method.
+     */
+    void
+    use_string_builders(ir::Arena &arena, TypeTable &type_table, ir::Method &method);
+
+}
+
+#endif // JAWA_BUILDERS_HPP
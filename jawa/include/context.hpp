@@ -17,6 +17,9 @@
 #include "builder.hpp"
 #include "error.hpp"
 #include "format.hpp"
+#include "ir.hpp"
+#include "log.hpp"
+#include "statistics.hpp"
 #include "tables.hpp"
 
 namespace jawa {
@@ -43,22 +46,36 @@ namespace jawa {
     {
     private:
         loc_t loc_;
+        Statistics statistics_;
+        Phase stop_after_;
+        jasm::u2 class_version_;
+        bool inline_methods_;
         TypeTable type_table_;
         ClassTable class_table_;
         VariableScopeTable scope_table_;
         std::locale locale_;
         std::unique_ptr<jasm::ClassBuilder> builder_;
-        jasm::BasicBlock static_initializer_;
+        ir::Arena arena_;
+        ir::Class *ir_class_;
+        ir::Method *ir_method_;
+        std::vector<ir::Switch *> switches_;
+        std::vector<ir::Loop *> loops_;
         Name package_name_;
 
         void
-        message_line(loc_t const &loc) const;
+        message_line(std::ostream &os, loc_t const &loc) const;
 
     public:
         explicit Context(const std::string &class_paths)
-          : type_table_()
-          , class_table_(type_table_, class_paths)
+          : statistics_()
+          , stop_after_(Phase::EMISSION)
+          , class_version_(59)
+          , inline_methods_(false)
+          , type_table_()
+          , class_table_(type_table_, class_paths, statistics_)
           , locale_("pl_PL.UTF-8")
+          , ir_class_(nullptr)
+          , ir_method_(nullptr)
           , package_name_()
         {}
 
@@ -116,7 +133,8 @@ namespace jawa {
         }
 
         /**
-         * Reports error message.
+         * Reports error message. The message is written to the standard error output at once, it is not buffered
+         * so that it is not lost if the compiler crashes afterwards.
          *
          * @param err type of the error.
          * @param loc location of the error.
@@ -125,9 +143,11 @@ namespace jawa {
         void
         message(errors::error_object<Args...> err, const loc_t &loc, Args... args) const
         {
-            std::cerr << "błąd:" << std::dec << loc.line << ':' << loc.column_start << ": ";
-            format(std::cerr, err.msg(), args...) << std::endl;
-            message_line(loc);
+            std::ostringstream os;
+            os << "błąd:" << std::dec << loc.line << ':' << loc.column_start << ": ";
+            format(os, err.msg(), args...) << '\n';
+            message_line(os, loc);
+            std::cerr << std::move(os).str();
         }
 
         /**
@@ -199,10 +219,129 @@ namespace jawa {
             return scope_table_;
         }
 
-        inline jasm::BasicBlock &
-        static_initializer()
+        /**
+         *
+         * @return reference to the compiler statistics.
+         */
+        inline Statistics &
+        statistics()
+        {
+            return statistics_;
+        }
+
+        /**
+         *
+         * @return major version of the emitted class files.
+         */
+        inline jasm::u2
+        class_version() const
+        {
+            return class_version_;
+        }
+
+        inline void
+        set_class_version(jasm::u2 version)
+        {
+            class_version_ = version;
+        }
+
+        /**
+         * @return true if the calls of small methods of the compiled class are inlined.
+         */
+        inline bool
+        inline_methods() const
+        {
+            return inline_methods_;
+        }
+
+        inline void
+        set_inline_methods(bool inline_methods)
+        {
+            inline_methods_ = inline_methods;
+        }
+
+        /**
+         * Sets the last phase the compiler runs.
+         *
+         * @param phase last phase.
+         */
+        inline void
+        set_stop_after(Phase phase)
+        {
+            stop_after_ = phase;
+        }
+
+        /**
+         * Determines whether a phase is run.
+         *
+         * @param phase compiler phase.
+         * @return true if the compiler does not stop before the phase, otherwise false.
+         */
+        inline bool
+        runs(Phase phase) const
+        {
+            return phase <= stop_after_;
+        }
+
+        /**
+         *
+         * @return reference to the arena of the IR nodes of the current class.
+         */
+        inline ir::Arena &
+        arena()
+        {
+            return arena_;
+        }
+
+        /**
+         *
+         * @return IR of the current class.
+         */
+        inline ir::Class *
+        ir_class()
+        {
+            return ir_class_;
+        }
+
+        inline void
+        set_ir_class(ir::Class *ir_class)
+        {
+            ir_class_ = ir_class;
+        }
+
+        /**
+         *
+         * @return IR of the method being parsed, nullptr outside of method bodies.
+         */
+        inline ir::Method *
+        ir_method()
+        {
+            return ir_method_;
+        }
+
+        inline void
+        set_ir_method(ir::Method *ir_method)
+        {
+            ir_method_ = ir_method;
+        }
+
+        /**
+         *
+         * @return switch statements enclosing the statement being parsed, the innermost one is the last.
+         */
+        inline std::vector<ir::Switch *> &
+        switches()
+        {
+            return switches_;
+        }
+
+        /**
+         * @return loops enclosing the statement being parsed, the innermost one is the last.
+         */
+        inline std::vector<ir::Loop *> &
+        loops()
         {
-            return static_initializer_;
+            return loops_;
         }
 
         inline void
@@ -50,8 +50,26 @@ namespace jawa::errors {
     extern err_n CLASS_NOT_FOUND;
     extern err_nn METHOD_NOT_FOUND;
     extern err_nn FIELD_NOT_FOUND;
+    extern err_nn NON_STATIC_FIELD;
     extern err EXPECTED_REFERENCE_TYPE;
     extern err_n VARIABLE_NOT_DECLARED;
+    extern err_n VARIABLE_ALREADY_DECLARED;
+    extern err_n INCOMPATIBLE_OPERANDS;
+    extern err_nn INCOMPATIBLE_TYPES;
+    extern err_n NUMBER_OUT_OF_RANGE;
+    extern err_n UNSUPPORTED_OPERATION;
+    extern err EXPECTED_CONSTANT_EXPRESSION;
+    extern err_n DUPLICATE_CASE_LABEL;
+    extern err DUPLICATE_DEFAULT_LABEL;
+    extern err BREAK_OUTSIDE_SWITCH;
+    extern err CONTINUE_OUTSIDE_LOOP;
+    extern err NON_STATIC_IN_STATIC_CONTEXT;
+    extern err EXPECTED_ARRAY_TYPE;
+    extern err INVALID_ASSIGNMENT_TARGET;
+    extern err_n CONSTRUCTOR_NOT_FOUND;
+    extern err_n MISSING_RETURN_TYPE;
+    extern err_n INVALID_SUPERCLASS;
+    extern err_n EXPECTED_INTERFACE;
 
 }
 
@@ -0,0 +1,41 @@
+/**
+ * @file folding.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#ifndef JAWA_FOLDING_HPP
+#define JAWA_FOLDING_HPP
+
+#include "ir.hpp"
+
+namespace jawa {
+
+    /**
+     * Evaluates an operation at compile time if all its operands are constants. Conversions, unary and binary
+     * operations (including string concatenation) are folded with the Java semantics: integer arithmetic wraps
+     * around and floating point arithmetic follows IEEE 754. Integer division by zero is left to fail at run time.
+     *
+     * @param arena arena of the IR nodes.
+     * @param expr expression whose operands have already been folded.
+     * @return constant node, or the expression itself if it cannot be folded.
+     */
+    ir::Expression *
+    fold(ir::Arena &arena, ir::Expression *expr);
+
+    /**
+     * Converts a constant to a string in the same way as String.valueOf does.
+     *
+     * @param constant constant.
+     * @return string representation of the constant.
+     */
+    Name
+    constant_to_string(const ir::Constant &constant);
+
+}
+
+#endif // JAWA_FOLDING_HPP
@@ -0,0 +1,33 @@
+/**
+ * @file hoisting.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#ifndef JAWA_HOISTING_HPP
+#define JAWA_HOISTING_HPP
+
+#include "ir.hpp"
+
+namespace jawa {
+
+    /**
+     * Moves the loads of loop invariant static fields out of the loops of a method. A field is invariant in a loop
+     * if it is a non-volatile field of the compiled class, the loop does not assign it and does not call any code
+     * which could. Its value is then loaded once into a new local variable before the loop.
+     * The pass has to run before the local variable slots are allocated.
+     *
+     * @param arena arena of the IR nodes.
+     * @param ir_class IR of the class of the method.
+     * @param method IR of the method.
+     */
+    void
+    hoist_invariants(ir::Arena &arena, const ir::Class &ir_class, ir::Method &method);
+
+}
+
+#endif // JAWA_HOISTING_HPP
@@ -0,0 +1,848 @@
+/**
+ * @file ir.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#ifndef JAWA_IR_HPP
+#define JAWA_IR_HPP
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "operators.hpp"
+#include "tables.hpp"
+#include "types.hpp"
+
+/**
+ * Typed intermediate representation built by the parser. The semantic actions resolve names and types
+ * and build expression and statement trees, which are lowered to byte code method by method once the whole
+ * class has been parsed.
+ */
+namespace jawa::ir {
+
+    /**
+     * Bump allocator of the IR nodes. All the nodes of a class are released at once when the class is lowered.
+     */
+    class Arena
+    {
+    private:
+        static constexpr std::size_t ChunkSize = 64 * 1024;
+
+        struct destructor_t
+        {
+            void *object;
+            void (*destroy)(void *);
+        };
+
+        std::vector<std::unique_ptr<std::byte[]>> chunks_;
+        std::size_t used_;
+        std::size_t capacity_;
+        std::vector<destructor_t> destructors_;
+
+        void *
+        allocate(std::size_t size, std::size_t alignment);
+
+    public:
+        Arena()
+          : used_(0)
+          , capacity_(0)
+        {}
+
+        Arena(const Arena &) = delete;
+
+        Arena &
+        operator=(const Arena &) = delete;
+
+        ~Arena()
+        {
+            reset();
+        }
+
+        /**
+         * Creates a new object in the arena.
+         *
+         * @tparam T type of the object.
+         * @tparam Args types of the constructor arguments.
+         * @param args constructor arguments.
+         * @return pointer to the object, valid until the arena is reset.
+         */
+        template<typename T, typename... Args>
+        T *
+        make(Args &&...args)
+        {
+            T *object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            if constexpr (!std::is_trivially_destructible_v<T>)
+                destructors_.push_back({ object, [](void *ptr) { static_cast<T *>(ptr)->~T(); } });
+            return object;
+        }
+
+        /**
+         * Destroys all the objects. The first chunk is kept for reuse.
+         */
+        void
+        reset();
+    };
+
+    enum class Kind
+    {
+        CONSTANT,
+        LOCAL_LOAD,
+        LOCAL_STORE,
+        STATIC_FIELD_LOAD,
+        STATIC_FIELD_STORE,
+        FIELD_LOAD,
+        FIELD_STORE,
+        INVOKE,
+        NEW,
+        NEW_ARRAY,
+        ARRAY_LOAD,
+        ARRAY_STORE,
+        ARRAY_LENGTH,
+        CONVERT,
+        UNARY,
+        BINARY,
+        POSTFIX_UPDATE,
+        EXPRESSION_STATEMENT,
+        RETURN,
+        BLOCK,
+        IF,
+        SWITCH,
+        LOOP,
+        BREAK,
+        CONTINUE,
+        SYNCHRONIZED,
+    };
+
+    struct Node
+    {
+        const Kind kind;
+
+        explicit Node(Kind kind)
+          : kind(kind)
+        {}
+    };
+
+    /**
+     * Casts a node to a concrete node type.
+     *
+     * @tparam T node type.
+     * @param node node, may be null.
+     * @return the node if it is of the given type, otherwise nullptr.
+     */
+    template<typename T>
+    inline T *
+    node_cast(Node *node)
+    {
+        return node && node->kind == T::NodeKind ? static_cast<T *>(node) : nullptr;
+    }
+
+    template<typename T>
+    inline const T *
+    node_cast(const Node *node)
+    {
+        return node && node->kind == T::NodeKind ? static_cast<const T *>(node) : nullptr;
+    }
+
+    /**
+     * Local variable or a formal parameter of a method.
+     */
+    struct Local
+    {
+        Name name;
+        TypeObs type;
+        jasm::u2 index;
+
+        Local(Name name, TypeObs type, jasm::u2 index)
+          : name(std::move(name))
+          , type(type)
+          , index(index)
+        {}
+    };
+
+    struct Expression : public Node
+    {
+        TypeObs type;
+
+        Expression(Kind kind, TypeObs type)
+          : Node(kind)
+          , type(type)
+        {}
+    };
+
+    using ExpressionArray = std::vector<Expression *>;
+
+    /**
+     * Compile-time constant of a primitive type or a string.
+     */
+    struct Constant : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::CONSTANT;
+
+        ConstantValue value;
+
+        Constant(TypeObs type, ConstantValue value)
+          : Expression(NodeKind, type)
+          , value(std::move(value))
+        {}
+    };
+
+    struct LocalLoad : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::LOCAL_LOAD;
+
+        Local *local;
+
+        explicit LocalLoad(Local *local)
+          : Expression(NodeKind, local->type)
+          , local(local)
+        {}
+    };
+
+    /**
+     * Assignment to a local variable. The value of the expression is the assigned value.
+     */
+    struct LocalStore : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::LOCAL_STORE;
+
+        Local *local;
+        Expression *value;
+
+        LocalStore(Local *local, Expression *value)
+          : Expression(NodeKind, local->type)
+          , local(local)
+          , value(value)
+        {}
+    };
+
+    struct StaticFieldLoad : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::STATIC_FIELD_LOAD;
+
+        Name class_name;
+        Name field_name;
+
+        StaticFieldLoad(TypeObs type, Name class_name, Name field_name)
+          : Expression(NodeKind, type)
+          , class_name(std::move(class_name))
+          , field_name(std::move(field_name))
+        {}
+    };
+
+    /**
+     * Assignment to a static field. The value of the expression is the assigned value.
+     */
+    struct StaticFieldStore : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::STATIC_FIELD_STORE;
+
+        Name class_name;
+        Name field_name;
+        Expression *value;
+
+        StaticFieldStore(Name class_name, Name field_name, Expression *value)
+          : Expression(NodeKind, value->type)
+          , class_name(std::move(class_name))
+          , field_name(std::move(field_name))
+          , value(value)
+        {}
+    };
+
+    /**
+     * Load of an instance field of an object.
+     */
+    struct FieldLoad : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::FIELD_LOAD;
+
+        Expression *object;
+        Name class_name;
+        Name field_name;
+
+        FieldLoad(TypeObs type, Expression *object, Name class_name, Name field_name)
+          : Expression(NodeKind, type)
+          , object(object)
+          , class_name(std::move(class_name))
+          , field_name(std::move(field_name))
+        {}
+    };
+
+    /**
+     * Assignment to an instance field. The value of the expression is the assigned value.
+     */
+    struct FieldStore : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::FIELD_STORE;
+
+        Expression *object;
+        Name class_name;
+        Name field_name;
+        Expression *value;
+
+        FieldStore(Expression *object, Name class_name, Name field_name, Expression *value)
+          : Expression(NodeKind, value->type)
+          , object(object)
+          , class_name(std::move(class_name))
+          , field_name(std::move(field_name))
+          , value(value)
+        {}
+    };
+
+    struct Invoke : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::INVOKE;
+
+        enum Dispatch
+        {
+            STATIC,
+            VIRTUAL,
+            SPECIAL,
+            INTERFACE,
+        };
+
+        Dispatch dispatch;
+        Name class_name;
+        Name method_name;
+        MethodTypeObs method_type;
+        Expression *receiver;
+        ExpressionArray arguments;
+
+        Invoke(Dispatch dispatch, Name class_name, Name method_name, MethodTypeObs method_type, Expression *receiver,
+               ExpressionArray arguments)
+          : Expression(NodeKind, method_type->return_type())
+          , dispatch(dispatch)
+          , class_name(std::move(class_name))
+          , method_name(std::move(method_name))
+          , method_type(method_type)
+          , receiver(receiver)
+          , arguments(std::move(arguments))
+        {}
+    };
+
+    /**
+     * Object instantiation including the constructor call.
+     */
+    struct New : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::NEW;
+
+        MethodTypeObs constructor_type;
+        ExpressionArray arguments;
+
+        New(ClassTypeObs type, MethodTypeObs constructor_type, ExpressionArray arguments)
+          : Expression(NodeKind, type)
+          , constructor_type(constructor_type)
+          , arguments(std::move(arguments))
+        {}
+    };
+
+    /**
+     * Creation of a one-dimensional array, its elements are zero.
+     */
+    struct NewArray : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::NEW_ARRAY;
+
+        Expression *length;
+
+        NewArray(ArrayTypeObs type, Expression *length)
+          : Expression(NodeKind, type)
+          , length(length)
+        {}
+    };
+
+    /**
+     * Load of an array element, the type of the expression is the element type.
+     */
+    struct ArrayLoad : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::ARRAY_LOAD;
+
+        Expression *array;
+        Expression *index;
+
+        ArrayLoad(TypeObs type, Expression *array, Expression *index)
+          : Expression(NodeKind, type)
+          , array(array)
+          , index(index)
+        {}
+    };
+
+    /**
+     * Assignment to an array element. The value of the expression is the assigned value.
+     */
+    struct ArrayStore : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::ARRAY_STORE;
+
+        Expression *array;
+        Expression *index;
+        Expression *value;
+
+        ArrayStore(Expression *array, Expression *index, Expression *value)
+          : Expression(NodeKind, value->type)
+          , array(array)
+          , index(index)
+          , value(value)
+        {}
+    };
+
+    struct ArrayLength : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::ARRAY_LENGTH;
+
+        Expression *array;
+
+        ArrayLength(TypeObs type, Expression *array)
+          : Expression(NodeKind, type)
+          , array(array)
+        {}
+    };
+
+    /**
+     * Primitive conversion of a value to the type of the expression.
+     */
+    struct Convert : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::CONVERT;
+
+        Expression *operand;
+
+        Convert(TypeObs type, Expression *operand)
+          : Expression(NodeKind, type)
+          , operand(operand)
+        {}
+    };
+
+    /**
+     * Unary operation. The operand has already been promoted to the type of the expression.
+     */
+    struct Unary : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::UNARY;
+
+        operators::unop op;
+        Expression *operand;
+
+        Unary(TypeObs type, operators::unop op, Expression *operand)
+          : Expression(NodeKind, type)
+          , op(op)
+          , operand(operand)
+        {}
+    };
+
+    /**
+     * Binary operation. The operands of numeric operations have already been promoted to a common type,
+     * the operands of string concatenation may be of any type.
+     */
+    struct Binary : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::BINARY;
+
+        operators::binop op;
+        Expression *lhs;
+        Expression *rhs;
+
+        Binary(TypeObs type, operators::binop op, Expression *lhs, Expression *rhs)
+          : Expression(NodeKind, type)
+          , op(op)
+          , lhs(lhs)
+          , rhs(rhs)
+        {}
+    };
+
+    /**
+     * Postfix increment or decrement. The value of the expression is the value of the variable before the update.
+     */
+    struct PostfixUpdate : public Expression
+    {
+        static constexpr Kind NodeKind = Kind::POSTFIX_UPDATE;
+
+        Expression *old_value;
+        Expression *update;
+
+        PostfixUpdate(Expression *old_value, Expression *update)
+          : Expression(NodeKind, old_value->type)
+          , old_value(old_value)
+          , update(update)
+        {}
+    };
+
+    struct Statement : public Node
+    {
+        using Node::Node;
+    };
+
+    using StatementArray = std::vector<Statement *>;
+
+    /**
+     * Expression evaluated for its side effects, its value is discarded.
+     */
+    struct ExpressionStatement : public Statement
+    {
+        static constexpr Kind NodeKind = Kind::EXPRESSION_STATEMENT;
+
+        Expression *expression;
+
+        explicit ExpressionStatement(Expression *expression)
+          : Statement(NodeKind)
+          , expression(expression)
+        {}
+    };
+
+    struct Return : public Statement
+    {
+        static constexpr Kind NodeKind = Kind::RETURN;
+
+        Expression *value;
+
+        explicit Return(Expression *value)
+          : Statement(NodeKind)
+          , value(value)
+        {}
+    };
+
+    struct Block : public Statement
+    {
+        static constexpr Kind NodeKind = Kind::BLOCK;
+
+        StatementArray statements;
+
+        explicit Block(StatementArray statements)
+          : Statement(NodeKind)
+          , statements(std::move(statements))
+        {}
+    };
+
+    /**
+     * If statement, either of the branches may be null if it is empty or erroneous.
+     */
+    struct If : public Statement
+    {
+        static constexpr Kind NodeKind = Kind::IF;
+
+        Expression *condition;
+        Statement *then_statement;
+        Statement *else_statement;
+
+        If(Expression *condition, Statement *then_statement, Statement *else_statement)
+          : Statement(NodeKind)
+          , condition(condition)
+          , then_statement(then_statement)
+          , else_statement(else_statement)
+        {}
+    };
+
+    /**
+     * Switch statement over an int or a string. The statements of the switch block are kept in a single array and
+     * every label refers to the statement the execution continues with, so the fall through is implicit.
+     */
+    struct Switch : public Statement
+    {
+        static constexpr Kind NodeKind = Kind::SWITCH;
+
+        struct Case
+        {
+            const Constant *value;
+            std::size_t target;
+        };
+
+        Expression *selector;
+        std::vector<Case> cases;
+        std::optional<std::size_t> default_target;
+        StatementArray statements;
+
+        explicit Switch(Expression *selector)
+          : Statement(NodeKind)
+          , selector(selector)
+          , cases()
+          , default_target()
+          , statements()
+        {}
+    };
+
+    /**
+     * While, do and for loop. The initialisation of a for loop precedes the loop in an enclosing block.
+     */
+    struct Loop : public Statement
+    {
+        static constexpr Kind NodeKind = Kind::LOOP;
+
+        // a for loop without a condition has the constant true
+        Expression *condition;
+        // null for an empty body
+        Statement *body;
+        StatementArray update;
+        // false for a do loop, whose condition is tested after the first iteration
+        bool test_first;
+
+        Loop(Expression *condition, bool test_first)
+          : Statement(NodeKind)
+          , condition(condition)
+          , body(nullptr)
+          , update()
+          , test_first(test_first)
+        {}
+    };
+
+    /**
+     * Jump out of the innermost switch statement or loop.
+     */
+    struct Break : public Statement
+    {
+        static constexpr Kind NodeKind = Kind::BREAK;
+
+        Break()
+          : Statement(NodeKind)
+        {}
+    };
+
+    /**
+     * Jump to the next iteration of the innermost loop.
+     */
+    struct Continue : public Statement
+    {
+        static constexpr Kind NodeKind = Kind::CONTINUE;
+
+        Continue()
+          : Statement(NodeKind)
+        {}
+    };
+
+    /**
+     * Synchronized statement. The lock is stored to a hidden local variable before the monitor is entered, so that
+     * the same object is released by all the exits of the body.
+     */
+    struct Synchronized : public Statement
+    {
+        static constexpr Kind NodeKind = Kind::SYNCHRONIZED;
+
+        Expression *lock;
+        Local *local;
+        // null for an empty body
+        Statement *body;
+
+        Synchronized(Expression *lock, Local *local, Statement *body)
+          : Statement(NodeKind)
+          , lock(lock)
+          , local(local)
+          , body(body)
+        {}
+    };
+
+    /**
+     * Node type T with the constness of the node type N.
+     */
+    template<typename N, typename T>
+    using like_t = std::conditional_t<std::is_const_v<N>, const T, T>;
+
+    /**
+     * Calls a function with each child expression and statement of a node. The children are passed by reference, so
+     * that a pass can replace them, the children of a constant node are passed by constant reference.
+     *
+     * @param node node, may be constant.
+     * @param visitor function accepting a reference to an expression and to a statement pointer.
+     */
+    template<typename N, typename F>
+    void
+    for_each_child(N *node, F &&visitor)
+    {
+        auto visit = [&visitor](auto &child) {
+            if (child != nullptr)
+                visitor(child);
+        };
+
+        switch (node->kind) {
+        case Kind::CONSTANT:
+        case Kind::LOCAL_LOAD:
+        case Kind::STATIC_FIELD_LOAD:
+        case Kind::BREAK:
+        case Kind::CONTINUE:
+            break;
+        case Kind::LOCAL_STORE:
+            visit(static_cast<like_t<N, LocalStore> *>(node)->value);
+            break;
+        case Kind::STATIC_FIELD_STORE:
+            visit(static_cast<like_t<N, StaticFieldStore> *>(node)->value);
+            break;
+        case Kind::FIELD_LOAD:
+            visit(static_cast<like_t<N, FieldLoad> *>(node)->object);
+            break;
+        case Kind::FIELD_STORE: {
+            auto *store = static_cast<like_t<N, FieldStore> *>(node);
+            visit(store->object);
+            visit(store->value);
+            break;
+        }
+        case Kind::INVOKE: {
+            auto *invoke = static_cast<like_t<N, Invoke> *>(node);
+            visit(invoke->receiver);
+            for (auto &argument : invoke->arguments)
+                visit(argument);
+            break;
+        }
+        case Kind::NEW:
+            for (auto &argument : static_cast<like_t<N, New> *>(node)->arguments)
+                visit(argument);
+            break;
+        case Kind::NEW_ARRAY:
+            visit(static_cast<like_t<N, NewArray> *>(node)->length);
+            break;
+        case Kind::ARRAY_LOAD: {
+            auto *load = static_cast<like_t<N, ArrayLoad> *>(node);
+            visit(load->array);
+            visit(load->index);
+            break;
+        }
+        case Kind::ARRAY_STORE: {
+            auto *store = static_cast<like_t<N, ArrayStore> *>(node);
+            visit(store->array);
+            visit(store->index);
+            visit(store->value);
+            break;
+        }
+        case Kind::ARRAY_LENGTH:
+            visit(static_cast<like_t<N, ArrayLength> *>(node)->array);
+            break;
+        case Kind::CONVERT:
+            visit(static_cast<like_t<N, Convert> *>(node)->operand);
+            break;
+        case Kind::UNARY:
+            visit(static_cast<like_t<N, Unary> *>(node)->operand);
+            break;
+        case Kind::BINARY: {
+            auto *binary = static_cast<like_t<N, Binary> *>(node);
+            visit(binary->lhs);
+            visit(binary->rhs);
+            break;
+        }
+        case Kind::POSTFIX_UPDATE: {
+            auto *update = static_cast<like_t<N, PostfixUpdate> *>(node);
+            visit(update->old_value);
+            visit(update->update);
+            break;
+        }
+        case Kind::EXPRESSION_STATEMENT:
+            visit(static_cast<like_t<N, ExpressionStatement> *>(node)->expression);
+            break;
+        case Kind::RETURN:
+            visit(static_cast<like_t<N, Return> *>(node)->value);
+            break;
+        case Kind::BLOCK:
+            for (auto &statement : static_cast<like_t<N, Block> *>(node)->statements)
+                visit(statement);
+            break;
+        case Kind::IF: {
+            auto *if_stmt = static_cast<like_t<N, If> *>(node);
+            visit(if_stmt->condition);
+            visit(if_stmt->then_statement);
+            visit(if_stmt->else_statement);
+            break;
+        }
+        case Kind::SWITCH: {
+            auto *switch_stmt = static_cast<like_t<N, Switch> *>(node);
+            visit(switch_stmt->selector);
+            for (auto &statement : switch_stmt->statements)
+                visit(statement);
+            break;
+        }
+        case Kind::LOOP: {
+            auto *loop = static_cast<like_t<N, Loop> *>(node);
+            visit(loop->condition);
+            visit(loop->body);
+            for (auto &statement : loop->update)
+                visit(statement);
+            break;
+        }
+        case Kind::SYNCHRONIZED: {
+            auto *sync = static_cast<like_t<N, Synchronized> *>(node);
+            visit(sync->lock);
+            visit(sync->body);
+            break;
+        }
+        }
+    }
+
+    /**
+     * Method of the compiled class. Methods without a body (native and abstract ones) have a null body.
+     */
+    struct Method
+    {
+        Name name;
+        MethodTypeObs type;
+        jasm::u2 access_flags;
+        std::vector<Local *> parameters;
+        // receiver of an instance method, null if the body does not refer to it
+        Local *receiver;
+        Block *body;
+        jasm::u2 locals_limit;
+
+        Method(Name name, MethodTypeObs type)
+          : name(std::move(name))
+          , type(type)
+          , access_flags(0)
+          , parameters()
+          , receiver(nullptr)
+          , body(nullptr)
+          , locals_limit(0)
+        {}
+    };
+
+    /**
+     * Field of the compiled class. Constant fields are inlined into the code referencing them.
+     */
+    struct Field
+    {
+        Name name;
+        TypeObs type;
+        jasm::u2 access_flags;
+        const Constant *constant_value;
+
+        Field(Name name, TypeObs type, jasm::u2 access_flags, const Constant *constant_value)
+          : name(std::move(name))
+          , type(type)
+          , access_flags(access_flags)
+          , constant_value(constant_value)
+        {}
+    };
+
+    /**
+     * Methods of the compiled class in the declaration order. The static initializer blocks and the field
+     * initializers are merged into a single method. The initializers of the instance fields are executed by every
+     * constructor after the constructor of the superclass.
+     */
+    struct Class
+    {
+        Name name;
+        Name super_name;
+        std::unordered_map<Name, Field *> fields;
+        std::vector<Method *> methods;
+        Method *static_initializer;
+        StatementArray field_initializers;
+        // receiver shared by all the instance methods, it is always in the slot 0
+        Local *receiver;
+
+        Class(Name name, Name super_name, Local *receiver)
+          : name(std::move(name))
+          , super_name(std::move(super_name))
+          , fields()
+          , methods()
+          , static_initializer(nullptr)
+          , field_initializers()
+          , receiver(receiver)
+        {}
+    };
+
+}
+
+#endif // JAWA_IR_HPP
@@ -0,0 +1,132 @@
+/**
+ * @file log.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#ifndef JAWA_LOG_HPP
+#define JAWA_LOG_HPP
+
+#include <iostream>
+#include <sstream>
+
+#define JAWA_LOG_OFF 0
+#define JAWA_LOG_INFO 1
+#define JAWA_LOG_DEBUG 2
+#define JAWA_LOG_TRACE 3
+
+/**
+ * Maximal level of the compiled-in log messages. Messages above the level are removed by the preprocessor
+ * including the evaluation of their arguments.
+ */
+#ifndef JAWA_LOG_LEVEL
+#define JAWA_LOG_LEVEL JAWA_LOG_OFF
+#endif
+
+#if JAWA_LOG_LEVEL >= JAWA_LOG_INFO
+#define LOG_INFO(...) jawa::log::trace_sink().write("info", __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void) 0)
+#endif
+
+#if JAWA_LOG_LEVEL >= JAWA_LOG_DEBUG
+#define LOG_DEBUG(...) jawa::log::trace_sink().write("debug", __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void) 0)
+#endif
+
+#if JAWA_LOG_LEVEL >= JAWA_LOG_TRACE
+#define LOG_TRACE(...) jawa::log::trace_sink().write("trace", __VA_ARGS__)
+#else
+#define LOG_TRACE(...) ((void) 0)
+#endif
+
+namespace jawa::log {
+
+    /**
+     * Collects records in memory and writes them to the underlying stream in large chunks, either when
+     * the buffer exceeds its capacity or when the sink is flushed or destroyed.
+     */
+    class BufferedSink
+    {
+    private:
+        std::ostream &os_;
+        std::ostringstream buffer_;
+        std::streamoff capacity_;
+
+    public:
+        explicit BufferedSink(std::ostream &os, std::streamoff capacity = 64 * 1024)
+          : os_(os)
+          , buffer_()
+          , capacity_(capacity)
+        {}
+
+        BufferedSink(const BufferedSink &) = delete;
+
+        BufferedSink &
+        operator=(const BufferedSink &) = delete;
+
+        ~BufferedSink()
+        {
+            flush();
+        }
+
+        /**
+         * Returns the stream a record is written to. The record has to be finished by calling end_record().
+         *
+         * @return buffer stream.
+         */
+        inline std::ostream &
+        stream()
+        {
+            return buffer_;
+        }
+
+        /**
+         * Finishes a record and flushes the buffer if it is full.
+         */
+        inline void
+        end_record()
+        {
+            if (buffer_.tellp() >= capacity_)
+                flush();
+        }
+
+        /**
+         * Writes a single line record.
+         *
+         * @param level record level.
+         * @param args record contents.
+         */
+        template<typename... Args>
+        void
+        write(const char *level, const Args &...args)
+        {
+            buffer_ << level << ": ";
+            (buffer_ << ... << args);
+            buffer_ << '\n';
+            end_record();
+        }
+
+        /**
+         * Writes the buffered records to the underlying stream.
+         */
+        void
+        flush();
+    };
+
+    /**
+     * Returns the sink of the debug traces. The traces are written to the standard error output.
+     *
+     * @return trace sink.
+     */
+    BufferedSink &
+    trace_sink();
+
+}
+
+#endif // JAWA_LOG_HPP
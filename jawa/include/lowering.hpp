@@ -0,0 +1,266 @@
+/**
+ * @file lowering.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#ifndef JAWA_LOWERING_HPP
+#define JAWA_LOWERING_HPP
+
+#include <map>
+#include <optional>
+
+#include "builder.hpp"
+#include "ir.hpp"
+#include "tables.hpp"
+
+namespace jawa {
+
+    /**
+     * Translates the IR of methods to byte code. The types of the operand stack entries and of the local
+     * variables are tracked while the instructions are emitted, so the stack limit of a method is exact and
+     * the stack map frames of the jump targets are derived from them.
+     */
+    class Lowering
+    {
+    private:
+        /**
+         * Operand stack entry, an object which is not initialised yet is identified by the label of its new
+         * instruction.
+         */
+        struct StackEntry
+        {
+            TypeObs type;
+            std::optional<jasm::Label> new_label;
+
+            inline bool
+            operator==(const StackEntry &other) const
+            {
+                return type == other.type && new_label == other.new_label;
+            }
+        };
+
+        /**
+         * Types of the local variable slots and of the operand stack entries. A null local variable type stands
+         * for a slot that cannot be used, that includes the second slot of long and double variables.
+         */
+        struct Frame
+        {
+            TypeObsArray locals;
+            std::vector<StackEntry> stack;
+        };
+
+        /**
+         * Jump target, its frame is the meet of the frames at all the jumps to the target. The frame of a target
+         * reached by backward jumps is fixed when the target is placed.
+         */
+        struct Target
+        {
+            jasm::Label label;
+            std::optional<Frame> frame;
+            bool placed = false;
+            // number of the monitors held at the target, the jumps release the monitors entered since
+            std::size_t monitors = 0;
+        };
+
+        jasm::ClassBuilder &builder_;
+        TypeTable &type_table_;
+        jasm::u2 class_version_;
+        jasm::u2 depth_;
+        jasm::u2 max_depth_;
+        TypeObsArray locals_;
+        std::vector<StackEntry> stack_;
+        bool reachable_;
+        std::vector<Target *> break_targets_;
+        std::vector<Target *> continue_targets_;
+        // lock variables of the enclosing synchronized statements, the innermost last
+        std::vector<const ir::Local *> monitors_;
+        std::optional<jasm::u2> string_concat_factory_;
+        jasm::u2 locals_limit_;
+        std::map<std::pair<Name, MethodTypeObs>, const ir::Method *> inline_candidates_;
+        jasm::u2 inline_base_;
+        jasm::u2 local_base_;
+        Target *inline_exit_;
+        TypeObs inline_return_type_;
+
+        /**
+         * Returns the slot of a local variable, the locals of an inlined method follow the ones of the caller.
+         */
+        inline jasm::u2
+        slot(const ir::Local *local) const
+        {
+            return local_base_ + local->index;
+        }
+
+        void
+        push(TypeObs type, std::optional<jasm::Label> new_label = std::nullopt);
+
+        void
+        pop(std::size_t entries = 1);
+
+        Target
+        create_target();
+
+        void
+        jump(Target &target);
+
+        void
+        go_to(Target &target);
+
+        void
+        branch(Target &target);
+
+        void
+        place(Target &target);
+
+        void
+        frame_types(std::vector<jasm::StackMapTableAttribute::VerificationType> &locals,
+                    std::vector<jasm::StackMapTableAttribute::VerificationType> &stack);
+
+        jasm::StackMapTableAttribute::VerificationType
+        verification_type(TypeObs type);
+
+        void
+        load_constant(jasm::u2 index, TypeObs type);
+
+        void
+        lower_constant(const ir::Constant *constant);
+
+        void
+        load_local(const ir::Local *local);
+
+        void
+        store_local(const ir::Local *local);
+
+        bool
+        lower_increment(const ir::LocalStore *store, bool discard);
+
+        void
+        lower_conversion(TypeObs from, TypeObs to);
+
+        void
+        lower_unary(const ir::Unary *unary);
+
+        void
+        lower_binary(const ir::Binary *binary);
+
+        void
+        lower_comparison(const ir::Binary *comparison, Target &target, bool jump_if);
+
+        void
+        lower_condition(const ir::Expression *condition, Target &target, bool jump_if);
+
+        void
+        lower_boolean(const ir::Expression *condition);
+
+        jasm::u2
+        string_concat_factory();
+
+        void
+        lower_concatenation(const ir::Binary *binary);
+
+        void
+        lower_dynamic_concatenation(const std::vector<const ir::Expression *> &operands);
+
+        void
+        append_operand(const ir::Expression *operand);
+
+        void
+        lower_arguments(const ir::ExpressionArray &arguments);
+
+        void
+        lower_expression(const ir::Expression *expr, bool discard);
+
+        const ir::Method *
+        inline_candidate(const ir::Invoke *invoke) const;
+
+        void
+        lower_inline(const ir::Invoke *invoke, const ir::Method &callee);
+
+        void
+        lower_inline_return(const ir::Expression *value);
+
+        void
+        lower_switch_instruction(std::vector<std::pair<int32_t, Target *>> cases, Target &default_target);
+
+        void
+        lower_string_dispatch(const ir::Switch *stmt, const std::vector<Target *> &case_targets,
+                              Target &default_target);
+
+        void
+        lower_switch(const ir::Switch *stmt);
+
+        Frame
+        loop_frame(const ir::Statement *stmt) const;
+
+        void
+        lower_loop(const ir::Loop *loop);
+
+        void
+        release_monitors(std::size_t held);
+
+        void
+        lower_synchronized(const ir::Synchronized *stmt);
+
+        void
+        lower_statement(const ir::Statement *stmt);
+
+    public:
+        /**
+         * @param class_version major version of the class file, it determines the instructions available.
+         */
+        Lowering(jasm::ClassBuilder &builder, TypeTable &type_table, jasm::u2 class_version)
+          : builder_(builder)
+          , type_table_(type_table)
+          , class_version_(class_version)
+          , depth_(0)
+          , max_depth_(0)
+          , locals_()
+          , stack_()
+          , reachable_(true)
+          , break_targets_()
+          , continue_targets_()
+          , string_concat_factory_()
+          , locals_limit_(0)
+          , inline_candidates_()
+          , inline_base_(0)
+          , local_base_(0)
+          , inline_exit_(nullptr)
+          , inline_return_type_(nullptr)
+        {}
+
+        /**
+         * Enables inlining of the calls of small methods of a class whose calls are bound at compile time, that is
+         * static, private and final methods. The inlined methods are still emitted on their own.
+         *
+         * @param ir_class IR of the class of the lowered methods.
+         */
+        void
+        enable_inlining(const ir::Class &ir_class);
+
+        /**
+         * Emits a method to the class builder.
+         *
+         * @param method IR of the method.
+         */
+        void
+        lower_method(const ir::Method &method);
+    };
+
+    /**
+     * Adds a constant to the constant pool of a class.
+     *
+     * @param builder class builder.
+     * @param constant constant of a primitive type or a string.
+     * @return index of the constant in the constant pool.
+     */
+    jasm::u2
+    add_constant(jasm::ClassBuilder &builder, const ir::Constant &constant);
+
+}
+
+#endif // JAWA_LOWERING_HPP
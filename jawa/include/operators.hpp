@@ -11,6 +11,8 @@
 #ifndef JAWA_OPERATORS_HPP
 #define JAWA_OPERATORS_HPP
 
+#include <cassert>
+
 namespace jawa::operators {
 
     enum addop
@@ -59,6 +61,117 @@ namespace jawa::operators {
         NE
     };
 
+    /**
+     * Binary operator of an expression in the IR.
+     */
+    enum class binop
+    {
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+        MOD,
+        SHL,
+        SHR,
+        USHR,
+        AND,
+        OR,
+        XOR,
+        LT,
+        GT,
+        LTE,
+        GTE,
+        EQ,
+        NE,
+        LAND,
+        LOR
+    };
+
+    /**
+     * Unary operator of an expression in the IR.
+     */
+    enum class unop
+    {
+        PLUS,
+        MINUS,
+        NOT,
+        LNOT
+    };
+
+    inline binop
+    to_binop(addop op)
+    {
+        return op == ADD ? binop::ADD : binop::SUB;
+    }
+
+    inline binop
+    to_binop(divop op)
+    {
+        return op == DIV ? binop::DIV : binop::MOD;
+    }
+
+    inline binop
+    to_binop(relop op)
+    {
+        return op == LTE ? binop::LTE : binop::GTE;
+    }
+
+    inline binop
+    to_binop(eqop op)
+    {
+        return op == EQ ? binop::EQ : binop::NE;
+    }
+
+    /**
+     * Returns the operator applied by a compound assignment. The ~= operator has no binary counterpart.
+     */
+    inline binop
+    to_binop(comp op)
+    {
+        switch (op) {
+        case COMP_ADD:
+            return binop::ADD;
+        case COMP_SUB:
+            return binop::SUB;
+        case COMP_MUL:
+            return binop::MUL;
+        case COMP_DIV:
+            return binop::DIV;
+        case COMP_MOD:
+            return binop::MOD;
+        case COMP_SHL:
+            return binop::SHL;
+        case COMP_SHR:
+            return binop::SHR;
+        case COMP_SHR_U:
+            return binop::USHR;
+        case COMP_AND:
+            return binop::AND;
+        case COMP_OR:
+            return binop::OR;
+        case COMP_XOR:
+            return binop::XOR;
+        default:
+            assert(false);
+            return binop::ADD;
+        }
+    }
+
+    inline unop
+    to_unop(addop op)
+    {
+        return op == ADD ? unop::PLUS : unop::MINUS;
+    }
+
+    /**
+     * Returns the source form of an operator, used in error messages.
+     */
+    const char *
+    symbol(binop op);
+
+    const char *
+    symbol(unop op);
+
 }
 
 #endif // JAWA_OPERATORS_HPP
@@ -12,19 +12,24 @@
 #define JAWA_PARSER_SEM_CPP_HPP
 
 #include "context.hpp"
+#include "ir.hpp"
 #include "modifiers.hpp"
+#include "operators.hpp"
 
 namespace jawa {
 
     struct Expression
     {
         TypeObs type;
+        ir::Expression *node;
 
         Expression()
-          : type(nullptr){};
+          : type(nullptr)
+          , node(nullptr){};
 
-        explicit Expression(TypeObs type)
-          : type(type){};
+        explicit Expression(ir::Expression *node)
+          : type(node->type)
+          , node(node){};
     };
 
     struct ClassAndName
@@ -32,6 +37,7 @@ namespace jawa {
         Name class_name;
         Name name;
         bool is_static = false;
+        ir::Expression *receiver = nullptr;
     };
 
     struct FormalParam
@@ -49,8 +55,23 @@ namespace jawa {
     using ExpressionArray = std::vector<Expression>;
     using FormalParamArray = std::vector<FormalParam>;
 
+    struct VariableDeclarator
+    {
+        Name name;
+        ExpressionOpt initializer;
+    };
+
+    using VariableDeclaratorArray = std::vector<VariableDeclarator>;
+
+    /**
+     * Enters a class declaration.
+     *
+     * @param class_name name of the class.
+     * @param super_type type after przedłuża, nullptr if the class extends java.lang.Object.
+     * @param interface_types types after realizuje.
+     */
     void
-    enter_class(context_t ctx, const Name &class_name);
+    enter_class(context_t ctx, const Name &class_name, TypeObs super_type, const TypeObsArray &interface_types);
 
     void
     leave_class(context_t ctx);
@@ -58,30 +79,89 @@ namespace jawa {
     void
     enter_method(context_t ctx, const Name &method_name, TypeObs return_type, FormalParamArray &formal_params);
 
+    /**
+     * Enters a constructor, the name has to be the name of the class.
+     */
+    void
+    enter_constructor(context_t ctx, const Name &name, FormalParamArray &formal_params);
+
     void
     enter_static_initializer(context_t ctx);
 
     void
-    leave_method(context_t ctx, const ModifierAndAnnotationPack &pack);
+    leave_method(context_t ctx, const ModifierAndAnnotationPack &pack, ir::Block *body);
 
     void
     declare_method(context_t ctx, const ModifierAndAnnotationPack &pack);
 
     void
-    declare_field(context_t ctx, const ModifierAndAnnotationPack &pack, TypeObs type, const Name &name);
+    declare_field(context_t ctx, const ModifierAndAnnotationPack &pack, TypeObs type, const Name &name,
+                  const ExpressionOpt &initializer);
 
     TypeObs
     find_class(context_t ctx, const Name &name);
 
-    void
+    ir::Method *
     generate_default_constructor(context_t ctx);
 
     Expression
     load_string_literal(context_t ctx, const Name &name);
 
+    Expression
+    load_literal(context_t ctx, int_t value);
+
+    Expression
+    load_literal(context_t ctx, long_t value);
+
+    Expression
+    load_literal(context_t ctx, float_t value);
+
+    Expression
+    load_literal(context_t ctx, double_t value);
+
+    Expression
+    load_literal(context_t ctx, char_t value);
+
+    Expression
+    load_literal(context_t ctx, bool_t value);
+
+    /**
+     * Loads the negation of the decimal literal 2147483648 or 9223372036854775808L, which is in range only as
+     * the operand of the unary minus.
+     *
+     * @param op unary operator applied to the literal, the plus is reported.
+     * @param literal text of the literal.
+     * @param value minimum of the type of the literal.
+     */
+    Expression
+    load_negated_literal(context_t ctx, operators::addop op, const Name &literal, int_t value);
+
+    Expression
+    load_negated_literal(context_t ctx, operators::addop op, const Name &literal, long_t value);
+
     Expression
     load_name(context_t ctx, const Name &name);
 
+    Expression
+    load_this(context_t ctx);
+
+    /**
+     * Loads a field of an object or the length of an array.
+     */
+    Expression
+    load_field(context_t ctx, const Expression &object, const Name &field_name);
+
+    Expression
+    load_array_element(context_t ctx, const Expression &array, const Expression &index);
+
+    /**
+     * Creates a one-dimensional array.
+     *
+     * @param element_type type of the elements, it may be an array type.
+     */
+    Expression
+    create_array(context_t ctx, TypeObs element_type, const Expression &length);
+
     ClassAndName
     resolve_method_class(context_t ctx, const Name &method);
 
@@ -95,10 +175,131 @@ namespace jawa {
     resolve_name_expression(context_t ctx, const Name &name);
 
     Expression
-    instantiate_object(context_t ctx, const Name &class_name);
+    instantiate_object(context_t ctx, const Name &class_name, const ExpressionArray &arguments);
+
+    /**
+     * Assigns a value to a variable.
+     *
+     * @param variable load of a local variable, a field or an array element.
+     * @param op operator of a compound assignment, std::nullopt for a simple assignment.
+     */
+    Expression
+    assign(context_t ctx, const Expression &variable, std::optional<operators::comp> op, const Expression &expr);
+
+    Expression
+    assign(context_t ctx, const Name &name, std::optional<operators::comp> op, const Expression &expr);
+
+    /**
+     * Increments or decrements a variable by one.
+     *
+     * @param variable load of a local variable, a field or an array element.
+     * @param postfix whether the value of the expression is the value before the update.
+     */
+    Expression
+    increment(context_t ctx, operators::incdec op, const Expression &variable, bool postfix);
+
+    Expression
+    increment(context_t ctx, operators::incdec op, const Name &name, bool postfix);
+
+    Expression
+    unary_operation(context_t ctx, operators::unop op, const Expression &operand);
+
+    Expression
+    binary_operation(context_t ctx, operators::binop op, const Expression &lhs, const Expression &rhs);
 
     Expression
-    assign(context_t ctx, const Name &name, const Expression &expr);
+    cast_expression(context_t ctx, TypeObs type, const Expression &operand);
+
+    ir::Statement *
+    expression_statement(context_t ctx, const Expression &expr);
+
+    ir::Statement *
+    return_statement(context_t ctx, const ExpressionOpt &expr);
+
+    /**
+     * @param else_statement else branch, nullptr if there is none.
+     */
+    ir::Statement *
+    if_statement(context_t ctx, const Expression &condition, ir::Statement *then_statement,
+                 ir::Statement *else_statement);
+
+    void
+    enter_block(context_t ctx);
+
+    ir::Block *
+    make_block(context_t ctx, ir::StatementArray &statements);
+
+    /**
+     * Declares local variables in the current block.
+     *
+     * @return assignments of the initial values, nullptr if there are none.
+     */
+    ir::Statement *
+    declare_local_variables(context_t ctx, TypeObs type, const VariableDeclaratorArray &declarators);
+
+    /**
+     * Enters a switch statement, the switch block is a new scope.
+     *
+     * @param selector expression of an integral type narrower than long, or a string.
+     */
+    void
+    enter_switch(context_t ctx, const Expression &selector);
+
+    /**
+     * Labels the next statement of the innermost switch block with a constant.
+     */
+    void
+    switch_label(context_t ctx, const Expression &value);
+
+    void
+    switch_default(context_t ctx);
+
+    void
+    switch_statements(context_t ctx, ir::StatementArray &statements);
+
+    ir::Statement *
+    leave_switch(context_t ctx);
+
+    /**
+     * Enters a while, do or for loop, the loop is a new scope.
+     *
+     * @param test_first false for a do loop.
+     */
+    void
+    enter_loop(context_t ctx, bool test_first);
+
+    /**
+     * Sets the condition of the innermost loop.
+     */
+    void
+    loop_condition(context_t ctx, const Expression &condition);
+
+    /**
+     * Sets the condition and the update of the innermost loop, which is a for loop.
+     *
+     * @param condition condition, the loop is endless if there is none.
+     * @param update update expression statements.
+     */
+    void
+    for_loop_head(context_t ctx, const ExpressionOpt &condition, ir::StatementArray &update);
+
+    /**
+     * @param init initialisation of a for loop, nullptr if there is none.
+     */
+    ir::Statement *
+    leave_loop(context_t ctx, ir::Statement *body, ir::Statement *init);
+
+    ir::Statement *
+    break_statement(context_t ctx);
+
+    ir::Statement *
+    continue_statement(context_t ctx);
+
+    /**
+     * @param lock object whose monitor is held while the body runs.
+     */
+    ir::Statement *
+    synchronized_statement(context_t ctx, const Expression &lock, ir::Block *body);
 
     void
     set_package_name(context_t ctx, const Name &name);
@@ -0,0 +1,32 @@
+/**
+ * @file slots.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#ifndef JAWA_SLOTS_HPP
+#define JAWA_SLOTS_HPP
+
+#include "ir.hpp"
+
+namespace jawa {
+
+    /**
+     * Assigns the local variable slots of a method. A variable is live from its first to its last occurrence in the
+     * order of the emitted code, or over a whole loop if it is live across its back edge. Variables whose live ranges
+     * do not overlap share a slot. The most used variables are allocated first, so they get the lowest slots which
+     * have the one byte load and store instructions.
+     * The parameters keep the slots given by the calling convention.
+     *
+     * @param method IR of the method, the indices of its locals and its locals limit are updated.
+     */
+    void
+    allocate_slots(ir::Method &method);
+
+}
+
+#endif // JAWA_SLOTS_HPP
@@ -0,0 +1,185 @@
+/**
+ * @file statistics.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#ifndef JAWA_STATISTICS_HPP
+#define JAWA_STATISTICS_HPP
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "types.hpp"
+
+namespace jawa {
+
+    /**
+     * Compiler phases in the order in which they are run.
+     */
+    enum class Phase : unsigned
+    {
+        LEXING,
+        PARSING,
+        LOADING,
+        GENERATION,
+        EMISSION,
+    };
+
+    constexpr std::size_t PhaseCount = 5;
+
+    /**
+     * Returns the name of a phase as used on the command line.
+     *
+     * @param phase compiler phase.
+     * @return phase name.
+     */
+    const char *
+    phase_name(Phase phase);
+
+    /**
+     * Collects wall time, call counts and processed bytes of the compiler phases.
+     *
+     * Phases nest (e.g. class loading is triggered from code generation), the time is always attributed
+     * to the innermost running phase only, so the phase times add up to the total time.
+     */
+    class Statistics
+    {
+    private:
+        using clock = std::chrono::steady_clock;
+
+        struct phase_stats_t
+        {
+            clock::duration time{};
+            std::size_t calls = 0;
+            std::size_t bytes = 0;
+        };
+
+        struct class_load_t
+        {
+            Name class_name;
+            Name source_file;
+            unsigned line;
+            clock::duration time;
+            std::size_t bytes;
+        };
+
+        bool enabled_;
+        clock::time_point start_;
+        clock::time_point last_switch_;
+        std::array<phase_stats_t, PhaseCount> phases_;
+        std::vector<Phase> running_;
+        std::vector<class_load_t> class_loads_;
+        Name source_file_;
+        const unsigned *line_;
+
+        void
+        switch_phase();
+
+    public:
+        /**
+         * Measures a phase for the lifetime of the object.
+         */
+        class ScopedPhase
+        {
+        private:
+            Statistics *statistics_;
+
+        public:
+            ScopedPhase(Statistics *statistics, Phase phase)
+              : statistics_(statistics)
+            {
+                if (statistics_)
+                    statistics_->enter(phase);
+            }
+
+            ScopedPhase(const ScopedPhase &) = delete;
+
+            ScopedPhase &
+            operator=(const ScopedPhase &) = delete;
+
+            ~ScopedPhase()
+            {
+                if (statistics_)
+                    statistics_->leave();
+            }
+        };
+
+        Statistics()
+          : enabled_(false)
+          , line_(nullptr)
+        {}
+
+        inline bool
+        enabled() const
+        {
+            return enabled_;
+        }
+
+        /**
+         * Enables collection of the statistics and starts the total time measurement.
+         */
+        void
+        enable();
+
+        /**
+         * Sets the source of the current location, which is used to attribute class loads.
+         *
+         * @param source_file currently compiled source file.
+         * @param line pointer to the current line number.
+         */
+        void
+        set_location(const Name &source_file, const unsigned *line);
+
+        void
+        enter(Phase phase);
+
+        void
+        leave();
+
+        /**
+         * Starts measuring a phase. The measurement ends when the returned object is destroyed.
+         *
+         * @param phase measured phase.
+         * @return scoped measurement.
+         */
+        inline ScopedPhase
+        measure(Phase phase)
+        {
+            return ScopedPhase(enabled_ ? this : nullptr, phase);
+        }
+
+        inline void
+        add_bytes(Phase phase, std::size_t bytes)
+        {
+            phases_[static_cast<std::size_t>(phase)].bytes += bytes;
+        }
+
+        /**
+         * Records a class loaded from the class path. The class is attributed to the current location.
+         *
+         * @param class_name name of the loaded class.
+         * @param time time spent loading the class.
+         * @param bytes class file size.
+         */
+        void
+        add_class_load(const Name &class_name, clock::duration time, std::size_t bytes);
+
+        /**
+         * Writes the report.
+         *
+         * @param os output stream.
+         */
+        void
+        report(std::ostream &os) const;
+    };
+
+}
+
+#endif // JAWA_STATISTICS_HPP
@@ -12,12 +12,21 @@
 #define JAWA_TABLES_HPP
 
 #include <class.hpp>
+#include <optional>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "statistics.hpp"
 #include "type.hpp"
 #include "types.hpp"
 
+namespace jawa::ir {
+
+    struct Local;
+
+}
+
 namespace jawa {
 
     using TypeObs = const jasm::Type *;
@@ -35,6 +44,78 @@ namespace jawa {
     using ClassTypeObs = const jasm::ClassType *;
     using ArrayTypeObs = const jasm::ArrayType *;
 
+    inline bool
+    is_boolean_type(TypeObs type)
+    {
+        return type != nullptr && type->prefix() == jasm::byte_code::BooleanTypePrefix;
+    }
+
+    /**
+     * Determines whether a type is byte, short, char, int or long.
+     */
+    inline bool
+    is_integral_type(TypeObs type)
+    {
+        if (type == nullptr)
+            return false;
+        switch (type->prefix()) {
+        case jasm::byte_code::ByteTypePrefix:
+        case jasm::byte_code::ShortTypePrefix:
+        case jasm::byte_code::CharTypePrefix:
+        case jasm::byte_code::IntTypePrefix:
+        case jasm::byte_code::LongTypePrefix:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * Determines whether a type is an integral or a floating point type.
+     */
+    inline bool
+    is_numeric_type(TypeObs type)
+    {
+        return is_integral_type(type) || (type != nullptr && (type->prefix() == jasm::byte_code::FloatTypePrefix ||
+                                                               type->prefix() == jasm::byte_code::DoubleTypePrefix));
+    }
+
+    inline bool
+    is_reference_type(TypeObs type)
+    {
+        return type != nullptr && (type->prefix() == jasm::byte_code::ClassTypePrefix ||
+                                   type->prefix() == jasm::byte_code::ArrayTypePrefix);
+    }
+
+    /**
+     * Returns the number of operand stack slots (and local variable slots) occupied by a value of a given type.
+     *
+     * @param type type of the value.
+     * @return 0 for void, 2 for long and double, otherwise 1.
+     */
+    inline jasm::u2
+    slot_count(TypeObs type)
+    {
+        if (type == nullptr)
+            return 0;
+        switch (type->prefix()) {
+        case jasm::byte_code::VoidTypePrefix:
+            return 0;
+        case jasm::byte_code::LongTypePrefix:
+        case jasm::byte_code::DoubleTypePrefix:
+            return 2;
+        default:
+            return 1;
+        }
+    }
+
+    inline bool
+    is_string_type(TypeObs type)
+    {
+        auto class_type = dynamic_cast<const jasm::ClassType *>(type);
+        return class_type != nullptr && class_type->class_name() == "java/lang/String";
+    }
+
     class TypeTable
     {
     private:
@@ -215,13 +296,28 @@ namespace jawa {
 
     class JawaField : public JawaClassMember
     {
+    private:
+        std::optional<ConstantValue> constant_value_;
+
     public:
-        JawaField(Name name, TypeObs type, jasm::u2 access_flags)
+        JawaField(Name name, TypeObs type, jasm::u2 access_flags, std::optional<ConstantValue> constant_value = {})
           : JawaClassMember(std::move(name), type, access_flags)
+          , constant_value_(std::move(constant_value))
         {
             assert(type != nullptr);
         }
 
+        /**
+         * Returns the value of a constant field (ConstantValue attribute).
+         *
+         * @return constant value, nullptr if the field is not a constant.
+         */
+        inline const ConstantValue *
+        constant_value() const
+        {
+            return constant_value_ ? &*constant_value_ : nullptr;
+        }
+
         std::size_t
         hash() const;
 
@@ -240,8 +336,28 @@ namespace jawa {
         {}
     };
 
+    /**
+     * Direct supertypes of a class.
+     */
+    struct JawaSupertypes
+    {
+        // empty for java/lang/Object
+        Name super_class;
+        std::vector<Name> interfaces;
+    };
+
     class JawaClass
     {
+    public:
+        /**
+         * Determines when the members of a loaded class are materialised.
+         */
+        enum LoadMode
+        {
+            EAGER, // every field and method is resolved when the class is loaded
+            LAZY   // members are resolved on the first lookup by name
+        };
+
     private:
         struct signature_hasher_t
         {
@@ -252,16 +368,66 @@ namespace jawa {
             }
         };
 
+        /**
+         * Unresolved class member. Name and descriptor are stored in a string pool shared by all the members
+         * of the class, so the index costs only a couple of allocations per class.
+         */
+        struct raw_member_t
+        {
+            std::uint32_t name_offset;
+            std::uint32_t descriptor_offset;
+            std::uint16_t name_length;
+            std::uint16_t descriptor_length;
+            jasm::u2 access_flags;
+            bool materialised;
+        };
+
+        TypeTable *type_table_;
         Name name_;
-        std::unordered_map<JawaMethodSignature, JawaMethod, signature_hasher_t> methods_;
-        std::unordered_map<Name, JawaField> fields_;
+        JawaSupertypes supertypes_;
+        jasm::u2 access_flags_;
+        mutable std::unordered_map<JawaMethodSignature, JawaMethod, signature_hasher_t> methods_;
+        mutable std::unordered_map<Name, JawaField> fields_;
+        std::unordered_map<Name, ConstantValue> constant_values_;
+
+        std::string raw_strings_;
+        mutable std::vector<raw_member_t> raw_methods_;
+        mutable std::vector<raw_member_t> raw_fields_;
+
+        std::string_view
+        raw_name(const raw_member_t &member) const;
+
+        std::string_view
+        raw_descriptor(const raw_member_t &member) const;
+
+        /**
+         * Finds all the unresolved members with a given name.
+         *
+         * @param members raw members sorted by name.
+         * @param name member name.
+         * @return range of members with the given name.
+         */
+        std::pair<std::vector<raw_member_t>::iterator, std::vector<raw_member_t>::iterator>
+        find_raw(std::vector<raw_member_t> &members, const Name &name) const;
+
+        void
+        materialise_method(raw_member_t &member) const;
+
+        void
+        materialise_field(raw_member_t &member) const;
 
     public:
-        JawaClass(TypeTable &type_table, jasm::Class &clazz);
+        JawaClass(TypeTable &type_table, jasm::Class &clazz, LoadMode mode = EAGER);
 
         const JawaMethod *
         get_method(const JawaMethodSignature &signature) const;
 
+        /**
+         * Returns all the overloads of a method declared by the class itself.
+         */
+        std::vector<const JawaMethod *>
+        get_methods(const Name &name) const;
+
         const JawaField *
         get_field(const Name &name) const;
 
@@ -271,6 +437,24 @@ namespace jawa {
             return name_;
         }
 
+        inline const JawaSupertypes &
+        supertypes() const
+        {
+            return supertypes_;
+        }
+
+        inline jasm::u2
+        access_flags() const
+        {
+            return access_flags_;
+        }
+
+        inline bool
+        is_interface() const
+        {
+            return access_flags_ & jasm::Class::ACC_INTERFACE;
+        }
+
         std::size_t
         hash() const;
 
@@ -285,20 +469,39 @@ namespace jawa {
 
         TypeTable &type_table_;
 
+        Statistics &statistics_;
+
+        JawaClass::LoadMode load_mode_;
+
         std::unordered_map<Name, JawaClass> classes_;
 
         std::unordered_map<Name, JawaImport> imported_classes_;
 
+        // supertypes of the classes being compiled, which have no class file yet
+        std::unordered_map<Name, JawaSupertypes> declared_classes_;
+
         Name
         find_class_file(const Name &class_name) const;
 
+        const JawaSupertypes *
+        get_supertypes(const Name &class_name);
+
+        void
+        collect_methods(const Name &class_name, const Name &method_name, std::vector<const JawaMethod *> &methods,
+                        std::unordered_set<Name> &visited);
+
         void
         implicit_import();
 
     public:
-        ClassTable(TypeTable &type_table, std::string class_paths)
+        ClassTable(TypeTable &type_table,
+                   std::string class_paths,
+                   Statistics &statistics,
+                   JawaClass::LoadMode load_mode = JawaClass::LAZY)
           : class_paths_(std::move(class_paths))
           , type_table_(type_table)
+          , statistics_(statistics)
+          , load_mode_(load_mode)
         {
             implicit_import();
         }
@@ -323,6 +526,50 @@ namespace jawa {
          */
         const JawaClass *
         load_class(const Name &class_name);
+
+        /**
+         * Records the supertypes of a compiled class, so it can be converted to them before its class file exists.
+         *
+         * @param class_name fully qualified class name.
+         * @param supertypes direct supertypes.
+         */
+        void
+        declare_class(const Name &class_name, JawaSupertypes supertypes);
+
+        /**
+         * Determines whether a class is a given class or one of its subclasses or subinterfaces.
+         */
+        bool
+        is_subclass(const Name &class_name, const Name &super_name);
+
+        /**
+         * Determines whether a value of a given type can be passed as an argument of a given type. Primitive types
+         * have to be the same, a reference can be converted to its supertypes.
+         */
+        bool
+        is_assignable(TypeObs from, TypeObs to);
+
+        /**
+         * Chooses an overload of a method for given arguments. The overload with the exact argument types is
+         * preferred, otherwise the most specific of the applicable ones is chosen as in Java.
+         *
+         * @param candidates types of the overloads.
+         * @param argument_types types of the arguments.
+         * @return index of the chosen overload, empty if none is applicable or the call is ambiguous.
+         */
+        std::optional<std::size_t>
+        select_overload(const std::vector<MethodTypeObs> &candidates, const TypeObsArray &argument_types);
+
+        /**
+         * Finds the method called with given arguments, the methods inherited from the superclasses and
+         * superinterfaces are included except for the constructors.
+         *
+         * @param class_name name of the class of the receiver.
+         * @param signature method name and argument types.
+         * @return method, nullptr if none is applicable.
+         */
+        const JawaMethod *
+        find_method(const Name &class_name, const JawaMethodSignature &signature);
     };
 
     struct Variable
@@ -334,12 +581,14 @@ namespace jawa {
     struct LocalVariable : public Variable
     {
         jasm::u2 index;
+        ir::Local *local;
     };
 
     class VariableScope
     {
     private:
         std::unordered_map<Name, LocalVariable> local_variables_;
+        jasm::u2 slots_ = 0;
 
         friend class VariableScopeTable;
 
@@ -348,7 +597,7 @@ namespace jawa {
         get_var(const Name &name) const;
 
         void
-        add_var(const Name &name, TypeObs type, jasm::u2 index);
+        add_var(const Name &name, TypeObs type, jasm::u2 index, ir::Local *local);
     };
 
     class VariableScopeTable
@@ -357,11 +606,13 @@ namespace jawa {
         std::vector<VariableScope> scopes_;
 
         jasm::u2 count_;
+        jasm::u2 limit_;
 
     public:
         VariableScopeTable()
           : scopes_()
-          , count_(0){};
+          , count_(0)
+          , limit_(0){};
 
         void
         enter_scope();
@@ -372,8 +623,32 @@ namespace jawa {
         const LocalVariable *
         get_var(const Name &name) const;
 
-        void
-        add_var(const Name &name, TypeObs type);
+        /**
+         * Declares a variable in the innermost scope. Variables of type long and double take up two slots.
+         *
+         * @param name name of the variable.
+         * @param type type of the variable.
+         * @param local IR node of the variable.
+         * @return index of the variable.
+         */
+        jasm::u2
+        add_var(const Name &name, TypeObs type, ir::Local *local);
+
+        /**
+         * Returns the number of local variable slots needed by the variables declared since the last reset,
+         * the slots of variables in disjoint scopes are shared.
+         */
+        inline jasm::u2
+        limit() const
+        {
+            return limit_;
+        }
+
+        inline void
+        reset_limit()
+        {
+            limit_ = count_;
+        }
     };
 
 }
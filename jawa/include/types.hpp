@@ -12,6 +12,8 @@
 #define JAWA_TYPES_HPP
 
 #include <cinttypes>
+#include <string>
+#include <variant>
 #include <vector>
 
 namespace jawa {
@@ -28,6 +30,11 @@ namespace jawa {
     using Name = std::string;
     using NameList = std::vector<Name>;
 
+    /**
+     * Value of a compile-time constant. Booleans, bytes, shorts and chars are represented as integers.
+     */
+    using ConstantValue = std::variant<int_t, long_t, float_t, double_t, Name>;
+
 }
 
 #endif // JAWA_TYPES_HPP
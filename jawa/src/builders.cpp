@@ -0,0 +1,232 @@
+/**
+ * @file builders.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <algorithm>
+#include <map>
+
+#include "builders.hpp"
+
+namespace jawa {
+
+    static const Name string_builder = "java/lang/StringBuilder";
+
+    /**
+     * Collects the operands appended to a variable by the value of the statement s = s + a + b + ...
+     *
+     * @return true if the value has this form.
+     */
+    static bool
+    appended_operands(ir::Expression *value, const ir::Local *local, ir::ExpressionArray &operands)
+    {
+        auto binary = ir::node_cast<ir::Binary>(value);
+        if (binary == nullptr || binary->op != operators::binop::ADD || !is_string_type(binary->type))
+            return false;
+        auto load = ir::node_cast<ir::LocalLoad>(binary->lhs);
+        if ((load == nullptr || load->local != local) && !appended_operands(binary->lhs, local, operands))
+            return false;
+        operands.push_back(binary->rhs);
+        return true;
+    }
+
+    /**
+     * Returns the store of a string variable if the statement only appends to it, otherwise nullptr.
+     */
+    static ir::LocalStore *
+    append_statement(ir::Statement *stmt, ir::ExpressionArray &operands)
+    {
+        auto expr_stmt = ir::node_cast<ir::ExpressionStatement>(stmt);
+        if (expr_stmt == nullptr)
+            return nullptr;
+        auto store = ir::node_cast<ir::LocalStore>(expr_stmt->expression);
+        if (store == nullptr || !is_string_type(store->local->type) ||
+            !appended_operands(store->value, store->local, operands))
+            return nullptr;
+        return store;
+    }
+
+    /**
+     * Number of the statements of a loop appending to a variable, a variable which occurs in the loop in any other
+     * way cannot use a builder.
+     */
+    struct Appends
+    {
+        // the variables are ordered by their first occurrence, so the emitted code does not depend on addresses
+        std::size_t order;
+        std::size_t statements = 0;
+        bool other_uses = false;
+    };
+
+    using AppendMap = std::map<ir::Local *, Appends>;
+
+    static Appends &
+    appends_of(AppendMap &appends, ir::Local *local)
+    {
+        return appends.try_emplace(local, Appends{ appends.size() }).first->second;
+    }
+
+    static void
+    count_appends(AppendMap &appends, ir::Node *node)
+    {
+        if (node->kind == ir::Kind::EXPRESSION_STATEMENT) {
+            ir::ExpressionArray operands;
+            if (auto store = append_statement(static_cast<ir::Statement *>(node), operands)) {
+                ++appends_of(appends, store->local).statements;
+                for (auto *operand : operands)
+                    count_appends(appends, operand);
+                return;
+            }
+        }
+        switch (node->kind) {
+        case ir::Kind::LOCAL_LOAD:
+            appends_of(appends, static_cast<ir::LocalLoad *>(node)->local).other_uses = true;
+            break;
+        case ir::Kind::LOCAL_STORE:
+            appends_of(appends, static_cast<ir::LocalStore *>(node)->local).other_uses = true;
+            break;
+        default:
+            break;
+        }
+        ir::for_each_child(node, [&appends](auto *child) { count_appends(appends, child); });
+    }
+
+    /**
+     * Returns the type of the parameter of the StringBuilder.append overload which a concatenation of an operand
+     * of a given type corresponds to.
+     */
+    static TypeObs
+    append_parameter_type(TypeTable &type_table, TypeObs type)
+    {
+        switch (type->prefix()) {
+        case jasm::byte_code::ByteTypePrefix:
+        case jasm::byte_code::ShortTypePrefix:
+            return type_table.get_int_type();
+        case jasm::byte_code::ClassTypePrefix:
+        case jasm::byte_code::ArrayTypePrefix:
+            // an array is appended as any other object, not as its characters
+            return is_string_type(type) ? type : type_table.get_class_type("java/lang/Object");
+        default:
+            return type;
+        }
+    }
+
+    static ir::Expression *
+    append(ir::Arena &arena, TypeTable &type_table, ir::Expression *builder, ir::Expression *operand)
+    {
+        MethodTypeObs append_type = type_table.get_method_type(
+          type_table.get_class_type(string_builder), { append_parameter_type(type_table, operand->type) });
+        return arena.make<ir::Invoke>(ir::Invoke::VIRTUAL, string_builder, "append", append_type, builder,
+                                      ir::ExpressionArray{ operand });
+    }
+
+    /**
+     * Replaces the statements appending to a variable by appends to its builder, which also set the flag telling
+     * that the variable has changed.
+     */
+    static void
+    replace_appends(ir::Arena &arena, TypeTable &type_table, ir::Node *node, const ir::Local *local,
+                    ir::Local *builder, ir::Local *appended)
+    {
+        ir::for_each_child(node, [&](auto *&child) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(child)>, ir::Statement *>) {
+                ir::ExpressionArray operands;
+                auto store = append_statement(child, operands);
+                if (store != nullptr && store->local == local) {
+                    ir::Expression *expr = arena.make<ir::LocalLoad>(builder);
+                    for (auto *operand : operands)
+                        expr = append(arena, type_table, expr, operand);
+                    auto *set_appended = arena.make<ir::LocalStore>(
+                      appended, arena.make<ir::Constant>(type_table.get_boolean_type(), static_cast<int_t>(true)));
+                    child = arena.make<ir::Block>(ir::StatementArray{ arena.make<ir::ExpressionStatement>(expr),
+                                                                      arena.make<ir::ExpressionStatement>(set_appended) });
+                    return;
+                }
+            }
+            replace_appends(arena, type_table, child, local, builder, appended);
+        });
+    }
+
+    static void
+    use_builders(ir::Arena &arena, TypeTable &type_table, ir::Statement *&stmt);
+
+    static void
+    use_builders_in_children(ir::Arena &arena, TypeTable &type_table, ir::Node *node)
+    {
+        ir::for_each_child(node, [&arena, &type_table](auto *&child) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(child)>, ir::Statement *>)
+                use_builders(arena, type_table, child);
+        });
+    }
+
+    /**
+     * Introduces the builders in a loop statement and then in the loops nested in it.
+     */
+    static void
+    use_builders(ir::Arena &arena, TypeTable &type_table, ir::Statement *&stmt)
+    {
+        auto loop = ir::node_cast<ir::Loop>(stmt);
+        if (loop == nullptr) {
+            use_builders_in_children(arena, type_table, stmt);
+            return;
+        }
+
+        AppendMap appends;
+        count_appends(appends, loop);
+        std::vector<ir::Local *> locals;
+        for (auto &[local, local_appends] : appends) {
+            if (!local_appends.other_uses && local_appends.statements > 0)
+                locals.push_back(local);
+        }
+        std::sort(locals.begin(), locals.end(), [&appends](ir::Local *lhs, ir::Local *rhs) {
+            return appends[lhs].order < appends[rhs].order;
+        });
+
+        ir::StatementArray before;
+        ir::StatementArray after;
+        ClassTypeObs builder_type = type_table.get_class_type(string_builder);
+        MethodTypeObs constructor_type = type_table.get_method_type(type_table.get_void_type(), TypeObsArray());
+        MethodTypeObs to_string_type =
+          type_table.get_method_type(type_table.get_class_type("java/lang/String"), TypeObsArray());
+        TypeObs boolean_type = type_table.get_boolean_type();
+        for (auto *local : locals) {
+            auto *builder = arena.make<ir::Local>(local->name, builder_type, 0);
+            auto *appended = arena.make<ir::Local>(local->name, boolean_type, 0);
+            replace_appends(arena, type_table, loop, local, builder, appended);
+            // the current value is appended rather than passed to the constructor, which rejects null
+            auto *created = arena.make<ir::New>(builder_type, constructor_type, ir::ExpressionArray());
+            before.push_back(arena.make<ir::ExpressionStatement>(arena.make<ir::LocalStore>(builder, created)));
+            before.push_back(arena.make<ir::ExpressionStatement>(
+              append(arena, type_table, arena.make<ir::LocalLoad>(builder), arena.make<ir::LocalLoad>(local))));
+            before.push_back(arena.make<ir::ExpressionStatement>(
+              arena.make<ir::LocalStore>(appended, arena.make<ir::Constant>(boolean_type, static_cast<int_t>(false)))));
+            // the variable keeps its value, including null, if none of the appends has run
+            auto *to_string = arena.make<ir::Invoke>(ir::Invoke::VIRTUAL, string_builder, "toString", to_string_type,
+                                                     arena.make<ir::LocalLoad>(builder), ir::ExpressionArray());
+            after.push_back(arena.make<ir::If>(
+              arena.make<ir::LocalLoad>(appended),
+              arena.make<ir::ExpressionStatement>(arena.make<ir::LocalStore>(local, to_string)), nullptr));
+        }
+
+        // the nested loops have no appends to the variables replaced above
+        use_builders_in_children(arena, type_table, loop);
+        if (before.empty())
+            return;
+        before.push_back(loop);
+        before.insert(before.end(), after.begin(), after.end());
+        stmt = arena.make<ir::Block>(std::move(before));
+    }
+
+    void
+    use_string_builders(ir::Arena &arena, TypeTable &type_table, ir::Method &method)
+    {
+        if (method.body != nullptr)
+            use_builders_in_children(arena, type_table, method.body);
+    }
+
+}
@@ -27,24 +27,23 @@ namespace jawa {
     }
 
     void
-    Context::message_line(loc_t const &loc) const
+    Context::message_line(std::ostream &os, loc_t const &loc) const
     {
-        std::cerr << ' ' << std::setw(5) << std::setfill(' ') << loc.line << " | " << jawa::line_buffer.str()
-                  << std::endl
-                  << "       | ";
+        os << ' ' << std::setw(5) << std::setfill(' ') << loc.line << " | " << jawa::line_buffer.str() << '\n'
+           << "       | ";
         // column starts at 1, so subtracting 1 is safe
         for (unsigned i = 0; i < loc.column_start - 1; ++i) {
-            std::cerr << ' ';
+            os << ' ';
         }
 
-        std::cerr << '^';
+        os << '^';
 
         // underline erroneous token
         for (unsigned i = loc.column_start + 1; i < loc.column_end; ++i) {
-            std::cerr << '~';
+            os << '~';
         }
 
-        std::cerr << std::endl;
+        os << '\n';
     }
 
     bool
@@ -19,6 +19,24 @@ namespace jawa::errors {
     err_n CLASS_NOT_FOUND{ "klasa \'%\' nie została znaleziona" };
     err_nn METHOD_NOT_FOUND{ "metoda \'%\' klasy \'%\' nie została znaleziona" };
     err_nn FIELD_NOT_FOUND{ "pole \'%\' klasy \'%\' nie zostało znalezione" };
+    err_nn NON_STATIC_FIELD{ "pole \'%\' klasy \'%\' nie jest statyczne" };
     err EXPECTED_REFERENCE_TYPE{ "oczekiwany typ referencyjny" };
     err_n VARIABLE_NOT_DECLARED{ "zmienna \'%\' nie zadeklarowana" };
+    err_n VARIABLE_ALREADY_DECLARED{ "zmienna \'%\' jest już zadeklarowana" };
+    err_n INCOMPATIBLE_OPERANDS{ "niezgodne typy operandów operatora \'%\'" };
+    err_nn INCOMPATIBLE_TYPES{ "niezgodne typy: \'%\' nie może zostać przekształcony na \'%\'" };
+    err_n NUMBER_OUT_OF_RANGE{ "liczba \'%\' jest poza zakresem" };
+    err_n UNSUPPORTED_OPERATION{ "operator \'%\' nie jest jeszcze obsługiwany" };
+    err EXPECTED_CONSTANT_EXPRESSION{ "oczekiwane wyrażenie stałe" };
+    err_n DUPLICATE_CASE_LABEL{ "powtórzona etykieta \'przypad %\'" };
+    err DUPLICATE_DEFAULT_LABEL{ "powtórzona etykieta \'domyślna\'" };
+    err BREAK_OUTSIDE_SWITCH{ "instrukcja \'złam\' poza instrukcją \'przełącz\' lub pętlą" };
+    err CONTINUE_OUTSIDE_LOOP{ "instrukcja \'kontyntynuj\' poza pętlą" };
+    err NON_STATIC_IN_STATIC_CONTEXT{ "odwołanie do \'to\' lub do niestatycznej składowej w kontekście statycznym" };
+    err EXPECTED_ARRAY_TYPE{ "oczekiwany typ tablicowy" };
+    err INVALID_ASSIGNMENT_TARGET{ "lewa strona przypisania nie jest zmienną" };
+    err_n CONSTRUCTOR_NOT_FOUND{ "konstruktor klasy \'%\' nie został znaleziony" };
+    err_n MISSING_RETURN_TYPE{ "brak typu zwracanego metody \'%\'" };
+    err_n INVALID_SUPERCLASS{ "typ \'%\' nie może zostać przedłużony" };
+    err_n EXPECTED_INTERFACE{ "typ \'%\' nie jest interfejsem" };
 }
\ No newline at end of file
@@ -0,0 +1,361 @@
+/**
+ * @file folding.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#include "folding.hpp"
+
+namespace jawa {
+
+    using operators::binop;
+    using operators::unop;
+
+    /**
+     * Converts a floating point value to an integral type, NaN is converted to 0 and out of range values
+     * saturate (JLS §5.1.3).
+     */
+    template<typename I, typename F>
+    static I
+    saturate(F value)
+    {
+        if (std::isnan(value))
+            return 0;
+        if (value <= static_cast<F>(std::numeric_limits<I>::min()))
+            return std::numeric_limits<I>::min();
+        if (value >= static_cast<F>(std::numeric_limits<I>::max()))
+            return std::numeric_limits<I>::max();
+        return static_cast<I>(value);
+    }
+
+    template<typename T>
+    static T
+    numeric_value(const ConstantValue &value)
+    {
+        return std::visit(
+          [](auto &&v) -> T {
+              using V = std::decay_t<decltype(v)>;
+              if constexpr (std::is_same_v<V, Name>) {
+                  assert(false);
+                  return T();
+              } else if constexpr (std::is_floating_point_v<V> && std::is_integral_v<T>) {
+                  return saturate<T>(v);
+              } else {
+                  return static_cast<T>(v);
+              }
+          },
+          value);
+    }
+
+    static ConstantValue
+    convert(const ConstantValue &value, TypeObs type)
+    {
+        switch (type->prefix()) {
+        case jasm::byte_code::ByteTypePrefix:
+            return static_cast<int_t>(static_cast<byte_t>(numeric_value<int_t>(value)));
+        case jasm::byte_code::ShortTypePrefix:
+            return static_cast<int_t>(static_cast<short_t>(numeric_value<int_t>(value)));
+        case jasm::byte_code::CharTypePrefix:
+            return static_cast<int_t>(static_cast<char_t>(numeric_value<int_t>(value)));
+        case jasm::byte_code::LongTypePrefix:
+            // narrowing of a float first converts to long, not to int
+            return numeric_value<long_t>(value);
+        case jasm::byte_code::FloatTypePrefix:
+            return numeric_value<float_t>(value);
+        case jasm::byte_code::DoubleTypePrefix:
+            return numeric_value<double_t>(value);
+        default:
+            if (std::holds_alternative<long_t>(value))
+                return static_cast<int_t>(std::get<long_t>(value));
+            return numeric_value<int_t>(value);
+        }
+    }
+
+    template<typename T>
+    static ConstantValue
+    fold_unary(unop op, T value)
+    {
+        using U = std::make_unsigned_t<std::conditional_t<std::is_integral_v<T>, T, int>>;
+        switch (op) {
+        case unop::PLUS:
+            return value;
+        case unop::MINUS:
+            if constexpr (std::is_integral_v<T>)
+                return static_cast<T>(U(0) - static_cast<U>(value));
+            else
+                return -value;
+        case unop::NOT:
+            if constexpr (std::is_integral_v<T>)
+                return static_cast<T>(~value);
+            break;
+        case unop::LNOT:
+            if constexpr (std::is_integral_v<T>)
+                return static_cast<T>(!value);
+            break;
+        }
+        assert(false);
+        return value;
+    }
+
+    /**
+     * Folds an arithmetic, bitwise or comparison operation on operands of the same type.
+     *
+     * @return folded value, std::nullopt for integer division by zero.
+     */
+    template<typename T>
+    static std::optional<ConstantValue>
+    fold_binary(binop op, T lhs, T rhs)
+    {
+        constexpr bool integral = std::is_integral_v<T>;
+        using U = std::make_unsigned_t<std::conditional_t<integral, T, int>>;
+        constexpr int shift_mask = sizeof(T) == 8 ? 63 : 31;
+
+        switch (op) {
+        case binop::LT:
+            return static_cast<int_t>(lhs < rhs);
+        case binop::GT:
+            return static_cast<int_t>(lhs > rhs);
+        case binop::LTE:
+            return static_cast<int_t>(lhs <= rhs);
+        case binop::GTE:
+            return static_cast<int_t>(lhs >= rhs);
+        case binop::EQ:
+            return static_cast<int_t>(lhs == rhs);
+        case binop::NE:
+            return static_cast<int_t>(lhs != rhs);
+        default:
+            break;
+        }
+
+        if constexpr (integral) {
+            switch (op) {
+            case binop::ADD:
+                return static_cast<T>(static_cast<U>(lhs) + static_cast<U>(rhs));
+            case binop::SUB:
+                return static_cast<T>(static_cast<U>(lhs) - static_cast<U>(rhs));
+            case binop::MUL:
+                return static_cast<T>(static_cast<U>(lhs) * static_cast<U>(rhs));
+            case binop::DIV:
+                if (rhs == 0)
+                    return std::nullopt;
+                if (rhs == -1)
+                    return static_cast<T>(U(0) - static_cast<U>(lhs));
+                return static_cast<T>(lhs / rhs);
+            case binop::MOD:
+                if (rhs == 0)
+                    return std::nullopt;
+                if (rhs == -1)
+                    return static_cast<T>(0);
+                return static_cast<T>(lhs % rhs);
+            case binop::SHL:
+                return static_cast<T>(static_cast<U>(lhs) << (rhs & shift_mask));
+            case binop::SHR:
+                // right shift of a negative value is arithmetic in C++20 and in all the supported compilers
+                return static_cast<T>(lhs >> (rhs & shift_mask));
+            case binop::USHR:
+                return static_cast<T>(static_cast<U>(lhs) >> (rhs & shift_mask));
+            case binop::AND:
+            case binop::LAND:
+                return static_cast<T>(lhs & rhs);
+            case binop::OR:
+            case binop::LOR:
+                return static_cast<T>(lhs | rhs);
+            case binop::XOR:
+                return static_cast<T>(lhs ^ rhs);
+            default:
+                break;
+            }
+        } else {
+            switch (op) {
+            case binop::ADD:
+                return lhs + rhs;
+            case binop::SUB:
+                return lhs - rhs;
+            case binop::MUL:
+                return lhs * rhs;
+            case binop::DIV:
+                return lhs / rhs;
+            case binop::MOD:
+                return static_cast<T>(std::fmod(lhs, rhs));
+            default:
+                break;
+            }
+        }
+        assert(false);
+        return std::nullopt;
+    }
+
+    static void
+    append_utf8(Name &str, char_t ch)
+    {
+        if (ch < 0x80) {
+            str += static_cast<char>(ch);
+        } else if (ch < 0x800) {
+            str += static_cast<char>(0xC0 | (ch >> 6));
+            str += static_cast<char>(0x80 | (ch & 0x3F));
+        } else {
+            str += static_cast<char>(0xE0 | (ch >> 12));
+            str += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+            str += static_cast<char>(0x80 | (ch & 0x3F));
+        }
+    }
+
+    /**
+     * Formats a floating point number as Double.toString and Float.toString do: the shortest decimal
+     * representation that rounds to the same value, in the scientific notation outside of [10^-3, 10^7).
+     */
+    template<typename T>
+    static Name
+    floating_to_string(T value)
+    {
+        if (std::isnan(value))
+            return "NaN";
+        if (std::isinf(value))
+            return value > 0 ? "Infinity" : "-Infinity";
+        if (value == 0)
+            return std::signbit(value) ? "-0.0" : "0.0";
+
+        char buffer[64];
+        constexpr int max_precision = std::numeric_limits<T>::max_digits10;
+        for (int precision = 1; precision <= max_precision; ++precision) {
+            std::snprintf(buffer, sizeof(buffer), "%.*e", precision - 1, static_cast<double>(value));
+            T parsed = std::is_same_v<T, float> ? std::strtof(buffer, nullptr) : std::strtod(buffer, nullptr);
+            if (parsed == value)
+                break;
+        }
+
+        // buffer holds [-]d[.ddd]e[+-]xx
+        Name str(buffer);
+        bool negative = str[0] == '-';
+        std::size_t e = str.find('e');
+        int exponent = std::atoi(str.c_str() + e + 1);
+        Name digits;
+        for (std::size_t i = negative; i < e; ++i) {
+            if (str[i] != '.')
+                digits += str[i];
+        }
+        while (digits.size() > 1 && digits.back() == '0')
+            digits.pop_back();
+
+        Name result = negative ? "-" : "";
+        T magnitude = std::abs(value);
+        if (magnitude >= T(1e-3) && magnitude < T(1e7)) {
+            if (exponent >= 0) {
+                if (digits.size() <= static_cast<std::size_t>(exponent) + 1)
+                    digits.append(exponent + 1 - digits.size() + 1, '0');
+                result += digits.substr(0, exponent + 1) + '.' + digits.substr(exponent + 1);
+            } else {
+                result += "0." + Name(-exponent - 1, '0') + digits;
+            }
+        } else {
+            result += digits.substr(0, 1) + '.' + (digits.size() > 1 ? digits.substr(1) : "0") + 'E' +
+                      std::to_string(exponent);
+        }
+        return result;
+    }
+
+    Name
+    constant_to_string(const ir::Constant &constant)
+    {
+        switch (constant.type->prefix()) {
+        case jasm::byte_code::BooleanTypePrefix:
+            return std::get<int_t>(constant.value) ? "true" : "false";
+        case jasm::byte_code::CharTypePrefix: {
+            Name str;
+            append_utf8(str, static_cast<char_t>(std::get<int_t>(constant.value)));
+            return str;
+        }
+        case jasm::byte_code::LongTypePrefix:
+            return std::to_string(std::get<long_t>(constant.value));
+        case jasm::byte_code::FloatTypePrefix:
+            return floating_to_string(std::get<float_t>(constant.value));
+        case jasm::byte_code::DoubleTypePrefix:
+            return floating_to_string(std::get<double_t>(constant.value));
+        case jasm::byte_code::ClassTypePrefix:
+            return std::get<Name>(constant.value);
+        default:
+            return std::to_string(std::get<int_t>(constant.value));
+        }
+    }
+
+    ir::Expression *
+    fold(ir::Arena &arena, ir::Expression *expr)
+    {
+        switch (expr->kind) {
+        case ir::Kind::CONVERT: {
+            auto convert_expr = static_cast<ir::Convert *>(expr);
+            auto operand = ir::node_cast<ir::Constant>(convert_expr->operand);
+            if (operand == nullptr)
+                return expr;
+            return arena.make<ir::Constant>(expr->type, convert(operand->value, expr->type));
+        }
+        case ir::Kind::UNARY: {
+            auto unary = static_cast<ir::Unary *>(expr);
+            auto operand = ir::node_cast<ir::Constant>(unary->operand);
+            if (operand == nullptr)
+                return expr;
+            ConstantValue value = std::visit(
+              [unary](auto &&v) -> ConstantValue {
+                  if constexpr (std::is_same_v<std::decay_t<decltype(v)>, Name>) {
+                      assert(false);
+                      return v;
+                  } else {
+                      return fold_unary(unary->op, v);
+                  }
+              },
+              operand->value);
+            return arena.make<ir::Constant>(expr->type, std::move(value));
+        }
+        case ir::Kind::BINARY: {
+            auto binary = static_cast<ir::Binary *>(expr);
+            auto lhs = ir::node_cast<ir::Constant>(binary->lhs);
+            auto rhs = ir::node_cast<ir::Constant>(binary->rhs);
+            if (lhs == nullptr || rhs == nullptr)
+                return expr;
+
+            if (is_string_type(expr->type))
+                return arena.make<ir::Constant>(expr->type, constant_to_string(*lhs) + constant_to_string(*rhs));
+
+            std::optional<ConstantValue> value;
+            switch (binary->op) {
+            case binop::SHL:
+            case binop::SHR:
+            case binop::USHR:
+                // the shift distance is always an int
+                if (std::holds_alternative<long_t>(lhs->value))
+                    value = fold_binary<long_t>(binary->op, std::get<long_t>(lhs->value), std::get<int_t>(rhs->value));
+                else
+                    value = fold_binary<int_t>(binary->op, std::get<int_t>(lhs->value), std::get<int_t>(rhs->value));
+                break;
+            default:
+                value = std::visit(
+                  [binary, rhs](auto &&v) -> std::optional<ConstantValue> {
+                      using V = std::decay_t<decltype(v)>;
+                      if constexpr (std::is_same_v<V, Name>) {
+                          return std::nullopt;
+                      } else {
+                          return fold_binary<V>(binary->op, v, std::get<V>(rhs->value));
+                      }
+                  },
+                  lhs->value);
+                break;
+            }
+            if (!value)
+                return expr;
+            return arena.make<ir::Constant>(expr->type, std::move(*value));
+        }
+        default:
+            return expr;
+        }
+    }
+
+}
@@ -0,0 +1,141 @@
+/**
+ * @file hoisting.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <set>
+
+#include "hoisting.hpp"
+#include "tables.hpp"
+
+namespace jawa {
+
+    /**
+     * Static field accesses of a loop and whether it may run code of other methods.
+     */
+    struct LoopSummary
+    {
+        std::set<Name> loaded;
+        std::set<Name> stored;
+        bool calls = false;
+    };
+
+    static void
+    summarise(LoopSummary &summary, const ir::Class &ir_class, const ir::Node *node)
+    {
+        switch (node->kind) {
+        case ir::Kind::STATIC_FIELD_LOAD: {
+            auto load = static_cast<const ir::StaticFieldLoad *>(node);
+            if (load->class_name == ir_class.name)
+                summary.loaded.insert(load->field_name);
+            break;
+        }
+        case ir::Kind::STATIC_FIELD_STORE: {
+            auto store = static_cast<const ir::StaticFieldStore *>(node);
+            if (store->class_name == ir_class.name)
+                summary.stored.insert(store->field_name);
+            break;
+        }
+        case ir::Kind::INVOKE:
+        case ir::Kind::NEW:
+            summary.calls = true;
+            break;
+        case ir::Kind::SYNCHRONIZED:
+            // entering a monitor makes the stores of other threads visible, no load can be moved out of the loop
+            summary.calls = true;
+            break;
+        case ir::Kind::BINARY: {
+            // concatenation of an object calls its toString method
+            auto binary = static_cast<const ir::Binary *>(node);
+            if (is_string_type(binary->type)) {
+                for (auto *operand : { binary->lhs, binary->rhs }) {
+                    if (is_reference_type(operand->type) && !is_string_type(operand->type))
+                        summary.calls = true;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+        }
+        ir::for_each_child(node, [&summary, &ir_class](auto *child) { summarise(summary, ir_class, child); });
+    }
+
+    static void
+    replace_loads(ir::Arena &arena, ir::Node *node, const Name &class_name, const Name &field_name, ir::Local *local)
+    {
+        ir::for_each_child(node, [&](auto *&child) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(child)>, ir::Expression *>) {
+                auto load = ir::node_cast<ir::StaticFieldLoad>(child);
+                if (load && load->class_name == class_name && load->field_name == field_name) {
+                    child = arena.make<ir::LocalLoad>(local);
+                    return;
+                }
+            }
+            replace_loads(arena, child, class_name, field_name, local);
+        });
+    }
+
+    static void
+    hoist(ir::Arena &arena, const ir::Class &ir_class, ir::Statement *&stmt);
+
+    static void
+    hoist_children(ir::Arena &arena, const ir::Class &ir_class, ir::Node *node)
+    {
+        ir::for_each_child(node, [&arena, &ir_class](auto *&child) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(child)>, ir::Statement *>)
+                hoist(arena, ir_class, child);
+        });
+    }
+
+    /**
+     * Hoists the invariant loads out of a loop statement and then out of the loops nested in it.
+     */
+    static void
+    hoist(ir::Arena &arena, const ir::Class &ir_class, ir::Statement *&stmt)
+    {
+        auto loop = ir::node_cast<ir::Loop>(stmt);
+        if (loop == nullptr) {
+            hoist_children(arena, ir_class, stmt);
+            return;
+        }
+
+        LoopSummary summary;
+        summarise(summary, ir_class, loop);
+        ir::StatementArray statements;
+        if (!summary.calls) {
+            for (const auto &field_name : summary.loaded) {
+                auto it = ir_class.fields.find(field_name);
+                if (it == ir_class.fields.end() || (it->second->access_flags & jasm::Field::ACC_VOLATILE) ||
+                    summary.stored.count(field_name))
+                    continue;
+
+                const ir::Field *field = it->second;
+                auto *local = arena.make<ir::Local>(field_name, field->type, 0);
+                replace_loads(arena, loop, ir_class.name, field_name, local);
+                auto *load = arena.make<ir::StaticFieldLoad>(field->type, ir_class.name, field_name);
+                statements.push_back(arena.make<ir::ExpressionStatement>(arena.make<ir::LocalStore>(local, load)));
+            }
+        }
+
+        // an inner loop may still have invariants which the outer loop does not
+        hoist_children(arena, ir_class, loop);
+        if (statements.empty())
+            return;
+        statements.push_back(loop);
+        stmt = arena.make<ir::Block>(std::move(statements));
+    }
+
+    void
+    hoist_invariants(ir::Arena &arena, const ir::Class &ir_class, ir::Method &method)
+    {
+        if (method.body != nullptr)
+            hoist_children(arena, ir_class, method.body);
+    }
+
+}
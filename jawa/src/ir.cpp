@@ -0,0 +1,56 @@
+/**
+ * @file ir.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <algorithm>
+#include <cstdint>
+
+#include "ir.hpp"
+
+namespace jawa::ir {
+
+    void *
+    Arena::allocate(std::size_t size, std::size_t alignment)
+    {
+        auto align = [alignment](std::uintptr_t address) { return (address + alignment - 1) & ~(alignment - 1); };
+
+        if (!chunks_.empty()) {
+            auto base = reinterpret_cast<std::uintptr_t>(chunks_.back().get());
+            std::size_t offset = align(base + used_) - base;
+            if (offset + size <= capacity_) {
+                used_ = offset + size;
+                return chunks_.back().get() + offset;
+            }
+        }
+
+        // objects larger than a chunk get a chunk of their own
+        capacity_ = std::max(ChunkSize, size + alignment);
+        chunks_.push_back(std::make_unique<std::byte[]>(capacity_));
+        auto base = reinterpret_cast<std::uintptr_t>(chunks_.back().get());
+        std::size_t offset = align(base) - base;
+        used_ = offset + size;
+        return chunks_.back().get() + offset;
+    }
+
+    void
+    Arena::reset()
+    {
+        // destroy in the reverse order of construction
+        for (auto it = destructors_.rbegin(); it != destructors_.rend(); ++it)
+            it->destroy(it->object);
+        destructors_.clear();
+
+        if (chunks_.size() > 1 || capacity_ != ChunkSize) {
+            chunks_.clear();
+            capacity_ = 0;
+        }
+        used_ = 0;
+    }
+
+}
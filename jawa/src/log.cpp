@@ -0,0 +1,32 @@
+/**
+ * @file log.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include "log.hpp"
+
+namespace jawa::log {
+
+    void
+    BufferedSink::flush()
+    {
+        if (buffer_.tellp() <= 0)
+            return;
+        os_ << std::move(buffer_).str();
+        os_.flush();
+        buffer_.str("");
+    }
+
+    BufferedSink &
+    trace_sink()
+    {
+        static BufferedSink sink(std::clog);
+        return sink;
+    }
+
+}
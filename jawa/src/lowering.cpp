@@ -0,0 +1,2080 @@
+/**
+ * @file lowering.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include "lowering.hpp"
+#include "folding.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+
+namespace jawa {
+
+    jasm::u2
+    add_constant(jasm::ClassBuilder &builder, const ir::Constant &constant)
+    {
+        switch (constant.type->prefix()) {
+        case jasm::byte_code::LongTypePrefix:
+            return builder.add_long_constant(std::get<long_t>(constant.value));
+        case jasm::byte_code::FloatTypePrefix:
+            return builder.add_float_constant(std::get<float_t>(constant.value));
+        case jasm::byte_code::DoubleTypePrefix:
+            return builder.add_double_constant(std::get<double_t>(constant.value));
+        case jasm::byte_code::ClassTypePrefix:
+            return builder.add_string_constant(std::get<Name>(constant.value));
+        default:
+            return builder.add_integer_constant(std::get<int_t>(constant.value));
+        }
+    }
+
+    /**
+     * Pushes an entry to the operand stack.
+     *
+     * @param new_label label of the new instruction if the entry is an object which is not initialised yet.
+     */
+    void
+    Lowering::push(TypeObs type, std::optional<jasm::Label> new_label)
+    {
+        stack_.push_back({ type, new_label });
+        depth_ += slot_count(type);
+        if (depth_ > max_depth_)
+            max_depth_ = depth_;
+    }
+
+    void
+    Lowering::pop(std::size_t entries)
+    {
+        assert(stack_.size() >= entries);
+        for (; entries > 0; --entries) {
+            depth_ -= slot_count(stack_.back().type);
+            stack_.pop_back();
+        }
+    }
+
+    Lowering::Target
+    Lowering::create_target()
+    {
+        return Target{ builder_.create_label(), std::nullopt, false, monitors_.size() };
+    }
+
+    /**
+     * Records a jump to a target from the current point of the code, a local variable keeps its type at the target
+     * only if it has the same type at all the jumps.
+     */
+    void
+    Lowering::jump(Target &target)
+    {
+        if (target.placed) {
+            // the frame of a loop head has already been emitted, the backward jumps have to agree with it
+            assert(target.frame->stack == stack_);
+            TypeObsArray &locals = target.frame->locals;
+            for (std::size_t i = 0; i < locals.size(); ++i)
+                assert(locals[i] == nullptr || (i < locals_.size() && locals_[i] == locals[i]));
+            return;
+        }
+        if (!target.frame) {
+            target.frame = Frame{ locals_, stack_ };
+            return;
+        }
+        // the operand stacks at the jumps to the same target always agree in jawa
+        assert(target.frame->stack == stack_);
+        TypeObsArray &locals = target.frame->locals;
+        if (locals.size() > locals_.size())
+            locals.resize(locals_.size());
+        for (std::size_t i = 0; i < locals.size(); ++i) {
+            if (locals[i] != locals_[i])
+                locals[i] = nullptr;
+        }
+    }
+
+    void
+    Lowering::go_to(Target &target)
+    {
+        jump(target);
+        builder_.make_jump<jasm::GoTo>(target.label);
+        reachable_ = false;
+    }
+
+    /**
+     * Records a conditional jump to a target, its operands have already been popped. The types at the fall through
+     * are passed to the builder, a jump too long for a two byte offset needs them.
+     */
+    void
+    Lowering::branch(Target &target)
+    {
+        jump(target);
+        std::vector<jasm::StackMapTableAttribute::VerificationType> locals;
+        std::vector<jasm::StackMapTableAttribute::VerificationType> stack;
+        frame_types(locals, stack);
+        builder_.set_fall_through_frame(std::move(locals), std::move(stack));
+    }
+
+    /**
+     * Binds the label of a target to the following instruction. If the preceding code is reachable, it falls
+     * through to the target. The code following a target without any jumps to it is unreachable.
+     */
+    void
+    Lowering::place(Target &target)
+    {
+        if (reachable_)
+            jump(target);
+        builder_.bind_label(target.label);
+        target.placed = true;
+        reachable_ = target.frame.has_value();
+        if (!reachable_)
+            return;
+
+        locals_ = target.frame->locals;
+        stack_.clear();
+        depth_ = 0;
+        for (auto &entry : target.frame->stack)
+            push(entry.type, entry.new_label);
+
+        std::vector<jasm::StackMapTableAttribute::VerificationType> locals;
+        std::vector<jasm::StackMapTableAttribute::VerificationType> stack;
+        frame_types(locals, stack);
+        builder_.set_frame(std::move(locals), std::move(stack));
+    }
+
+    /**
+     * Converts the types of the local variables and of the operand stack entries to the types of a stack map frame.
+     */
+    void
+    Lowering::frame_types(std::vector<jasm::StackMapTableAttribute::VerificationType> &locals,
+                          std::vector<jasm::StackMapTableAttribute::VerificationType> &stack)
+    {
+        using VerificationType = jasm::StackMapTableAttribute::VerificationType;
+
+        for (std::size_t i = 0; i < locals_.size(); ++i) {
+            if (locals_[i] == nullptr) {
+                locals.emplace_back(VerificationType::ITEM_TOP);
+                continue;
+            }
+            locals.push_back(verification_type(locals_[i]));
+            // long and double variables are a single entry of the frame
+            i += slot_count(locals_[i]) - 1;
+        }
+        while (!locals.empty() && locals.back().tag == VerificationType::ITEM_TOP)
+            locals.pop_back();
+
+        for (auto &entry : stack_) {
+            if (entry.new_label)
+                stack.emplace_back(VerificationType::ITEM_UNINITIALIZED, *entry.new_label);
+            else
+                stack.push_back(verification_type(entry.type));
+        }
+    }
+
+    jasm::StackMapTableAttribute::VerificationType
+    Lowering::verification_type(TypeObs type)
+    {
+        using VerificationType = jasm::StackMapTableAttribute::VerificationType;
+
+        switch (type->prefix()) {
+        case jasm::byte_code::LongTypePrefix:
+            return VerificationType(VerificationType::ITEM_LONG);
+        case jasm::byte_code::FloatTypePrefix:
+            return VerificationType(VerificationType::ITEM_FLOAT);
+        case jasm::byte_code::DoubleTypePrefix:
+            return VerificationType(VerificationType::ITEM_DOUBLE);
+        case jasm::byte_code::ClassTypePrefix: {
+            auto class_type = dynamic_cast<ClassTypeObs>(type);
+            assert(class_type != nullptr);
+            return VerificationType(VerificationType::ITEM_OBJECT,
+                                    builder_.add_class_constant(class_type->class_name()));
+        }
+        case jasm::byte_code::ArrayTypePrefix:
+            // array classes are named by their descriptors
+            return VerificationType(VerificationType::ITEM_OBJECT, builder_.add_class_constant(type->descriptor()));
+        default:
+            return VerificationType(VerificationType::ITEM_INTEGER);
+        }
+    }
+
+    void
+    Lowering::load_constant(jasm::u2 index, TypeObs type)
+    {
+        if (index <= 0xFF)
+            builder_.make_instruction<jasm::LoadConst>(U2_LOW(index));
+        else
+            builder_.make_instruction<jasm::LoadConstW>(U2_SPLIT(index));
+        push(type);
+    }
+
+    void
+    Lowering::lower_constant(const ir::Constant *constant)
+    {
+        using namespace jasm::byte_code;
+
+        // the shortest instruction pushing the value is chosen, as javac does
+        switch (constant->type->prefix()) {
+        case LongTypePrefix: {
+            long_t value = std::get<long_t>(constant->value);
+            if (value == 0)
+                builder_.make_instruction<jasm::LongConst0>();
+            else if (value == 1)
+                builder_.make_instruction<jasm::LongConst1>();
+            else
+                builder_.make_instruction<jasm::LoadConst2W>(U2_SPLIT(add_constant(builder_, *constant)));
+            push(constant->type);
+            return;
+        }
+        case DoubleTypePrefix: {
+            double_t value = std::get<double_t>(constant->value);
+            if (value == 0.0 && !std::signbit(value))
+                builder_.make_instruction<jasm::DoubleConst0>();
+            else if (value == 1.0)
+                builder_.make_instruction<jasm::DoubleConst1>();
+            else
+                builder_.make_instruction<jasm::LoadConst2W>(U2_SPLIT(add_constant(builder_, *constant)));
+            push(constant->type);
+            return;
+        }
+        case FloatTypePrefix: {
+            float_t value = std::get<float_t>(constant->value);
+            if (value == 0.0f && !std::signbit(value))
+                builder_.make_instruction<jasm::FloatConst0>();
+            else if (value == 1.0f)
+                builder_.make_instruction<jasm::FloatConst1>();
+            else if (value == 2.0f)
+                builder_.make_instruction<jasm::FloatConst2>();
+            else
+                break;
+            push(constant->type);
+            return;
+        }
+        case ClassTypePrefix:
+        case ArrayTypePrefix:
+            break;
+        default: {
+            int_t value = std::get<int_t>(constant->value);
+            switch (value) {
+            case -1:
+                builder_.make_instruction<jasm::IntConstNeg1>();
+                break;
+            case 0:
+                builder_.make_instruction<jasm::IntConst0>();
+                break;
+            case 1:
+                builder_.make_instruction<jasm::IntConst1>();
+                break;
+            case 2:
+                builder_.make_instruction<jasm::IntConst2>();
+                break;
+            case 3:
+                builder_.make_instruction<jasm::IntConst3>();
+                break;
+            case 4:
+                builder_.make_instruction<jasm::IntConst4>();
+                break;
+            case 5:
+                builder_.make_instruction<jasm::IntConst5>();
+                break;
+            default:
+                if (value >= std::numeric_limits<byte_t>::min() && value <= std::numeric_limits<byte_t>::max())
+                    builder_.make_instruction<jasm::BytePush>(static_cast<jasm::u1>(value));
+                else if (value >= std::numeric_limits<short_t>::min() && value <= std::numeric_limits<short_t>::max())
+                    builder_.make_instruction<jasm::ShortPush>(U2_SPLIT(static_cast<jasm::u2>(value)));
+                else
+                    break;
+                push(constant->type);
+                return;
+            }
+            push(constant->type);
+            return;
+        }
+        }
+
+        load_constant(add_constant(builder_, *constant), constant->type);
+    }
+
+    /**
+     * Emits a load or a store of a local variable, the short forms are used for the first four slots.
+     */
+    template<typename I0, typename I1, typename I2, typename I3, typename I>
+    static void
+    local_instruction(jasm::ClassBuilder &builder, jasm::u2 index)
+    {
+        // TODO: wide instructions
+        assert(index <= 0xFF);
+        switch (index) {
+        case 0:
+            builder.make_instruction<I0>();
+            break;
+        case 1:
+            builder.make_instruction<I1>();
+            break;
+        case 2:
+            builder.make_instruction<I2>();
+            break;
+        case 3:
+            builder.make_instruction<I3>();
+            break;
+        default:
+            builder.make_instruction<I>(U2_LOW(index));
+            break;
+        }
+    }
+
+    void
+    Lowering::load_local(const ir::Local *local)
+    {
+        using namespace jasm;
+
+        jasm::u2 index = slot(local);
+        switch (local->type->prefix()) {
+        case LongTypePrefix:
+            local_instruction<LongLoad0, LongLoad1, LongLoad2, LongLoad3, LongLoad>(builder_, index);
+            break;
+        case FloatTypePrefix:
+            local_instruction<FloatLoad0, FloatLoad1, FloatLoad2, FloatLoad3, FloatLoad>(builder_, index);
+            break;
+        case DoubleTypePrefix:
+            local_instruction<DoubleLoad0, DoubleLoad1, DoubleLoad2, DoubleLoad3, DoubleLoad>(builder_, index);
+            break;
+        case ClassTypePrefix:
+        case ArrayTypePrefix:
+            local_instruction<RefLoad0, RefLoad1, RefLoad2, RefLoad3, RefLoad>(builder_, index);
+            break;
+        default:
+            local_instruction<IntLoad0, IntLoad1, IntLoad2, IntLoad3, IntLoad>(builder_, index);
+            break;
+        }
+        push(local->type);
+    }
+
+    void
+    Lowering::store_local(const ir::Local *local)
+    {
+        using namespace jasm;
+
+        jasm::u2 index = slot(local);
+        switch (local->type->prefix()) {
+        case LongTypePrefix:
+            local_instruction<LongStore0, LongStore1, LongStore2, LongStore3, LongStore>(builder_, index);
+            break;
+        case FloatTypePrefix:
+            local_instruction<FloatStore0, FloatStore1, FloatStore2, FloatStore3, FloatStore>(builder_, index);
+            break;
+        case DoubleTypePrefix:
+            local_instruction<DoubleStore0, DoubleStore1, DoubleStore2, DoubleStore3, DoubleStore>(builder_, index);
+            break;
+        case ClassTypePrefix:
+        case ArrayTypePrefix:
+            local_instruction<RefStore0, RefStore1, RefStore2, RefStore3, RefStore>(builder_, index);
+            break;
+        default:
+            local_instruction<IntStore0, IntStore1, IntStore2, IntStore3, IntStore>(builder_, index);
+            break;
+        }
+        jasm::u2 slots = slot_count(local->type);
+        pop();
+
+        if (locals_.size() < index + slots)
+            locals_.resize(index + slots);
+        // a long or a double variable overlapping with the stored slot is overwritten
+        if (index > 0 && locals_[index - 1] != nullptr && slot_count(locals_[index - 1]) == 2)
+            locals_[index - 1] = nullptr;
+        locals_[index] = local->type;
+        if (slots == 2)
+            locals_[index + 1] = nullptr;
+    }
+
+    /**
+     * Emits iinc for an assignment of the form x = x + c or x = x - c, where x is an int variable and c is
+     * a constant that fits in a byte.
+     *
+     * @return true if the assignment has been emitted.
+     */
+    bool
+    Lowering::lower_increment(const ir::LocalStore *store, bool discard)
+    {
+        if (store->local->type->prefix() != jasm::byte_code::IntTypePrefix)
+            return false;
+        auto *binary = ir::node_cast<ir::Binary>(store->value);
+        if (binary == nullptr || (binary->op != operators::binop::ADD && binary->op != operators::binop::SUB))
+            return false;
+
+        auto *load = ir::node_cast<ir::LocalLoad>(binary->lhs);
+        auto *constant = ir::node_cast<ir::Constant>(binary->rhs);
+        if (load == nullptr && binary->op == operators::binop::ADD) {
+            load = ir::node_cast<ir::LocalLoad>(binary->rhs);
+            constant = ir::node_cast<ir::Constant>(binary->lhs);
+        }
+        if (load == nullptr || constant == nullptr || load->local != store->local)
+            return false;
+
+        int64_t increment = std::get<int_t>(constant->value);
+        if (binary->op == operators::binop::SUB)
+            increment = -increment;
+        if (increment < std::numeric_limits<byte_t>::min() || increment > std::numeric_limits<byte_t>::max())
+            return false;
+
+        // TODO: wide instructions
+        assert(slot(store->local) <= 0xFF);
+        builder_.make_instruction<jasm::IntInc>(U2_LOW(slot(store->local)), static_cast<jasm::u1>(increment));
+        if (!discard)
+            load_local(store->local);
+        return true;
+    }
+
+    /**
+     * Returns the computational type of a primitive type, the types represented as int on the operand stack
+     * are mapped to int.
+     */
+    static char
+    computational_type(TypeObs type)
+    {
+        switch (type->prefix()) {
+        case jasm::byte_code::LongTypePrefix:
+        case jasm::byte_code::FloatTypePrefix:
+        case jasm::byte_code::DoubleTypePrefix:
+            return type->prefix();
+        default:
+            return jasm::byte_code::IntTypePrefix;
+        }
+    }
+
+    void
+    Lowering::lower_conversion(TypeObs from, TypeObs to)
+    {
+        using namespace jasm::byte_code;
+
+        char source = computational_type(from);
+        char target = computational_type(to);
+
+        switch (source) {
+        case IntTypePrefix:
+            if (target == LongTypePrefix)
+                builder_.make_instruction<jasm::IntToLong>();
+            else if (target == FloatTypePrefix)
+                builder_.make_instruction<jasm::IntToFloat>();
+            else if (target == DoubleTypePrefix)
+                builder_.make_instruction<jasm::IntToDouble>();
+            break;
+        case LongTypePrefix:
+            if (target == IntTypePrefix)
+                builder_.make_instruction<jasm::LongToInt>();
+            else if (target == FloatTypePrefix)
+                builder_.make_instruction<jasm::LongToFloat>();
+            else if (target == DoubleTypePrefix)
+                builder_.make_instruction<jasm::LongToDouble>();
+            break;
+        case FloatTypePrefix:
+            if (target == IntTypePrefix)
+                builder_.make_instruction<jasm::FloatToInt>();
+            else if (target == LongTypePrefix)
+                builder_.make_instruction<jasm::FloatToLong>();
+            else if (target == DoubleTypePrefix)
+                builder_.make_instruction<jasm::FloatToDouble>();
+            break;
+        case DoubleTypePrefix:
+            if (target == IntTypePrefix)
+                builder_.make_instruction<jasm::DoubleToInt>();
+            else if (target == LongTypePrefix)
+                builder_.make_instruction<jasm::DoubleToLong>();
+            else if (target == FloatTypePrefix)
+                builder_.make_instruction<jasm::DoubleToFloat>();
+            break;
+        default:
+            break;
+        }
+
+        // narrowing to the types represented as int
+        if (source != target || from->prefix() != to->prefix()) {
+            switch (to->prefix()) {
+            case ByteTypePrefix:
+                builder_.make_instruction<jasm::IntToByte>();
+                break;
+            case ShortTypePrefix:
+                builder_.make_instruction<jasm::IntToShort>();
+                break;
+            case CharTypePrefix:
+                builder_.make_instruction<jasm::IntToChar>();
+                break;
+            default:
+                break;
+            }
+        }
+
+        pop();
+        push(to);
+    }
+
+    /**
+     * Emits a conditional jump of the family given by the instructions for the comparison operators.
+     */
+    template<typename Eq, typename Ne, typename Lt, typename Ge, typename Gt, typename Le>
+    static void
+    conditional_jump(jasm::ClassBuilder &builder, operators::binop op, jasm::Label label)
+    {
+        using operators::binop;
+
+        switch (op) {
+        case binop::EQ:
+            builder.make_jump<Eq>(label);
+            break;
+        case binop::NE:
+            builder.make_jump<Ne>(label);
+            break;
+        case binop::LT:
+            builder.make_jump<Lt>(label);
+            break;
+        case binop::GTE:
+            builder.make_jump<Ge>(label);
+            break;
+        case binop::GT:
+            builder.make_jump<Gt>(label);
+            break;
+        case binop::LTE:
+            builder.make_jump<Le>(label);
+            break;
+        default:
+            assert(false);
+            break;
+        }
+    }
+
+    /**
+     * Returns the comparison which holds exactly if the given one does not, x < y is the same as !(x >= y).
+     */
+    static operators::binop
+    negate(operators::binop op)
+    {
+        using operators::binop;
+
+        switch (op) {
+        case binop::LT:
+            return binop::GTE;
+        case binop::GTE:
+            return binop::LT;
+        case binop::GT:
+            return binop::LTE;
+        case binop::LTE:
+            return binop::GT;
+        case binop::EQ:
+            return binop::NE;
+        default:
+            return binop::EQ;
+        }
+    }
+
+    /**
+     * Returns the comparison with exchanged operands, x < y is the same as y > x.
+     */
+    static operators::binop
+    exchange(operators::binop op)
+    {
+        using operators::binop;
+
+        switch (op) {
+        case binop::LT:
+            return binop::GT;
+        case binop::GT:
+            return binop::LT;
+        case binop::LTE:
+            return binop::GTE;
+        case binop::GTE:
+            return binop::LTE;
+        default:
+            return op;
+        }
+    }
+
+    static bool
+    is_zero(const ir::Expression *expr)
+    {
+        auto *constant = ir::node_cast<ir::Constant>(expr);
+        return constant != nullptr && std::holds_alternative<int_t>(constant->value) &&
+               std::get<int_t>(constant->value) == 0;
+    }
+
+    /**
+     * Checks whether the value of an expression is computed by conditional jumps, that is it is a comparison,
+     * a conditional operation or a negation of one.
+     */
+    static bool
+    is_condition(const ir::Expression *expr)
+    {
+        using operators::binop;
+
+        if (auto *unary = ir::node_cast<ir::Unary>(expr))
+            return unary->op == operators::unop::LNOT && is_condition(unary->operand);
+        auto *binary = ir::node_cast<ir::Binary>(expr);
+        if (binary == nullptr)
+            return false;
+        switch (binary->op) {
+        case binop::LT:
+        case binop::GT:
+        case binop::LTE:
+        case binop::GTE:
+        case binop::EQ:
+        case binop::NE:
+        case binop::LAND:
+        case binop::LOR:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void
+    Lowering::lower_unary(const ir::Unary *unary)
+    {
+        using namespace jasm::byte_code;
+
+        if (is_condition(unary)) {
+            lower_boolean(unary);
+            return;
+        }
+
+        lower_expression(unary->operand, false);
+        char type = computational_type(unary->type);
+
+        switch (unary->op) {
+        case operators::unop::PLUS:
+            break;
+        case operators::unop::MINUS:
+            if (type == LongTypePrefix)
+                builder_.make_instruction<jasm::LongNeg>();
+            else if (type == FloatTypePrefix)
+                builder_.make_instruction<jasm::FloatNeg>();
+            else if (type == DoubleTypePrefix)
+                builder_.make_instruction<jasm::DoubleNeg>();
+            else
+                builder_.make_instruction<jasm::IntNeg>();
+            break;
+        case operators::unop::NOT:
+            // ~x == x ^ -1
+            if (type == LongTypePrefix) {
+                builder_.make_instruction<jasm::LoadConst2W>(U2_SPLIT(builder_.add_long_constant(-1)));
+                builder_.make_instruction<jasm::LongXor>();
+                push(unary->type);
+                pop();
+            } else {
+                builder_.make_instruction<jasm::IntConstNeg1>();
+                builder_.make_instruction<jasm::IntXor>();
+                push(unary->type);
+                pop();
+            }
+            break;
+        case operators::unop::LNOT:
+            // !x == x ^ 1
+            builder_.make_instruction<jasm::IntConst1>();
+            builder_.make_instruction<jasm::IntXor>();
+            push(unary->type);
+            pop();
+            break;
+        }
+    }
+
+    void
+    Lowering::lower_binary(const ir::Binary *binary)
+    {
+        using namespace jasm::byte_code;
+        using operators::binop;
+
+        if (is_string_type(binary->type)) {
+            lower_concatenation(binary);
+            return;
+        }
+        if (is_condition(binary)) {
+            lower_boolean(binary);
+            return;
+        }
+
+        lower_expression(binary->lhs, false);
+        lower_expression(binary->rhs, false);
+        char type = computational_type(binary->lhs->type);
+
+#define ARITHMETIC_CASE(OP, INT, LONG, FLOAT, DOUBLE)                                                                  \
+    case binop::OP:                                                                                                    \
+        if (type == LongTypePrefix)                                                                                    \
+            builder_.make_instruction<jasm::LONG>();                                                                   \
+        else if (type == FloatTypePrefix)                                                                              \
+            builder_.make_instruction<jasm::FLOAT>();                                                                  \
+        else if (type == DoubleTypePrefix)                                                                             \
+            builder_.make_instruction<jasm::DOUBLE>();                                                                 \
+        else                                                                                                           \
+            builder_.make_instruction<jasm::INT>();                                                                    \
+        break;
+
+#define INTEGRAL_CASE(OP, INT, LONG)                                                                                   \
+    case binop::OP:                                                                                                    \
+        if (type == LongTypePrefix)                                                                                    \
+            builder_.make_instruction<jasm::LONG>();                                                                   \
+        else                                                                                                           \
+            builder_.make_instruction<jasm::INT>();                                                                    \
+        break;
+
+        switch (binary->op) {
+            ARITHMETIC_CASE(ADD, IntAdd, LongAdd, FloatAdd, DoubleAdd)
+            ARITHMETIC_CASE(SUB, IntSub, LongSub, FloatSub, DoubleSub)
+            ARITHMETIC_CASE(MUL, IntMul, LongMul, FloatMul, DoubleMul)
+            ARITHMETIC_CASE(DIV, IntDiv, LongDiv, FloatDiv, DoubleDiv)
+            ARITHMETIC_CASE(MOD, IntRem, LongRem, FloatRen, DoubleRem)
+            INTEGRAL_CASE(SHL, IntShl, LongShl)
+            INTEGRAL_CASE(SHR, IntShr, LongShr)
+            INTEGRAL_CASE(USHR, IntUShr, LongUShr)
+            INTEGRAL_CASE(AND, IntAnd, LongAnd)
+            INTEGRAL_CASE(OR, IntOr, LongOr)
+            INTEGRAL_CASE(XOR, IntXor, LongXor)
+        default:
+            assert(false);
+            break;
+        }
+
+#undef ARITHMETIC_CASE
+#undef INTEGRAL_CASE
+
+        pop(2);
+        push(binary->type);
+    }
+
+    /**
+     * Emits a comparison fused with the conditional jump. Comparisons of ints against zero use the single
+     * operand jumps, long and floating point values are compared first and the result is tested. The NaN
+     * comparisons are false, so the floating point comparison is chosen by the original operator even if the
+     * jump is negated.
+     */
+    void
+    Lowering::lower_comparison(const ir::Binary *comparison, Target &target, bool jump_if)
+    {
+        using namespace jasm::byte_code;
+        using operators::binop;
+
+        binop op = jump_if ? comparison->op : negate(comparison->op);
+        const ir::Expression *lhs = comparison->lhs;
+        const ir::Expression *rhs = comparison->rhs;
+
+        switch (lhs->type->prefix()) {
+        case ClassTypePrefix:
+        case ArrayTypePrefix:
+            lower_expression(lhs, false);
+            lower_expression(rhs, false);
+            if (op == binop::EQ)
+                builder_.make_jump<jasm::IfRefCmpEq>(target.label);
+            else
+                builder_.make_jump<jasm::IfRefCmpNe>(target.label);
+            pop(2);
+            break;
+        case LongTypePrefix:
+        case FloatTypePrefix:
+        case DoubleTypePrefix: {
+            bool less = comparison->op == binop::LT || comparison->op == binop::LTE;
+            lower_expression(lhs, false);
+            lower_expression(rhs, false);
+            if (lhs->type->prefix() == LongTypePrefix)
+                builder_.make_instruction<jasm::LongCmp>();
+            else if (lhs->type->prefix() == FloatTypePrefix && less)
+                builder_.make_instruction<jasm::FloatCmpG>();
+            else if (lhs->type->prefix() == FloatTypePrefix)
+                builder_.make_instruction<jasm::FloatCmpL>();
+            else if (less)
+                builder_.make_instruction<jasm::DoubleCmpG>();
+            else
+                builder_.make_instruction<jasm::DoubleCmpL>();
+            pop(2);
+            push(type_table_.get_int_type());
+            conditional_jump<jasm::IfEq, jasm::IfNe, jasm::IfLt, jasm::IfGe, jasm::IfGt, jasm::IfLe>(builder_, op,
+                                                                                                   target.label);
+            pop();
+            break;
+        }
+        default:
+            if (is_zero(rhs) || is_zero(lhs)) {
+                if (is_zero(lhs)) {
+                    lower_expression(rhs, false);
+                    op = exchange(op);
+                } else {
+                    lower_expression(lhs, false);
+                }
+                conditional_jump<jasm::IfEq, jasm::IfNe, jasm::IfLt, jasm::IfGe, jasm::IfGt, jasm::IfLe>(builder_, op,
+                                                                                                       target.label);
+                pop();
+                break;
+            }
+            lower_expression(lhs, false);
+            lower_expression(rhs, false);
+            conditional_jump<jasm::IfIntCmpEq, jasm::IfIntCmpNe, jasm::IfIntCmpLt, jasm::IfIntCmpGe,
+                             jasm::IfIntCmpGt, jasm::IfIntCmpLe>(builder_, op, target.label);
+            pop(2);
+            break;
+        }
+        branch(target);
+    }
+
+    /**
+     * Emits a jump to a target which is taken if a boolean expression evaluates to the given value, otherwise
+     * the code falls through. The right operands of && and || are evaluated only if they can change the result.
+     *
+     * @param jump_if value of the condition for which the jump is taken.
+     */
+    void
+    Lowering::lower_condition(const ir::Expression *condition, Target &target, bool jump_if)
+    {
+        using operators::binop;
+
+        if (condition == nullptr || !reachable_)
+            return;
+
+        if (auto *constant = ir::node_cast<ir::Constant>(condition)) {
+            if ((std::get<int_t>(constant->value) != 0) == jump_if)
+                go_to(target);
+            return;
+        }
+
+        if (auto *unary = ir::node_cast<ir::Unary>(condition); unary && unary->op == operators::unop::LNOT) {
+            lower_condition(unary->operand, target, !jump_if);
+            return;
+        }
+
+        if (auto *binary = ir::node_cast<ir::Binary>(condition); binary && is_condition(binary)) {
+            if (binary->op != binop::LAND && binary->op != binop::LOR) {
+                lower_comparison(binary, target, jump_if);
+                return;
+            }
+            // x || y jumps if either of the operands is true, x && y jumps on the first false one
+            if ((binary->op == binop::LOR) == jump_if) {
+                lower_condition(binary->lhs, target, jump_if);
+                lower_condition(binary->rhs, target, jump_if);
+            } else {
+                Target skip = create_target();
+                lower_condition(binary->lhs, skip, !jump_if);
+                lower_condition(binary->rhs, target, jump_if);
+                place(skip);
+            }
+            return;
+        }
+
+        lower_expression(condition, false);
+        if (jump_if)
+            builder_.make_jump<jasm::IfNe>(target.label);
+        else
+            builder_.make_jump<jasm::IfEq>(target.label);
+        pop();
+        branch(target);
+    }
+
+    /**
+     * Computes the value of a condition, the jumps of the condition lead to pushing either 1 or 0.
+     */
+    void
+    Lowering::lower_boolean(const ir::Expression *condition)
+    {
+        Target false_target = create_target();
+        Target end = create_target();
+        lower_condition(condition, false_target, false);
+        if (reachable_) {
+            builder_.make_instruction<jasm::IntConst1>();
+            push(condition->type);
+            go_to(end);
+        }
+        place(false_target);
+        if (reachable_) {
+            builder_.make_instruction<jasm::IntConst0>();
+            push(condition->type);
+        }
+        place(end);
+    }
+
+    /**
+     * Collects the operands of a string concatenation, nested concatenations are flattened into a single one.
+     */
+    static void
+    concatenation_operands(const ir::Expression *expr, std::vector<const ir::Expression *> &operands)
+    {
+        auto *binary = ir::node_cast<ir::Binary>(expr);
+        if (binary && is_string_type(binary->type)) {
+            concatenation_operands(binary->lhs, operands);
+            concatenation_operands(binary->rhs, operands);
+            return;
+        }
+        operands.push_back(expr);
+    }
+
+    void
+    Lowering::append_operand(const ir::Expression *operand)
+    {
+        using namespace jasm::byte_code;
+
+        lower_expression(operand, false);
+
+        TypeObs argument_type;
+        switch (operand->type->prefix()) {
+        case ByteTypePrefix:
+        case ShortTypePrefix:
+            argument_type = type_table_.get_int_type();
+            break;
+        case ClassTypePrefix:
+        case ArrayTypePrefix:
+            argument_type = is_string_type(operand->type) ? operand->type
+                                                          : type_table_.get_class_type("java/lang/Object");
+            break;
+        default:
+            argument_type = operand->type;
+            break;
+        }
+
+        ClassTypeObs builder_type = type_table_.get_class_type("java/lang/StringBuilder");
+        MethodTypeObs append_type = type_table_.get_method_type(builder_type, { argument_type });
+        jasm::u2 append_index = builder_.add_method_constant("java/lang/StringBuilder", "append", *append_type);
+        builder_.make_instruction<jasm::InvokeVirtual>(U2_SPLIT(append_index));
+        pop();
+    }
+
+    jasm::u2
+    Lowering::string_concat_factory()
+    {
+        if (string_concat_factory_)
+            return *string_concat_factory_;
+
+        ClassTypeObs string_type = type_table_.get_class_type("java/lang/String");
+        ClassTypeObs lookup_type = type_table_.get_class_type("java/lang/invoke/MethodHandles$Lookup");
+        ClassTypeObs method_type = type_table_.get_class_type("java/lang/invoke/MethodType");
+        ClassTypeObs call_site_type = type_table_.get_class_type("java/lang/invoke/CallSite");
+        TypeObs constants_type = type_table_.get_array_type(type_table_.get_class_type("java/lang/Object"), 1);
+        MethodTypeObs bootstrap_type = type_table_.get_method_type(
+          call_site_type, { lookup_type, string_type, method_type, string_type, constants_type });
+
+        jasm::u2 method_index = builder_.add_method_constant("java/lang/invoke/StringConcatFactory",
+                                                             "makeConcatWithConstants", *bootstrap_type);
+        string_concat_factory_ =
+          builder_.add_method_handle_constant(jasm::MethodHandleConstant::REF_INVOKE_STATIC, method_index);
+        return *string_concat_factory_;
+    }
+
+    /**
+     * Concatenates strings by a single invokedynamic call of StringConcatFactory.makeConcatWithConstants, no
+     * intermediate objects are created. Constant operands are a part of the recipe, only the other operands
+     * are passed to the call.
+     */
+    void
+    Lowering::lower_dynamic_concatenation(const std::vector<const ir::Expression *> &operands)
+    {
+        // the factory accepts at most 200 argument slots, longer concatenations are split into several calls
+        constexpr jasm::u2 max_argument_slots = 200;
+        ClassTypeObs string_type = type_table_.get_class_type("java/lang/String");
+
+        Name recipe;
+        std::vector<jasm::u2> constants;
+        TypeObsArray argument_types;
+        jasm::u2 argument_slots = 0;
+        auto concatenate = [&]() {
+            std::vector<jasm::u2> arguments{ builder_.add_string_constant(recipe) };
+            arguments.insert(arguments.end(), constants.begin(), constants.end());
+            jasm::u2 bootstrap_method = builder_.add_bootstrap_method(string_concat_factory(), std::move(arguments));
+            MethodTypeObs type = type_table_.get_method_type(string_type, argument_types);
+            jasm::u2 index = builder_.add_invoke_dynamic_constant(bootstrap_method, "makeConcatWithConstants", *type);
+            // the last two operands of invokedynamic are always zero
+            builder_.make_instruction<jasm::InvokeDynamic>(U2_SPLIT(index), jasm::u1(0), jasm::u1(0));
+            pop(argument_types.size());
+            push(string_type);
+        };
+
+        for (auto *operand : operands) {
+            if (auto *constant = ir::node_cast<ir::Constant>(operand)) {
+                // the tags of the recipe cannot be a part of it, such constants are passed to the bootstrap method
+                Name value = constant_to_string(*constant);
+                if (value.find_first_of("\1\2") == Name::npos) {
+                    recipe += value;
+                } else {
+                    recipe += '\2';
+                    constants.push_back(builder_.add_string_constant(value));
+                }
+                continue;
+            }
+
+            jasm::u2 slots = slot_count(operand->type);
+            if (argument_slots + slots > max_argument_slots) {
+                concatenate();
+                recipe = "\1";
+                constants.clear();
+                argument_types = { string_type };
+                argument_slots = 1;
+            }
+            lower_expression(operand, false);
+            recipe += '\1';
+            argument_types.push_back(operand->type);
+            argument_slots += slots;
+        }
+        concatenate();
+    }
+
+    void
+    Lowering::lower_concatenation(const ir::Binary *binary)
+    {
+        std::vector<const ir::Expression *> operands;
+        concatenation_operands(binary, operands);
+
+        // StringConcatFactory is available since Java 9, older targets append the operands to a StringBuilder
+        if (class_version_ >= 53) {
+            lower_dynamic_concatenation(operands);
+            return;
+        }
+
+        ClassTypeObs string_type = type_table_.get_class_type("java/lang/String");
+        MethodTypeObs constructor_type = type_table_.get_method_type(type_table_.get_void_type(), TypeObsArray());
+        MethodTypeObs to_string_type = type_table_.get_method_type(string_type, TypeObsArray());
+
+        ClassTypeObs builder_type = type_table_.get_class_type("java/lang/StringBuilder");
+        jasm::u2 class_index = builder_.add_class_constant("java/lang/StringBuilder");
+        jasm::Label new_label = builder_.create_label();
+        builder_.bind_label(new_label);
+        builder_.make_instruction<jasm::New>(U2_SPLIT(class_index));
+        builder_.make_instruction<jasm::Duplicate>();
+        push(builder_type, new_label);
+        push(builder_type, new_label);
+        jasm::u2 constructor_index =
+          builder_.add_method_constant("java/lang/StringBuilder", "<init>", *constructor_type);
+        builder_.make_instruction<jasm::InvokeSpecial>(U2_SPLIT(constructor_index));
+        pop(2);
+        push(builder_type);
+
+        for (auto *operand : operands)
+            append_operand(operand);
+
+        jasm::u2 to_string_index = builder_.add_method_constant("java/lang/StringBuilder", "toString", *to_string_type);
+        builder_.make_instruction<jasm::InvokeVirtual>(U2_SPLIT(to_string_index));
+        pop();
+        push(string_type);
+    }
+
+    /**
+     * Returns the type code of the newarray instruction creating an array of a primitive type (JVMS §6.5).
+     */
+    static jasm::u1
+    array_type_code(TypeObs element_type)
+    {
+        switch (element_type->prefix()) {
+        case jasm::byte_code::BooleanTypePrefix:
+            return 4;
+        case jasm::byte_code::CharTypePrefix:
+            return 5;
+        case jasm::byte_code::FloatTypePrefix:
+            return 6;
+        case jasm::byte_code::DoubleTypePrefix:
+            return 7;
+        case jasm::byte_code::ByteTypePrefix:
+            return 8;
+        case jasm::byte_code::ShortTypePrefix:
+            return 9;
+        case jasm::byte_code::IntTypePrefix:
+            return 10;
+        default:
+            return 11;
+        }
+    }
+
+    /**
+     * Emits the load of an array element, the array and the index are on the operand stack.
+     */
+    static void
+    array_load(jasm::ClassBuilder &builder, TypeObs element_type)
+    {
+        switch (element_type->prefix()) {
+        case jasm::byte_code::BooleanTypePrefix:
+        case jasm::byte_code::ByteTypePrefix:
+            builder.make_instruction<jasm::ByteArrayLoad>();
+            break;
+        case jasm::byte_code::CharTypePrefix:
+            builder.make_instruction<jasm::CharArrayLoad>();
+            break;
+        case jasm::byte_code::ShortTypePrefix:
+            builder.make_instruction<jasm::ShortArrayLoad>();
+            break;
+        case jasm::byte_code::IntTypePrefix:
+            builder.make_instruction<jasm::IntArrayLoad>();
+            break;
+        case jasm::byte_code::LongTypePrefix:
+            builder.make_instruction<jasm::LongArrayLoad>();
+            break;
+        case jasm::byte_code::FloatTypePrefix:
+            builder.make_instruction<jasm::FloatArrayLoad>();
+            break;
+        case jasm::byte_code::DoubleTypePrefix:
+            builder.make_instruction<jasm::DoubleArrayLoad>();
+            break;
+        default:
+            builder.make_instruction<jasm::RefArrayLoad>();
+            break;
+        }
+    }
+
+    /**
+     * Emits the store of an array element, the array, the index and the value are on the operand stack.
+     */
+    static void
+    array_store(jasm::ClassBuilder &builder, TypeObs element_type)
+    {
+        switch (element_type->prefix()) {
+        case jasm::byte_code::BooleanTypePrefix:
+        case jasm::byte_code::ByteTypePrefix:
+            builder.make_instruction<jasm::ByteArrayStore>();
+            break;
+        case jasm::byte_code::CharTypePrefix:
+            builder.make_instruction<jasm::CharArrayStore>();
+            break;
+        case jasm::byte_code::ShortTypePrefix:
+            builder.make_instruction<jasm::ShortArrayStore>();
+            break;
+        case jasm::byte_code::IntTypePrefix:
+            builder.make_instruction<jasm::IntArrayStore>();
+            break;
+        case jasm::byte_code::LongTypePrefix:
+            builder.make_instruction<jasm::LongArrayStore>();
+            break;
+        case jasm::byte_code::FloatTypePrefix:
+            builder.make_instruction<jasm::FloatArrayStore>();
+            break;
+        case jasm::byte_code::DoubleTypePrefix:
+            builder.make_instruction<jasm::DoubleArrayStore>();
+            break;
+        default:
+            builder.make_instruction<jasm::RefArrayStore>();
+            break;
+        }
+    }
+
+    void
+    Lowering::lower_arguments(const ir::ExpressionArray &arguments)
+    {
+        for (auto *argument : arguments)
+            lower_expression(argument, false);
+    }
+
+    void
+    Lowering::lower_expression(const ir::Expression *expr, bool discard)
+    {
+        // erroneous expressions have already been reported
+        if (expr == nullptr)
+            return;
+
+        jasm::u2 slots = slot_count(expr->type);
+
+        switch (expr->kind) {
+        case ir::Kind::CONSTANT:
+            if (discard)
+                return;
+            lower_constant(static_cast<const ir::Constant *>(expr));
+            return;
+        case ir::Kind::LOCAL_LOAD:
+            if (discard)
+                return;
+            load_local(static_cast<const ir::LocalLoad *>(expr)->local);
+            return;
+        case ir::Kind::LOCAL_STORE: {
+            auto *store = static_cast<const ir::LocalStore *>(expr);
+            if (lower_increment(store, discard))
+                return;
+            lower_expression(store->value, false);
+            if (!discard) {
+                if (slots == 2)
+                    builder_.make_instruction<jasm::Duplicate2>();
+                else
+                    builder_.make_instruction<jasm::Duplicate>();
+                push(expr->type);
+            }
+            store_local(store->local);
+            return;
+        }
+        case ir::Kind::STATIC_FIELD_LOAD: {
+            auto *load = static_cast<const ir::StaticFieldLoad *>(expr);
+            jasm::u2 field_index = builder_.add_field_constant(load->class_name, load->field_name, *load->type);
+            // the load may initialise the class, so it is not removed even if the value is not used
+            builder_.make_instruction<jasm::GetStatic>(U2_SPLIT(field_index));
+            push(expr->type);
+            break;
+        }
+        case ir::Kind::STATIC_FIELD_STORE: {
+            auto *store = static_cast<const ir::StaticFieldStore *>(expr);
+            lower_expression(store->value, false);
+            if (!discard) {
+                if (slots == 2)
+                    builder_.make_instruction<jasm::Duplicate2>();
+                else
+                    builder_.make_instruction<jasm::Duplicate>();
+                push(expr->type);
+            }
+            jasm::u2 field_index = builder_.add_field_constant(store->class_name, store->field_name, *store->type);
+            builder_.make_instruction<jasm::PutStatic>(U2_SPLIT(field_index));
+            pop();
+            return;
+        }
+        case ir::Kind::FIELD_LOAD: {
+            auto *load = static_cast<const ir::FieldLoad *>(expr);
+            lower_expression(load->object, false);
+            jasm::u2 field_index = builder_.add_field_constant(load->class_name, load->field_name, *load->type);
+            // the load of a field of a null reference fails, so it is not removed even if the value is not used
+            builder_.make_instruction<jasm::GetField>(U2_SPLIT(field_index));
+            pop();
+            push(expr->type);
+            break;
+        }
+        case ir::Kind::FIELD_STORE: {
+            auto *store = static_cast<const ir::FieldStore *>(expr);
+            lower_expression(store->object, false);
+            lower_expression(store->value, false);
+            if (!discard) {
+                // the value is kept below the object
+                if (slots == 2)
+                    builder_.make_instruction<jasm::Duplicate2X1>();
+                else
+                    builder_.make_instruction<jasm::DuplicateX1>();
+                pop(2);
+                push(expr->type);
+                push(store->object->type);
+                push(expr->type);
+            }
+            jasm::u2 field_index = builder_.add_field_constant(store->class_name, store->field_name, *store->type);
+            builder_.make_instruction<jasm::PutField>(U2_SPLIT(field_index));
+            pop(2);
+            return;
+        }
+        case ir::Kind::INVOKE: {
+            auto *invoke = static_cast<const ir::Invoke *>(expr);
+            if (const ir::Method *callee = inline_candidate(invoke)) {
+                lower_inline(invoke, *callee);
+                break;
+            }
+            jasm::u2 method_index =
+              invoke->dispatch == ir::Invoke::INTERFACE
+                ? builder_.add_interface_method_constant(invoke->class_name, invoke->method_name, *invoke->method_type)
+                : builder_.add_method_constant(invoke->class_name, invoke->method_name, *invoke->method_type);
+
+            std::size_t input_entries = invoke->arguments.size();
+            if (invoke->dispatch != ir::Invoke::STATIC) {
+                lower_expression(invoke->receiver, false);
+                input_entries += 1;
+            }
+            lower_arguments(invoke->arguments);
+
+            switch (invoke->dispatch) {
+            case ir::Invoke::STATIC:
+                builder_.make_instruction<jasm::InvokeStatic>(U2_SPLIT(method_index));
+                break;
+            case ir::Invoke::VIRTUAL:
+                builder_.make_instruction<jasm::InvokeVirtual>(U2_SPLIT(method_index));
+                break;
+            case ir::Invoke::SPECIAL:
+                builder_.make_instruction<jasm::InvokeSpecial>(U2_SPLIT(method_index));
+                break;
+            case ir::Invoke::INTERFACE: {
+                // the count operand is the number of argument slots including the receiver
+                jasm::u1 count = 1;
+                for (TypeObs type : invoke->method_type->argument_types())
+                    count += slot_count(type);
+                builder_.make_instruction<jasm::InvokeInterface>(U2_SPLIT(method_index), count, jasm::u1(0));
+                break;
+            }
+            }
+            pop(input_entries);
+            if (slots > 0)
+                push(expr->type);
+            break;
+        }
+        case ir::Kind::NEW: {
+            auto *instantiation = static_cast<const ir::New *>(expr);
+            auto class_type = dynamic_cast<ClassTypeObs>(instantiation->type);
+            assert(class_type != nullptr);
+
+            // the frames within the arguments refer to the uninitialised object by the label of the new instruction
+            jasm::u2 class_index = builder_.add_class_constant(class_type->class_name());
+            jasm::Label new_label = builder_.create_label();
+            builder_.bind_label(new_label);
+            builder_.make_instruction<jasm::New>(U2_SPLIT(class_index));
+            push(class_type, new_label);
+            if (!discard) {
+                builder_.make_instruction<jasm::Duplicate>();
+                push(class_type, new_label);
+            }
+
+            lower_arguments(instantiation->arguments);
+
+            jasm::u2 constructor_index =
+              builder_.add_method_constant(class_type->class_name(), "<init>", *instantiation->constructor_type);
+            builder_.make_instruction<jasm::InvokeSpecial>(U2_SPLIT(constructor_index));
+            pop(1 + instantiation->arguments.size());
+            if (!discard) {
+                pop();
+                push(class_type);
+            }
+            return;
+        }
+        case ir::Kind::NEW_ARRAY: {
+            auto array_type = dynamic_cast<ArrayTypeObs>(expr->type);
+            assert(array_type != nullptr);
+            lower_expression(static_cast<const ir::NewArray *>(expr)->length, false);
+            if (array_type->dimension() > 1) {
+                // array classes are named by their descriptors
+                TypeObs element_type =
+                  type_table_.get_array_type(array_type->element_type(), array_type->dimension() - 1);
+                jasm::u2 class_index = builder_.add_class_constant(element_type->descriptor());
+                builder_.make_instruction<jasm::RefNewArray>(U2_SPLIT(class_index));
+            } else if (auto class_type = dynamic_cast<ClassTypeObs>(array_type->element_type())) {
+                jasm::u2 class_index = builder_.add_class_constant(class_type->class_name());
+                builder_.make_instruction<jasm::RefNewArray>(U2_SPLIT(class_index));
+            } else {
+                builder_.make_instruction<jasm::NewArray>(array_type_code(array_type->element_type()));
+            }
+            pop();
+            push(expr->type);
+            break;
+        }
+        case ir::Kind::ARRAY_LOAD: {
+            auto *load = static_cast<const ir::ArrayLoad *>(expr);
+            lower_expression(load->array, false);
+            lower_expression(load->index, false);
+            // the load may fail, so it is not removed even if the value is not used
+            array_load(builder_, expr->type);
+            pop(2);
+            push(expr->type);
+            break;
+        }
+        case ir::Kind::ARRAY_STORE: {
+            auto *store = static_cast<const ir::ArrayStore *>(expr);
+            lower_expression(store->array, false);
+            lower_expression(store->index, false);
+            lower_expression(store->value, false);
+            if (!discard) {
+                // the value is kept below the array and the index
+                if (slots == 2)
+                    builder_.make_instruction<jasm::Duplicate2X2>();
+                else
+                    builder_.make_instruction<jasm::DuplicateX2>();
+                pop(3);
+                push(expr->type);
+                push(store->array->type);
+                push(store->index->type);
+                push(expr->type);
+            }
+            array_store(builder_, expr->type);
+            pop(3);
+            return;
+        }
+        case ir::Kind::ARRAY_LENGTH:
+            lower_expression(static_cast<const ir::ArrayLength *>(expr)->array, false);
+            builder_.make_instruction<jasm::ArrayLength>();
+            pop();
+            push(expr->type);
+            break;
+        case ir::Kind::CONVERT: {
+            auto *convert = static_cast<const ir::Convert *>(expr);
+            lower_expression(convert->operand, false);
+            lower_conversion(convert->operand->type, convert->type);
+            break;
+        }
+        case ir::Kind::UNARY:
+            lower_unary(static_cast<const ir::Unary *>(expr));
+            break;
+        case ir::Kind::BINARY:
+            lower_binary(static_cast<const ir::Binary *>(expr));
+            break;
+        case ir::Kind::POSTFIX_UPDATE: {
+            auto *update = static_cast<const ir::PostfixUpdate *>(expr);
+            if (!discard)
+                lower_expression(update->old_value, false);
+            lower_expression(update->update, true);
+            return;
+        }
+        default:
+            assert(false);
+            return;
+        }
+
+        if (discard && slots > 0) {
+            if (slots == 2)
+                builder_.make_instruction<jasm::Pop2>();
+            else
+                builder_.make_instruction<jasm::Pop>();
+            pop();
+        }
+    }
+
+    /**
+     * Computes String.hashCode of a string, the hash is computed from the UTF-16 code units of the string.
+     */
+    static int32_t
+    string_hash_code(const Name &str)
+    {
+        uint32_t hash = 0;
+        for (std::size_t i = 0; i < str.size();) {
+            auto byte = static_cast<unsigned char>(str[i]);
+            uint32_t code_point;
+            std::size_t length;
+            if (byte < 0x80) {
+                code_point = byte;
+                length = 1;
+            } else if ((byte & 0xE0) == 0xC0) {
+                code_point = byte & 0x1F;
+                length = 2;
+            } else if ((byte & 0xF0) == 0xE0) {
+                code_point = byte & 0x0F;
+                length = 3;
+            } else {
+                code_point = byte & 0x07;
+                length = 4;
+            }
+            for (std::size_t j = 1; j < length && i + j < str.size(); ++j)
+                code_point = (code_point << 6) | (static_cast<unsigned char>(str[i + j]) & 0x3F);
+            i += length;
+
+            if (code_point >= 0x10000) {
+                code_point -= 0x10000;
+                hash = 31 * hash + (0xD800 + (code_point >> 10));
+                hash = 31 * hash + (0xDC00 + (code_point & 0x3FF));
+            } else {
+                hash = 31 * hash + code_point;
+            }
+        }
+        return static_cast<int32_t>(hash);
+    }
+
+    /**
+     * Emits tableswitch or lookupswitch using the cost model of javac, the time cost counts three times as much
+     * as the space cost. Tableswitch is chosen for dense cases, the lookup in a sparse table is a search.
+     */
+    void
+    Lowering::lower_switch_instruction(std::vector<std::pair<int32_t, Target *>> cases, Target &default_target)
+    {
+        pop();
+        jump(default_target);
+        for (auto &switch_case : cases)
+            jump(*switch_case.second);
+        reachable_ = false;
+
+        std::sort(cases.begin(), cases.end(), [](auto &lhs, auto &rhs) { return lhs.first < rhs.first; });
+        if (!cases.empty()) {
+            int64_t low = cases.front().first;
+            int64_t high = cases.back().first;
+            int64_t table_space_cost = 4 + (high - low + 1);
+            int64_t table_time_cost = 3;
+            int64_t lookup_space_cost = 3 + 2 * static_cast<int64_t>(cases.size());
+            int64_t lookup_time_cost = static_cast<int64_t>(cases.size());
+            if (table_space_cost + 3 * table_time_cost <= lookup_space_cost + 3 * lookup_time_cost) {
+                std::vector<jasm::Label> labels(high - low + 1, default_target.label);
+                for (auto &switch_case : cases)
+                    labels[switch_case.first - low] = switch_case.second->label;
+                builder_.make_instruction<jasm::TableSwitch>(static_cast<int32_t>(low), default_target.label,
+                                                             std::move(labels));
+                return;
+            }
+        }
+
+        std::vector<std::pair<int32_t, jasm::Label>> pairs;
+        for (auto &switch_case : cases)
+            pairs.emplace_back(switch_case.first, switch_case.second->label);
+        builder_.make_instruction<jasm::LookupSwitch>(default_target.label, std::move(pairs));
+    }
+
+    /**
+     * Dispatches a string switch on the hash code of the selector, then the selector is compared with the strings
+     * sharing the hash code and a match jumps straight to its case. The selector stays on the operand stack until
+     * the comparisons are done.
+     */
+    void
+    Lowering::lower_string_dispatch(const ir::Switch *stmt, const std::vector<Target *> &case_targets,
+                                    Target &default_target)
+    {
+        ClassTypeObs string_type = type_table_.get_class_type("java/lang/String");
+        ClassTypeObs object_type = type_table_.get_class_type("java/lang/Object");
+
+        builder_.make_instruction<jasm::Duplicate>();
+        push(string_type);
+        MethodTypeObs hash_code_type = type_table_.get_method_type(type_table_.get_int_type(), {});
+        jasm::u2 hash_code_index = builder_.add_method_constant("java/lang/String", "hashCode", *hash_code_type);
+        builder_.make_instruction<jasm::InvokeVirtual>(U2_SPLIT(hash_code_index));
+        pop();
+        push(type_table_.get_int_type());
+
+        std::map<int32_t, std::vector<std::size_t>> buckets;
+        for (std::size_t i = 0; i < stmt->cases.size(); ++i)
+            buckets[string_hash_code(std::get<Name>(stmt->cases[i].value->value))].push_back(i);
+
+        std::vector<Target> bucket_targets;
+        bucket_targets.reserve(buckets.size());
+        std::vector<std::pair<int32_t, Target *>> hashes;
+        for (auto &bucket : buckets) {
+            bucket_targets.push_back(create_target());
+            hashes.emplace_back(bucket.first, &bucket_targets.back());
+        }
+        Target no_match = create_target();
+        lower_switch_instruction(std::move(hashes), no_match);
+
+        MethodTypeObs equals_type = type_table_.get_method_type(type_table_.get_boolean_type(), { object_type });
+        jasm::u2 equals_index = builder_.add_method_constant("java/lang/String", "equals", *equals_type);
+        auto bucket_target = bucket_targets.begin();
+        for (auto &bucket : buckets) {
+            place(*bucket_target++);
+            for (std::size_t i = 0; i < bucket.second.size(); ++i) {
+                std::size_t case_index = bucket.second[i];
+                bool last = i + 1 == bucket.second.size();
+                Target next = last ? Target{} : create_target();
+                Target &mismatch = last ? no_match : next;
+
+                builder_.make_instruction<jasm::Duplicate>();
+                push(string_type);
+                lower_constant(stmt->cases[case_index].value);
+                builder_.make_instruction<jasm::InvokeVirtual>(U2_SPLIT(equals_index));
+                pop(2);
+                push(type_table_.get_boolean_type());
+                builder_.make_jump<jasm::IfEq>(mismatch.label);
+                pop();
+                branch(mismatch);
+                builder_.make_instruction<jasm::Pop>();
+                pop();
+                go_to(*case_targets[case_index]);
+                if (!last)
+                    place(next);
+            }
+        }
+
+        place(no_match);
+        builder_.make_instruction<jasm::Pop>();
+        pop();
+        go_to(default_target);
+    }
+
+    void
+    Lowering::lower_switch(const ir::Switch *stmt)
+    {
+        std::size_t statement_count = stmt->statements.size();
+        Target end = create_target();
+        std::map<std::size_t, Target> targets;
+        // labels following the last statement of the switch block refer to the end of the switch
+        auto target_of = [&](std::size_t index) -> Target & {
+            if (index >= statement_count)
+                return end;
+            auto search = targets.find(index);
+            if (search == targets.end())
+                search = targets.emplace(index, create_target()).first;
+            return search->second;
+        };
+
+        std::vector<Target *> case_targets;
+        for (auto &switch_case : stmt->cases)
+            case_targets.push_back(&target_of(switch_case.target));
+        Target &default_target = stmt->default_target ? target_of(*stmt->default_target) : end;
+
+        lower_expression(stmt->selector, false);
+        if (is_string_type(stmt->selector->type)) {
+            lower_string_dispatch(stmt, case_targets, default_target);
+        } else {
+            std::vector<std::pair<int32_t, Target *>> cases;
+            for (std::size_t i = 0; i < stmt->cases.size(); ++i)
+                cases.emplace_back(std::get<int_t>(stmt->cases[i].value->value), case_targets[i]);
+            lower_switch_instruction(std::move(cases), default_target);
+        }
+
+        break_targets_.push_back(&end);
+        for (std::size_t i = 0; i < statement_count; ++i) {
+            auto search = targets.find(i);
+            if (search != targets.end())
+                place(search->second);
+            // unreachable statements are not emitted, the verifier would require a frame for them
+            if (reachable_)
+                lower_statement(stmt->statements[i]);
+        }
+        break_targets_.pop_back();
+        place(end);
+    }
+
+    static void
+    collect_stores(const ir::Node *node, std::vector<const ir::Local *> &stores)
+    {
+        if (auto *store = ir::node_cast<ir::LocalStore>(node))
+            stores.push_back(store->local);
+        else if (auto *sync = ir::node_cast<ir::Synchronized>(node))
+            stores.push_back(sync->local);
+        ir::for_each_child(node, [&stores](auto *child) { collect_stores(child, stores); });
+    }
+
+    /**
+     * Returns the frame at the head of a loop entered from the current point of the code. The head is reached by the
+     * backward jumps as well, so the slots whose type may be changed by the stores in the loop are left out.
+     * The frame of an exception handler is derived the same way from the statement it protects.
+     */
+    Lowering::Frame
+    Lowering::loop_frame(const ir::Statement *stmt) const
+    {
+        std::vector<const ir::Local *> stores;
+        collect_stores(stmt, stores);
+
+        TypeObsArray locals = locals_;
+        for (auto *local : stores) {
+            std::size_t index = slot(local);
+            if (index > 0 && index - 1 < locals.size() && locals[index - 1] != nullptr &&
+                slot_count(locals[index - 1]) == 2)
+                locals[index - 1] = nullptr;
+            if (index < locals.size() && locals[index] != local->type)
+                locals[index] = nullptr;
+            if (slot_count(local->type) == 2 && index + 1 < locals.size())
+                locals[index + 1] = nullptr;
+        }
+        return Frame{ std::move(locals), stack_ };
+    }
+
+    /**
+     * Emits a loop with the condition at the bottom, a loop tested first is entered by a jump to the condition.
+     * Each iteration then takes a single conditional jump back to the head.
+     */
+    void
+    Lowering::lower_loop(const ir::Loop *loop)
+    {
+        auto *constant = ir::node_cast<ir::Constant>(loop->condition);
+        bool endless = constant && std::get<int_t>(constant->value);
+        if (loop->test_first && constant && !endless)
+            return;
+
+        Target head = create_target();
+        Target next = create_target();
+        Target exit = create_target();
+        std::optional<Target> test;
+        head.frame = loop_frame(loop);
+        if (loop->test_first && !endless) {
+            test = create_target();
+            go_to(*test);
+        }
+        place(head);
+
+        break_targets_.push_back(&exit);
+        continue_targets_.push_back(&next);
+        if (loop->body != nullptr)
+            lower_statement(loop->body);
+        continue_targets_.pop_back();
+        break_targets_.pop_back();
+
+        place(next);
+        for (auto *update : loop->update) {
+            if (reachable_)
+                lower_statement(update);
+        }
+        if (test)
+            place(*test);
+        if (reachable_) {
+            if (endless)
+                go_to(head);
+            else
+                lower_condition(loop->condition, head, true);
+        }
+        place(exit);
+    }
+
+    /**
+     * Releases the monitors entered since a given number of them was held, the innermost first. The monitors stay
+     * held by the code following the jump or return which leaves them.
+     */
+    void
+    Lowering::release_monitors(std::size_t held)
+    {
+        for (std::size_t i = monitors_.size(); i > held; --i) {
+            load_local(monitors_[i - 1]);
+            builder_.make_instruction<jasm::MonitorExit>();
+            pop();
+        }
+    }
+
+    /**
+     * Holds the monitor of the lock while the body runs. The monitor is released at the end of the body, by the
+     * jumps and returns out of it and by a handler of any exception thrown in the body, which rethrows it.
+     */
+    void
+    Lowering::lower_synchronized(const ir::Synchronized *stmt)
+    {
+        lower_expression(stmt->lock, false);
+        builder_.make_instruction<jasm::Duplicate>();
+        push(stmt->local->type);
+        store_local(stmt->local);
+        builder_.make_instruction<jasm::MonitorEnter>();
+        pop();
+
+        jasm::Label start = builder_.create_label();
+        jasm::Label end = builder_.create_label();
+        Target handler = create_target();
+        Target exit = create_target();
+        // the handler is entered with just the exception on the operand stack
+        handler.frame = loop_frame(stmt);
+        handler.frame->stack = { StackEntry{ type_table_.get_class_type("java/lang/Throwable"), std::nullopt } };
+
+        builder_.bind_label(start);
+        monitors_.push_back(stmt->local);
+        if (stmt->body != nullptr)
+            lower_statement(stmt->body);
+        if (reachable_)
+            release_monitors(monitors_.size() - 1);
+        monitors_.pop_back();
+        builder_.bind_label(end);
+        if (reachable_)
+            go_to(exit);
+        builder_.add_exception_handler(start, end, handler.label);
+
+        place(handler);
+        load_local(stmt->local);
+        builder_.make_instruction<jasm::MonitorExit>();
+        pop();
+        builder_.make_instruction<jasm::RefThrow>();
+        pop();
+        reachable_ = false;
+        place(exit);
+    }
+
+    void
+    Lowering::lower_statement(const ir::Statement *stmt)
+    {
+        switch (stmt->kind) {
+        case ir::Kind::EXPRESSION_STATEMENT:
+            lower_expression(static_cast<const ir::ExpressionStatement *>(stmt)->expression, true);
+            break;
+        case ir::Kind::RETURN: {
+            const ir::Expression *value = static_cast<const ir::Return *>(stmt)->value;
+            if (inline_exit_ != nullptr) {
+                lower_inline_return(value);
+                release_monitors(inline_exit_->monitors);
+                go_to(*inline_exit_);
+                break;
+            }
+            if (value == nullptr) {
+                release_monitors(0);
+                builder_.make_instruction<jasm::Return>();
+                reachable_ = false;
+                break;
+            }
+            lower_expression(value, false);
+            // the returned value stays on the operand stack while the monitors are released
+            release_monitors(0);
+            switch (value->type->prefix()) {
+            case jasm::byte_code::LongTypePrefix:
+                builder_.make_instruction<jasm::LongReturn>();
+                break;
+            case jasm::byte_code::FloatTypePrefix:
+                builder_.make_instruction<jasm::FloatReturn>();
+                break;
+            case jasm::byte_code::DoubleTypePrefix:
+                builder_.make_instruction<jasm::DoubleReturn>();
+                break;
+            case jasm::byte_code::ClassTypePrefix:
+            case jasm::byte_code::ArrayTypePrefix:
+                builder_.make_instruction<jasm::RefReturn>();
+                break;
+            default:
+                builder_.make_instruction<jasm::IntReturn>();
+                break;
+            }
+            pop();
+            reachable_ = false;
+            break;
+        }
+        case ir::Kind::BLOCK:
+            for (auto *inner : static_cast<const ir::Block *>(stmt)->statements) {
+                // unreachable statements are not emitted, the verifier would require a frame for them
+                if (!reachable_)
+                    break;
+                lower_statement(inner);
+            }
+            break;
+        case ir::Kind::IF: {
+            auto *if_stmt = static_cast<const ir::If *>(stmt);
+            // only the branch selected by a constant condition is emitted
+            if (auto *constant = ir::node_cast<ir::Constant>(if_stmt->condition)) {
+                const ir::Statement *live =
+                  std::get<int_t>(constant->value) ? if_stmt->then_statement : if_stmt->else_statement;
+                if (live != nullptr)
+                    lower_statement(live);
+                break;
+            }
+            Target else_target = create_target();
+            lower_condition(if_stmt->condition, else_target, false);
+            if (reachable_ && if_stmt->then_statement)
+                lower_statement(if_stmt->then_statement);
+            if (if_stmt->else_statement == nullptr) {
+                place(else_target);
+                break;
+            }
+            Target end = create_target();
+            if (reachable_)
+                go_to(end);
+            place(else_target);
+            if (reachable_)
+                lower_statement(if_stmt->else_statement);
+            place(end);
+            break;
+        }
+        case ir::Kind::SWITCH:
+            lower_switch(static_cast<const ir::Switch *>(stmt));
+            break;
+        case ir::Kind::LOOP:
+            lower_loop(static_cast<const ir::Loop *>(stmt));
+            break;
+        case ir::Kind::BREAK:
+            assert(!break_targets_.empty());
+            release_monitors(break_targets_.back()->monitors);
+            go_to(*break_targets_.back());
+            break;
+        case ir::Kind::CONTINUE:
+            assert(!continue_targets_.empty());
+            release_monitors(continue_targets_.back()->monitors);
+            go_to(*continue_targets_.back());
+            break;
+        case ir::Kind::SYNCHRONIZED:
+            lower_synchronized(static_cast<const ir::Synchronized *>(stmt));
+            break;
+        default:
+            assert(false);
+            break;
+        }
+    }
+
+    /**
+     * Returns the number of the local variable slots of a method including the parameters.
+     */
+    static jasm::u2
+    locals_limit(const ir::Method &method)
+    {
+        jasm::u2 limit = method.access_flags & jasm::Method::ACC_STATIC ? 0 : 1;
+        for (auto *argument_type : method.type->argument_types())
+            limit += slot_count(argument_type);
+        return std::max(limit, method.locals_limit);
+    }
+
+    /**
+     * Estimates the length of the byte code of a statement or an expression, the estimate errs on the larger side.
+     * Switches, loops and synchronized statements are never considered small.
+     */
+    static std::size_t
+    estimated_size(const ir::Node *node)
+    {
+        if (node == nullptr)
+            return 0;
+
+        switch (node->kind) {
+        case ir::Kind::CONSTANT:
+            return 3;
+        case ir::Kind::LOCAL_LOAD:
+            return 2;
+        case ir::Kind::LOCAL_STORE:
+            return estimated_size(static_cast<const ir::LocalStore *>(node)->value) + 3;
+        case ir::Kind::STATIC_FIELD_LOAD:
+            return 3;
+        case ir::Kind::STATIC_FIELD_STORE:
+            return estimated_size(static_cast<const ir::StaticFieldStore *>(node)->value) + 4;
+        case ir::Kind::FIELD_LOAD:
+            return estimated_size(static_cast<const ir::FieldLoad *>(node)->object) + 3;
+        case ir::Kind::FIELD_STORE: {
+            auto *store = static_cast<const ir::FieldStore *>(node);
+            return estimated_size(store->object) + estimated_size(store->value) + 4;
+        }
+        case ir::Kind::INVOKE: {
+            auto *invoke = static_cast<const ir::Invoke *>(node);
+            std::size_t size = estimated_size(invoke->receiver) + 3;
+            for (auto *argument : invoke->arguments)
+                size += estimated_size(argument);
+            return size;
+        }
+        case ir::Kind::NEW: {
+            std::size_t size = 7;
+            for (auto *argument : static_cast<const ir::New *>(node)->arguments)
+                size += estimated_size(argument);
+            return size;
+        }
+        case ir::Kind::NEW_ARRAY:
+            return estimated_size(static_cast<const ir::NewArray *>(node)->length) + 3;
+        case ir::Kind::ARRAY_LOAD: {
+            auto *load = static_cast<const ir::ArrayLoad *>(node);
+            return estimated_size(load->array) + estimated_size(load->index) + 1;
+        }
+        case ir::Kind::ARRAY_STORE: {
+            auto *store = static_cast<const ir::ArrayStore *>(node);
+            return estimated_size(store->array) + estimated_size(store->index) + estimated_size(store->value) + 2;
+        }
+        case ir::Kind::ARRAY_LENGTH:
+            return estimated_size(static_cast<const ir::ArrayLength *>(node)->array) + 1;
+        case ir::Kind::CONVERT:
+            return estimated_size(static_cast<const ir::Convert *>(node)->operand) + 1;
+        case ir::Kind::UNARY:
+            return estimated_size(static_cast<const ir::Unary *>(node)->operand) + 2;
+        case ir::Kind::BINARY: {
+            auto *binary = static_cast<const ir::Binary *>(node);
+            // conditions and concatenations take several instructions
+            std::size_t size = is_condition(binary) || is_string_type(binary->type) ? 8 : 1;
+            return estimated_size(binary->lhs) + estimated_size(binary->rhs) + size;
+        }
+        case ir::Kind::POSTFIX_UPDATE: {
+            auto *update = static_cast<const ir::PostfixUpdate *>(node);
+            return estimated_size(update->old_value) + estimated_size(update->update);
+        }
+        case ir::Kind::EXPRESSION_STATEMENT:
+            return estimated_size(static_cast<const ir::ExpressionStatement *>(node)->expression) + 1;
+        case ir::Kind::RETURN:
+            return estimated_size(static_cast<const ir::Return *>(node)->value) + 3;
+        case ir::Kind::BLOCK: {
+            std::size_t size = 0;
+            for (auto *statement : static_cast<const ir::Block *>(node)->statements)
+                size += estimated_size(statement);
+            return size;
+        }
+        case ir::Kind::IF: {
+            auto *if_stmt = static_cast<const ir::If *>(node);
+            return estimated_size(if_stmt->condition) + estimated_size(if_stmt->then_statement) +
+                   estimated_size(if_stmt->else_statement) + 6;
+        }
+        case ir::Kind::BREAK:
+            return 3;
+        default:
+            return std::numeric_limits<std::size_t>::max() / 2;
+        }
+    }
+
+    void
+    Lowering::enable_inlining(const ir::Class &ir_class)
+    {
+        // the default limit of the byte code size of the methods inlined by HotSpot regardless of their use
+        constexpr std::size_t max_inline_size = 35;
+
+        for (auto *method : ir_class.methods) {
+            if (method->body == nullptr || method->name == "<init>")
+                continue;
+            // only the calls which cannot be overridden are bound at compile time
+            if (!(method->access_flags &
+                  (jasm::Method::ACC_STATIC | jasm::Method::ACC_PRIVATE | jasm::Method::ACC_FINAL)))
+                continue;
+            if (method->access_flags & jasm::Method::ACC_SYNCHRONIZED)
+                continue;
+            if (estimated_size(method->body) > max_inline_size)
+                continue;
+            inline_candidates_.emplace(std::make_pair(method->name, method->type), method);
+        }
+    }
+
+    /**
+     * Finds the method called by an invocation if the call can be inlined. The inlined bodies are not inlined
+     * into again.
+     */
+    const ir::Method *
+    Lowering::inline_candidate(const ir::Invoke *invoke) const
+    {
+        if (inline_exit_ != nullptr || invoke->class_name != builder_.class_name())
+            return nullptr;
+        auto search = inline_candidates_.find(std::make_pair(invoke->method_name, invoke->method_type));
+        if (search == inline_candidates_.end())
+            return nullptr;
+        bool static_method = search->second->access_flags & jasm::Method::ACC_STATIC;
+        if (static_method != (invoke->dispatch == ir::Invoke::STATIC))
+            return nullptr;
+        return search->second;
+    }
+
+    /**
+     * Expands a call in place. The arguments are stored to the local variables following the ones of the caller,
+     * the returns of the callee jump to the end of the expanded body with the returned value on the operand stack.
+     */
+    void
+    Lowering::lower_inline(const ir::Invoke *invoke, const ir::Method &callee)
+    {
+        LOG_DEBUG("inlining method ", callee.name);
+        if (invoke->dispatch != ir::Invoke::STATIC) {
+            // a call on a null reference still has to fail, even if the body does not use the receiver
+            lower_expression(invoke->receiver, false);
+            if (callee.receiver != nullptr) {
+                builder_.make_instruction<jasm::Duplicate>();
+                push(invoke->receiver->type);
+            }
+            MethodTypeObs get_class_type =
+              type_table_.get_method_type(type_table_.get_class_type("java/lang/Class"), TypeObsArray());
+            jasm::u2 get_class_index = builder_.add_method_constant("java/lang/Object", "getClass", *get_class_type);
+            builder_.make_instruction<jasm::InvokeVirtual>(U2_SPLIT(get_class_index));
+            builder_.make_instruction<jasm::Pop>();
+            pop();
+        }
+        lower_arguments(invoke->arguments);
+
+        local_base_ = inline_base_;
+        for (auto parameter = callee.parameters.rbegin(); parameter != callee.parameters.rend(); ++parameter)
+            store_local(*parameter);
+        if (invoke->dispatch != ir::Invoke::STATIC && callee.receiver != nullptr)
+            store_local(callee.receiver);
+        locals_limit_ = std::max<jasm::u2>(locals_limit_, inline_base_ + locals_limit(callee));
+
+        Target exit = create_target();
+        inline_exit_ = &exit;
+        inline_return_type_ = callee.type->return_type();
+        const ir::StatementArray &statements = callee.body->statements;
+        for (std::size_t i = 0; i < statements.size() && reachable_; ++i) {
+            // the last return falls through to the end of the body
+            auto *last_return = i + 1 == statements.size() ? ir::node_cast<ir::Return>(statements[i]) : nullptr;
+            if (last_return != nullptr)
+                lower_inline_return(last_return->value);
+            else
+                lower_statement(statements[i]);
+        }
+        inline_exit_ = nullptr;
+        local_base_ = 0;
+
+        // a frame is needed only if there are any jumps to the end
+        if (exit.frame || !reachable_)
+            place(exit);
+        else
+            builder_.bind_label(exit.label);
+        if (locals_.size() > inline_base_)
+            locals_.resize(inline_base_);
+    }
+
+    /**
+     * Leaves the value returned by an inlined method on the operand stack.
+     */
+    void
+    Lowering::lower_inline_return(const ir::Expression *value)
+    {
+        if (value == nullptr)
+            return;
+        lower_expression(value, false);
+        // the entries at the end of the body agree for all the returns
+        pop();
+        push(inline_return_type_);
+    }
+
+    void
+    Lowering::lower_method(const ir::Method &method)
+    {
+        LOG_DEBUG("lowering method ", method.name);
+        depth_ = 0;
+        max_depth_ = 0;
+        stack_.clear();
+        reachable_ = true;
+        break_targets_.clear();
+        continue_targets_.clear();
+        monitors_.clear();
+        locals_limit_ = locals_limit(method);
+        inline_base_ = locals_limit_;
+
+        // the receiver is left out of the frames of the methods which do not refer to it
+        locals_.assign(method.access_flags & jasm::Method::ACC_STATIC ? 0 : 1, nullptr);
+        if (method.receiver != nullptr)
+            locals_[0] = method.receiver->type;
+        for (auto *parameter : method.parameters) {
+            locals_.resize(parameter->index + slot_count(parameter->type), nullptr);
+            locals_[parameter->index] = parameter->type;
+        }
+
+        builder_.enter_method(method.name, *method.type, method.access_flags);
+        if (method.body != nullptr) {
+            lower_statement(method.body);
+            if (reachable_ && slot_count(method.type->return_type()) == 0)
+                builder_.make_instruction<jasm::Return>();
+        }
+        builder_.leave_method();
+
+        if (jasm::CodeAttribute *code = builder_.current_code()) {
+            code->set_stack_limit(max_depth_);
+            code->set_locals_limit(locals_limit_);
+        }
+    }
+
+}
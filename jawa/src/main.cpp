@@ -9,14 +9,47 @@
  */
 #include "context.hpp"
 #include "parser.hpp"
+#include <filesystem>
 #include <iostream>
 
+YY_DECL;
+
 using namespace jawa;
 
 void
 show_usage(const char *name)
 {
-    std::cerr << "usage: " << name << " [--ścieżkaklasy ŚCIEŻKAKLASY] <PLIK_ŹRÓDŁOWY ...>" << std::endl;
+    std::cerr << "usage: " << name
+              << " [--ścieżkaklasy ŚCIEŻKAKLASY] [--tylko-składnia] [--zatrzymaj-po=FAZA] [--wersja-klasy=WERSJA]"
+                 " [--wstawiaj-metody] [--czas] <PLIK_ŹRÓDŁOWY ...>"
+              << std::endl;
+    std::cerr << "  --tylko-składnia      zatrzyma się po analizie składniowej, nie generuje kodu" << std::endl;
+    std::cerr << "  --zatrzymaj-po=FAZA   zatrzyma się po fazie leksykalna, składnia, generowanie lub emisja"
+              << std::endl;
+    std::cerr << "  --wersja-klasy=WERSJA wersja plików klas od 50 (Java 6) do 59 (Java 15), domyślnie 59"
+              << std::endl;
+    std::cerr << "  --wstawiaj-metody     wstawi krótkie metody statyczne, prywatne i finalne do miejsc wywołań"
+              << std::endl;
+    std::cerr << "  --czas                wypisze czas spędzony w poszczególnych fazach" << std::endl;
+}
+
+/**
+ * Parses a phase after which the compiler stops.
+ *
+ * @param name phase name.
+ * @param phase parsed phase.
+ * @return true if the name is a valid phase.
+ */
+static bool
+parse_phase(const char *name, Phase &phase)
+{
+    for (Phase candidate : { Phase::LEXING, Phase::PARSING, Phase::GENERATION, Phase::EMISSION }) {
+        if (strcmp(name, phase_name(candidate)) == 0) {
+            phase = candidate;
+            return true;
+        }
+    }
+    return false;
 }
 
 int
@@ -29,6 +62,12 @@ main(int argc, char *argv[])
 
     const char *classpath = ".";
     std::vector<const char *> sources;
+    Phase stop_after = Phase::EMISSION;
+    jasm::u2 class_version = 59;
+    bool inline_methods = false;
+    bool timing = false;
+    const char stop_after_option[] = "--zatrzymaj-po=";
+    const char class_version_option[] = "--wersja-klasy=";
 
     for (int i = 1; i < argc; ++i) {
         if (strcmp(argv[i], "--ścieżkaklasy") == 0) {
@@ -37,6 +76,26 @@ main(int argc, char *argv[])
                 return 1;
             }
             classpath = argv[++i];
+        } else if (strcmp(argv[i], "--tylko-składnia") == 0) {
+            stop_after = Phase::PARSING;
+        } else if (strncmp(argv[i], stop_after_option, sizeof(stop_after_option) - 1) == 0) {
+            if (!parse_phase(argv[i] + sizeof(stop_after_option) - 1, stop_after)) {
+                show_usage(argv[0]);
+                return 1;
+            }
+        } else if (strncmp(argv[i], class_version_option, sizeof(class_version_option) - 1) == 0) {
+            // the stack map frames are emitted for all the versions, they were introduced in version 50
+            char *end;
+            long version = strtol(argv[i] + sizeof(class_version_option) - 1, &end, 10);
+            if (*end != '\0' || version < 50 || version > 59) {
+                show_usage(argv[0]);
+                return 1;
+            }
+            class_version = version;
+        } else if (strcmp(argv[i], "--wstawiaj-metody") == 0) {
+            inline_methods = true;
+        } else if (strcmp(argv[i], "--czas") == 0) {
+            timing = true;
         } else {
             sources.push_back(argv[i]);
         }
@@ -48,6 +107,11 @@ main(int argc, char *argv[])
     }
 
     Context ctx(classpath);
+    ctx.set_stop_after(stop_after);
+    ctx.set_class_version(class_version);
+    ctx.set_inline_methods(inline_methods);
+    if (timing)
+        ctx.statistics().enable();
 
     for (auto file : sources) {
         FILE *iff = fopen(file, "r");
@@ -56,13 +120,29 @@ main(int argc, char *argv[])
             return 1;
         }
 
+        std::error_code ec;
+        auto size = std::filesystem::file_size(file, ec);
+        if (!ec)
+            ctx.statistics().add_bytes(Phase::LEXING, size);
+        ctx.statistics().set_location(file, &ctx.loc().line);
+
         auto scn = lexer_init(iff);
-        parser prs(scn, &ctx);
 
-        prs.parse();
+        if (ctx.runs(Phase::PARSING)) {
+            parser prs(scn, &ctx);
+            auto phase = ctx.statistics().measure(Phase::PARSING);
+            prs.parse();
+        } else {
+            auto phase = ctx.statistics().measure(Phase::LEXING);
+            while (scan_token(scn, &ctx).kind() != parser::symbol_kind::S_YYEOF)
+                ;
+        }
 
         lexer_shutdown(scn);
     }
 
+    if (timing)
+        ctx.statistics().report(std::cerr);
+
     return 0;
 }
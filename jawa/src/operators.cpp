@@ -0,0 +1,76 @@
+/**
+ * @file operators.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+#include "operators.hpp"
+
+namespace jawa::operators {
+
+    const char *
+    symbol(binop op)
+    {
+        switch (op) {
+        case binop::ADD:
+            return "+";
+        case binop::SUB:
+            return "-";
+        case binop::MUL:
+            return "*";
+        case binop::DIV:
+            return "/";
+        case binop::MOD:
+            return "%";
+        case binop::SHL:
+            return "<<";
+        case binop::SHR:
+            return ">>";
+        case binop::USHR:
+            return ">>>";
+        case binop::AND:
+            return "&";
+        case binop::OR:
+            return "|";
+        case binop::XOR:
+            return "^";
+        case binop::LT:
+            return "<";
+        case binop::GT:
+            return ">";
+        case binop::LTE:
+            return "<=";
+        case binop::GTE:
+            return ">=";
+        case binop::EQ:
+            return "==";
+        case binop::NE:
+            return "!=";
+        case binop::LAND:
+            return "&&";
+        case binop::LOR:
+            return "||";
+        }
+        return "";
+    }
+
+    const char *
+    symbol(unop op)
+    {
+        switch (op) {
+        case unop::PLUS:
+            return "+";
+        case unop::MINUS:
+            return "-";
+        case unop::NOT:
+            return "~";
+        case unop::LNOT:
+            return "!";
+        }
+        return "";
+    }
+
+}
@@ -24,6 +24,7 @@
 {
 #include <sstream>
 #include <iostream>
+#include <limits>
 
 #include "bisonflex.hpp"
 #include "context.hpp"
@@ -31,6 +32,7 @@
 #include "types.hpp"
 #include "operators.hpp"
 #include "builder.hpp"
+#include "ir.hpp"
 #include "parser_sem.hpp"
 #include "tables.hpp"
 }
@@ -40,6 +42,16 @@
 {
 YY_DECL;
 
+/**
+ * Reads the next token. The time spent in the lexer is attributed to the lexing phase.
+ */
+static jawa::parser::symbol_type
+yylex(yyscan_t yyscanner, jawa::Context *ctx)
+{
+    auto phase = ctx->statistics().measure(jawa::Phase::LEXING);
+    return scan_token(yyscanner, ctx);
+}
+
 using namespace jawa;
 }
 
@@ -57,7 +69,7 @@ using namespace jawa;
 %token<ModifierForm>        STATIC          "statyczny/statyczna"
 %token<ModifierForm>        FINAL           "końcowy/końcowa"
 %token<ModifierForm>        NATIVE          "ojczysty/ojczysta"
-%token<ModifierForm>        VOLATILE        "zmeinny/zmeinna"
+%token<ModifierForm>        VOLATILE        "zmienny/zmienna"
 %token<ModifierForm>        SYNCHRONIZED    "zsynchronizowany/zsynchronizowana"
 %token<ModifierForm>        ABSTRACT        "abstrakcyjny/abstrakcyjna"
 %token<ModifierForm>        TRANSIENT       "przejściowy/przejściowa"
@@ -67,7 +79,7 @@ using namespace jawa;
 %token                      IF              "jeśli"
 %token                      ELSE            "albo"
 %token                      FOR             "dla"
-%token                      DO              "zrob"
+%token                      DO              "wykonaj"
 %token                      WHILE           "dopóki"
 %token                      RETURN          "zwróć"
 %token                      TRY             "spróbuj"
@@ -150,6 +162,9 @@ using namespace jawa;
 %token<short_t>             SHORT_LIT       "literał krótky"
 %token<int_t>               INT_LIT         "literał całkowity"
 %token<long_t>              LONG_LIT        "literał dlugy"
+/* decimal literals of the magnitude of the minimum, allowed only as the operands of the unary minus */
+%token<Name>                MIN_INT_LIT     "literał całkowity 2147483648"
+%token<Name>                MIN_LONG_LIT    "literał dlugy 9223372036854775808L"
 %token<char_t>              CHAR_LIT        "literał znakowy"
 %token<float_t>             FLOAT_LIT       "literał pojedynczy"
 %token<double_t>            DOUBLE_LIT      "literał podwójny"
@@ -161,13 +176,14 @@ using namespace jawa;
 
 
 %type<Name>                 Identifier Name
-%type<Name>                 CreatedName
+%type<Name>                 CreatedName CreatedNameTail_opt CreatedNameTail
 %type<NameList>             NameList
 %type<TypeObs>              Type VoidType PrimitiveType ReferenceType NumericType IntegralType
-%type<TypeObs>              FloatingPointType ClassOrInterfaceType ArrayType
+%type<TypeObs>              FloatingPointType ClassOrInterfaceType ArrayType ClassExtends_opt ClassExtends
+%type<TypeObsArray>         TypeList Implements_opt Implements
 %type<FormalParamArray>     FormalParameters FormalParameterDecls_opt FormalParameterDecls
 %type<size_t>               Dims
-%type<ExpressionArray>      Arguments Expressions_opt Expressions
+%type<ExpressionArray>      Arguments Expressions_opt Expressions ClassCreatorRest
 %type<Expression>           ExpressionNoName AssignmentExpressionNoName ConditionalExpressionNoName
 %type<Expression>           InclusiveOrExpressionNoName ExclusiveOrExpressionNoName
 %type<Expression>           AndExpressionNoName EqualityExpressionNoName RelationalExpressionNoName
@@ -175,9 +191,22 @@ using namespace jawa;
 %type<Expression>           CastExpressionNoName UnaryExpressionNotPlusMinusNoName PreIncDecExpression
 %type<Expression>           UnaryExpressionNoName PostIncDecExpression PostfixExpressionNoName
 %type<Expression>           ConstantExpressionNoName PrimaryNoName Literal ConditionalOrExpressionNoName
-%type<Expression>           ConditionalAndExpressionNoName Creator
-%type<ExpressionOpt>        ExpressionNoName_opt
+%type<Expression>           ConditionalAndExpressionNoName Creator DimExpr
+%type<ExpressionOpt>        ExpressionNoName_opt VariableDeclaratorRest VariableInitializerAssignment_opt
+%type<Expression>           VariableInitializerAssignment VariableInitializer
+%type<VariableDeclarator>   VariableDeclarator
+%type<VariableDeclaratorArray> VariableDeclarators FieldDeclaratorsRest FieldDeclaratorsRestTail
 %type<ClassAndName>         MethodName
+%type<Expression>           StatementExpression
+%type<ir::Block *>          Block
+%type<ir::StatementArray>   BlockStatements_opt BlockStatements
+%type<ir::Statement *>      BlockStatement Statement StatementWithoutTrailingSubstatement ExpressionStatement
+%type<ir::Statement *>      ReturnStatement LocalVariableDeclarationStatement ForInit ForInit_opt
+%type<ir::Statement *>      SwitchStatement BreakStatement StatementNoShortIf IfThenStatement IfThenElseStatement
+%type<ir::Statement *>      IfThenElseStatementNoShortIf WhileStatement WhileStatementNoShortIf DoStatement ForStatement
+%type<ir::Statement *>      BasicForStatement ForStatementNoShortIf ForHead ContinueStatement SynchronizedStatement
+%type<ir::StatementArray>   ForUpdate_opt ForUpdate StatementExpressionList
+%type<std::optional<operators::comp>> AssignmentOperator
 %type<ModifierAndAnnotationPack> Modifiers_opt Modifiers StaticInitializerHead
 %type<std::pair<Modifier, ModifierForm>> Modifier
 
@@ -246,7 +275,7 @@ InterfaceDeclaration: NormalInterfaceDeclaration
 NormalClassDeclaration: NormalClassDeclarationHead ClassBody
                       ;
 
-NormalClassDeclarationHead: CLASS Identifier TypeParameters_opt ClassExtends_opt Implements_opt { enter_class(ctx, $2); }
+NormalClassDeclarationHead: CLASS Identifier TypeParameters_opt ClassExtends_opt Implements_opt { enter_class(ctx, $2, $4, $5); }
                           ;
 
 EnumDeclaration: ENUM Identifier Implements_opt EnumBody
@@ -258,11 +287,11 @@ NormalInterfaceDeclaration: INTERFACE Identifier TypeParameters_opt InterfaceExt
 AnnotationTypeDeclaration: AT_INTERFACE Identifier AnnotationTypeBody
                          ;
 
-ClassExtends_opt: %empty
-                | ClassExtends
+ClassExtends_opt: %empty        { $$ = nullptr; }
+                | ClassExtends  { $$ = $1; }
                 ;
 
-ClassExtends: EXTENDS Type
+ClassExtends: EXTENDS Type      { $$ = $2; }
             ;
 
 InterfaceExtends_opt: %empty
@@ -272,11 +301,11 @@ InterfaceExtends_opt: %empty
 InterfaceExtends: EXTENDS TypeList
                 ;
 
-Implements_opt: %empty
-              | Implements
+Implements_opt: %empty          { }
+              | Implements      { $$ = $1; }
               ;
 
-Implements: IMPLEMENTS TypeList
+Implements: IMPLEMENTS TypeList { $$ = $2; }
           ;
 
 /* Types */
@@ -333,7 +362,7 @@ TypeDeclSpecifierHead: Name TypeArguments DOT
                      | TypeDeclSpecifierHead DOT Name TypeArguments DOT
                      ;
 
-ArrayType: PrimitiveType Dims
+ArrayType: PrimitiveType Dims          { $$ = ctx->type_table().get_array_type($1, $2); }
          | Name Dims                { $$ = ctx->type_table().get_array_type(find_class(ctx, $1), $2); }
          | TypeDeclSpecifier Dims
          ;
@@ -389,8 +418,8 @@ NonWildcardTypeArguments_opt: %empty | NonWildcardTypeArguments ;
 NonWildcardTypeArguments: LT TypeList GT
                         ;
 
-TypeList: ReferenceType
-        | TypeList COMMA ReferenceType
+TypeList: ReferenceType                  { $$.push_back($1); }
+        | TypeList COMMA ReferenceType   { $$ = std::move($1); $$.push_back($3); }
         ;
 
 
@@ -506,37 +535,44 @@ ClassBodyDeclarations: ClassBodyDeclaration
 
 ClassBodyDeclaration: SEMIC
                     | MemberDecl
-                    | StaticInitializerHead Block { leave_method(ctx, $1); }
+                    | StaticInitializerHead Block { leave_method(ctx, $1, $2); }
                     ;
 
 StaticInitializerHead: STATIC { enter_static_initializer(ctx); }
                      ;
 
 MemberDecl: MethodOrFieldDecl
-          | Modifiers_opt Identifier ConstructorDeclaratorRest
+          | Modifiers_opt ConstructorDeclHead Block { leave_method(ctx, $1, $3); }
           | Modifiers_opt GenericMethodOrConstructorDecl
           | Modifiers_opt ClassDeclaration
           | Modifiers_opt InterfaceDeclaration
           ;
 
-MethodOrFieldDecl: Modifiers_opt Type Identifier FieldDeclaratorsRest SEMIC { declare_field(ctx, $1, $2, $3); }
-                 | Modifiers_opt MethodDeclHead Block                  { leave_method(ctx, $1); }
+MethodOrFieldDecl: Modifiers_opt Type Identifier FieldDeclaratorsRest SEMIC {
+                        $4.front().name = $3;
+                        for (auto &declarator : $4)
+                            declare_field(ctx, $1, $2, declarator.name, declarator.initializer);
+                    }
+                 | Modifiers_opt MethodDeclHead Block                  { leave_method(ctx, $1, $3); }
                  | Modifiers_opt MethodDeclHead SEMIC                  { declare_method(ctx, $1); }
                  ;
 
 FieldDeclHead: Type Identifier
              ;
 
-MethodDeclHead: Type Identifier FormalParameters Dims_opt Throws_opt    { }
+MethodDeclHead: Type Identifier FormalParameters Dims_opt Throws_opt    { enter_method(ctx, $2, $1, $3); }
               | VoidType Identifier FormalParameters Throws_opt         { enter_method(ctx, $2, $1, $3); }
               ;
 
-FieldDeclaratorsRest: VariableDeclaratorRest
-                    | VariableDeclaratorRest FieldDeclaratorsRestTail
+FieldDeclaratorsRest: VariableDeclaratorRest                          { $$.push_back({ Name(), $1 }); }
+                    | VariableDeclaratorRest FieldDeclaratorsRestTail {
+                        $$.push_back({ Name(), $1 });
+                        $$.insert($$.end(), $2.begin(), $2.end());
+                    }
                     ;
 
-FieldDeclaratorsRestTail: COMMA VariableDeclarator
-                        | FieldDeclaratorsRestTail COMMA VariableDeclarator
+FieldDeclaratorsRestTail: COMMA VariableDeclarator                          { $$.push_back($2); }
+                        | FieldDeclaratorsRestTail COMMA VariableDeclarator { $$ = std::move($1); $$.push_back($3); }
                         ;
 
 MethodDeclaratorRest: Block
@@ -550,6 +586,9 @@ Throws_opt: %empty
 Throws: THROWS NameList
       ;
 
+ConstructorDeclHead: Identifier FormalParameters Throws_opt { enter_constructor(ctx, $1, $2); }
+                   ;
+
 ConstructorDeclaratorRest: FormalParameters Throws_opt Block
                          ;
 
@@ -626,30 +665,30 @@ VariableDeclaratorId: Identifier Dims_opt
 
 
 
-VariableDeclarators: VariableDeclarator
-                   | VariableDeclarators COMMA VariableDeclarator
+VariableDeclarators: VariableDeclarator                           { $$.push_back($1); }
+                   | VariableDeclarators COMMA VariableDeclarator { $$ = std::move($1); $$.push_back($3); }
                    ;
 
-VariableDeclarator: Identifier VariableDeclaratorRest
+VariableDeclarator: Identifier VariableDeclaratorRest { $$ = { $1, $2 }; }
                   ;
 
-VariableDeclaratorRest: Dims_opt VariableInitializerAssignment_opt
+VariableDeclaratorRest: Dims_opt VariableInitializerAssignment_opt { $$ = $2; }
                       ;
 
-VariableInitializerAssignment_opt: %empty
-                                 | VariableInitializerAssignment
+VariableInitializerAssignment_opt: %empty                        { $$ = std::nullopt; }
+                                 | VariableInitializerAssignment { $$ = std::make_optional($1); }
                                  ;
 
-VariableInitializerAssignment: ASGN VariableInitializer
+VariableInitializerAssignment: ASGN VariableInitializer { $$ = $2; }
                              ;
 
 VariableInitializers: VariableInitializer
                     | VariableInitializers COMMA VariableInitializer
                     ;
 
-VariableInitializer: ArrayInitializer
-                   | ExpressionNoName
-                   | Name
+VariableInitializer: ArrayInitializer    { }
+                   | ExpressionNoName    { $$ = $1; }
+                   | Name                { $$ = load_name(ctx, $1); }
                    ;
 
 ArrayInitializer: LCUR RCUR
@@ -659,69 +698,72 @@ ArrayInitializer: LCUR RCUR
                 ;
 
 
-Block: LCUR BlockStatements_opt RCUR
+Block: BlockStart BlockStatements_opt RCUR { $$ = make_block(ctx, $2); }
      ;
 
-BlockStatements_opt: %empty
-                   | BlockStatements
+BlockStart: LCUR { enter_block(ctx); }
+          ;
+
+BlockStatements_opt: %empty          { }
+                   | BlockStatements { $$ = std::move($1); }
                    ;
 
-BlockStatements: BlockStatement
-               | BlockStatements BlockStatement
+BlockStatements: BlockStatement                 { if ($1) $$.push_back($1); }
+               | BlockStatements BlockStatement { $$ = std::move($1); if ($2) $$.push_back($2); }
                ;
 
-BlockStatement: LocalVariableDeclarationStatement SEMIC
-              | ClassOrInterfaceDeclaration
-              | Statement
+BlockStatement: LocalVariableDeclarationStatement SEMIC { $$ = $1; }
+              | ClassOrInterfaceDeclaration             { $$ = nullptr; }
+              | Statement                               { $$ = $1; }
               ;
 
-LocalVariableDeclarationStatement: Type VariableDeclarators
-                                 | Modifiers Type VariableDeclarators
+LocalVariableDeclarationStatement: Type VariableDeclarators           { $$ = declare_local_variables(ctx, $1, $2); }
+                                 | Modifiers Type VariableDeclarators { $$ = declare_local_variables(ctx, $2, $3); }
                                  ;
 /* Statements */
 
-Statement: StatementWithoutTrailingSubstatement
-         | LabeledStatement
-         | IfThenStatement
-         | IfThenElseStatement
-         | WhileStatement
-         | ForStatement
+Statement: StatementWithoutTrailingSubstatement { $$ = $1; }
+         | LabeledStatement                     { $$ = nullptr; }
+         | IfThenStatement                      { $$ = $1; }
+         | IfThenElseStatement                  { $$ = $1; }
+         | WhileStatement                       { $$ = $1; }
+         | ForStatement                         { $$ = $1; }
          ;
 
-StatementWithoutTrailingSubstatement: Block
-                                    | EmptyStatement
-                                    | ExpressionStatement
-                                    | AssertStatement
-                                    | SwitchStatement
-                                    | DoStatement
-                                    | BreakStatement
-                                    | ContinueStatement
-                                    | ReturnStatement
-                                    | SynchronizedStatement
-                                    | ThrowStatement
-                                    | TryStatement
+StatementWithoutTrailingSubstatement: Block                 { $$ = $1; }
+                                    | EmptyStatement        { $$ = nullptr; }
+                                    | ExpressionStatement   { $$ = $1; }
+                                    | AssertStatement       { $$ = nullptr; }
+                                    | SwitchStatement       { $$ = $1; }
+                                    | DoStatement           { $$ = $1; }
+                                    | BreakStatement        { $$ = $1; }
+                                    | ContinueStatement     { $$ = $1; }
+                                    | ReturnStatement       { $$ = $1; }
+                                    | SynchronizedStatement { $$ = $1; }
+                                    | ThrowStatement        { $$ = nullptr; }
+                                    | TryStatement          { $$ = nullptr; }
                                     ;
 
-StatementNoShortIf: StatementWithoutTrailingSubstatement
-                  | LabeledStatementNoShortIf
-                  | IfThenElseStatementNoShortIf
-                  | WhileStatementNoShortIf
-                  | ForStatementNoShortIf
+StatementNoShortIf: StatementWithoutTrailingSubstatement { $$ = $1; }
+                  | LabeledStatementNoShortIf            { $$ = nullptr; }
+                  | IfThenElseStatementNoShortIf         { $$ = $1; }
+                  | WhileStatementNoShortIf              { $$ = $1; }
+                  | ForStatementNoShortIf                { $$ = $1; }
                   ;
 
 EmptyStatement: SEMIC
               ;
 
-IfThenStatement: IF LPAR ExpressionNoName RPAR Statement
-               | IF LPAR Name RPAR Statement
+IfThenStatement: IF LPAR ExpressionNoName RPAR Statement { $$ = if_statement(ctx, $3, $5, nullptr); }
+               | IF LPAR Name RPAR Statement             { $$ = if_statement(ctx, load_name(ctx, $3), $5, nullptr); }
                ;
 
-IfThenElseStatement: IF LPAR ExpressionNoName RPAR StatementNoShortIf ELSE Statement
-                   | IF LPAR Name RPAR StatementNoShortIf ELSE Statement
+IfThenElseStatement: IF LPAR ExpressionNoName RPAR StatementNoShortIf ELSE Statement { $$ = if_statement(ctx, $3, $5, $7); }
+                   | IF LPAR Name RPAR StatementNoShortIf ELSE Statement { $$ = if_statement(ctx, load_name(ctx, $3), $5, $7); }
                    ;
 
-IfThenElseStatementNoShortIf: IF LPAR ExpressionNoName RPAR StatementNoShortIf ELSE StatementNoShortIf
-                            | IF LPAR Name RPAR StatementNoShortIf ELSE StatementNoShortIf
+IfThenElseStatementNoShortIf: IF LPAR ExpressionNoName RPAR StatementNoShortIf ELSE StatementNoShortIf { $$ = if_statement(ctx, $3, $5, $7); }
+                            | IF LPAR Name RPAR StatementNoShortIf ELSE StatementNoShortIf { $$ = if_statement(ctx, load_name(ctx, $3), $5, $7); }
                             ;
 
 LabeledStatement: Identifier COLON Statement
@@ -730,11 +772,11 @@ LabeledStatement: Identifier COLON Statement
 LabeledStatementNoShortIf: Identifier COLON StatementNoShortIf
                          ;
 
-ExpressionStatement: StatementExpression SEMIC
+ExpressionStatement: StatementExpression SEMIC { $$ = expression_statement(ctx, $1); }
                    ;
 
-StatementExpression: ExpressionNoName
-                   | Name
+StatementExpression: ExpressionNoName { $$ = $1; }
+                   | Name             { }
                    ;
 
 AssertStatement: ASSERT ExpressionNoName SEMIC
@@ -745,10 +787,13 @@ AssertStatement: ASSERT ExpressionNoName SEMIC
                | ASSERT Name COLON Name SEMIC
                ;
 
-SwitchStatement: SWITCH LPAR ExpressionNoName RPAR SwitchBlock
-               | SWITCH LPAR Name RPAR SwitchBlock
+SwitchStatement: SwitchHead SwitchBlock { $$ = leave_switch(ctx); }
                ;
 
+SwitchHead: SWITCH LPAR ExpressionNoName RPAR { enter_switch(ctx, $3); }
+          | SWITCH LPAR Name RPAR             { enter_switch(ctx, load_name(ctx, $3)); }
+          ;
+
 SwitchBlock: LCUR SwitchBlockStatementGroups SwitchLabels RCUR
            | LCUR SwitchBlockStatementGroups RCUR
            | LCUR SwitchLabels RCUR
@@ -759,79 +804,96 @@ SwitchBlockStatementGroups: SwitchBlockStatementGroup
                           | SwitchBlockStatementGroups SwitchBlockStatementGroup
                           ;
 
-SwitchBlockStatementGroup: SwitchLabels BlockStatements
+SwitchBlockStatementGroup: SwitchLabels BlockStatements { switch_statements(ctx, $2); }
                          ;
 
 SwitchLabels: SwitchLabel
             | SwitchLabels SwitchLabel
             ;
 
-SwitchLabel: CASE ConstantExpressionNoName COLON
-           | CASE Name COLON
-           | DEFAULT COLON
+SwitchLabel: CASE ConstantExpressionNoName COLON { switch_label(ctx, $2); }
+           | CASE Name COLON                     { switch_label(ctx, load_name(ctx, $2)); }
+           | DEFAULT COLON                       { switch_default(ctx); }
            ;
 
-WhileStatement: WHILE LPAR ExpressionNoName RPAR Statement
-              | WHILE LPAR Name RPAR Statement
+WhileStatement: WhileHead Statement { $$ = leave_loop(ctx, $2, nullptr); }
               ;
 
-WhileStatementNoShortIf: WHILE LPAR ExpressionNoName RPAR StatementNoShortIf
-                       | WHILE LPAR Name RPAR StatementNoShortIf
+WhileStatementNoShortIf: WhileHead StatementNoShortIf { $$ = leave_loop(ctx, $2, nullptr); }
                        ;
 
-DoStatement: DO Statement WHILE LPAR ExpressionNoName RPAR SEMIC
-           | DO Statement WHILE LPAR Name RPAR SEMIC
+WhileHead: WHILE LPAR ExpressionNoName RPAR { enter_loop(ctx, true); loop_condition(ctx, $3); }
+         | WHILE LPAR Name RPAR             { enter_loop(ctx, true); loop_condition(ctx, load_name(ctx, $3)); }
+         ;
+
+DoStatement: DoHead Statement WHILE LPAR ExpressionNoName RPAR SEMIC { loop_condition(ctx, $5); $$ = leave_loop(ctx, $2, nullptr); }
+           | DoHead Statement WHILE LPAR Name RPAR SEMIC { loop_condition(ctx, load_name(ctx, $5)); $$ = leave_loop(ctx, $2, nullptr); }
            ;
 
-ForStatement: BasicForStatement
+DoHead: DO { enter_loop(ctx, false); }
+      ;
+
+ForStatement: BasicForStatement { $$ = $1; }
             ;
 
-BasicForStatement: FOR LPAR ForInit_opt SEMIC ExpressionNoName_opt SEMIC ForUpdate_opt RPAR Statement
-                 | FOR LPAR ForInit_opt SEMIC Name SEMIC ForUpdate_opt RPAR Statement
+BasicForStatement: ForHead Statement { $$ = leave_loop(ctx, $2, $1); }
                  ;
 
-ForStatementNoShortIf: FOR LPAR ForInit_opt SEMIC ExpressionNoName_opt SEMIC ForUpdate_opt RPAR StatementNoShortIf
-                     | FOR LPAR ForInit_opt SEMIC Name SEMIC ForUpdate_opt RPAR StatementNoShortIf
+ForStatementNoShortIf: ForHead StatementNoShortIf { $$ = leave_loop(ctx, $2, $1); }
                      ;
 
-ForInit_opt: %empty
-           | ForInit
+ForHead: ForStart ForInit_opt SEMIC ExpressionNoName_opt SEMIC ForUpdate_opt RPAR { for_loop_head(ctx, $4, $6); $$ = $2; }
+       | ForStart ForInit_opt SEMIC Name SEMIC ForUpdate_opt RPAR { for_loop_head(ctx, load_name(ctx, $4), $6); $$ = $2; }
+       ;
+
+ForStart: FOR LPAR { enter_loop(ctx, true); }
+        ;
+
+ForInit_opt: %empty     { $$ = nullptr; }
+           | ForInit    { $$ = $1; }
            ;
 
-ForInit: LocalVariableDeclarationStatement
+ForInit: LocalVariableDeclarationStatement { $$ = $1; }
        /* | StatementExpression */
        ;
 
-ForUpdate_opt: %empty
-             | ForUpdate
+ForUpdate_opt: %empty     { }
+             | ForUpdate  { $$ = std::move($1); }
              ;
 
-ForUpdate: StatementExpressionList
+ForUpdate: StatementExpressionList { $$ = std::move($1); }
          ;
 
-StatementExpressionList: StatementExpression
-                       | StatementExpressionList COMMA StatementExpression
+StatementExpressionList: StatementExpression {
+                            if (auto stmt = expression_statement(ctx, $1))
+                                $$.push_back(stmt);
+                        }
+                       | StatementExpressionList COMMA StatementExpression {
+                            $$ = std::move($1);
+                            if (auto stmt = expression_statement(ctx, $3))
+                                $$.push_back(stmt);
+                        }
                        ;
 
-BreakStatement: BREAK SEMIC
-              | BREAK Identifier SEMIC
+BreakStatement: BREAK SEMIC            { $$ = break_statement(ctx); }
+              | BREAK Identifier SEMIC { $$ = nullptr; }
               ;
 
-ContinueStatement: CONTINUE SEMIC
-                 | CONTINUE Identifier SEMIC
+ContinueStatement: CONTINUE SEMIC            { $$ = continue_statement(ctx); }
+                 | CONTINUE Identifier SEMIC { $$ = nullptr; }
                  ;
 
-ReturnStatement: RETURN ExpressionNoName SEMIC
-               | RETURN Name SEMIC
-               | RETURN SEMIC
+ReturnStatement: RETURN ExpressionNoName SEMIC { $$ = return_statement(ctx, $2); }
+               | RETURN Name SEMIC             { $$ = return_statement(ctx, load_name(ctx, $2)); }
+               | RETURN SEMIC                  { $$ = return_statement(ctx, std::nullopt); }
                ;
 
 ThrowStatement: THROW ExpressionNoName SEMIC
               | THROW Name SEMIC
               ;
 
-SynchronizedStatement: SYNCHRONIZED LPAR ExpressionNoName RPAR Block
-                     | SYNCHRONIZED LPAR Name RPAR Block
+SynchronizedStatement: SYNCHRONIZED LPAR ExpressionNoName RPAR Block { $$ = synchronized_statement(ctx, $3, $5); }
+                     | SYNCHRONIZED LPAR Name RPAR Block { $$ = synchronized_statement(ctx, load_name(ctx, $3), $5); }
                      ;
 
 TryStatement: TRY Block Catches
@@ -891,7 +953,7 @@ Expressions_opt: %empty         { }
 Expressions: ExpressionNoName                   { $$.push_back($1); }
            | Name                               { $$.push_back(load_name(ctx, $1)); }
            | Expressions COMMA ExpressionNoName { $$ = $1; $$.push_back($3); }
-           | Expressions COMMA Name             { /* TODO */ }
+           | Expressions COMMA Name             { $$ = $1; $$.push_back(load_name(ctx, $3)); }
            ;
 
 ExpressionNoName_opt: %empty           { $$ = std::nullopt; }
@@ -902,14 +964,14 @@ ExpressionNoName: AssignmentExpressionNoName { $$ = $1; }
           ;
 
 AssignmentExpressionNoName: ConditionalExpressionNoName { $$ = $1; }
-                    | ConditionalExpressionNoName AssignmentOperator AssignmentExpressionNoName
-                    | ConditionalExpressionNoName AssignmentOperator Name
-                    | Name AssignmentOperator AssignmentExpressionNoName { assign(ctx, $1, $3); }
-                    | Name AssignmentOperator Name
+                    | ConditionalExpressionNoName AssignmentOperator AssignmentExpressionNoName { $$ = assign(ctx, $1, $2, $3); }
+                    | ConditionalExpressionNoName AssignmentOperator Name { $$ = assign(ctx, $1, $2, load_name(ctx, $3)); }
+                    | Name AssignmentOperator AssignmentExpressionNoName { $$ = assign(ctx, $1, $2, $3); }
+                    | Name AssignmentOperator Name { $$ = assign(ctx, $1, $2, load_name(ctx, $3)); }
                     ;
 
-AssignmentOperator: ASGN
-                  | COMP
+AssignmentOperator: ASGN { $$ = std::nullopt; }
+                  | COMP { $$ = $1; }
                   ;
 
 ConditionalExpressionNoName: ConditionalOrExpressionNoName { $$ = $1; }
@@ -924,100 +986,100 @@ ConditionalExpressionNoName: ConditionalOrExpressionNoName { $$ = $1; }
                            ;
 
 ConditionalOrExpressionNoName: ConditionalAndExpressionNoName { $$ = $1; }
-                             | ConditionalOrExpressionNoName DVERT ConditionalAndExpressionNoName
-                             | ConditionalOrExpressionNoName DVERT Name
-                             | Name DVERT ConditionalAndExpressionNoName
-                             | Name DVERT Name
+                             | ConditionalOrExpressionNoName DVERT ConditionalAndExpressionNoName { $$ = binary_operation(ctx, operators::binop::LOR, $1, $3); }
+                             | ConditionalOrExpressionNoName DVERT Name { $$ = binary_operation(ctx, operators::binop::LOR, $1, load_name(ctx, $3)); }
+                             | Name DVERT ConditionalAndExpressionNoName { $$ = binary_operation(ctx, operators::binop::LOR, load_name(ctx, $1), $3); }
+                             | Name DVERT Name { $$ = binary_operation(ctx, operators::binop::LOR, load_name(ctx, $1), load_name(ctx, $3)); }
                              ;
 
 ConditionalAndExpressionNoName: InclusiveOrExpressionNoName { $$ = $1; }
-                              | ConditionalAndExpressionNoName DAMP InclusiveOrExpressionNoName
-                              | ConditionalAndExpressionNoName DAMP Name
-                              | Name DAMP InclusiveOrExpressionNoName
-                              | Name DAMP Name
+                              | ConditionalAndExpressionNoName DAMP InclusiveOrExpressionNoName { $$ = binary_operation(ctx, operators::binop::LAND, $1, $3); }
+                              | ConditionalAndExpressionNoName DAMP Name { $$ = binary_operation(ctx, operators::binop::LAND, $1, load_name(ctx, $3)); }
+                              | Name DAMP InclusiveOrExpressionNoName { $$ = binary_operation(ctx, operators::binop::LAND, load_name(ctx, $1), $3); }
+                              | Name DAMP Name { $$ = binary_operation(ctx, operators::binop::LAND, load_name(ctx, $1), load_name(ctx, $3)); }
                               ;
 
 InclusiveOrExpressionNoName: ExclusiveOrExpressionNoName { $$ = $1; }
-                           | InclusiveOrExpressionNoName VERT ExclusiveOrExpressionNoName
-                           | InclusiveOrExpressionNoName VERT Name
-                           | Name VERT ExclusiveOrExpressionNoName
-                           | Name VERT Name
+                           | InclusiveOrExpressionNoName VERT ExclusiveOrExpressionNoName { $$ = binary_operation(ctx, operators::binop::OR, $1, $3); }
+                           | InclusiveOrExpressionNoName VERT Name { $$ = binary_operation(ctx, operators::binop::OR, $1, load_name(ctx, $3)); }
+                           | Name VERT ExclusiveOrExpressionNoName { $$ = binary_operation(ctx, operators::binop::OR, load_name(ctx, $1), $3); }
+                           | Name VERT Name { $$ = binary_operation(ctx, operators::binop::OR, load_name(ctx, $1), load_name(ctx, $3)); }
                            ;
 
 ExclusiveOrExpressionNoName: AndExpressionNoName { $$ = $1; }
-                           | ExclusiveOrExpressionNoName HAT AndExpressionNoName
-                           | ExclusiveOrExpressionNoName HAT Name
-                           | Name HAT AndExpressionNoName
-                           | Name HAT Name
+                           | ExclusiveOrExpressionNoName HAT AndExpressionNoName { $$ = binary_operation(ctx, operators::binop::XOR, $1, $3); }
+                           | ExclusiveOrExpressionNoName HAT Name { $$ = binary_operation(ctx, operators::binop::XOR, $1, load_name(ctx, $3)); }
+                           | Name HAT AndExpressionNoName { $$ = binary_operation(ctx, operators::binop::XOR, load_name(ctx, $1), $3); }
+                           | Name HAT Name { $$ = binary_operation(ctx, operators::binop::XOR, load_name(ctx, $1), load_name(ctx, $3)); }
                            ;
 
 AndExpressionNoName: EqualityExpressionNoName { $$ = $1; }
-                   | AndExpressionNoName AMP EqualityExpressionNoName
-                   | AndExpressionNoName AMP Name
-                   | Name AMP EqualityExpressionNoName
-                   | Name AMP Name
+                   | AndExpressionNoName AMP EqualityExpressionNoName { $$ = binary_operation(ctx, operators::binop::AND, $1, $3); }
+                   | AndExpressionNoName AMP Name { $$ = binary_operation(ctx, operators::binop::AND, $1, load_name(ctx, $3)); }
+                   | Name AMP EqualityExpressionNoName { $$ = binary_operation(ctx, operators::binop::AND, load_name(ctx, $1), $3); }
+                   | Name AMP Name { $$ = binary_operation(ctx, operators::binop::AND, load_name(ctx, $1), load_name(ctx, $3)); }
                    ;
 
 EqualityExpressionNoName: RelationalExpressionNoName { $$ = $1; }
-                        | EqualityExpressionNoName EQOP RelationalExpressionNoName
-                        | EqualityExpressionNoName EQOP Name
-                        | Name EQOP RelationalExpressionNoName
-                        | Name EQOP Name
+                        | EqualityExpressionNoName EQOP RelationalExpressionNoName { $$ = binary_operation(ctx, operators::to_binop($2), $1, $3); }
+                        | EqualityExpressionNoName EQOP Name { $$ = binary_operation(ctx, operators::to_binop($2), $1, load_name(ctx, $3)); }
+                        | Name EQOP RelationalExpressionNoName { $$ = binary_operation(ctx, operators::to_binop($2), load_name(ctx, $1), $3); }
+                        | Name EQOP Name { $$ = binary_operation(ctx, operators::to_binop($2), load_name(ctx, $1), load_name(ctx, $3)); }
                         | EqualityExpressionNoName INSTANCEOF ReferenceType
                         | Name INSTANCEOF ReferenceType
                         ;
 
 RelationalExpressionNoName: ShiftExpressionNoName { $$ = $1; }
-                          | ShiftExpressionNoName LT ShiftExpressionNoName
-                          | ShiftExpressionNoName LT Name
-                          | Name LT ShiftExpressionNoName
-                          | Name LT Name
-                          | ShiftExpressionNoName GT ShiftExpressionNoName
-                          | ShiftExpressionNoName GT Name
-                          | Name GT ShiftExpressionNoName
-                          | Name GT Name
-                          | ShiftExpressionNoName RELOP ShiftExpressionNoName
-                          | ShiftExpressionNoName RELOP Name
-                          | Name RELOP ShiftExpressionNoName
-                          | Name RELOP Name
+                          | ShiftExpressionNoName LT ShiftExpressionNoName { $$ = binary_operation(ctx, operators::binop::LT, $1, $3); }
+                          | ShiftExpressionNoName LT Name { $$ = binary_operation(ctx, operators::binop::LT, $1, load_name(ctx, $3)); }
+                          | Name LT ShiftExpressionNoName { $$ = binary_operation(ctx, operators::binop::LT, load_name(ctx, $1), $3); }
+                          | Name LT Name { $$ = binary_operation(ctx, operators::binop::LT, load_name(ctx, $1), load_name(ctx, $3)); }
+                          | ShiftExpressionNoName GT ShiftExpressionNoName { $$ = binary_operation(ctx, operators::binop::GT, $1, $3); }
+                          | ShiftExpressionNoName GT Name { $$ = binary_operation(ctx, operators::binop::GT, $1, load_name(ctx, $3)); }
+                          | Name GT ShiftExpressionNoName { $$ = binary_operation(ctx, operators::binop::GT, load_name(ctx, $1), $3); }
+                          | Name GT Name { $$ = binary_operation(ctx, operators::binop::GT, load_name(ctx, $1), load_name(ctx, $3)); }
+                          | ShiftExpressionNoName RELOP ShiftExpressionNoName { $$ = binary_operation(ctx, operators::to_binop($2), $1, $3); }
+                          | ShiftExpressionNoName RELOP Name { $$ = binary_operation(ctx, operators::to_binop($2), $1, load_name(ctx, $3)); }
+                          | Name RELOP ShiftExpressionNoName { $$ = binary_operation(ctx, operators::to_binop($2), load_name(ctx, $1), $3); }
+                          | Name RELOP Name { $$ = binary_operation(ctx, operators::to_binop($2), load_name(ctx, $1), load_name(ctx, $3)); }
                           ;
 
 ShiftExpressionNoName: AdditiveExpressionNoName { $$ = $1; }
-                     | ShiftExpressionNoName SHL AdditiveExpressionNoName
-                     | ShiftExpressionNoName SHL Name
-                     | ShiftExpressionNoName SHR AdditiveExpressionNoName
-                     | ShiftExpressionNoName SHR Name
-                     | ShiftExpressionNoName USHR AdditiveExpressionNoName
-                     | ShiftExpressionNoName USHR Name
-                     | Name SHL AdditiveExpressionNoName
-                     | Name SHL Name
-                     | Name SHR AdditiveExpressionNoName
-                     | Name SHR Name
-                     | Name USHR AdditiveExpressionNoName
-                     | Name USHR Name
+                     | ShiftExpressionNoName SHL AdditiveExpressionNoName { $$ = binary_operation(ctx, operators::binop::SHL, $1, $3); }
+                     | ShiftExpressionNoName SHL Name { $$ = binary_operation(ctx, operators::binop::SHL, $1, load_name(ctx, $3)); }
+                     | ShiftExpressionNoName SHR AdditiveExpressionNoName { $$ = binary_operation(ctx, operators::binop::SHR, $1, $3); }
+                     | ShiftExpressionNoName SHR Name { $$ = binary_operation(ctx, operators::binop::SHR, $1, load_name(ctx, $3)); }
+                     | ShiftExpressionNoName USHR AdditiveExpressionNoName { $$ = binary_operation(ctx, operators::binop::USHR, $1, $3); }
+                     | ShiftExpressionNoName USHR Name { $$ = binary_operation(ctx, operators::binop::USHR, $1, load_name(ctx, $3)); }
+                     | Name SHL AdditiveExpressionNoName { $$ = binary_operation(ctx, operators::binop::SHL, load_name(ctx, $1), $3); }
+                     | Name SHL Name { $$ = binary_operation(ctx, operators::binop::SHL, load_name(ctx, $1), load_name(ctx, $3)); }
+                     | Name SHR AdditiveExpressionNoName { $$ = binary_operation(ctx, operators::binop::SHR, load_name(ctx, $1), $3); }
+                     | Name SHR Name { $$ = binary_operation(ctx, operators::binop::SHR, load_name(ctx, $1), load_name(ctx, $3)); }
+                     | Name USHR AdditiveExpressionNoName { $$ = binary_operation(ctx, operators::binop::USHR, load_name(ctx, $1), $3); }
+                     | Name USHR Name { $$ = binary_operation(ctx, operators::binop::USHR, load_name(ctx, $1), load_name(ctx, $3)); }
                      ;
 
 
 AdditiveExpressionNoName: MultiplicativeExpressionNoName { $$ = $1; }
-                        | AdditiveExpressionNoName ADDOP MultiplicativeExpressionNoName
-                        | AdditiveExpressionNoName ADDOP Name
-                        | Name ADDOP MultiplicativeExpressionNoName
-                        | Name ADDOP Name
+                        | AdditiveExpressionNoName ADDOP MultiplicativeExpressionNoName { $$ = binary_operation(ctx, operators::to_binop($2), $1, $3); }
+                        | AdditiveExpressionNoName ADDOP Name { $$ = binary_operation(ctx, operators::to_binop($2), $1, load_name(ctx, $3)); }
+                        | Name ADDOP MultiplicativeExpressionNoName { $$ = binary_operation(ctx, operators::to_binop($2), load_name(ctx, $1), $3); }
+                        | Name ADDOP Name { $$ = binary_operation(ctx, operators::to_binop($2), load_name(ctx, $1), load_name(ctx, $3)); }
                         ;
 
 MultiplicativeExpressionNoName: UnaryExpressionNoName { $$ = $1; }
-                              | MultiplicativeExpressionNoName STAR UnaryExpressionNoName
-                              | MultiplicativeExpressionNoName STAR Name
-                              | Name STAR UnaryExpressionNoName
-                              | Name STAR Name
-                              | MultiplicativeExpressionNoName DIVOP UnaryExpressionNoName
-                              | MultiplicativeExpressionNoName DIVOP Name
-                              | Name DIVOP UnaryExpressionNoName
-                              | Name DIVOP Name
+                              | MultiplicativeExpressionNoName STAR UnaryExpressionNoName { $$ = binary_operation(ctx, operators::binop::MUL, $1, $3); }
+                              | MultiplicativeExpressionNoName STAR Name { $$ = binary_operation(ctx, operators::binop::MUL, $1, load_name(ctx, $3)); }
+                              | Name STAR UnaryExpressionNoName { $$ = binary_operation(ctx, operators::binop::MUL, load_name(ctx, $1), $3); }
+                              | Name STAR Name { $$ = binary_operation(ctx, operators::binop::MUL, load_name(ctx, $1), load_name(ctx, $3)); }
+                              | MultiplicativeExpressionNoName DIVOP UnaryExpressionNoName { $$ = binary_operation(ctx, operators::to_binop($2), $1, $3); }
+                              | MultiplicativeExpressionNoName DIVOP Name { $$ = binary_operation(ctx, operators::to_binop($2), $1, load_name(ctx, $3)); }
+                              | Name DIVOP UnaryExpressionNoName { $$ = binary_operation(ctx, operators::to_binop($2), load_name(ctx, $1), $3); }
+                              | Name DIVOP Name { $$ = binary_operation(ctx, operators::to_binop($2), load_name(ctx, $1), load_name(ctx, $3)); }
                               ;
 
-CastExpressionNoName: LPAR PrimitiveType RPAR UnaryExpressionNoName
-                    | LPAR PrimitiveType RPAR Name
+CastExpressionNoName: LPAR PrimitiveType RPAR UnaryExpressionNoName { $$ = cast_expression(ctx, $2, $4); }
+                    | LPAR PrimitiveType RPAR Name                  { $$ = cast_expression(ctx, $2, load_name(ctx, $4)); }
                     | LPAR ReferenceTypeNoName RPAR UnaryExpressionNotPlusMinusNoName
                     | LPAR ReferenceTypeNoName RPAR Name
                     | LPAR Name RPAR UnaryExpressionNotPlusMinusNoName
@@ -1025,26 +1087,28 @@ CastExpressionNoName: LPAR PrimitiveType RPAR UnaryExpressionNoName
                     ;
 
 UnaryExpressionNotPlusMinusNoName: PostfixExpressionNoName { $$ = $1; }
-                                 | TILDE UnaryExpressionNoName
-                                 | TILDE Name
-                                 | EMPH UnaryExpressionNoName
-                                 | EMPH Name
+                                 | TILDE UnaryExpressionNoName { $$ = unary_operation(ctx, operators::unop::NOT, $2); }
+                                 | TILDE Name                  { $$ = unary_operation(ctx, operators::unop::NOT, load_name(ctx, $2)); }
+                                 | EMPH UnaryExpressionNoName  { $$ = unary_operation(ctx, operators::unop::LNOT, $2); }
+                                 | EMPH Name                   { $$ = unary_operation(ctx, operators::unop::LNOT, load_name(ctx, $2)); }
                                  | CastExpressionNoName { $$ = $1; }
                                  ;
 
-PreIncDecExpression: INCDEC UnaryExpressionNoName
-                   | INCDEC Name
+PreIncDecExpression: INCDEC UnaryExpressionNoName { $$ = increment(ctx, $1, $2, false); }
+                   | INCDEC Name                { $$ = increment(ctx, $1, $2, false); }
                    ;
 
 UnaryExpressionNoName: PreIncDecExpression { $$ = $1; }
-                     | ADDOP UnaryExpressionNoName
-                     | ADDOP Name
+                     | ADDOP UnaryExpressionNoName { $$ = unary_operation(ctx, operators::to_unop($1), $2); }
+                     | ADDOP Name                  { $$ = unary_operation(ctx, operators::to_unop($1), load_name(ctx, $2)); }
+                     | ADDOP MIN_INT_LIT           { $$ = load_negated_literal(ctx, $1, $2, std::numeric_limits<int_t>::min()); }
+                     | ADDOP MIN_LONG_LIT          { $$ = load_negated_literal(ctx, $1, $2, std::numeric_limits<long_t>::min()); }
                      | UnaryExpressionNotPlusMinusNoName { $$ = $1; }
                      ;
 
 
-PostIncDecExpression: PostfixExpressionNoName INCDEC
-                    | Name INCDEC
+PostIncDecExpression: PostfixExpressionNoName INCDEC { $$ = increment(ctx, $2, $1, true); }
+                    | Name INCDEC               { $$ = increment(ctx, $2, $1, true); }
                     ;
 
 PostfixExpressionNoName: PrimaryNoName          { $$ = $1; }
@@ -1055,8 +1119,9 @@ ConstantExpressionNoName: ExpressionNoName
                         ;
 
 PrimaryNoName: Literal          { $$ = $1; }
-             | LPAR ExpressionNoName RPAR
-             | LPAR Name RPAR
+             | LPAR ExpressionNoName RPAR { $$ = $2; }
+             | LPAR Name RPAR             { $$ = load_name(ctx, $2); }
+             | THIS { $$ = load_this(ctx); }
              | THIS ThisSuffix
              | SUPER SuperSuffix
              | NEW Creator { $$ = $2; }
@@ -1064,8 +1129,8 @@ PrimaryNoName: Literal          { $$ = $1; }
              /* | NonWildcardTypeArguments THIS Arguments */
              | PrimitiveType Dims_opt DOT CLASS
              | VOID DOT CLASS
-             | Name LBRA ExpressionNoName RBRA
-             | Name LBRA Name RBRA
+             | Name LBRA ExpressionNoName RBRA { $$ = load_array_element(ctx, load_name(ctx, $1), $3); }
+             | Name LBRA Name RBRA { $$ = load_array_element(ctx, load_name(ctx, $1), load_name(ctx, $3)); }
              | MethodName Arguments  { $$ = invoke_method(ctx, $1, $2); }
              | Name DOT CLASS
              | Name DOT ExplicitGenericInvocation
@@ -1074,18 +1139,20 @@ PrimaryNoName: Literal          { $$ = $1; }
              | Name DOT NEW NonWildcardTypeArguments_opt InnerCreator
              | Name LBRA Dims DOT CLASS RBRA
              | PrimaryNoName DOT Identifier Arguments { $$ = invoke_method(ctx, $1, $3, $4); }
-             | PrimaryNoName DOT Identifier
+             | PrimaryNoName DOT Identifier { $$ = load_field(ctx, $1, $3); }
              ;
 
 MethodName: Name    {  $$ = resolve_method_class(ctx, $1); }
           ;
 
-Literal: INT_LIT
-       | FLOAT_LIT
-       | CHAR_LIT
+Literal: INT_LIT        { $$ = load_literal(ctx, $1); }
+       | LONG_LIT       { $$ = load_literal(ctx, $1); }
+       | FLOAT_LIT      { $$ = load_literal(ctx, $1); }
+       | DOUBLE_LIT     { $$ = load_literal(ctx, $1); }
+       | CHAR_LIT       { $$ = load_literal(ctx, $1); }
        | STR_LIT        { $$ = load_string_literal(ctx, $1); }
-       | TRUE
-       | FALSE
+       | TRUE           { $$ = load_literal(ctx, true); }
+       | FALSE          { $$ = load_literal(ctx, false); }
        | NULL
        ;
 
@@ -1100,8 +1167,6 @@ SuperSuffix: Arguments
            ;
 
 ThisSuffix: Arguments
-          | DOT Identifier
-          | DOT Identifier Arguments
           ;
 
 ExplicitGenericInvocationSuffix: SUPER SuperSuffix
@@ -1110,30 +1175,40 @@ ExplicitGenericInvocationSuffix: SUPER SuperSuffix
 
 
 Creator: NonWildcardTypeArguments CreatedName ClassCreatorRest
-       | CreatedName ClassCreatorRest { $$ = instantiate_object(ctx, $1); }
+       | CreatedName ClassCreatorRest { $$ = instantiate_object(ctx, $1, $2); }
+       | CreatedName DimExpr          { $$ = create_array(ctx, find_class(ctx, $1), $2); }
+       | CreatedName DimExpr Dims     { $$ = create_array(ctx, ctx->type_table().get_array_type(find_class(ctx, $1), $3), $2); }
        | CreatedName ArrayCreatorRest
+       | PrimitiveType DimExpr        { $$ = create_array(ctx, $1, $2); }
+       | PrimitiveType DimExpr Dims   { $$ = create_array(ctx, ctx->type_table().get_array_type($1, $3), $2); }
+       ;
+
+DimExpr: LBRA ExpressionNoName RBRA { $$ = $2; }
+       | LBRA Name RBRA             { $$ = load_name(ctx, $2); }
        ;
 
-CreatedName: Identifier CreatedNameTail_opt { $$ = $1; }
+CreatedName: Identifier CreatedNameTail_opt { $$ = $1 + $2; }
            | Identifier TypeArgumentsOrDiamond CreatedNameTail_opt
            ;
 
-CreatedNameTail_opt: %empty | CreatedNameTail ;
+CreatedNameTail_opt: %empty             { }
+                   | CreatedNameTail    { $$ = $1; }
+                   ;
 
-CreatedNameTail: DOT Identifier
-               | DOT Identifier TypeArgumentsOrDiamond
-               | CreatedNameTail DOT Identifier
-               | CreatedNameTail DOT Identifier TypeArgumentsOrDiamond
+CreatedNameTail: DOT Identifier                                         { $$ = "/" + $2; }
+               | DOT Identifier TypeArgumentsOrDiamond                  { $$ = "/" + $2; }
+               | CreatedNameTail DOT Identifier                         { $$ = $1 + "/" + $3; }
+               | CreatedNameTail DOT Identifier TypeArgumentsOrDiamond  { $$ = $1 + "/" + $3; }
                ;
 
-ClassCreatorRest: Arguments
+ClassCreatorRest: Arguments           { $$ = $1; }
                 | Arguments ClassBody
                 ;
 
 ArrayCreatorRest: LBRA RBRA ArrayInitializer
                 | LBRA RBRA Dims ArrayInitializer
-                | LBRA ExpressionNoName RBRA ArrayCreatorExpressions
-                | LBRA ExpressionNoName RBRA ArrayCreatorExpressions Dims
+                | DimExpr ArrayCreatorExpressions
+                | DimExpr ArrayCreatorExpressions Dims
                 ;
 
 ArrayCreatorExpressions: LBRA ExpressionNoName RBRA
@@ -1200,6 +1275,12 @@ namespace jawa {
 
     void parser::report_syntax_error(parser::context const &parser_ctx) const
     {
+        // a literal of the magnitude of the minimum is out of range unless it is negated
+        if (parser_ctx.token() == symbol_kind::S_MIN_INT_LIT || parser_ctx.token() == symbol_kind::S_MIN_LONG_LIT) {
+            ctx->message(errors::NUMBER_OUT_OF_RANGE, parser_ctx.location(), parser_ctx.lookahead().value.as<Name>());
+            return;
+        }
+
         // Max 3 expected tokens
         symbol_kind_type expected[3];
         int n = parser_ctx.expected_tokens(expected, 3);
@@ -9,59 +9,151 @@
  */
 
 #include "parser_sem.hpp"
+#include "builders.hpp"
 #include "class.hpp"
-#include <iostream>
+#include "folding.hpp"
+#include "hoisting.hpp"
+#include "log.hpp"
+#include "lowering.hpp"
+#include "slots.hpp"
+#include <algorithm>
+#include <fstream>
+#include <limits>
 
 #define BUILDER ctx->class_builder()
 #define TYPE_TABLE ctx->type_table()
 #define CLASS_TABLE ctx->class_table()
 #define SCOPE_TABLE ctx->scope_table()
-#define CLINIT ctx->static_initializer()
+#define ARENA ctx->arena()
+
+/**
+ * Skips the rest of a semantic action if the compiler stops after parsing, otherwise the action is measured
+ * as a part of the code generation phase.
+ */
+#define SEMANTIC_ACTION(...)                                                                                           \
+    if (!ctx->runs(Phase::GENERATION))                                                                                 \
+        return __VA_ARGS__;                                                                                            \
+    auto phase = ctx->statistics().measure(Phase::GENERATION)
 
 namespace jawa {
 
+    /**
+     * Loads the class of a supertype in the declaration of a class.
+     *
+     * @return loaded class, nullptr if the type is not a class type or the class is not found.
+     */
+    static const JawaClass *
+    load_supertype(context_t ctx, TypeObs type)
+    {
+        auto class_type = dynamic_cast<ClassTypeObs>(type);
+        if (class_type == nullptr) {
+            ctx->message(errors::EXPECTED_REFERENCE_TYPE, ctx->loc());
+            return nullptr;
+        }
+        const JawaClass *jawa_class = CLASS_TABLE.load_class(class_type->class_name());
+        if (jawa_class == nullptr)
+            ctx->message(errors::CLASS_NOT_FOUND, ctx->loc(), class_type->class_name());
+        return jawa_class;
+    }
+
     void
-    enter_class(context_t ctx, const Name &class_name)
+    enter_class(context_t ctx, const Name &class_name, TypeObs super_type, const TypeObsArray &interface_types)
     {
-        std::cout << "entering class " << class_name << std::endl;
+        SEMANTIC_ACTION();
+        LOG_DEBUG("entering class ", class_name);
         ctx->new_class_builder(class_name);
-        BUILDER.set_version(59, 0);
+        BUILDER.set_version(ctx->class_version(), 0);
         BUILDER.set_access_flags(jasm::Class::ACC_PUBLIC | jasm::Class::ACC_SUPER);
+
+        JawaSupertypes supertypes{ "java/lang/Object", {} };
+        // a type with type arguments has no type yet and the class then extends java.lang.Object
+        if (super_type != nullptr) {
+            if (const JawaClass *super_class = load_supertype(ctx, super_type)) {
+                if (super_class->is_interface() || (super_class->access_flags() & jasm::Class::ACC_FINAL))
+                    ctx->message(errors::INVALID_SUPERCLASS, ctx->loc(), super_class->class_name());
+                else
+                    supertypes.super_class = super_class->class_name();
+            }
+        }
+        for (TypeObs interface_type : interface_types) {
+            if (interface_type == nullptr)
+                continue;
+            if (const JawaClass *interface = load_supertype(ctx, interface_type)) {
+                if (!interface->is_interface())
+                    ctx->message(errors::EXPECTED_INTERFACE, ctx->loc(), interface->class_name());
+                else
+                    supertypes.interfaces.push_back(interface->class_name());
+            }
+        }
+        BUILDER.set_super_class(supertypes.super_class);
+        for (auto &interface : supertypes.interfaces)
+            BUILDER.add_interface(interface);
+
+        ClassTypeObs this_type = TYPE_TABLE.get_class_type(BUILDER.class_name());
+        auto *receiver = ARENA.make<ir::Local>("to", this_type, 0);
+        ctx->set_ir_class(ARENA.make<ir::Class>(BUILDER.class_name(), supertypes.super_class, receiver));
+        CLASS_TABLE.declare_class(BUILDER.class_name(), std::move(supertypes));
     }
 
-    void
-    generate_static_initializer(context_t p_context);
     void
     leave_class(context_t ctx)
     {
-        std::cout << "leaving class" << std::endl;
+        SEMANTIC_ACTION();
+        LOG_DEBUG("leaving class");
+        ir::Class *ir_class = ctx->ir_class();
+
+        auto is_constructor = [](const ir::Method *method) { return method->name == "<init>"; };
+        if (std::none_of(ir_class->methods.begin(), ir_class->methods.end(), is_constructor))
+            ir_class->methods.push_back(generate_default_constructor(ctx));
+
+        // the instance fields are initialised right after the constructor of the superclass returns
+        for (auto *method : ir_class->methods) {
+            if (is_constructor(method) && method->body != nullptr) {
+                auto &statements = method->body->statements;
+                statements.insert(statements.begin() + 1, ir_class->field_initializers.begin(),
+                                  ir_class->field_initializers.end());
+            }
+        }
+
+        for (auto *method : ir_class->methods) {
+            hoist_invariants(ARENA, *ir_class, *method);
+            use_string_builders(ARENA, TYPE_TABLE, *method);
+            allocate_slots(*method);
+        }
+        if (ir_class->static_initializer) {
+            hoist_invariants(ARENA, *ir_class, *ir_class->static_initializer);
+            use_string_builders(ARENA, TYPE_TABLE, *ir_class->static_initializer);
+            allocate_slots(*ir_class->static_initializer);
+        }
 
-        // TODO: check if no constructor was created
-        generate_default_constructor(ctx);
+        // the methods are lowered once the whole class is known
+        Lowering lowering(BUILDER, TYPE_TABLE, ctx->class_version());
+        if (ctx->inline_methods())
+            lowering.enable_inlining(*ir_class);
+        for (auto *method : ir_class->methods)
+            lowering.lower_method(*method);
+        if (ir_class->static_initializer && !ir_class->static_initializer->body->statements.empty())
+            lowering.lower_method(*ir_class->static_initializer);
 
-        if (CLINIT.length() > 0)
-            generate_static_initializer(ctx);
+        ctx->set_ir_class(nullptr);
+        ARENA.reset();
 
         auto class_name = BUILDER.class_name();
         jasm::Class clazz = BUILDER.build();
-        std::cout << clazz;
+        // constants of the inlined calls and of the removed code are no longer referred to
+        clazz.remove_unused_constants();
+        LOG_TRACE(clazz);
 
+        if (!ctx->runs(Phase::EMISSION))
+            return;
+
+        auto emission = ctx->statistics().measure(Phase::EMISSION);
         std::ofstream os(class_name + ".class");
         clazz.emit_bytecode(os);
+        ctx->statistics().add_bytes(Phase::EMISSION, os.tellp());
         os.close();
     }
 
-    void
-    generate_static_initializer(context_t ctx)
-    {
-        VoidTypeObs void_type = TYPE_TABLE.get_void_type();
-        MethodTypeObs void_method_type = TYPE_TABLE.get_method_type(void_type, TypeObsArray());
-        BUILDER.enter_method("<clinit>", *void_method_type, jasm::Method::ACC_STATIC);
-        CLINIT.make_instruction<jasm::Return>();
-        BUILDER.add_basic_block(std::move(CLINIT));
-        BUILDER.leave_method();
-    }
-
     bool
     is_main(context_t ctx, const Name &method_name, TypeObs return_type, TypeObsArray &argument_types)
     {
@@ -79,102 +171,273 @@ namespace jawa {
     void
     enter_method(context_t ctx, const Name &method_name, TypeObs return_type, FormalParamArray &formal_params)
     {
-        std::cout << "entering method " << method_name << std::endl;
+        SEMANTIC_ACTION();
+        LOG_DEBUG("entering method ", method_name);
 
         TypeObsArray argument_types;
         for (auto &formal_param : formal_params)
             argument_types.push_back(formal_param.type);
 
         MethodTypeObs method_type = TYPE_TABLE.get_method_type(return_type, argument_types);
+        ir::Method *method;
         if (is_main(ctx, method_name, return_type, argument_types)) {
-            BUILDER.enter_method("main", *method_type,
-                                 jasm::Method::ACC_PUBLIC | jasm::Method::ACC_STATIC // <- temproary TODO: remove
-            );
+            method = ARENA.make<ir::Method>("main", method_type);
         } else {
-            BUILDER.enter_method(method_name, *method_type);
+            method = ARENA.make<ir::Method>(method_name, method_type);
         }
+        ctx->set_ir_method(method);
 
         SCOPE_TABLE.enter_scope();
-        // TODO: if the function is not static
-        // SCOPE_TABLE.add_var("this", TYPE_TABLE.get_class_type(BUILDER.class_name()));
+        SCOPE_TABLE.reset_limit();
         for (auto &formal_param : formal_params) {
-            SCOPE_TABLE.add_var(formal_param.name, formal_param.type);
+            auto *local = ARENA.make<ir::Local>(formal_param.name, formal_param.type, 0);
+            local->index = SCOPE_TABLE.add_var(formal_param.name, formal_param.type, local);
+            method->parameters.push_back(local);
         }
     }
 
     void
-    enter_static_initializer(context_t ctx)
+    enter_constructor(context_t ctx, const Name &name, FormalParamArray &formal_params)
+    {
+        SEMANTIC_ACTION();
+        const Name &class_name = ctx->ir_class()->name;
+        if (name != class_name.substr(class_name.rfind('/') + 1))
+            ctx->message(errors::MISSING_RETURN_TYPE, ctx->loc(), name);
+        enter_method(ctx, "<init>", TYPE_TABLE.get_void_type(), formal_params);
+    }
+
+    /**
+     * Returns the static initializer of the current class, it is created on the first use.
+     */
+    static ir::Method *
+    static_initializer(context_t ctx)
     {
-        std::cout << "entering static initializer" << std::endl;
-        BUILDER.set_insertion_point(&CLINIT);
+        ir::Class *ir_class = ctx->ir_class();
+        if (ir_class->static_initializer == nullptr) {
+            VoidTypeObs void_type = TYPE_TABLE.get_void_type();
+            MethodTypeObs void_method_type = TYPE_TABLE.get_method_type(void_type, TypeObsArray());
+            ir_class->static_initializer = ARENA.make<ir::Method>("<clinit>", void_method_type);
+            ir_class->static_initializer->access_flags = jasm::Method::ACC_STATIC;
+            ir_class->static_initializer->body = ARENA.make<ir::Block>(ir::StatementArray());
+        }
+        return ir_class->static_initializer;
     }
 
     void
-    set_method_modifiers(context_t ctx, const ModifierAndAnnotationPack &pack)
+    enter_static_initializer(context_t ctx)
+    {
+        SEMANTIC_ACTION();
+        LOG_DEBUG("entering static initializer");
+        ctx->set_ir_method(static_initializer(ctx));
+        SCOPE_TABLE.enter_scope();
+        SCOPE_TABLE.reset_limit();
+    }
+
+    static jasm::u2
+    method_access_flags(const ModifierAndAnnotationPack &pack)
     {
         jasm::u2 flags = 0;
         if (pack.modifier_pack.get(Modifier::PUBLIC) != ModifierForm::NONE)
             flags |= jasm::Method::ACC_PUBLIC;
+        if (pack.modifier_pack.get(Modifier::PRIVATE) != ModifierForm::NONE)
+            flags |= jasm::Method::ACC_PRIVATE;
+        if (pack.modifier_pack.get(Modifier::PROTECTED) != ModifierForm::NONE)
+            flags |= jasm::Method::ACC_PROTECTED;
         if (pack.modifier_pack.get(Modifier::STATIC) != ModifierForm::NONE)
             flags |= jasm::Method::ACC_STATIC;
+        if (pack.modifier_pack.get(Modifier::FINAL) != ModifierForm::NONE)
+            flags |= jasm::Method::ACC_FINAL;
         if (pack.modifier_pack.get(Modifier::NATIVE) != ModifierForm::NONE)
             flags |= jasm::Method::ACC_NATIVE;
-        BUILDER.current_method()->set_access_flags(flags);
+        if (pack.modifier_pack.get(Modifier::SYNCHRONIZED) != ModifierForm::NONE)
+            flags |= jasm::Method::ACC_SYNCHRONIZED;
+        return flags;
+    }
+
+    /**
+     * Checks whether a statement or an expression refers to a local variable.
+     */
+    static bool
+    refers_to(const ir::Node *node, const ir::Local *local)
+    {
+        auto load = ir::node_cast<ir::LocalLoad>(node);
+        if (load != nullptr && load->local == local)
+            return true;
+        bool found = false;
+        ir::for_each_child(node, [&found, local](const ir::Node *child) { found = found || refers_to(child, local); });
+        return found;
+    }
+
+    /**
+     * Calls the constructor of the superclass without arguments.
+     */
+    static ir::Statement *
+    super_call(context_t ctx)
+    {
+        MethodTypeObs void_method_type = TYPE_TABLE.get_method_type(TYPE_TABLE.get_void_type(), TypeObsArray());
+        auto *receiver = ARENA.make<ir::LocalLoad>(ctx->ir_class()->receiver);
+        return ARENA.make<ir::ExpressionStatement>(ARENA.make<ir::Invoke>(
+          ir::Invoke::SPECIAL, ctx->ir_class()->super_name, "<init>", void_method_type, receiver,
+          ir::ExpressionArray()));
     }
 
     void
-    leave_method(context_t ctx, const ModifierAndAnnotationPack &pack)
+    leave_method(context_t ctx, const ModifierAndAnnotationPack &pack, ir::Block *body)
     {
-        if (BUILDER.current_method() != nullptr) {
-            std::cout << "leaving method" << std::endl;
-            SCOPE_TABLE.leave_scope();
+        SEMANTIC_ACTION();
+        ir::Method *method = ctx->ir_method();
+        if (method == nullptr)
+            return;
 
-            set_method_modifiers(ctx, pack);
+        LOG_DEBUG("leaving method");
+        // the static initializer blocks share the slots of their local variables
+        method->locals_limit = std::max(method->locals_limit, SCOPE_TABLE.limit());
+        SCOPE_TABLE.leave_scope();
+        ctx->set_ir_method(nullptr);
 
-            BUILDER.make_instruction<jasm::Return>();
-            BUILDER.leave_method();
-            BUILDER.set_insertion_point(&CLINIT);
+        ir::Class *ir_class = ctx->ir_class();
+        bool refers_to_receiver = body != nullptr && refers_to(body, ir_class->receiver);
+        if (method == ir_class->static_initializer) {
+            if (refers_to_receiver)
+                ctx->message(errors::NON_STATIC_IN_STATIC_CONTEXT, ctx->loc());
+            // all the static initializer blocks are merged into one method
+            auto &statements = method->body->statements;
+            statements.insert(statements.end(), body->statements.begin(), body->statements.end());
+            return;
         }
+
+        method->access_flags = method_access_flags(pack);
+        method->body = body;
+        if (method->name == "<init>") {
+            method->access_flags &= ~jasm::Method::ACC_STATIC;
+            method->receiver = ir_class->receiver;
+            body->statements.insert(body->statements.begin(), super_call(ctx));
+        } else if (refers_to_receiver) {
+            if (method->access_flags & jasm::Method::ACC_STATIC)
+                ctx->message(errors::NON_STATIC_IN_STATIC_CONTEXT, ctx->loc());
+            else
+                method->receiver = ir_class->receiver;
+        }
+        ir_class->methods.push_back(method);
     }
 
     void
     declare_method(context_t ctx, const ModifierAndAnnotationPack &pack)
     {
-        std::cout << "declaring method" << std::endl;
-        set_method_modifiers(ctx, pack);
-        BUILDER.leave_method();
+        SEMANTIC_ACTION();
+        ir::Method *method = ctx->ir_method();
+        if (method == nullptr)
+            return;
+
+        LOG_DEBUG("declaring method");
+        SCOPE_TABLE.leave_scope();
+        ctx->set_ir_method(nullptr);
+
+        method->access_flags = method_access_flags(pack);
+        ctx->ir_class()->methods.push_back(method);
+    }
+
+    /**
+     * Checks whether a class name refers to the compiled class, which is not in the class table until it is written.
+     */
+    static bool
+    is_compiled_class(context_t ctx, const Name &name)
+    {
+        const ir::Class *ir_class = ctx->ir_class();
+        if (ir_class == nullptr)
+            return false;
+        return name == ir_class->name || name == ir_class->name.substr(ir_class->name.rfind('/') + 1);
     }
 
     TypeObs
     find_class(context_t ctx, const Name &name)
     {
+        SEMANTIC_ACTION(nullptr);
         if (name == "Łańcuch") // temporary measure
             return TYPE_TABLE.get_class_type("java/lang/String");
+        if (is_compiled_class(ctx, name))
+            return TYPE_TABLE.get_class_type(ctx->ir_class()->name);
         auto cls = CLASS_TABLE.load_class(name);
         assert(cls != nullptr);
         return TYPE_TABLE.get_class_type(cls->class_name());
     }
 
-    void
+    ir::Method *
     generate_default_constructor(context_t ctx)
     {
         VoidTypeObs void_type = TYPE_TABLE.get_void_type();
         MethodTypeObs void_method_type = TYPE_TABLE.get_method_type(void_type, TypeObsArray());
-        BUILDER.enter_method("<init>", *void_method_type, jasm::Method::ACC_PUBLIC);
-        BUILDER.make_instruction<jasm::RefLoad0>();
-        jasm::u2 object_constructor = BUILDER.add_method_constant("java/lang/Object", "<init>", *void_method_type);
-        BUILDER.make_instruction<jasm::InvokeSpecial>(U2_SPLIT(object_constructor));
-        BUILDER.make_instruction<jasm::Return>();
-        BUILDER.leave_method();
+
+        auto *constructor = ARENA.make<ir::Method>("<init>", void_method_type);
+        constructor->access_flags = jasm::Method::ACC_PUBLIC;
+        constructor->receiver = ctx->ir_class()->receiver;
+        constructor->body = ARENA.make<ir::Block>(ir::StatementArray{ super_call(ctx) });
+        return constructor;
     }
 
     Expression
     load_string_literal(context_t ctx, const Name &name)
     {
-        jasm::u2 str_index = BUILDER.add_string_constant(name);
-        // TODO: check if str_index <= 0xFF, otherwise use different instruction
-        BUILDER.make_instruction<jasm::LoadConst>(U2_LOW(str_index));
-        return Expression(TYPE_TABLE.get_class_type("java/lang/String"));
+        SEMANTIC_ACTION(Expression());
+        return Expression(ARENA.make<ir::Constant>(TYPE_TABLE.get_class_type("java/lang/String"), name));
+    }
+
+    Expression
+    load_literal(context_t ctx, int_t value)
+    {
+        SEMANTIC_ACTION(Expression());
+        return Expression(ARENA.make<ir::Constant>(TYPE_TABLE.get_int_type(), value));
+    }
+
+    Expression
+    load_literal(context_t ctx, long_t value)
+    {
+        SEMANTIC_ACTION(Expression());
+        return Expression(ARENA.make<ir::Constant>(TYPE_TABLE.get_long_type(), value));
+    }
+
+    Expression
+    load_literal(context_t ctx, float_t value)
+    {
+        SEMANTIC_ACTION(Expression());
+        return Expression(ARENA.make<ir::Constant>(TYPE_TABLE.get_float_type(), value));
+    }
+
+    Expression
+    load_literal(context_t ctx, double_t value)
+    {
+        SEMANTIC_ACTION(Expression());
+        return Expression(ARENA.make<ir::Constant>(TYPE_TABLE.get_double_type(), value));
+    }
+
+    Expression
+    load_literal(context_t ctx, char_t value)
+    {
+        SEMANTIC_ACTION(Expression());
+        return Expression(ARENA.make<ir::Constant>(TYPE_TABLE.get_char_type(), static_cast<int_t>(value)));
+    }
+
+    Expression
+    load_literal(context_t ctx, bool_t value)
+    {
+        SEMANTIC_ACTION(Expression());
+        return Expression(ARENA.make<ir::Constant>(TYPE_TABLE.get_boolean_type(), static_cast<int_t>(value)));
+    }
+
+    Expression
+    load_negated_literal(context_t ctx, operators::addop op, const Name &literal, int_t value)
+    {
+        if (op != operators::SUB)
+            ctx->message(errors::NUMBER_OUT_OF_RANGE, ctx->loc(), literal);
+        return load_literal(ctx, value);
+    }
+
+    Expression
+    load_negated_literal(context_t ctx, operators::addop op, const Name &literal, long_t value)
+    {
+        if (op != operators::SUB)
+            ctx->message(errors::NUMBER_OUT_OF_RANGE, ctx->loc(), literal);
+        return load_literal(ctx, value);
     }
 
     static std::vector<std::size_t>
@@ -191,72 +454,312 @@ namespace jawa {
         return indices;
     }
 
-    ClassAndName
-    resolve_method_class(context_t ctx, const Name &method)
+    /**
+     * Loads a static field of an imported class. The values of constant fields are inlined.
+     *
+     * @return value of the field, nullptr if the field does not exist or it is not static.
+     */
+    static ir::Expression *
+    load_static_field(context_t ctx, const JawaClass *jawa_class, const Name &class_name, const Name &field_name)
     {
-        auto splits = split_name(method);
-
-        if (splits.size() == 2) {
-            // TODO: method in this class
-            assert(false);
+        const JawaField *jawa_field = jawa_class->get_field(field_name);
+        if (jawa_field == nullptr) {
+            ctx->message(errors::FIELD_NOT_FOUND, ctx->loc(), field_name, class_name);
+            return nullptr;
+        }
+        if (!(jawa_field->access_flags() & jasm::Field::ACC_STATIC)) {
+            ctx->message(errors::NON_STATIC_FIELD, ctx->loc(), field_name, class_name);
+            return nullptr;
         }
 
-        // TODO: check for local variables and this class fields
+        if (const ConstantValue *value = jawa_field->constant_value())
+            return ARENA.make<ir::Constant>(jawa_field->type(), *value);
+        return ARENA.make<ir::StaticFieldLoad>(jawa_field->type(), class_name, field_name);
+    }
+
+    struct QualifiedName
+    {
+        Name class_name;
+        ir::Expression *value;
+    };
+
+    /**
+     * Resolves a name consisting of a class name followed by a static field and a chain of fields of its value.
+     *
+     * @return value of the last field (nullptr if the name is a class name) and the class of the object it is
+     *         loaded from, std::nullopt if the name cannot be resolved.
+     */
+    static std::optional<QualifiedName>
+    resolve_qualified_name(context_t ctx, const Name &name)
+    {
+        auto splits = split_name(name);
 
         Name class_name;
         std::vector<std::size_t>::iterator it;
-        for (it = splits.begin() + 1; it + 1 < splits.end(); ++it) {
-            Name name = CLASS_TABLE.get_fully_qualified_name(method.substr(0, *it));
-            if (!name.empty()) {
-                class_name = name;
+        for (it = splits.begin() + 1; it < splits.end(); ++it) {
+            Name fully_qualified_name = CLASS_TABLE.get_fully_qualified_name(name.substr(0, *it));
+            if (!fully_qualified_name.empty()) {
+                class_name = fully_qualified_name;
                 break;
             }
         }
 
         if (class_name.empty()) {
-            ctx->message(errors::CLASS_NOT_FOUND, ctx->loc(), method.substr(0, splits[1]));
-            return {};
+            ctx->message(errors::CLASS_NOT_FOUND, ctx->loc(), name.substr(0, splits[1]));
+            return std::nullopt;
         }
 
+        if (it + 1 == splits.end())
+            return QualifiedName{ class_name, nullptr };
+
         const JawaClass *jawa_class = CLASS_TABLE.load_class(class_name);
-        Name method_name = method.substr(splits[splits.size() - 2] + 1);
-
-        if (it + 2 != splits.end()) {
-            jasm::u2 field_index;
-            for (; it + 2 < splits.end(); ++it) {
-                // this is a bit messy
-                Name field_name = method.substr(*it + 1, *(it + 1) - *it - 1);
-                const JawaField *jawa_field = jawa_class->get_field(field_name);
-                if (jawa_field == nullptr) {
-                    ctx->message(errors::FIELD_NOT_FOUND, ctx->loc(), field_name, class_name);
-                    return {};
-                }
-                assert(jawa_field->access_flags() & jasm::Field::ACC_STATIC);
-                auto class_type = dynamic_cast<ClassTypeObs>(jawa_field->type());
-                assert(class_type); // in fact it could also be an array
-
-                field_index = BUILDER.add_field_constant(class_name, field_name,
-                                                         *TYPE_TABLE.get_class_type(class_type->class_name()));
-                BUILDER.make_instruction<jasm::GetStatic>(U2_SPLIT(field_index));
-
-                jawa_class = CLASS_TABLE.load_class(class_type->class_name());
-                if (jawa_class == nullptr) {
-                    ctx->message(errors::CLASS_NOT_FOUND, ctx->loc(), class_type->class_name());
-                    return {};
-                }
+        if (jawa_class == nullptr) {
+            ctx->message(errors::CLASS_NOT_FOUND, ctx->loc(), class_name);
+            return std::nullopt;
+        }
+        // only the first field is accessed through the class, the following ones are fields of its value
+        Name field_name = name.substr(*it + 1, *(it + 1) - *it - 1);
+        ir::Expression *field = load_static_field(ctx, jawa_class, class_name, field_name);
+        if (field == nullptr)
+            return std::nullopt;
+
+        Expression value(field);
+        for (++it; value.node != nullptr && it + 1 < splits.end(); ++it) {
+            if (auto class_type = dynamic_cast<ClassTypeObs>(value.type))
                 class_name = class_type->class_name();
+            value = load_field(ctx, value, name.substr(*it + 1, *(it + 1) - *it - 1));
+        }
+        if (value.node == nullptr)
+            return std::nullopt;
+
+        return QualifiedName{ class_name, value.node };
+    }
+
+    /**
+     * Loads a field of the compiled class.
+     *
+     * @param object object whose field is loaded, nullptr for the receiver of the current method.
+     * @return value of the field, nullptr if there is no such field.
+     */
+    static ir::Expression *
+    load_own_field(context_t ctx, ir::Expression *object, const Name &name)
+    {
+        // TODO: fields declared after their use
+        ir::Class *ir_class = ctx->ir_class();
+        auto search = ir_class->fields.find(name);
+        if (search == ir_class->fields.end())
+            return nullptr;
+        const ir::Field *field = search->second;
+        if (field->constant_value != nullptr)
+            return ARENA.make<ir::Constant>(field->type, field->constant_value->value);
+        if (field->access_flags & jasm::Field::ACC_STATIC)
+            return ARENA.make<ir::StaticFieldLoad>(field->type, ir_class->name, field->name);
+        if (object == nullptr)
+            object = ARENA.make<ir::LocalLoad>(ir_class->receiver);
+        return ARENA.make<ir::FieldLoad>(field->type, object, ir_class->name, field->name);
+    }
+
+    /**
+     * Loads a local variable or a field of the compiled class.
+     *
+     * @return value of the variable, nullptr if there is no such variable.
+     */
+    static ir::Expression *
+    load_variable(context_t ctx, const Name &name)
+    {
+        if (auto *var = SCOPE_TABLE.get_var(name))
+            return ARENA.make<ir::LocalLoad>(var->local);
+        return load_own_field(ctx, nullptr, name);
+    }
+
+    Expression
+    load_field(context_t ctx, const Expression &object, const Name &field_name)
+    {
+        SEMANTIC_ACTION(Expression());
+        if (object.node == nullptr)
+            return Expression();
+        if (dynamic_cast<ArrayTypeObs>(object.type) != nullptr && field_name == "długość")
+            return Expression(ARENA.make<ir::ArrayLength>(TYPE_TABLE.get_int_type(), object.node));
+
+        auto class_type = dynamic_cast<ClassTypeObs>(object.type);
+        if (class_type == nullptr) {
+            ctx->message(errors::EXPECTED_REFERENCE_TYPE, ctx->loc());
+            return Expression();
+        }
+
+        if (is_compiled_class(ctx, class_type->class_name())) {
+            if (auto *value = load_own_field(ctx, object.node, field_name))
+                return Expression(value);
+            ctx->message(errors::FIELD_NOT_FOUND, ctx->loc(), field_name, class_type->class_name());
+            return Expression();
+        }
+
+        const JawaClass *jawa_class = CLASS_TABLE.load_class(class_type->class_name());
+        if (jawa_class == nullptr) {
+            ctx->message(errors::CLASS_NOT_FOUND, ctx->loc(), class_type->class_name());
+            return Expression();
+        }
+        const JawaField *jawa_field = jawa_class->get_field(field_name);
+        if (jawa_field == nullptr) {
+            ctx->message(errors::FIELD_NOT_FOUND, ctx->loc(), field_name, class_type->class_name());
+            return Expression();
+        }
+        // a static field accessed through an object does not depend on the object
+        if (jawa_field->access_flags() & jasm::Field::ACC_STATIC)
+            return Expression(load_static_field(ctx, jawa_class, class_type->class_name(), field_name));
+        return Expression(ARENA.make<ir::FieldLoad>(jawa_field->type(), object.node, class_type->class_name(),
+                                                    field_name));
+    }
+
+    /**
+     * Loads a name consisting of a variable followed by a chain of fields.
+     *
+     * @return value of the last field, std::nullopt if the name does not start with a variable.
+     */
+    static std::optional<Expression>
+    load_variable_path(context_t ctx, const Name &name)
+    {
+        std::size_t end = name.find('/');
+        ir::Expression *variable = load_variable(ctx, name.substr(0, end));
+        if (variable == nullptr)
+            return std::nullopt;
+
+        Expression value(variable);
+        while (end != Name::npos && value.node != nullptr) {
+            std::size_t start = end + 1;
+            end = name.find('/', start);
+            value = load_field(ctx, value, name.substr(start, end - start));
+        }
+        return value;
+    }
+
+    ClassAndName
+    resolve_method_class(context_t ctx, const Name &method)
+    {
+        SEMANTIC_ACTION({});
+        std::size_t method_start = method.rfind('/');
+
+        if (method_start == Name::npos) {
+            // method of the compiled class, it is resolved with its arguments
+            return { ctx->ir_class()->name, method, false, nullptr };
+        }
+
+        Name method_name = method.substr(method_start + 1);
+        Name qualifier_name = method.substr(0, method_start);
+        if (auto receiver = load_variable_path(ctx, qualifier_name)) {
+            if (receiver->node == nullptr)
+                return {};
+            auto class_type = dynamic_cast<ClassTypeObs>(receiver->type);
+            if (class_type == nullptr) {
+                ctx->message(errors::EXPECTED_REFERENCE_TYPE, ctx->loc());
+                return {};
             }
+            return { class_type->class_name(), method_name, false, receiver->node };
+        }
 
-            return { class_name, method_name };
-        } else {
+        auto qualifier = resolve_qualified_name(ctx, qualifier_name);
+        if (!qualifier)
+            return {};
+
+        if (qualifier->value == nullptr) {
             // static method
-            return { class_name, method_name, true };
+            return { qualifier->class_name, method_name, true };
+        }
+
+        auto class_type = dynamic_cast<ClassTypeObs>(qualifier->value->type);
+        if (class_type == nullptr) {
+            // in fact it could also be an array
+            ctx->message(errors::EXPECTED_REFERENCE_TYPE, ctx->loc());
+            return {};
+        }
+        return { class_type->class_name(), method_name, false, qualifier->value };
+    }
+
+    static ir::ExpressionArray
+    argument_nodes(const ExpressionArray &arguments)
+    {
+        ir::ExpressionArray nodes;
+        nodes.reserve(arguments.size());
+        for (auto &argument : arguments)
+            nodes.push_back(argument.node);
+        return nodes;
+    }
+
+    /**
+     * Invokes a method the compiled class inherits from its superclass.
+     */
+    static Expression
+    invoke_inherited_method(context_t ctx, ir::Expression *receiver, const Name &method_name,
+                            const ExpressionArray &arguments)
+    {
+        TypeObsArray argument_types;
+        for (auto &expr : arguments)
+            argument_types.push_back(expr.type);
+
+        ir::Class *ir_class = ctx->ir_class();
+        JawaMethodSignature signature(method_name, argument_types);
+        const JawaMethod *callee = CLASS_TABLE.find_method(ir_class->super_name, signature);
+        if (callee == nullptr) {
+            ctx->message(errors::METHOD_NOT_FOUND, ctx->loc(), method_name, ir_class->name);
+            return Expression();
+        }
+
+        LOG_DEBUG("invoking inherited method ", method_name);
+        if (callee->access_flags() & jasm::Method::ACC_STATIC)
+            return Expression(ARENA.make<ir::Invoke>(ir::Invoke::STATIC, ir_class->super_name, method_name,
+                                                     callee->method_type(), nullptr, argument_nodes(arguments)));
+
+        if (receiver == nullptr)
+            receiver = ARENA.make<ir::LocalLoad>(ir_class->receiver);
+        return Expression(ARENA.make<ir::Invoke>(ir::Invoke::VIRTUAL, ir_class->super_name, method_name,
+                                                 callee->method_type(), receiver, argument_nodes(arguments)));
+    }
+
+    /**
+     * Invokes a method of the compiled class. Only the methods declared before the call are known, the other ones
+     * are looked up in the superclass.
+     *
+     * @param receiver object whose method is invoked, nullptr for the receiver of the current method.
+     */
+    static Expression
+    invoke_own_method(context_t ctx, ir::Expression *receiver, const Name &method_name,
+                      const ExpressionArray &arguments)
+    {
+        TypeObsArray argument_types;
+        for (auto &expr : arguments)
+            argument_types.push_back(expr.type);
+
+        ir::Class *ir_class = ctx->ir_class();
+        std::vector<const ir::Method *> overloads;
+        std::vector<MethodTypeObs> overload_types;
+        for (const ir::Method *method : ir_class->methods) {
+            if (method->name == method_name) {
+                overloads.push_back(method);
+                overload_types.push_back(method->type);
+            }
         }
+        auto overload = CLASS_TABLE.select_overload(overload_types, argument_types);
+        if (!overload)
+            return invoke_inherited_method(ctx, receiver, method_name, arguments);
+
+        const ir::Method *callee = overloads[*overload];
+        LOG_DEBUG("invoking method ", method_name);
+        if (callee->access_flags & jasm::Method::ACC_STATIC)
+            return Expression(ARENA.make<ir::Invoke>(ir::Invoke::STATIC, ir_class->name, method_name, callee->type,
+                                                     nullptr, argument_nodes(arguments)));
+
+        if (receiver == nullptr)
+            receiver = ARENA.make<ir::LocalLoad>(ir_class->receiver);
+        // private methods are not virtual
+        auto dispatch = callee->access_flags & jasm::Method::ACC_PRIVATE ? ir::Invoke::SPECIAL : ir::Invoke::VIRTUAL;
+        return Expression(ARENA.make<ir::Invoke>(dispatch, ir_class->name, method_name, callee->type, receiver,
+                                                 argument_nodes(arguments)));
     }
 
     Expression
     invoke_method(context_t ctx, const Expression &expr, const Name &method_name, const ExpressionArray &arguments)
     {
+        SEMANTIC_ACTION(Expression());
         TypeObsArray argument_types;
         for (auto &expr : arguments) {
             assert(expr.type != nullptr);
@@ -271,6 +774,8 @@ namespace jawa {
             ctx->message(errors::EXPECTED_REFERENCE_TYPE, ctx->loc());
             return Expression();
         }
+        if (is_compiled_class(ctx, class_type->class_name()))
+            return invoke_own_method(ctx, expr.node, method_name, arguments);
 
         const JawaClass *jawa_class = CLASS_TABLE.load_class(class_type->class_name());
         if (!jawa_class) {
@@ -278,23 +783,53 @@ namespace jawa {
             return Expression();
         }
 
-        const JawaMethod *jawa_method = jawa_class->get_method(signature);
+        const JawaMethod *jawa_method = CLASS_TABLE.find_method(class_type->class_name(), signature);
         if (!jawa_method) {
             ctx->message(errors::METHOD_NOT_FOUND, ctx->loc(), method_name, class_type->class_name());
             return Expression();
         }
 
-        jasm::u2 method_index =
-          BUILDER.add_method_constant(class_type->class_name(), method_name, *jawa_method->type());
-        BUILDER.make_instruction<jasm::InvokeVirtual>(U2_SPLIT(method_index));
+        LOG_DEBUG("invoking method ", method_name);
+        auto dispatch = jawa_class->is_interface() ? ir::Invoke::INTERFACE : ir::Invoke::VIRTUAL;
+        return Expression(ARENA.make<ir::Invoke>(dispatch, class_type->class_name(), method_name,
+                                                 jawa_method->method_type(), expr.node, argument_nodes(arguments)));
+    }
+
+    /**
+     * Replaces printing to System.wyjście by a direct call of the java.io.PrintStream the stream delegates to. The
+     * standard library built without its native library exposes the stream as the static field strumień.
+     *
+     * @return call of the print stream, nullptr if the call cannot be replaced.
+     */
+    static ir::Expression *
+    print_intrinsic(context_t ctx, const ClassAndName &method, const JawaClass *jawa_class,
+                    const ExpressionArray &arguments)
+    {
+        if (method.class_name != "jawa/io/StrumieńDrukowania" || method.name != "wydrukovać" || arguments.size() != 1)
+            return nullptr;
+        // the receiver is dropped, so it has to be free of side effects
+        auto receiver = ir::node_cast<ir::StaticFieldLoad>(method.receiver);
+        if (receiver == nullptr || receiver->class_name != "jawa/jȩzyk/System" || receiver->field_name != "wyjście")
+            return nullptr;
+
+        const JawaField *delegate = jawa_class->get_field("strumień");
+        if (delegate == nullptr || !(delegate->access_flags() & jasm::Field::ACC_STATIC))
+            return nullptr;
+        auto stream_type = dynamic_cast<ClassTypeObs>(delegate->type());
+        if (stream_type == nullptr || stream_type->class_name() != "java/io/PrintStream")
+            return nullptr;
 
-        std::cout << "invoking method " << method_name << std::endl;
-        return Expression(jawa_method->method_type()->return_type());
+        LOG_DEBUG("invoking print stream of ", method.class_name);
+        auto *stream = ARENA.make<ir::StaticFieldLoad>(stream_type, method.class_name, "strumień");
+        MethodTypeObs println_type = TYPE_TABLE.get_method_type(TYPE_TABLE.get_void_type(), { arguments[0].type });
+        return ARENA.make<ir::Invoke>(ir::Invoke::VIRTUAL, stream_type->class_name(), "println", println_type, stream,
+                                      argument_nodes(arguments));
     }
 
     Expression
     invoke_method(context_t ctx, const ClassAndName &method, const ExpressionArray &arguments)
     {
+        SEMANTIC_ACTION(Expression());
         if (method.name.empty())
             return Expression();
 
@@ -304,6 +839,9 @@ namespace jawa {
             argument_types.push_back(expr.type);
         }
 
+        if (is_compiled_class(ctx, method.class_name))
+            return invoke_own_method(ctx, method.receiver, method.name, arguments);
+
         JawaMethodSignature signature(method.name, argument_types);
 
         const JawaClass *jawa_class = CLASS_TABLE.load_class(method.class_name);
@@ -312,103 +850,854 @@ namespace jawa {
             return Expression();
         }
 
-        const JawaMethod *jawa_method = jawa_class->get_method(signature);
+        const JawaMethod *jawa_method = CLASS_TABLE.find_method(method.class_name, signature);
         if (!jawa_method) {
             ctx->message(errors::METHOD_NOT_FOUND, ctx->loc(), method.name, method.class_name);
             return Expression();
         }
 
-        jasm::u2 method_index = BUILDER.add_method_constant(method.class_name, method.name, *jawa_method->type());
-
-        if (method.is_static) {
-            BUILDER.make_instruction<jasm::InvokeStatic>(U2_SPLIT(method_index));
-        } else {
-            BUILDER.make_instruction<jasm::InvokeVirtual>(U2_SPLIT(method_index));
-        }
+        if (auto *print = print_intrinsic(ctx, method, jawa_class, arguments))
+            return Expression(print);
 
-        std::cout << "invoking method " << method.name << std::endl;
-        return Expression(jawa_method->method_type()->return_type());
+        LOG_DEBUG("invoking method ", method.name);
+        auto dispatch = jawa_class->is_interface() ? ir::Invoke::INTERFACE : ir::Invoke::VIRTUAL;
+        return Expression(ARENA.make<ir::Invoke>(method.is_static ? ir::Invoke::STATIC : dispatch, method.class_name,
+                                                 method.name, jawa_method->method_type(), method.receiver,
+                                                 argument_nodes(arguments)));
     }
 
     Expression
     load_name(context_t ctx, const Name &name)
     {
-        auto *var = SCOPE_TABLE.get_var(name);
-        if (var == nullptr) {
+        SEMANTIC_ACTION(Expression());
+        LOG_TRACE("name expression ", name);
+
+        if (auto value = load_variable_path(ctx, name))
+            return *value;
+        if (name.find('/') == Name::npos) {
             ctx->message(errors::VARIABLE_NOT_DECLARED, ctx->loc(), name);
-            return Expression{};
+            return Expression();
         }
-        std::cout << "name expression " << name << std::endl;
-        // TODO: check if the variable has a reference type
-        switch (var->index) {
-        case 0:
-            BUILDER.make_instruction<jasm::RefLoad0>();
-            break;
-        case 1:
-            BUILDER.make_instruction<jasm::RefLoad1>();
-            break;
-        case 2:
-            BUILDER.make_instruction<jasm::RefLoad2>();
-            break;
-        case 3:
-            BUILDER.make_instruction<jasm::RefLoad3>();
-            break;
+
+        auto qualified_name = resolve_qualified_name(ctx, name);
+        if (!qualified_name)
+            return Expression();
+        if (qualified_name->value == nullptr) {
+            ctx->message(errors::VARIABLE_NOT_DECLARED, ctx->loc(), name);
+            return Expression();
+        }
+        return Expression(qualified_name->value);
+    }
+
+    /**
+     * Returns the position of a numeric type in the order of the widening primitive conversions. Short and char
+     * share the position, yet neither of them can be widened to the other.
+     */
+    static int
+    numeric_rank(TypeObs type)
+    {
+        switch (type->prefix()) {
+        case jasm::byte_code::ByteTypePrefix:
+            return 0;
+        case jasm::byte_code::ShortTypePrefix:
+        case jasm::byte_code::CharTypePrefix:
+            return 1;
+        case jasm::byte_code::IntTypePrefix:
+            return 2;
+        case jasm::byte_code::LongTypePrefix:
+            return 3;
+        case jasm::byte_code::FloatTypePrefix:
+            return 4;
+        case jasm::byte_code::DoubleTypePrefix:
+            return 5;
         default:
-            BUILDER.make_instruction<jasm::RefLoad>(U2_LOW(var->index));
-            break;
+            return -1;
         }
-        return Expression(var->type);
+    }
+
+    static bool
+    is_widening(TypeObs from, TypeObs to)
+    {
+        if (!is_numeric_type(from) || !is_numeric_type(to))
+            return false;
+        if (to->prefix() == jasm::byte_code::CharTypePrefix)
+            return false;
+        return numeric_rank(from) < numeric_rank(to);
+    }
+
+    /**
+     * Converts an expression to a primitive type, constant operands are converted at compile time.
+     */
+    static ir::Expression *
+    convert(context_t ctx, ir::Expression *expr, TypeObs type)
+    {
+        if (expr->type == type)
+            return expr;
+        return fold(ARENA, ARENA.make<ir::Convert>(type, expr));
+    }
+
+    static TypeObs
+    unary_promotion(context_t ctx, TypeObs type)
+    {
+        switch (type->prefix()) {
+        case jasm::byte_code::ByteTypePrefix:
+        case jasm::byte_code::ShortTypePrefix:
+        case jasm::byte_code::CharTypePrefix:
+            return TYPE_TABLE.get_int_type();
+        default:
+            return type;
+        }
+    }
+
+    static TypeObs
+    binary_promotion(context_t ctx, TypeObs lhs, TypeObs rhs)
+    {
+        lhs = unary_promotion(ctx, lhs);
+        rhs = unary_promotion(ctx, rhs);
+        return numeric_rank(lhs) >= numeric_rank(rhs) ? lhs : rhs;
+    }
+
+    /**
+     * Converts an expression to a type in an assignment context (JLS §5.2). Apart from the widening conversions
+     * a constant of type int can be narrowed to byte, short or char if its value fits in the type.
+     *
+     * @return converted expression, nullptr if the types are not compatible.
+     */
+    static ir::Expression *
+    coerce(context_t ctx, ir::Expression *expr, TypeObs type)
+    {
+        if (expr->type == type)
+            return expr;
+        if (is_widening(expr->type, type))
+            return convert(ctx, expr, type);
+
+        auto constant = ir::node_cast<ir::Constant>(expr);
+        if (constant != nullptr && is_integral_type(expr->type) && std::holds_alternative<int_t>(constant->value)) {
+            int_t value = std::get<int_t>(constant->value);
+            bool fits;
+            switch (type->prefix()) {
+            case jasm::byte_code::ByteTypePrefix:
+                fits = value >= std::numeric_limits<byte_t>::min() && value <= std::numeric_limits<byte_t>::max();
+                break;
+            case jasm::byte_code::ShortTypePrefix:
+                fits = value >= std::numeric_limits<short_t>::min() && value <= std::numeric_limits<short_t>::max();
+                break;
+            case jasm::byte_code::CharTypePrefix:
+                fits = value >= std::numeric_limits<char_t>::min() && value <= std::numeric_limits<char_t>::max();
+                break;
+            default:
+                fits = false;
+                break;
+            }
+            if (fits)
+                return convert(ctx, expr, type);
+        }
+
+        // TODO: check subtyping
+        if (is_reference_type(expr->type) && is_reference_type(type))
+            return expr;
+
+        ctx->message(errors::INCOMPATIBLE_TYPES, ctx->loc(), expr->type->descriptor(), type->descriptor());
+        return nullptr;
     }
 
     void
-    declare_field(context_t ctx, const ModifierAndAnnotationPack &pack, TypeObs type, const Name &name)
+    declare_field(context_t ctx, const ModifierAndAnnotationPack &pack, TypeObs type, const Name &name,
+                  const ExpressionOpt &initializer)
     {
-        std::cout << "declaring field " << name << std::endl;
-        BUILDER.declare_field(name, *type,
-                              jasm::Field::ACC_PUBLIC | jasm::Field::ACC_STATIC); // <- temporary solution TODO: remove
+        SEMANTIC_ACTION();
+        LOG_DEBUG("declaring field ", name);
+        jasm::u2 access_flags = 0;
+        if (pack.modifier_pack.get(Modifier::PUBLIC) != ModifierForm::NONE)
+            access_flags |= jasm::Field::ACC_PUBLIC;
+        if (pack.modifier_pack.get(Modifier::PRIVATE) != ModifierForm::NONE)
+            access_flags |= jasm::Field::ACC_PRIVATE;
+        if (pack.modifier_pack.get(Modifier::PROTECTED) != ModifierForm::NONE)
+            access_flags |= jasm::Field::ACC_PROTECTED;
+        if (pack.modifier_pack.get(Modifier::STATIC) != ModifierForm::NONE)
+            access_flags |= jasm::Field::ACC_STATIC;
+        if (pack.modifier_pack.get(Modifier::FINAL) != ModifierForm::NONE)
+            access_flags |= jasm::Field::ACC_FINAL;
+        if (pack.modifier_pack.get(Modifier::VOLATILE) != ModifierForm::NONE)
+            access_flags |= jasm::Field::ACC_VOLATILE;
+        if (pack.modifier_pack.get(Modifier::TRANSIENT) != ModifierForm::NONE)
+            access_flags |= jasm::Field::ACC_TRANSIENT;
+        bool is_static = access_flags & jasm::Field::ACC_STATIC;
+
+        ir::Class *ir_class = ctx->ir_class();
+        ir::Expression *value = nullptr;
+        if (initializer && initializer->node != nullptr)
+            value = coerce(ctx, initializer->node, type);
+        if (value != nullptr && is_static && refers_to(value, ir_class->receiver)) {
+            ctx->message(errors::NON_STATIC_IN_STATIC_CONTEXT, ctx->loc());
+            value = nullptr;
+        }
+
+        // final fields initialised with a constant expression are constants, as in javac
+        const ir::Constant *constant = ir::node_cast<ir::Constant>(value);
+        if (!(access_flags & jasm::Field::ACC_FINAL))
+            constant = nullptr;
+
+        jasm::Field &field = BUILDER.declare_field(name, *type, access_flags);
+        if (constant != nullptr) {
+            jasm::u2 attribute_name_index = BUILDER.add_utf8_constant("ConstantValue");
+            jasm::u2 constant_value_index = add_constant(BUILDER, *constant);
+            field.make_attribute<jasm::ConstantValueAttribute>(attribute_name_index, constant_value_index);
+        } else if (value != nullptr && is_static) {
+            // the other initializers are executed by the static initializer in the declaration order
+            auto *store = ARENA.make<ir::StaticFieldStore>(BUILDER.class_name(), name, value);
+            static_initializer(ctx)->body->statements.push_back(ARENA.make<ir::ExpressionStatement>(store));
+        }
+        // the instance fields are assigned even if they are constants, as javac does
+        if (value != nullptr && !is_static) {
+            auto *receiver = ARENA.make<ir::LocalLoad>(ir_class->receiver);
+            auto *store = ARENA.make<ir::FieldStore>(receiver, BUILDER.class_name(), name, value);
+            ir_class->field_initializers.push_back(ARENA.make<ir::ExpressionStatement>(store));
+        }
+
+        ir_class->fields[name] = ARENA.make<ir::Field>(name, type, access_flags, constant);
     }
 
     Expression
-    instantiate_object(context_t ctx, const Name &class_name)
+    instantiate_object(context_t ctx, const Name &class_name, const ExpressionArray &arguments)
     {
-        std::cout << "instantiate new class " << class_name << std::endl;
+        SEMANTIC_ACTION(Expression());
+        LOG_DEBUG("instantiate new class ", class_name);
+        TypeObsArray argument_types;
+        for (auto &expr : arguments) {
+            if (expr.node == nullptr)
+                return Expression();
+            argument_types.push_back(expr.type);
+        }
+        if (is_compiled_class(ctx, class_name)) {
+            // the default constructor is generated only if the class declares none
+            ir::Class *ir_class = ctx->ir_class();
+            std::vector<MethodTypeObs> constructor_types;
+            for (auto *method : ir_class->methods) {
+                if (method->name == "<init>")
+                    constructor_types.push_back(method->type);
+            }
+            if (constructor_types.empty())
+                constructor_types.push_back(TYPE_TABLE.get_method_type(TYPE_TABLE.get_void_type(), TypeObsArray()));
+            auto constructor = CLASS_TABLE.select_overload(constructor_types, argument_types);
+            if (!constructor) {
+                ctx->message(errors::CONSTRUCTOR_NOT_FOUND, ctx->loc(), ir_class->name);
+                return Expression();
+            }
+            ClassTypeObs type = TYPE_TABLE.get_class_type(ir_class->name);
+            return Expression(ARENA.make<ir::New>(type, constructor_types[*constructor], argument_nodes(arguments)));
+        }
+
         auto cls = CLASS_TABLE.load_class(class_name);
         assert(cls != nullptr);
+        JawaMethodSignature signature("<init>", argument_types);
+        const JawaMethod *constructor = CLASS_TABLE.find_method(cls->class_name(), signature);
+        if (constructor == nullptr) {
+            ctx->message(errors::CONSTRUCTOR_NOT_FOUND, ctx->loc(), cls->class_name());
+            return Expression();
+        }
 
         ClassTypeObs type = TYPE_TABLE.get_class_type(cls->class_name());
-        jasm::u2 class_idx = BUILDER.add_class_constant(cls->class_name());
-        BUILDER.make_instruction<jasm::New>(U2_SPLIT(class_idx));
-        BUILDER.make_instruction<jasm::Duplicate>();
+        return Expression(ARENA.make<ir::New>(type, constructor->method_type(), argument_nodes(arguments)));
+    }
 
-        VoidTypeObs void_type = TYPE_TABLE.get_void_type();
-        // TODO: support for different types of constructors
-        MethodTypeObs constructor_type = TYPE_TABLE.get_method_type(void_type, TypeObsArray());
-        jasm::u2 constructor_idx = BUILDER.add_method_constant(cls->class_name(), "<init>", *constructor_type);
-        BUILDER.make_instruction<jasm::InvokeSpecial>(U2_SPLIT(constructor_idx));
+    Expression
+    load_this(context_t ctx)
+    {
+        SEMANTIC_ACTION(Expression());
+        // the use in a static context is reported once the method is known to be static
+        return Expression(ARENA.make<ir::LocalLoad>(ctx->ir_class()->receiver));
+    }
+
+    /**
+     * Returns the type of the elements of an array type.
+     */
+    static TypeObs
+    element_type(context_t ctx, ArrayTypeObs array_type)
+    {
+        if (array_type->dimension() > 1)
+            return TYPE_TABLE.get_array_type(array_type->element_type(), array_type->dimension() - 1);
+        return array_type->element_type();
+    }
+
+    /**
+     * Converts an array index or length to int.
+     *
+     * @return converted expression, nullptr if it is not of an integral type narrower than long.
+     */
+    static ir::Expression *
+    int_operand(context_t ctx, const Expression &expr)
+    {
+        if (!is_integral_type(expr.type) || unary_promotion(ctx, expr.type) != TYPE_TABLE.get_int_type()) {
+            ctx->message(errors::INCOMPATIBLE_TYPES, ctx->loc(), expr.type->descriptor(),
+                         TYPE_TABLE.get_int_type()->descriptor());
+            return nullptr;
+        }
+        return convert(ctx, expr.node, TYPE_TABLE.get_int_type());
+    }
+
+    Expression
+    load_array_element(context_t ctx, const Expression &array, const Expression &index)
+    {
+        SEMANTIC_ACTION(Expression());
+        if (array.node == nullptr || index.node == nullptr)
+            return Expression();
+        auto array_type = dynamic_cast<ArrayTypeObs>(array.type);
+        if (array_type == nullptr) {
+            ctx->message(errors::EXPECTED_ARRAY_TYPE, ctx->loc());
+            return Expression();
+        }
+        ir::Expression *index_node = int_operand(ctx, index);
+        if (index_node == nullptr)
+            return Expression();
+        return Expression(ARENA.make<ir::ArrayLoad>(element_type(ctx, array_type), array.node, index_node));
+    }
+
+    Expression
+    create_array(context_t ctx, TypeObs element_type, const Expression &length)
+    {
+        SEMANTIC_ACTION(Expression());
+        if (element_type == nullptr || length.node == nullptr)
+            return Expression();
+        ir::Expression *length_node = int_operand(ctx, length);
+        if (length_node == nullptr)
+            return Expression();
+
+        ArrayTypeObs type;
+        if (auto element_array_type = dynamic_cast<ArrayTypeObs>(element_type))
+            type = TYPE_TABLE.get_array_type(element_array_type->element_type(), element_array_type->dimension() + 1);
+        else
+            type = TYPE_TABLE.get_array_type(element_type, 1);
+        return Expression(ARENA.make<ir::NewArray>(type, length_node));
+    }
 
-        return Expression(type);
+    /**
+     * Replaces the load of a variable by an assignment to it.
+     *
+     * @param variable load of a local variable, a field or an array element.
+     * @return assignment, nullptr if the expression is not a variable or the value cannot be assigned to it.
+     */
+    static ir::Expression *
+    store(context_t ctx, ir::Expression *variable, ir::Expression *value)
+    {
+        switch (variable->kind) {
+        case ir::Kind::LOCAL_LOAD: {
+            ir::Local *local = static_cast<ir::LocalLoad *>(variable)->local;
+            if (local == ctx->ir_class()->receiver)
+                break;
+            value = coerce(ctx, value, local->type);
+            return value ? ARENA.make<ir::LocalStore>(local, value) : nullptr;
+        }
+        case ir::Kind::STATIC_FIELD_LOAD: {
+            auto *load = static_cast<ir::StaticFieldLoad *>(variable);
+            value = coerce(ctx, value, load->type);
+            return value ? ARENA.make<ir::StaticFieldStore>(load->class_name, load->field_name, value) : nullptr;
+        }
+        case ir::Kind::FIELD_LOAD: {
+            auto *load = static_cast<ir::FieldLoad *>(variable);
+            value = coerce(ctx, value, load->type);
+            return value ? ARENA.make<ir::FieldStore>(load->object, load->class_name, load->field_name, value)
+                         : nullptr;
+        }
+        case ir::Kind::ARRAY_LOAD: {
+            auto *load = static_cast<ir::ArrayLoad *>(variable);
+            value = coerce(ctx, value, load->type);
+            return value ? ARENA.make<ir::ArrayStore>(load->array, load->index, value) : nullptr;
+        }
+        default:
+            break;
+        }
+        ctx->message(errors::INVALID_ASSIGNMENT_TARGET, ctx->loc());
+        return nullptr;
+    }
+
+    /**
+     * Checks whether an expression can be evaluated twice with the same result and without side effects other than
+     * an exception, the variable of a compound assignment is both loaded and stored.
+     */
+    static bool
+    is_repeatable(const ir::Expression *expr)
+    {
+        switch (expr->kind) {
+        case ir::Kind::CONSTANT:
+        case ir::Kind::LOCAL_LOAD:
+        case ir::Kind::STATIC_FIELD_LOAD:
+            return true;
+        case ir::Kind::FIELD_LOAD:
+        case ir::Kind::ARRAY_LOAD:
+        case ir::Kind::ARRAY_LENGTH:
+        case ir::Kind::CONVERT:
+        case ir::Kind::UNARY:
+        case ir::Kind::BINARY: {
+            // concatenation calls toString
+            if (is_string_type(expr->type))
+                return false;
+            bool repeatable = true;
+            ir::for_each_child(static_cast<const ir::Node *>(expr), [&repeatable](const ir::Node *child) {
+                repeatable = repeatable && is_repeatable(static_cast<const ir::Expression *>(child));
+            });
+            return repeatable;
+        }
+        default:
+            return false;
+        }
+    }
+
+    Expression
+    assign(context_t ctx, const Expression &variable, std::optional<operators::comp> op, const Expression &expr)
+    {
+        SEMANTIC_ACTION(expr);
+        if (variable.node == nullptr || expr.node == nullptr)
+            return Expression();
+        if (!op) {
+            ir::Expression *assignment = store(ctx, variable.node, expr.node);
+            return assignment ? Expression(assignment) : Expression();
+        }
+
+        if (*op == operators::COMP_NOT) {
+            ctx->message(errors::UNSUPPORTED_OPERATION, ctx->loc(), Name("~="));
+            return Expression();
+        }
+        if (!is_repeatable(variable.node)) {
+            ctx->message(errors::UNSUPPORTED_OPERATION, ctx->loc(),
+                         Name(operators::symbol(operators::to_binop(*op))) + "=");
+            return Expression();
+        }
+
+        // E1 op= E2 is equivalent to E1 = (T) ((E1) op (E2)), where T is the type of E1 (JLS §15.26.2)
+        Expression value =
+          cast_expression(ctx, variable.type, binary_operation(ctx, operators::to_binop(*op), variable, expr));
+        if (value.node == nullptr)
+            return value;
+        ir::Expression *assignment = store(ctx, variable.node, value.node);
+        return assignment ? Expression(assignment) : Expression();
     }
 
     Expression
-    assign(context_t ctx, const Name &name, const Expression &expr)
+    assign(context_t ctx, const Name &name, std::optional<operators::comp> op, const Expression &expr)
     {
-        // TODO: this is an ad hoc function in its entirety
-        std::cout << "assigning to " << name << std::endl;
-        jasm::u2 field_idx = BUILDER.add_field_constant(BUILDER.class_name(), name, *expr.type);
-        BUILDER.make_instruction<jasm::PutStatic>(U2_SPLIT(field_idx));
-        return expr;
+        SEMANTIC_ACTION(expr);
+        LOG_DEBUG("assigning to ", name);
+        if (expr.node == nullptr)
+            return expr;
+        return assign(ctx, load_name(ctx, name), op, expr);
+    }
+
+    Expression
+    increment(context_t ctx, operators::incdec op, const Expression &variable, bool postfix)
+    {
+        SEMANTIC_ACTION(Expression());
+        operators::comp comp = op == operators::INC ? operators::COMP_ADD : operators::COMP_SUB;
+        Expression update = assign(ctx, variable, comp, load_literal(ctx, 1));
+        if (!postfix || update.node == nullptr)
+            return update;
+        return Expression(ARENA.make<ir::PostfixUpdate>(variable.node, update.node));
+    }
+
+    Expression
+    increment(context_t ctx, operators::incdec op, const Name &name, bool postfix)
+    {
+        SEMANTIC_ACTION(Expression());
+        return increment(ctx, op, load_name(ctx, name), postfix);
+    }
+
+    Expression
+    unary_operation(context_t ctx, operators::unop op, const Expression &operand)
+    {
+        SEMANTIC_ACTION(Expression());
+        if (operand.node == nullptr)
+            return Expression();
+
+        TypeObs type = nullptr;
+        switch (op) {
+        case operators::unop::PLUS:
+        case operators::unop::MINUS:
+            if (is_numeric_type(operand.type))
+                type = unary_promotion(ctx, operand.type);
+            break;
+        case operators::unop::NOT:
+            if (is_integral_type(operand.type))
+                type = unary_promotion(ctx, operand.type);
+            break;
+        case operators::unop::LNOT:
+            if (is_boolean_type(operand.type))
+                type = operand.type;
+            break;
+        }
+
+        if (type == nullptr) {
+            ctx->message(errors::INCOMPATIBLE_OPERANDS, ctx->loc(), Name(operators::symbol(op)));
+            return Expression();
+        }
+
+        return Expression(fold(ARENA, ARENA.make<ir::Unary>(type, op, convert(ctx, operand.node, type))));
+    }
+
+    Expression
+    binary_operation(context_t ctx, operators::binop op, const Expression &lhs, const Expression &rhs)
+    {
+        using operators::binop;
+
+        SEMANTIC_ACTION(Expression());
+        if (lhs.node == nullptr || rhs.node == nullptr)
+            return Expression();
+
+        TypeObs type = nullptr;
+        TypeObs lhs_type = lhs.type;
+        TypeObs rhs_type = rhs.type;
+        switch (op) {
+        case binop::ADD:
+            if (is_string_type(lhs.type) || is_string_type(rhs.type)) {
+                if (lhs.type != TYPE_TABLE.get_void_type() && rhs.type != TYPE_TABLE.get_void_type())
+                    type = TYPE_TABLE.get_class_type("java/lang/String");
+                break;
+            }
+            [[fallthrough]];
+        case binop::SUB:
+        case binop::MUL:
+        case binop::DIV:
+        case binop::MOD:
+            if (is_numeric_type(lhs.type) && is_numeric_type(rhs.type))
+                type = lhs_type = rhs_type = binary_promotion(ctx, lhs.type, rhs.type);
+            break;
+        case binop::SHL:
+        case binop::SHR:
+        case binop::USHR:
+            // the shift distance is always an int
+            if (is_integral_type(lhs.type) && is_integral_type(rhs.type)) {
+                type = lhs_type = unary_promotion(ctx, lhs.type);
+                rhs_type = TYPE_TABLE.get_int_type();
+            }
+            break;
+        case binop::AND:
+        case binop::OR:
+        case binop::XOR:
+            if (is_boolean_type(lhs.type) && is_boolean_type(rhs.type))
+                type = lhs.type;
+            else if (is_integral_type(lhs.type) && is_integral_type(rhs.type))
+                type = lhs_type = rhs_type = binary_promotion(ctx, lhs.type, rhs.type);
+            break;
+        case binop::LT:
+        case binop::GT:
+        case binop::LTE:
+        case binop::GTE:
+            if (is_numeric_type(lhs.type) && is_numeric_type(rhs.type)) {
+                lhs_type = rhs_type = binary_promotion(ctx, lhs.type, rhs.type);
+                type = TYPE_TABLE.get_boolean_type();
+            }
+            break;
+        case binop::EQ:
+        case binop::NE:
+            if (is_numeric_type(lhs.type) && is_numeric_type(rhs.type)) {
+                lhs_type = rhs_type = binary_promotion(ctx, lhs.type, rhs.type);
+                type = TYPE_TABLE.get_boolean_type();
+            } else if ((is_boolean_type(lhs.type) && is_boolean_type(rhs.type)) ||
+                       (is_reference_type(lhs.type) && is_reference_type(rhs.type))) {
+                type = TYPE_TABLE.get_boolean_type();
+            }
+            break;
+        case binop::LAND:
+        case binop::LOR:
+            if (is_boolean_type(lhs.type) && is_boolean_type(rhs.type))
+                type = lhs.type;
+            break;
+        }
+
+        if (type == nullptr) {
+            ctx->message(errors::INCOMPATIBLE_OPERANDS, ctx->loc(), Name(operators::symbol(op)));
+            return Expression();
+        }
+
+        ir::Expression *lhs_node = is_numeric_type(lhs_type) ? convert(ctx, lhs.node, lhs_type) : lhs.node;
+        ir::Expression *rhs_node = is_numeric_type(rhs_type) ? convert(ctx, rhs.node, rhs_type) : rhs.node;
+        return Expression(fold(ARENA, ARENA.make<ir::Binary>(type, op, lhs_node, rhs_node)));
+    }
+
+    Expression
+    cast_expression(context_t ctx, TypeObs type, const Expression &operand)
+    {
+        SEMANTIC_ACTION(Expression());
+        if (operand.node == nullptr || operand.type == type)
+            return operand;
+        if (!is_numeric_type(type) || !is_numeric_type(operand.type)) {
+            ctx->message(errors::INCOMPATIBLE_TYPES, ctx->loc(), operand.type->descriptor(), type->descriptor());
+            return Expression();
+        }
+        return Expression(convert(ctx, operand.node, type));
+    }
+
+    ir::Statement *
+    expression_statement(context_t ctx, const Expression &expr)
+    {
+        SEMANTIC_ACTION(nullptr);
+        if (expr.node == nullptr)
+            return nullptr;
+        return ARENA.make<ir::ExpressionStatement>(expr.node);
+    }
+
+    ir::Statement *
+    return_statement(context_t ctx, const ExpressionOpt &expr)
+    {
+        SEMANTIC_ACTION(nullptr);
+        TypeObs return_type = ctx->ir_method()->type->return_type();
+        if (!expr) {
+            if (return_type != TYPE_TABLE.get_void_type()) {
+                ctx->message(errors::INCOMPATIBLE_TYPES, ctx->loc(), TYPE_TABLE.get_void_type()->descriptor(),
+                             return_type->descriptor());
+                return nullptr;
+            }
+            return ARENA.make<ir::Return>(nullptr);
+        }
+        if (expr->node == nullptr)
+            return nullptr;
+
+        ir::Expression *value = coerce(ctx, expr->node, return_type);
+        if (value == nullptr)
+            return nullptr;
+        return ARENA.make<ir::Return>(value);
+    }
+
+    ir::Statement *
+    if_statement(context_t ctx, const Expression &condition, ir::Statement *then_statement,
+                 ir::Statement *else_statement)
+    {
+        SEMANTIC_ACTION(nullptr);
+        if (condition.node == nullptr)
+            return nullptr;
+        if (!is_boolean_type(condition.type)) {
+            ctx->message(errors::INCOMPATIBLE_TYPES, ctx->loc(), condition.type->descriptor(),
+                         TYPE_TABLE.get_boolean_type()->descriptor());
+            return nullptr;
+        }
+        return ARENA.make<ir::If>(condition.node, then_statement, else_statement);
+    }
+
+    void
+    enter_block(context_t ctx)
+    {
+        SEMANTIC_ACTION();
+        SCOPE_TABLE.enter_scope();
+    }
+
+    ir::Block *
+    make_block(context_t ctx, ir::StatementArray &statements)
+    {
+        SEMANTIC_ACTION(nullptr);
+        SCOPE_TABLE.leave_scope();
+        return ARENA.make<ir::Block>(std::move(statements));
+    }
+
+    ir::Statement *
+    declare_local_variables(context_t ctx, TypeObs type, const VariableDeclaratorArray &declarators)
+    {
+        SEMANTIC_ACTION(nullptr);
+        ir::StatementArray initializers;
+        for (auto &declarator : declarators) {
+            LOG_DEBUG("declaring local variable ", declarator.name);
+            if (SCOPE_TABLE.get_var(declarator.name) != nullptr) {
+                ctx->message(errors::VARIABLE_ALREADY_DECLARED, ctx->loc(), declarator.name);
+                continue;
+            }
+
+            // the initializer cannot refer to the variable yet, javac would report it as not initialised
+            ir::Expression *value = nullptr;
+            if (declarator.initializer && declarator.initializer->node != nullptr)
+                value = coerce(ctx, declarator.initializer->node, type);
+
+            auto *local = ARENA.make<ir::Local>(declarator.name, type, 0);
+            local->index = SCOPE_TABLE.add_var(declarator.name, type, local);
+            if (value != nullptr)
+                initializers.push_back(ARENA.make<ir::ExpressionStatement>(ARENA.make<ir::LocalStore>(local, value)));
+        }
+
+        if (initializers.empty())
+            return nullptr;
+        if (initializers.size() == 1)
+            return initializers.front();
+        return ARENA.make<ir::Block>(std::move(initializers));
+    }
+
+    void
+    enter_switch(context_t ctx, const Expression &selector)
+    {
+        SEMANTIC_ACTION();
+        // the switch is entered even for an erroneous selector, so that the labels have a statement to refer to
+        ir::Expression *node = selector.node;
+        if (node != nullptr && !is_string_type(node->type) &&
+            unary_promotion(ctx, node->type) != TYPE_TABLE.get_int_type()) {
+            ctx->message(errors::INCOMPATIBLE_TYPES, ctx->loc(), node->type->descriptor(),
+                         TYPE_TABLE.get_int_type()->descriptor());
+            node = nullptr;
+        }
+        ctx->switches().push_back(ARENA.make<ir::Switch>(node));
+        SCOPE_TABLE.enter_scope();
+    }
+
+    void
+    switch_label(context_t ctx, const Expression &value)
+    {
+        SEMANTIC_ACTION();
+        ir::Switch *switch_stmt = ctx->switches().back();
+        if (value.node == nullptr || switch_stmt->selector == nullptr)
+            return;
+        if (ir::node_cast<ir::Constant>(value.node) == nullptr) {
+            ctx->message(errors::EXPECTED_CONSTANT_EXPRESSION, ctx->loc());
+            return;
+        }
+
+        // the label has to be assignable to the type of the selector, the selector itself is compared as an int
+        ir::Expression *label = coerce(ctx, value.node, switch_stmt->selector->type);
+        if (label == nullptr)
+            return;
+        if (!is_string_type(label->type))
+            label = convert(ctx, label, TYPE_TABLE.get_int_type());
+        switch_stmt->cases.push_back({ ir::node_cast<ir::Constant>(label), switch_stmt->statements.size() });
+    }
+
+    void
+    switch_default(context_t ctx)
+    {
+        SEMANTIC_ACTION();
+        ir::Switch *switch_stmt = ctx->switches().back();
+        if (switch_stmt->default_target) {
+            ctx->message(errors::DUPLICATE_DEFAULT_LABEL, ctx->loc());
+            return;
+        }
+        switch_stmt->default_target = switch_stmt->statements.size();
+    }
+
+    void
+    switch_statements(context_t ctx, ir::StatementArray &statements)
+    {
+        SEMANTIC_ACTION();
+        ir::StatementArray &switch_statements = ctx->switches().back()->statements;
+        switch_statements.insert(switch_statements.end(), statements.begin(), statements.end());
+    }
+
+    ir::Statement *
+    leave_switch(context_t ctx)
+    {
+        SEMANTIC_ACTION(nullptr);
+        ir::Switch *switch_stmt = ctx->switches().back();
+        ctx->switches().pop_back();
+        SCOPE_TABLE.leave_scope();
+        if (switch_stmt->selector == nullptr)
+            return nullptr;
+
+        std::vector<const ir::Constant *> labels;
+        for (auto &switch_case : switch_stmt->cases)
+            labels.push_back(switch_case.value);
+        std::sort(labels.begin(), labels.end(),
+                  [](const ir::Constant *lhs, const ir::Constant *rhs) { return lhs->value < rhs->value; });
+        auto duplicate =
+          std::adjacent_find(labels.begin(), labels.end(),
+                             [](const ir::Constant *lhs, const ir::Constant *rhs) { return lhs->value == rhs->value; });
+        if (duplicate != labels.end()) {
+            ctx->message(errors::DUPLICATE_CASE_LABEL, ctx->loc(), constant_to_string(**duplicate));
+            return nullptr;
+        }
+        return switch_stmt;
+    }
+
+    void
+    enter_loop(context_t ctx, bool test_first)
+    {
+        SEMANTIC_ACTION();
+        // the loop is entered even for an erroneous condition, so that break and continue have a loop to refer to
+        ctx->loops().push_back(ARENA.make<ir::Loop>(nullptr, test_first));
+        SCOPE_TABLE.enter_scope();
+    }
+
+    void
+    loop_condition(context_t ctx, const Expression &condition)
+    {
+        SEMANTIC_ACTION();
+        if (condition.node == nullptr)
+            return;
+        if (!is_boolean_type(condition.type)) {
+            ctx->message(errors::INCOMPATIBLE_TYPES, ctx->loc(), condition.type->descriptor(),
+                         TYPE_TABLE.get_boolean_type()->descriptor());
+            return;
+        }
+        ctx->loops().back()->condition = condition.node;
+    }
+
+    void
+    for_loop_head(context_t ctx, const ExpressionOpt &condition, ir::StatementArray &update)
+    {
+        SEMANTIC_ACTION();
+        if (condition)
+            loop_condition(ctx, *condition);
+        else
+            ctx->loops().back()->condition = ARENA.make<ir::Constant>(TYPE_TABLE.get_boolean_type(), int_t(1));
+        ctx->loops().back()->update = std::move(update);
+    }
+
+    ir::Statement *
+    leave_loop(context_t ctx, ir::Statement *body, ir::Statement *init)
+    {
+        SEMANTIC_ACTION(nullptr);
+        ir::Loop *loop = ctx->loops().back();
+        ctx->loops().pop_back();
+        SCOPE_TABLE.leave_scope();
+        if (loop->condition == nullptr)
+            return nullptr;
+
+        loop->body = body;
+        if (init == nullptr)
+            return loop;
+        return ARENA.make<ir::Block>(ir::StatementArray{ init, loop });
+    }
+
+    ir::Statement *
+    break_statement(context_t ctx)
+    {
+        SEMANTIC_ACTION(nullptr);
+        if (ctx->switches().empty() && ctx->loops().empty()) {
+            ctx->message(errors::BREAK_OUTSIDE_SWITCH, ctx->loc());
+            return nullptr;
+        }
+        return ARENA.make<ir::Break>();
+    }
+
+    ir::Statement *
+    continue_statement(context_t ctx)
+    {
+        SEMANTIC_ACTION(nullptr);
+        if (ctx->loops().empty()) {
+            ctx->message(errors::CONTINUE_OUTSIDE_LOOP, ctx->loc());
+            return nullptr;
+        }
+        return ARENA.make<ir::Continue>();
+    }
+
+    ir::Statement *
+    synchronized_statement(context_t ctx, const Expression &lock, ir::Block *body)
+    {
+        SEMANTIC_ACTION(nullptr);
+        if (lock.node == nullptr)
+            return nullptr;
+        if (!is_reference_type(lock.type)) {
+            ctx->message(errors::INCOMPATIBLE_TYPES, ctx->loc(), lock.type->descriptor(),
+                         TYPE_TABLE.get_class_type("java/lang/Object")->descriptor());
+            return nullptr;
+        }
+        auto *local = ARENA.make<ir::Local>("$zamek", lock.type, 0);
+        return ARENA.make<ir::Synchronized>(lock.node, local, body);
     }
 
     void
     set_package_name(context_t ctx, const Name &name)
     {
+        SEMANTIC_ACTION();
         ctx->set_package_name(name);
     }
 
     void
     import(context_t ctx, const Name &name)
     {
-        std::cout << "importing " << name << std::endl;
+        SEMANTIC_ACTION();
+        LOG_DEBUG("importing ", name);
         CLASS_TABLE.import_class(name);
     }
 
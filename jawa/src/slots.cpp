@@ -0,0 +1,197 @@
+/**
+ * @file slots.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "slots.hpp"
+#include "tables.hpp"
+
+namespace jawa {
+
+    /**
+     * Positions of the first and the last occurrence of a variable and the number of its occurrences, the
+     * occurrences in loops count more.
+     */
+    struct LiveRange
+    {
+        std::size_t start;
+        std::size_t end;
+        std::size_t uses;
+
+        inline bool
+        overlaps(const LiveRange &other) const
+        {
+            return start <= other.end && other.start <= end;
+        }
+    };
+
+    struct Liveness
+    {
+        std::size_t position = 0;
+        unsigned loop_depth = 0;
+        // locals in the order of their first occurrence
+        std::vector<ir::Local *> locals;
+        std::unordered_map<const ir::Local *, LiveRange> ranges;
+        // positions of the loops, the inner loops precede the outer ones
+        std::vector<LiveRange> loops;
+    };
+
+    static void
+    occurrence(Liveness &liveness, ir::Local *local)
+    {
+        std::size_t position = liveness.position++;
+        auto [it, inserted] = liveness.ranges.try_emplace(local, LiveRange{ position, position, 0 });
+        if (inserted)
+            liveness.locals.push_back(local);
+        it->second.end = position;
+        // an occurrence in a loop counts as eight outside of it
+        it->second.uses += std::size_t(1) << (3 * std::min(liveness.loop_depth, 3u));
+    }
+
+    /**
+     * Numbers the occurrences of the locals in the order in which the lowering emits them.
+     */
+    static void
+    analyse(Liveness &liveness, ir::Node *node)
+    {
+        switch (node->kind) {
+        case ir::Kind::LOCAL_LOAD:
+            occurrence(liveness, static_cast<ir::LocalLoad *>(node)->local);
+            break;
+        case ir::Kind::LOCAL_STORE: {
+            auto store = static_cast<ir::LocalStore *>(node);
+            // the value is evaluated before it is stored
+            analyse(liveness, store->value);
+            occurrence(liveness, store->local);
+            break;
+        }
+        case ir::Kind::LOOP: {
+            auto loop = static_cast<ir::Loop *>(node);
+            std::size_t start = liveness.position;
+            ++liveness.loop_depth;
+            // the condition is tested at the bottom of the loop
+            if (loop->body != nullptr)
+                analyse(liveness, loop->body);
+            for (auto *update : loop->update)
+                analyse(liveness, update);
+            if (loop->condition != nullptr)
+                analyse(liveness, loop->condition);
+            --liveness.loop_depth;
+            if (liveness.position > start)
+                liveness.loops.push_back(LiveRange{ start, liveness.position - 1, 0 });
+            break;
+        }
+        case ir::Kind::SYNCHRONIZED: {
+            auto sync = static_cast<ir::Synchronized *>(node);
+            analyse(liveness, sync->lock);
+            occurrence(liveness, sync->local);
+            if (sync->body != nullptr)
+                analyse(liveness, sync->body);
+            // the lock is loaded again to release the monitor at the end of the body
+            occurrence(liveness, sync->local);
+            break;
+        }
+        default:
+            ir::for_each_child(node, [&liveness](auto *child) { analyse(liveness, child); });
+            break;
+        }
+    }
+
+    /**
+     * Extends the live ranges of the variables which are live across the back edge of a loop to the whole loop.
+     * A variable used in a loop is live across its back edge if it is also used before or after the loop, the
+     * variables occurring only in a loop are assigned in each iteration before they are used.
+     */
+    static void
+    extend_over_loops(Liveness &liveness)
+    {
+        for (auto &loop : liveness.loops) {
+            for (auto &[local, range] : liveness.ranges) {
+                if (range.overlaps(loop) && (range.start < loop.start || range.end > loop.end)) {
+                    range.start = std::min(range.start, loop.start);
+                    range.end = std::max(range.end, loop.end);
+                }
+            }
+        }
+    }
+
+    /**
+     * Live ranges of the variables allocated to each slot.
+     */
+    using SlotRanges = std::vector<std::vector<LiveRange>>;
+
+    static bool
+    is_free(const SlotRanges &slots, std::size_t slot, const LiveRange &range)
+    {
+        if (slot >= slots.size())
+            return true;
+        return std::none_of(slots[slot].begin(), slots[slot].end(),
+                            [&range](const LiveRange &other) { return other.overlaps(range); });
+    }
+
+    static void
+    occupy(SlotRanges &slots, std::size_t slot, const LiveRange &range)
+    {
+        if (slot >= slots.size())
+            slots.resize(slot + 1);
+        slots[slot].push_back(range);
+    }
+
+    void
+    allocate_slots(ir::Method &method)
+    {
+        Liveness liveness;
+        // the parameters are assigned at the entry of the method
+        for (auto *parameter : method.parameters)
+            occurrence(liveness, parameter);
+        if (method.body != nullptr)
+            analyse(liveness, method.body);
+        extend_over_loops(liveness);
+
+        SlotRanges slots;
+        jasm::u2 slot = 0;
+        if (!(method.access_flags & jasm::Method::ACC_STATIC)) {
+            // the receiver is kept for the whole method
+            occupy(slots, slot++, LiveRange{ 0, liveness.position, 0 });
+            if (method.receiver != nullptr)
+                method.receiver->index = 0;
+        }
+        for (auto *parameter : method.parameters) {
+            parameter->index = slot;
+            for (jasm::u2 i = 0; i < slot_count(parameter->type); ++i)
+                occupy(slots, slot++, liveness.ranges[parameter]);
+        }
+
+        std::vector<ir::Local *> locals;
+        for (auto *local : liveness.locals) {
+            if (local != method.receiver &&
+                std::find(method.parameters.begin(), method.parameters.end(), local) == method.parameters.end())
+                locals.push_back(local);
+        }
+        std::stable_sort(locals.begin(), locals.end(), [&liveness](const ir::Local *lhs, const ir::Local *rhs) {
+            return liveness.ranges[lhs].uses > liveness.ranges[rhs].uses;
+        });
+
+        for (auto *local : locals) {
+            const LiveRange &range = liveness.ranges[local];
+            jasm::u2 slots_needed = slot_count(local->type);
+            jasm::u2 index = 0;
+            while (!is_free(slots, index, range) || (slots_needed == 2 && !is_free(slots, index + 1, range)))
+                ++index;
+            local->index = index;
+            for (jasm::u2 i = 0; i < slots_needed; ++i)
+                occupy(slots, index + i, range);
+        }
+
+        method.locals_limit = slots.size();
+    }
+
+}
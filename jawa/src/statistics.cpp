@@ -0,0 +1,122 @@
+/**
+ * @file statistics.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include "statistics.hpp"
+#include "unicode.hpp"
+#include <cassert>
+#include <iomanip>
+
+namespace jawa {
+
+    const char *
+    phase_name(Phase phase)
+    {
+        switch (phase) {
+        case Phase::LEXING:
+            return "leksykalna";
+        case Phase::PARSING:
+            return "składnia";
+        case Phase::LOADING:
+            return "ładowanie";
+        case Phase::GENERATION:
+            return "generowanie";
+        case Phase::EMISSION:
+            return "emisja";
+        }
+        return "";
+    }
+
+    void
+    Statistics::enable()
+    {
+        enabled_ = true;
+        start_ = clock::now();
+        last_switch_ = start_;
+    }
+
+    void
+    Statistics::set_location(const Name &source_file, const unsigned *line)
+    {
+        source_file_ = source_file;
+        line_ = line;
+    }
+
+    void
+    Statistics::switch_phase()
+    {
+        clock::time_point now = clock::now();
+        if (!running_.empty())
+            phases_[static_cast<std::size_t>(running_.back())].time += now - last_switch_;
+        last_switch_ = now;
+    }
+
+    void
+    Statistics::enter(Phase phase)
+    {
+        switch_phase();
+        running_.push_back(phase);
+        ++phases_[static_cast<std::size_t>(phase)].calls;
+    }
+
+    void
+    Statistics::leave()
+    {
+        assert(!running_.empty());
+        switch_phase();
+        running_.pop_back();
+    }
+
+    void
+    Statistics::add_class_load(const Name &class_name, clock::duration time, std::size_t bytes)
+    {
+        class_loads_.push_back({ class_name, source_file_, line_ ? *line_ : 0, time, bytes });
+    }
+
+    static double
+    to_ms(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    void
+    Statistics::report(std::ostream &os) const
+    {
+        auto total = clock::now() - start_;
+        clock::duration measured{};
+
+        os << std::left << std::setw(14) << "faza" << std::right << std::setw(12) << "czas [ms]" << std::setw(13)
+           << "wywołania" << std::setw(14) << "bajty" << std::endl;
+        os << std::fixed << std::setprecision(3);
+        for (std::size_t i = 0; i < PhaseCount; ++i) {
+            const phase_stats_t &stats = phases_[i];
+            measured += stats.time;
+            // phase names contain multi-byte characters, so they are padded by hand
+            const char *name = phase_name(static_cast<Phase>(i));
+            os << name;
+            for (int width = unicode::utf8_length(name); width < 14; ++width)
+                os << ' ';
+            os << std::setw(12) << to_ms(stats.time) << std::setw(12) << stats.calls << std::setw(14) << stats.bytes
+               << std::endl;
+        }
+        os << std::left << std::setw(14) << "inne" << std::right << std::setw(12) << to_ms(total - measured)
+           << std::endl;
+        os << std::left << std::setw(14) << "razem" << std::right << std::setw(12) << to_ms(total) << std::endl;
+
+        if (class_loads_.empty())
+            return;
+
+        os << std::endl << "ładowanie klas:" << std::endl;
+        for (auto &load : class_loads_) {
+            os << "  " << load.source_file << ':' << load.line << ": " << load.class_name << " (" << to_ms(load.time)
+               << " ms, " << load.bytes << " B)" << std::endl;
+        }
+    }
+
+}
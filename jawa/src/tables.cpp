@@ -9,7 +9,10 @@
  */
 
 #include "tables.hpp"
+#include "log.hpp"
+#include <algorithm>
 #include <class.hpp>
+#include <cstring>
 #include <filesystem>
 #include <sstream>
 
@@ -67,55 +70,193 @@ namespace jawa {
         return name_ == clazz.name_;
     }
 
+    std::string_view
+    JawaClass::raw_name(const raw_member_t &member) const
+    {
+        return std::string_view(raw_strings_).substr(member.name_offset, member.name_length);
+    }
+
+    std::string_view
+    JawaClass::raw_descriptor(const raw_member_t &member) const
+    {
+        return std::string_view(raw_strings_).substr(member.descriptor_offset, member.descriptor_length);
+    }
+
+    std::pair<std::vector<JawaClass::raw_member_t>::iterator, std::vector<JawaClass::raw_member_t>::iterator>
+    JawaClass::find_raw(std::vector<raw_member_t> &members, const Name &name) const
+    {
+        auto less = [this](const raw_member_t &lhs, std::string_view rhs) { return raw_name(lhs) < rhs; };
+        auto greater = [this](std::string_view lhs, const raw_member_t &rhs) { return lhs < raw_name(rhs); };
+        auto first = std::lower_bound(members.begin(), members.end(), std::string_view(name), less);
+        auto last = std::upper_bound(first, members.end(), std::string_view(name), greater);
+        return { first, last };
+    }
+
+    void
+    JawaClass::materialise_method(raw_member_t &member) const
+    {
+        member.materialised = true;
+        auto type = dynamic_cast<MethodTypeObs>(type_table_->from_descriptor(Name(raw_descriptor(member))));
+        assert(type != nullptr);
+
+        JawaMethod jawa_method(Name(raw_name(member)), type, member.access_flags);
+        methods_.insert({ jawa_method.signature(), std::move(jawa_method) });
+    }
+
+    void
+    JawaClass::materialise_field(raw_member_t &member) const
+    {
+        member.materialised = true;
+        TypeObs type = type_table_->from_descriptor(Name(raw_descriptor(member)));
+
+        Name name(raw_name(member));
+        std::optional<ConstantValue> constant_value;
+        if (auto search = constant_values_.find(name); search != constant_values_.end())
+            constant_value = search->second;
+        fields_.insert({ name, JawaField(name, type, member.access_flags, std::move(constant_value)) });
+    }
+
     const JawaMethod *
     JawaClass::get_method(const JawaMethodSignature &signature) const
     {
+        // overloads share the name, so all of them are resolved at once
+        auto [first, last] = find_raw(raw_methods_, signature.name);
+        for (auto it = first; it != last; ++it) {
+            if (!it->materialised)
+                materialise_method(*it);
+        }
+
         auto search = methods_.find(signature);
         if (search != methods_.end())
             return &search->second;
         return nullptr;
     }
 
-    JawaClass::JawaClass(TypeTable &type_table, jasm::Class &clazz)
+    std::vector<const JawaMethod *>
+    JawaClass::get_methods(const Name &name) const
     {
-        jasm::ClassConstant *this_class = clazz.this_class();
-        jasm::u2 index = this_class->name_index();
-        auto *constant = dynamic_cast<jasm::Utf8Constant *>(clazz.constant_pool().get(index));
-        name_ = constant->value();
-
-        for (auto &field : clazz.fields()) {
-            index = field.name_index();
-            auto name_constant = dynamic_cast<jasm::Utf8Constant *>(clazz.constant_pool().get(index));
+        auto [first, last] = find_raw(raw_methods_, name);
+        for (auto it = first; it != last; ++it) {
+            if (!it->materialised)
+                materialise_method(*it);
+        }
 
-            index = field.descriptor_index();
-            auto descriptor_constant = dynamic_cast<jasm::Utf8Constant *>(clazz.constant_pool().get(index));
-            TypeObs type = type_table.from_descriptor(descriptor_constant->value());
+        std::vector<const JawaMethod *> methods;
+        for (auto it = first; it != last; ++it) {
+            auto type = dynamic_cast<MethodTypeObs>(type_table_->from_descriptor(Name(raw_descriptor(*it))));
+            const JawaMethod *method = &methods_.at(JawaMethodSignature(name, type->argument_types()));
+            // bridge methods differ only in the return type and share the entry of the bridged method
+            if (std::find(methods.begin(), methods.end(), method) == methods.end())
+                methods.push_back(method);
+        }
+        return methods;
+    }
 
-            jasm::u2 access_flags = field.access_flags();
+    JawaClass::JawaClass(TypeTable &type_table, jasm::Class &clazz, LoadMode mode)
+      : type_table_(&type_table)
+      , access_flags_(clazz.access_flags())
+    {
+        const jasm::ConstantPool &pool = clazz.constant_pool();
+        auto utf8 = [&pool](jasm::u2 index) -> const std::string & {
+            auto constant = dynamic_cast<const jasm::Utf8Constant *>(pool.get(index));
+            assert(constant != nullptr);
+            return constant->value();
+        };
 
-            fields_.insert({ name_constant->value(), JawaField(name_constant->value(), type, access_flags) });
+        name_ = utf8(clazz.this_class()->name_index());
+        if (auto super_class = clazz.super_class())
+            supertypes_.super_class = utf8(super_class->name_index());
+        for (jasm::u2 index : clazz.interfaces()) {
+            auto interface = dynamic_cast<const jasm::ClassConstant *>(pool.get(index));
+            assert(interface != nullptr);
+            supertypes_.interfaces.push_back(utf8(interface->name_index()));
         }
 
-        for (auto &method : clazz.methods()) {
-            index = method.name_index();
-            auto name_constant = dynamic_cast<jasm::Utf8Constant *>(clazz.constant_pool().get(index));
+        std::size_t raw_strings_length = 0;
+        for (auto &field : clazz.fields())
+            raw_strings_length += utf8(field.name_index()).size() + utf8(field.descriptor_index()).size();
+        for (auto &method : clazz.methods())
+            raw_strings_length += utf8(method.name_index()).size() + utf8(method.descriptor_index()).size();
+        raw_strings_.reserve(raw_strings_length);
+        raw_fields_.reserve(clazz.fields().size());
+        raw_methods_.reserve(clazz.methods().size());
+
+        auto make_raw = [this](const std::string &name, const std::string &descriptor, jasm::u2 access_flags) {
+            raw_member_t member{};
+            member.name_offset = raw_strings_.size();
+            member.name_length = name.size();
+            raw_strings_ += name;
+            member.descriptor_offset = raw_strings_.size();
+            member.descriptor_length = descriptor.size();
+            raw_strings_ += descriptor;
+            member.access_flags = access_flags;
+            member.materialised = false;
+            return member;
+        };
+
+        for (auto &field : clazz.fields())
+            raw_fields_.push_back(
+              make_raw(utf8(field.name_index()), utf8(field.descriptor_index()), field.access_flags()));
 
-            index = method.descriptor_index();
-            auto descriptor_constant = dynamic_cast<jasm::Utf8Constant *>(clazz.constant_pool().get(index));
-            auto type = dynamic_cast<MethodTypeObs>(type_table.from_descriptor(descriptor_constant->value()));
-            assert(type != nullptr);
+        // the constants are resolved eagerly, the constant pool is not kept
+        for (auto &field : clazz.fields()) {
+            if ((field.access_flags() & (jasm::Field::ACC_STATIC | jasm::Field::ACC_FINAL)) !=
+                (jasm::Field::ACC_STATIC | jasm::Field::ACC_FINAL))
+                continue;
+            for (auto &attribute : field.attributes()) {
+                auto constant_value = dynamic_cast<const jasm::ConstantValueAttribute *>(attribute.get());
+                if (constant_value == nullptr)
+                    continue;
+                const jasm::Constant *constant = pool.get(constant_value->constant_value_index());
+                if (auto integer = dynamic_cast<const jasm::IntegerConstant *>(constant)) {
+                    constant_values_.emplace(utf8(field.name_index()), static_cast<int_t>(integer->bytes()));
+                } else if (auto float_constant = dynamic_cast<const jasm::FloatConstant *>(constant)) {
+                    jasm::u4 bytes = float_constant->bytes();
+                    float_t value;
+                    std::memcpy(&value, &bytes, sizeof(value));
+                    constant_values_.emplace(utf8(field.name_index()), value);
+                } else if (auto long_constant = dynamic_cast<const jasm::LongConstant *>(constant)) {
+                    jasm::u8 bytes = (jasm::u8) long_constant->high_bytes() << 32u | long_constant->low_bytes();
+                    constant_values_.emplace(utf8(field.name_index()), static_cast<long_t>(bytes));
+                } else if (auto double_constant = dynamic_cast<const jasm::DoubleConstant *>(constant)) {
+                    jasm::u8 bytes = (jasm::u8) double_constant->high_bytes() << 32u | double_constant->low_bytes();
+                    double_t value;
+                    std::memcpy(&value, &bytes, sizeof(value));
+                    constant_values_.emplace(utf8(field.name_index()), value);
+                } else if (auto string = dynamic_cast<const jasm::StringConstant *>(constant)) {
+                    constant_values_.emplace(utf8(field.name_index()), utf8(string->string_index()));
+                }
+            }
+        }
 
-            // TODO: modifiers
-            jasm::u2 access_flags = method.access_flags();
+        // TODO: modifiers
+        for (auto &method : clazz.methods())
+            raw_methods_.push_back(
+              make_raw(utf8(method.name_index()), utf8(method.descriptor_index()), method.access_flags()));
 
-            JawaMethod jawa_method(name_constant->value(), type, access_flags);
-            methods_.insert({ jawa_method.signature(), std::move(jawa_method) });
+        auto by_name = [this](const raw_member_t &lhs, const raw_member_t &rhs) {
+            return raw_name(lhs) < raw_name(rhs);
+        };
+        std::sort(raw_fields_.begin(), raw_fields_.end(), by_name);
+        std::sort(raw_methods_.begin(), raw_methods_.end(), by_name);
+
+        if (mode == EAGER) {
+            for (auto &field : raw_fields_)
+                materialise_field(field);
+            for (auto &method : raw_methods_)
+                materialise_method(method);
         }
     }
 
     const JawaField *
     JawaClass::get_field(const Name &name) const
     {
+        auto [first, last] = find_raw(raw_fields_, name);
+        for (auto it = first; it != last; ++it) {
+            if (!it->materialised)
+                materialise_field(*it);
+        }
+
         auto search = fields_.find(name);
         if (search != fields_.end())
             return &search->second;
@@ -157,7 +298,7 @@ namespace jawa {
 
         std::size_t index = fully_qualified_name.rfind('/');
         Name last_part = fully_qualified_name.substr(index + 1, std::string::npos);
-        std::cout << last_part << std::endl;
+        LOG_DEBUG("imported ", last_part);
 
         imported_classes_.insert({ last_part, JawaImport(fully_qualified_name, file) });
         return true;
@@ -209,17 +350,157 @@ namespace jawa {
         if (file.empty())
             return nullptr;
 
-        std::cout << "load " << file << std::endl;
+        auto phase = statistics_.measure(Phase::LOADING);
+        auto start = std::chrono::steady_clock::now();
+
+        LOG_INFO("load ", file);
         std::ifstream is(file);
         jasm::Class clazz(is);
         is.close();
 
-        JawaClass jawa_class(type_table_, clazz);
+        if (statistics_.enabled()) {
+            // the position of a stream which has read past the end is unknown, the size is taken from the file
+            std::error_code error;
+            std::uintmax_t bytes = std::filesystem::file_size(file, error);
+            statistics_.add_class_load(class_name, std::chrono::steady_clock::now() - start, error ? 0 : bytes);
+        }
+
+        JawaClass jawa_class(type_table_, clazz, load_mode_);
         auto inserted = classes_.insert({ class_name, std::move(jawa_class) });
 
         return &inserted.first->second;
     }
 
+    void
+    ClassTable::declare_class(const Name &class_name, JawaSupertypes supertypes)
+    {
+        declared_classes_[class_name] = std::move(supertypes);
+    }
+
+    const JawaSupertypes *
+    ClassTable::get_supertypes(const Name &class_name)
+    {
+        auto search = declared_classes_.find(class_name);
+        if (search != declared_classes_.end())
+            return &search->second;
+        const JawaClass *jawa_class = load_class(class_name);
+        return jawa_class != nullptr ? &jawa_class->supertypes() : nullptr;
+    }
+
+    bool
+    ClassTable::is_subclass(const Name &class_name, const Name &super_name)
+    {
+        if (class_name == super_name || super_name == "java/lang/Object")
+            return true;
+        const JawaSupertypes *supertypes = get_supertypes(class_name);
+        if (supertypes == nullptr)
+            return false;
+        if (!supertypes->super_class.empty() && is_subclass(supertypes->super_class, super_name))
+            return true;
+        return std::any_of(supertypes->interfaces.begin(), supertypes->interfaces.end(),
+                           [this, &super_name](const Name &interface) { return is_subclass(interface, super_name); });
+    }
+
+    bool
+    ClassTable::is_assignable(TypeObs from, TypeObs to)
+    {
+        if (from == to)
+            return true;
+        auto to_class = dynamic_cast<ClassTypeObs>(to);
+        if (to_class == nullptr || !is_reference_type(from))
+            return false;
+        auto from_class = dynamic_cast<ClassTypeObs>(from);
+        if (from_class == nullptr) {
+            const Name &name = to_class->class_name();
+            return name == "java/lang/Object" || name == "java/lang/Cloneable" || name == "java/io/Serializable";
+        }
+        return is_subclass(from_class->class_name(), to_class->class_name());
+    }
+
+    std::optional<std::size_t>
+    ClassTable::select_overload(const std::vector<MethodTypeObs> &candidates, const TypeObsArray &argument_types)
+    {
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            if (candidates[i]->argument_types() == argument_types)
+                return i;
+        }
+
+        // every argument of a call of one overload can be passed to the other one
+        auto accepts = [this](const TypeObsArray &parameter_types, const TypeObsArray &argument_types) {
+            if (parameter_types.size() != argument_types.size())
+                return false;
+            for (std::size_t i = 0; i < argument_types.size(); ++i) {
+                if (!is_assignable(argument_types[i], parameter_types[i]))
+                    return false;
+            }
+            return true;
+        };
+
+        std::vector<std::size_t> applicable;
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            if (accepts(candidates[i]->argument_types(), argument_types))
+                applicable.push_back(i);
+        }
+        for (std::size_t i : applicable) {
+            const TypeObsArray &parameter_types = candidates[i]->argument_types();
+            auto less_specific = [&](std::size_t j) {
+                return accepts(candidates[j]->argument_types(), parameter_types);
+            };
+            if (std::all_of(applicable.begin(), applicable.end(), less_specific))
+                return i;
+        }
+        return std::nullopt;
+    }
+
+    void
+    ClassTable::collect_methods(const Name &class_name, const Name &method_name,
+                                std::vector<const JawaMethod *> &methods, std::unordered_set<Name> &visited)
+    {
+        if (!visited.insert(class_name).second)
+            return;
+        const JawaClass *jawa_class = load_class(class_name);
+        if (jawa_class == nullptr)
+            return;
+
+        bool inherited = visited.size() > 1;
+        for (const JawaMethod *method : jawa_class->get_methods(method_name)) {
+            if (inherited && (method->access_flags() & jasm::Method::ACC_PRIVATE))
+                continue;
+            // an overridden method is represented by the overriding one
+            auto overrides = [method](const JawaMethod *other) {
+                return other->method_type()->argument_types() == method->method_type()->argument_types();
+            };
+            if (std::none_of(methods.begin(), methods.end(), overrides))
+                methods.push_back(method);
+        }
+
+        // interfaces have java/lang/Object as their superclass, so its methods are found as well
+        const JawaSupertypes &supertypes = jawa_class->supertypes();
+        if (!supertypes.super_class.empty())
+            collect_methods(supertypes.super_class, method_name, methods, visited);
+        for (auto &interface : supertypes.interfaces)
+            collect_methods(interface, method_name, methods, visited);
+    }
+
+    const JawaMethod *
+    ClassTable::find_method(const Name &class_name, const JawaMethodSignature &signature)
+    {
+        std::vector<const JawaMethod *> methods;
+        if (signature.name == "<init>") {
+            if (const JawaClass *jawa_class = load_class(class_name))
+                methods = jawa_class->get_methods(signature.name);
+        } else {
+            std::unordered_set<Name> visited;
+            collect_methods(class_name, signature.name, methods, visited);
+        }
+
+        std::vector<MethodTypeObs> types;
+        for (const JawaMethod *method : methods)
+            types.push_back(method->method_type());
+        auto index = select_overload(types, signature.argument_types);
+        return index ? methods[*index] : nullptr;
+    }
+
     Name
     ClassTable::get_fully_qualified_name(const Name &name)
     {
@@ -359,9 +640,10 @@ namespace jawa {
     }
 
     void
-    VariableScope::add_var(const Name &name, TypeObs type, jasm::u2 index)
+    VariableScope::add_var(const Name &name, TypeObs type, jasm::u2 index, ir::Local *local)
     {
-        local_variables_.emplace(name, LocalVariable{ { name, type }, index });
+        local_variables_.emplace(name, LocalVariable{ { name, type }, index, local });
+        slots_ += slot_count(type);
     }
 
     void
@@ -374,7 +656,7 @@ namespace jawa {
     VariableScopeTable::leave_scope()
     {
         assert(scopes_.size() > 0);
-        count_ -= scopes_.back().local_variables_.size();
+        count_ -= scopes_.back().slots_;
         scopes_.pop_back();
     }
 
@@ -389,10 +671,15 @@ namespace jawa {
         return nullptr;
     }
 
-    void
-    VariableScopeTable::add_var(const Name &name, TypeObs type)
+    jasm::u2
+    VariableScopeTable::add_var(const Name &name, TypeObs type, ir::Local *local)
     {
         assert(scopes_.size() > 0);
-        scopes_.back().add_var(name, type, count_++);
+        jasm::u2 index = count_;
+        scopes_.back().add_var(name, type, index, local);
+        count_ += slot_count(type);
+        if (count_ > limit_)
+            limit_ = count_;
+        return index;
     }
 }
\ No newline at end of file
@@ -0,0 +1,164 @@
+/**
+ * @file compile_benchmark.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef JAWAC_PATH
+#define JAWAC_PATH "jawac"
+#endif
+
+/**
+ * Result of a single compiler run.
+ */
+struct run_t
+{
+    double seconds;
+    long peak_rss_kb;
+    int status;
+};
+
+/**
+ * Runs the compiler in the project directory and measures its wall time and peak resident set size.
+ *
+ * @param arguments compiler command line.
+ * @param directory working directory.
+ * @return measured run.
+ */
+static run_t
+run_compiler(const std::vector<std::string> &arguments, const std::string &directory)
+{
+    std::vector<char *> argv;
+    for (auto &argument : arguments)
+        argv.push_back(const_cast<char *>(argument.c_str()));
+    argv.push_back(nullptr);
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (chdir(directory.c_str()) != 0)
+            _exit(127);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage
+    {};
+    wait4(pid, &status, 0, &usage);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return { seconds, usage.ru_maxrss, WIFEXITED(status) ? WEXITSTATUS(status) : -1 };
+}
+
+static void
+show_usage(const char *name)
+{
+    std::cerr << "usage: " << name << " [--jawac JAWAC] [--classpath CLASSPATH] [--iterations N] <PROJECT_DIRECTORY>"
+              << " [-- JAWAC_OPTIONS ...]" << std::endl;
+}
+
+int
+main(int argc, char *argv[])
+{
+    std::string jawac = JAWAC_PATH;
+    std::string classpath = ".";
+    std::string project;
+    int iterations = 5;
+    std::vector<std::string> extra_options;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--jawac") == 0 && i + 1 < argc) {
+            jawac = argv[++i];
+        } else if (strcmp(argv[i], "--classpath") == 0 && i + 1 < argc) {
+            classpath = argv[++i];
+        } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--") == 0) {
+            extra_options.assign(argv + i + 1, argv + argc);
+            break;
+        } else if (project.empty()) {
+            project = argv[i];
+        } else {
+            show_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (project.empty()) {
+        show_usage(argv[0]);
+        return 1;
+    }
+
+    std::ifstream manifest(std::filesystem::path(project) / "pliki.txt");
+    if (!manifest) {
+        std::cerr << "could not open " << project << "/pliki.txt, generate the project with workload_generator"
+                  << std::endl;
+        return 1;
+    }
+
+    // the project directory has to be on the class path, the classes refer to each other
+    std::vector<std::string> arguments = { std::filesystem::absolute(jawac).string(), "--ścieżkaklasy",
+                                           ".:" + classpath };
+    arguments.insert(arguments.end(), extra_options.begin(), extra_options.end());
+
+    std::size_t lines = 0, bytes = 0;
+    std::string file;
+    while (std::getline(manifest, file)) {
+        std::ifstream is(std::filesystem::path(project) / file);
+        std::string line;
+        while (std::getline(is, line)) {
+            ++lines;
+            bytes += line.size() + 1;
+        }
+        arguments.push_back(file);
+    }
+
+    std::cout << arguments.size() - 3 - extra_options.size() << " files, " << lines << " lines, " << bytes
+              << " bytes" << std::endl;
+
+    std::vector<run_t> runs;
+    for (int i = 0; i < iterations; ++i) {
+        run_t run = run_compiler(arguments, project);
+        if (run.status != 0) {
+            std::cerr << "jawac failed with status " << run.status << std::endl;
+            return 1;
+        }
+        runs.push_back(run);
+    }
+
+    std::sort(runs.begin(), runs.end(), [](const run_t &lhs, const run_t &rhs) { return lhs.seconds < rhs.seconds; });
+    const run_t &best = runs.front();
+    const run_t &median = runs[runs.size() / 2];
+    long peak_rss_kb = 0;
+    for (auto &run : runs)
+        peak_rss_kb = std::max(peak_rss_kb, run.peak_rss_kb);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "best:     " << best.seconds << " s, " << std::setprecision(0) << lines / best.seconds << " lines/s, "
+              << std::setprecision(2) << bytes / best.seconds / 1e6 << " MB/s" << std::endl;
+    std::cout << std::setprecision(3) << "median:   " << median.seconds << " s, " << std::setprecision(0)
+              << lines / median.seconds << " lines/s, " << std::setprecision(2) << bytes / median.seconds / 1e6
+              << " MB/s" << std::endl;
+    std::cout << "peak RSS: " << peak_rss_kb << " KB" << std::endl;
+
+    return 0;
+}
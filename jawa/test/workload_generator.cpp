@@ -0,0 +1,237 @@
+/**
+ * @file workload_generator.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct parameters_t
+{
+    unsigned classes = 100;
+    unsigned methods = 20;
+    unsigned statements = 10;
+    unsigned imports = 5;
+    unsigned literals = 200;
+    unsigned packages = 10;
+    unsigned seed = 1;
+};
+
+static const char *const Words[] = {
+    "zażółć", "gęślą", "jaźń", "źdźbło", "łódź", "żółw", "ćma", "ślimak", "jeż", "dąb",
+    "wartość", "wynik", "błąd", "żądanie", "odpowiedź", "użytkownik", "plik", "ścieżka", "węzeł", "pamięć",
+};
+
+/**
+ * Generates a synthetic Jawa project for benchmarking the compiler.
+ *
+ * Only the language subset jawac can compile is generated: packages, imports, static fields initialised
+ * in a static initializer, static void methods with Łańcuch parameters, string literals and static calls.
+ * Classes call methods of classes generated before them only, so the sources compile in the order listed
+ * in the manifest file (pliki.txt).
+ */
+class Generator
+{
+private:
+    const parameters_t &params_;
+    std::mt19937 random_;
+    std::vector<std::string> literals_;
+
+    unsigned
+    pick(unsigned n)
+    {
+        return std::uniform_int_distribution<unsigned>(0, n - 1)(random_);
+    }
+
+    std::string
+    package_name(unsigned klass) const
+    {
+        return "gen.p" + std::to_string(klass % params_.packages);
+    }
+
+    static std::string
+    class_name(unsigned klass)
+    {
+        return "Klasa" + std::to_string(klass);
+    }
+
+    static std::string
+    method_name(unsigned method)
+    {
+        return "metoda" + std::to_string(method);
+    }
+
+    void
+    statement(std::ostream &os, const std::vector<unsigned> &imported)
+    {
+        unsigned kind = pick(imported.empty() ? 2 : 4);
+        os << "        ";
+        switch (kind) {
+        case 0:
+            os << "System.wyjście.wydrukovać(\"" << literals_[pick(literals_.size())] << "\");";
+            break;
+        case 1:
+            os << "System.wyjście.wydrukovać(" << (pick(2) ? "pierwszy" : "drugi") << ");";
+            break;
+        default: {
+            unsigned callee = imported[pick(imported.size())];
+            os << class_name(callee) << '.' << method_name(pick(params_.methods)) << "(\""
+               << literals_[pick(literals_.size())] << "\", " << (pick(2) ? "pierwszy" : "drugi") << ");";
+            break;
+        }
+        }
+        os << '\n';
+    }
+
+public:
+    explicit Generator(const parameters_t &params)
+      : params_(params)
+      , random_(params.seed)
+    {
+        for (unsigned i = 0; i < params_.literals; ++i) {
+            std::ostringstream literal;
+            unsigned words = 1 + pick(6);
+            for (unsigned w = 0; w < words; ++w)
+                literal << (w ? " " : "") << Words[pick(sizeof(Words) / sizeof(*Words))];
+            literal << ' ' << i;
+            literals_.push_back(literal.str());
+        }
+    }
+
+    /**
+     * Writes a single class.
+     *
+     * @param os output stream.
+     * @param klass class number.
+     * @return number of written lines.
+     */
+    std::size_t
+    write_class(std::ostream &os, unsigned klass)
+    {
+        std::vector<unsigned> imported;
+        for (unsigned i = 0; i < params_.imports && klass > 0; ++i) {
+            unsigned callee = pick(klass);
+            if (std::find(imported.begin(), imported.end(), callee) == imported.end())
+                imported.push_back(callee);
+        }
+
+        std::ostringstream ss;
+        ss << "/**\n * Klasa wygenerowana dla testów wydajności kompilatora.\n */\n";
+        ss << "pakiet " << package_name(klass) << ";\n\n";
+        ss << "zaimportuj jawa.io.StrumieńDrukowania;\n";
+        for (unsigned callee : imported)
+            ss << "zaimportuj " << package_name(callee) << '.' << class_name(callee) << ";\n";
+        ss << "\npubliczna klasa " << class_name(klass) << " {\n\n";
+        ss << "    publiczny statyczny StrumieńDrukowania strumień;\n\n";
+        ss << "    statyczny {\n        strumień = nowy StrumieńDrukowania();\n    }\n";
+
+        for (unsigned m = 0; m < params_.methods; ++m) {
+            ss << "\n    // " << literals_[pick(literals_.size())] << '\n';
+            ss << "    publiczny statyczny void " << method_name(m) << "(Łańcuch pierwszy, Łańcuch drugi) {\n";
+            for (unsigned s = 0; s < params_.statements; ++s)
+                statement(ss, imported);
+            ss << "    }\n";
+        }
+        ss << "\n}\n";
+
+        std::string source = std::move(ss).str();
+        os << source;
+        std::size_t lines = 0;
+        for (char ch : source)
+            lines += ch == '\n';
+        return lines;
+    }
+
+    /**
+     * Writes the project into a directory. The package directories are created as well, because jawac
+     * writes the class files there.
+     *
+     * @param directory project directory.
+     * @return number of written lines.
+     */
+    std::size_t
+    write_project(const std::filesystem::path &directory)
+    {
+        std::filesystem::create_directories(directory);
+        std::ofstream manifest(directory / "pliki.txt");
+        std::size_t lines = 0;
+
+        for (unsigned klass = 0; klass < params_.classes; ++klass) {
+            std::filesystem::path package_dir = directory / "gen" / ("p" + std::to_string(klass % params_.packages));
+            std::filesystem::create_directories(package_dir);
+
+            std::filesystem::path file = package_dir / (class_name(klass) + ".jawa");
+            std::ofstream os(file);
+            lines += write_class(os, klass);
+            manifest << std::filesystem::relative(file, directory).string() << '\n';
+        }
+        return lines;
+    }
+};
+
+static void
+show_usage(const char *name)
+{
+    std::cerr << "usage: " << name
+              << " [--classes N] [--methods N] [--statements N] [--imports N] [--literals N] [--packages N]"
+                 " [--seed N] <OUTPUT_DIRECTORY>"
+              << std::endl;
+}
+
+int
+main(int argc, char *argv[])
+{
+    parameters_t params;
+    const char *output = nullptr;
+
+    struct option_t
+    {
+        const char *name;
+        unsigned *value;
+    } options[] = {
+        { "--classes", &params.classes },   { "--methods", &params.methods },   { "--statements", &params.statements },
+        { "--imports", &params.imports },   { "--literals", &params.literals }, { "--packages", &params.packages },
+        { "--seed", &params.seed },
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        bool matched = false;
+        for (auto &option : options) {
+            if (strcmp(argv[i], option.name) == 0 && i + 1 < argc) {
+                *option.value = std::stoul(argv[++i]);
+                matched = true;
+                break;
+            }
+        }
+        if (matched)
+            continue;
+        if (output || argv[i][0] == '-') {
+            show_usage(argv[0]);
+            return 1;
+        }
+        output = argv[i];
+    }
+
+    if (!output || params.classes == 0 || params.methods == 0 || params.literals == 0 || params.packages == 0) {
+        show_usage(argv[0]);
+        return 1;
+    }
+
+    Generator generator(params);
+    std::size_t lines = generator.write_project(output);
+    std::cout << params.classes << " classes, " << lines << " lines written to " << output << std::endl;
+
+    return 0;
+}
@@ -8,15 +8,111 @@
  * Copyright (c) 2021 Peter Grajcar
  */
 #include "jawa_io_StrumieńDrukowania.hpp"
-#include <iostream>
+#include <cerrno>
+#include <mutex>
+#include <vector>
+
+#include <unistd.h>
+
+/**
+ * Buffer of the standard output. It is written by a single write call when it is full, when it is flushed
+ * explicitly and when the library is unloaded at the exit of the virtual machine. A terminal gets each line as
+ * soon as it is printed, as with the C standard output.
+ */
+class OutputBuffer
+{
+private:
+    static constexpr std::size_t Capacity = 64 * 1024;
+
+    int fd_;
+    bool line_buffered_;
+    std::vector<char> buffer_;
+    std::size_t size_;
+    std::mutex mutex_;
+
+    void
+    write_all(const char *data, std::size_t size)
+    {
+        while (size > 0) {
+            ssize_t written = ::write(fd_, data, size);
+            if (written < 0) {
+                if (errno == EINTR)
+                    continue;
+                // there is nowhere to report the error to
+                return;
+            }
+            data += written;
+            size -= written;
+        }
+    }
+
+    void
+    flush_locked()
+    {
+        write_all(buffer_.data(), size_);
+        size_ = 0;
+    }
+
+public:
+    explicit OutputBuffer(int fd)
+      : fd_(fd)
+      , line_buffered_(::isatty(fd))
+      , buffer_(Capacity)
+      , size_(0)
+      , mutex_()
+    {}
+
+    ~OutputBuffer()
+    {
+        flush_locked();
+    }
+
+    /**
+     * Appends a string followed by a new line.
+     */
+    void
+    print_line(JNIEnv *env, jstring str)
+    {
+        jsize length = env->GetStringLength(str);
+        auto size = static_cast<std::size_t>(env->GetStringUTFLength(str));
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (size_ + size + 1 > Capacity)
+            flush_locked();
+        if (size + 1 > Capacity) {
+            // the string is copied to a temporary buffer only if it does not fit in an empty buffer
+            std::vector<char> line(size + 1);
+            env->GetStringUTFRegion(str, 0, length, line.data());
+            line[size] = '\n';
+            write_all(line.data(), line.size());
+            return;
+        }
+        // the characters are converted directly into the buffer
+        env->GetStringUTFRegion(str, 0, length, buffer_.data() + size_);
+        size_ += size;
+        buffer_[size_++] = '\n';
+        if (line_buffered_)
+            flush_locked();
+    }
+
+    void
+    flush()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_locked();
+    }
+};
+
+static OutputBuffer output(STDOUT_FILENO);
 
 JNIEXPORT void JNICALL
 Java_jawa_io_Strumie_00144Drukowania_wydrukova_00107(JNIEnv *env, jobject obj, jstring str)
 {
-    jboolean is_copy = false;
-    auto *ch = env->GetStringUTFChars(str, &is_copy);
-    jsize size = env->GetStringUTFLength(str);
-    for (jsize i = 0; i < size; ++i, ++ch)
-        std::cout << (char) *ch;
-    std::cout << std::endl;
+    output.print_line(env, str);
+}
+
+JNIEXPORT void JNICALL
+Java_jawa_io_Strumie_00144Drukowania_opr_000f3_0017cnij(JNIEnv *env, jobject obj)
+{
+    output.flush();
 }
@@ -24,6 +24,14 @@ extern "C"
     JNIEXPORT void JNICALL
     Java_jawa_io_Strumie_00144Drukowania_wydrukova_00107(JNIEnv *, jobject, jstring);
 
+    /*
+     * Class:     jawa_io_StrumieńDrukowania
+     * Method:    opróżnij
+     * Signature: ()V
+     */
+    JNIEXPORT void JNICALL
+    Java_jawa_io_Strumie_00144Drukowania_opr_000f3_0017cnij(JNIEnv *, jobject);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,46 @@
+/**
+ * @file jawa_io_StrumieńWejścia.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+#include "jawa_io_StrumieńWejścia.hpp"
+#include "jawa_io_pliki.hpp"
+
+#include <unistd.h>
+
+JNIEXPORT jint JNICALL
+Java_jawa_io_Strumie_00144Wej_0015bcia_otw_000f3rz(JNIEnv *env, jclass cls, jstring path)
+{
+    return open_file(env, path, O_RDONLY);
+}
+
+/**
+ * Reads into the memory of a direct buffer, the bytes are then copied to the Jawa arrays by the buffer itself
+ * without any JNI array access.
+ */
+JNIEXPORT jint JNICALL
+Java_jawa_io_Strumie_00144Wej_0015bcia_wype_00142nij(JNIEnv *env, jclass cls, jint fd, jobject buffer)
+{
+    void *data = env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    ssize_t count;
+    do {
+        count = ::read(fd, data, static_cast<std::size_t>(capacity));
+    } while (count < 0 && errno == EINTR);
+    if (count < 0) {
+        throw_io_exception(env, "read");
+        return 0;
+    }
+    return static_cast<jint>(count);
+}
+
+JNIEXPORT void JNICALL
+Java_jawa_io_Strumie_00144Wej_0015bcia_zamknijDeskryptor(JNIEnv *env, jclass cls, jint fd)
+{
+    if (fd >= 0)
+        ::close(fd);
+}
@@ -0,0 +1,47 @@
+/**
+ * @file jawa_io_StrumieńWyjścia.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+#include "jawa_io_StrumieńWyjścia.hpp"
+#include "jawa_io_pliki.hpp"
+
+#include <unistd.h>
+
+JNIEXPORT jint JNICALL
+Java_jawa_io_Strumie_00144Wyj_0015bcia_otw_000f3rz(JNIEnv *env, jclass cls, jstring path)
+{
+    return open_file(env, path, O_WRONLY | O_CREAT | O_TRUNC);
+}
+
+/**
+ * Writes the beginning of a direct buffer which the Jawa side has filled.
+ */
+JNIEXPORT void JNICALL
+Java_jawa_io_Strumie_00144Wyj_0015bcia_zapisz(JNIEnv *env, jclass cls, jint fd, jobject buffer, jint length)
+{
+    auto data = static_cast<const char *>(env->GetDirectBufferAddress(buffer));
+    auto size = static_cast<std::size_t>(length);
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            throw_io_exception(env, "write");
+            return;
+        }
+        data += written;
+        size -= written;
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_jawa_io_Strumie_00144Wyj_0015bcia_zamknijDeskryptor(JNIEnv *env, jclass cls, jint fd)
+{
+    if (fd >= 0 && ::close(fd) < 0 && errno != EINTR)
+        throw_io_exception(env, "close");
+}
@@ -0,0 +1,46 @@
+/**
+ * @file jawa_io_StrumieńWyjścia.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+#include <jni.h>
+
+#ifndef _Included_jawa_io_Strumie_00144Wyj_0015bcia
+#define _Included_jawa_io_Strumie_00144Wyj_0015bcia
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /*
+     * Class:     jawa_io_StrumieńWyjścia
+     * Method:    otwórz
+     * Signature: (Ljava/lang/String;)I
+     */
+    JNIEXPORT jint JNICALL
+    Java_jawa_io_Strumie_00144Wyj_0015bcia_otw_000f3rz(JNIEnv *, jclass, jstring);
+
+    /*
+     * Class:     jawa_io_StrumieńWyjścia
+     * Method:    zapisz
+     * Signature: (ILjava/nio/ByteBuffer;I)V
+     */
+    JNIEXPORT void JNICALL
+    Java_jawa_io_Strumie_00144Wyj_0015bcia_zapisz(JNIEnv *, jclass, jint, jobject, jint);
+
+    /*
+     * Class:     jawa_io_StrumieńWyjścia
+     * Method:    zamknijDeskryptor
+     * Signature: (I)V
+     */
+    JNIEXPORT void JNICALL
+    Java_jawa_io_Strumie_00144Wyj_0015bcia_zamknijDeskryptor(JNIEnv *, jclass, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
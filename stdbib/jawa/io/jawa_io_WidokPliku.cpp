@@ -0,0 +1,81 @@
+/**
+ * @file jawa_io_WidokPliku.cpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+#include "jawa_io_WidokPliku.hpp"
+#include "jawa_io_pliki.hpp"
+
+#include <limits>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// an empty file cannot be mapped, its view is an empty buffer with a valid address
+static char empty_view;
+
+/**
+ * Maps a whole file to memory. The buffer is writable as far as the virtual machine knows, the Jawa side only
+ * hands out its read-only duplicates.
+ */
+JNIEXPORT jobject JNICALL
+Java_jawa_io_WidokPliku_mapuj(JNIEnv *env, jclass cls, jstring path)
+{
+    int fd = open_file(env, path, O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info;
+    if (::fstat(fd, &info) < 0) {
+        throw_io_exception(env, "fstat");
+        ::close(fd);
+        return nullptr;
+    }
+    // the buffers are indexed by int
+    if (info.st_size > std::numeric_limits<jint>::max()) {
+        errno = EFBIG;
+        throw_io_exception(env, "mmap");
+        ::close(fd);
+        return nullptr;
+    }
+    if (info.st_size == 0) {
+        ::close(fd);
+        return env->NewDirectByteBuffer(&empty_view, 0);
+    }
+
+    auto size = static_cast<std::size_t>(info.st_size);
+    void *data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        throw_io_exception(env, "mmap");
+        return nullptr;
+    }
+    ::madvise(data, size, MADV_SEQUENTIAL);
+
+    jobject buffer = env->NewDirectByteBuffer(data, static_cast<jlong>(size));
+    if (buffer == nullptr)
+        ::munmap(data, size);
+    return buffer;
+}
+
+JNIEXPORT jint JNICALL
+Java_jawa_io_WidokPliku_pojemno_0015b_00107(JNIEnv *env, jclass cls, jobject buffer)
+{
+    return static_cast<jint>(env->GetDirectBufferCapacity(buffer));
+}
+
+JNIEXPORT void JNICALL
+Java_jawa_io_WidokPliku_odmapuj(JNIEnv *env, jclass cls, jobject buffer)
+{
+    void *data = env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    // a buffer which is not direct has no address
+    if (data != nullptr && capacity > 0)
+        ::munmap(data, static_cast<std::size_t>(capacity));
+}
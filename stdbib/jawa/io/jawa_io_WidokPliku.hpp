@@ -0,0 +1,46 @@
+/**
+ * @file jawa_io_WidokPliku.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+#include <jni.h>
+
+#ifndef _Included_jawa_io_WidokPliku
+#define _Included_jawa_io_WidokPliku
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /*
+     * Class:     jawa_io_WidokPliku
+     * Method:    mapuj
+     * Signature: (Ljava/lang/String;)Ljava/nio/ByteBuffer;
+     */
+    JNIEXPORT jobject JNICALL
+    Java_jawa_io_WidokPliku_mapuj(JNIEnv *, jclass, jstring);
+
+    /*
+     * Class:     jawa_io_WidokPliku
+     * Method:    pojemność
+     * Signature: (Ljava/nio/ByteBuffer;)I
+     */
+    JNIEXPORT jint JNICALL
+    Java_jawa_io_WidokPliku_pojemno_0015b_00107(JNIEnv *, jclass, jobject);
+
+    /*
+     * Class:     jawa_io_WidokPliku
+     * Method:    odmapuj
+     * Signature: (Ljava/nio/ByteBuffer;)V
+     */
+    JNIEXPORT void JNICALL
+    Java_jawa_io_WidokPliku_odmapuj(JNIEnv *, jclass, jobject);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,56 @@
+/**
+ * @file jawa_io_pliki.hpp
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2021 Peter Grajcar
+ */
+#ifndef JAWA_IO_PLIKI_HPP
+#define JAWA_IO_PLIKI_HPP
+
+#include <jni.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+
+/**
+ * Throws java.io.IOException with the description of errno. The native method has to return right after.
+ */
+inline void
+throw_io_exception(JNIEnv *env, const std::string &what)
+{
+    std::string message = what + ": " + std::strerror(errno);
+    jclass exception = env->FindClass("java/io/IOException");
+    if (exception != nullptr)
+        env->ThrowNew(exception, message.c_str());
+}
+
+/**
+ * Opens a file named by a Jawa string.
+ *
+ * @return file descriptor, -1 if an exception is pending.
+ */
+inline int
+open_file(JNIEnv *env, jstring path, int flags)
+{
+    const char *chars = env->GetStringUTFChars(path, nullptr);
+    if (chars == nullptr)
+        return -1;
+    std::string name(chars);
+    env->ReleaseStringUTFChars(path, chars);
+
+    int fd;
+    do {
+        fd = ::open(name.c_str(), flags | O_CLOEXEC, 0666);
+    } while (fd < 0 && errno == EINTR);
+    if (fd < 0)
+        throw_io_exception(env, name);
+    return fd;
+}
+
+#endif // JAWA_IO_PLIKI_HPP
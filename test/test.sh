@@ -7,8 +7,11 @@
 
 JAWAC=jawac
 
-BIN_DIR=$(dirname "$0")/../build/jawa
-TEST_DIR=$(dirname "$0")/../test
+ROOT_DIR=$(cd "$(dirname "$0")/.." && pwd)
+BIN_DIR=$ROOT_DIR/build/jawa
+TEST_DIR=$ROOT_DIR/test
+STDBIB_DIR=$ROOT_DIR/stdbib
+NATIVE_DIR=$ROOT_DIR/build/stdbib
 
 if [ ! -f "$BIN_DIR/$JAWAC" ]; then
   echo "could not found $BIN_DIR/$JAWAC" &>/dev/stderr
@@ -26,7 +29,28 @@ for TEST in "$TEST_DIR"/*.jawa; do
   TEST_NAME=$(basename "$TEST")
   printf "==== TEST %-20s ====\n" "$TEST_NAME"
   GOLD=$(echo "$TEST" | sed "s/\.jawa/.out/")
-  if "$BIN_DIR/$JAWAC" "$TEST" 2>/dev/null | diff "$GOLD" -; then
+  # the compiler options of a test are listed in the file with the .opcje extension
+  OPTIONS_FILE=$(echo "$TEST" | sed "s/\.jawa/.opcje/")
+  OPTIONS=
+  if [ -f "$OPTIONS_FILE" ]; then
+    OPTIONS=$(cat "$OPTIONS_FILE")
+  fi
+  CLASS_DIR=$(mktemp -d)
+  if grep -q "głowny(" "$TEST"; then
+    # programs are compiled and run, the output of the program is compared
+    CLASS_NAME=$(basename "$TEST" .jawa)
+    OUTPUT=$( (cd "$CLASS_DIR" &&
+               "$BIN_DIR/$JAWAC" $OPTIONS --ścieżkaklasy ".:$STDBIB_DIR:$JAVA_CLASSPATH" "$TEST" >/dev/null 2>&1) &&
+             java -Djava.library.path="$NATIVE_DIR" -classpath "$CLASS_DIR:$STDBIB_DIR" "$CLASS_NAME" 2>&1)
+  else
+    OUTPUT=$(cd "$CLASS_DIR" && "$BIN_DIR/$JAWAC" $OPTIONS "$TEST" 2>/dev/null)
+  fi
+  rm -rf "$CLASS_DIR"
+  # the command substitution strips the newline ending the output
+  if [ -n "$OUTPUT" ]; then
+    OUTPUT=$OUTPUT$'\n'
+  fi
+  if printf "%s" "$OUTPUT" | diff "$GOLD" -; then
     echo "\e[0;32m$TEST_NAME PASSED\e[0m"
     PASSED=${PASSED}1
   else